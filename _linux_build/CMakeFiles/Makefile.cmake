@@ -0,0 +1,114 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/root/repo/cmake/PkgConfigHandler.cmake"
+  "/root/repo/cmake/WindowsDebug.cmake"
+  "/root/repo/include/version.h.in"
+  "/root/repo/src/cec-client/CMakeLists.txt"
+  "/root/repo/src/cec-client/env.h.in"
+  "/root/repo/src/cec-daemon/CMakeLists.txt"
+  "/root/repo/src/cecc-client/CMakeLists.txt"
+  "/root/repo/src/cecc-client/env.h.in"
+  "/root/repo/src/libcec/CMakeLists.txt"
+  "/root/repo/src/libcec/bench/CMakeLists.txt"
+  "/root/repo/src/libcec/cmake/CheckPlatformSupport.cmake"
+  "/root/repo/src/libcec/cmake/DisplayPlatformSupport.cmake"
+  "/root/repo/src/libcec/cmake/LinkPlatformSupport.cmake"
+  "/root/repo/src/libcec/cmake/SetBuildInfo.cmake"
+  "/root/repo/src/libcec/emulator/CMakeLists.txt"
+  "/root/repo/src/libcec/env.h.in"
+  "/root/repo/src/libcec/libcec.pc.in"
+  "/root/repo/src/libcec/tests/CMakeLists.txt"
+  "/root/repo/src/pyCecClient/CMakeLists.txt"
+  "/usr/share/cmake-3.25/Modules/BasicConfigVersion-AnyNewerVersion.cmake.in"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCheckCompilerFlagCommonPatterns.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakePackageConfigHelpers.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCXXCompilerFlag.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCXXSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckFunctionExists.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFile.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckSymbolExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPkgConfig.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPython/Support.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPython3.cmake"
+  "/usr/share/cmake-3.25/Modules/FindSWIG.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/GNUInstallDirs.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckCompilerFlag.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckFlagCommonConfig.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  "/usr/share/cmake-3.25/Modules/WriteBasicConfigVersionFile.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "/root/repo/include/version.h"
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "/root/repo/src/cec-client/env.h"
+  "src/cec-client/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "/root/repo/src/cecc-client/env.h"
+  "src/cecc-client/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/pyCecClient/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/cec-daemon/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "/root/repo/src/libcec/env.h"
+  "/root/repo/src/libcec/libcec.pc"
+  "src/libcec/libcec-config-version.cmake"
+  "src/libcec/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/libcec/emulator/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/libcec/tests/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/libcec/bench/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "src/cec-client/CMakeFiles/cec-client.dir/DependInfo.cmake"
+  "src/cecc-client/CMakeFiles/cecc-client.dir/DependInfo.cmake"
+  "src/cec-daemon/CMakeFiles/cec-daemon.dir/DependInfo.cmake"
+  "src/libcec/CMakeFiles/libobj.dir/DependInfo.cmake"
+  "src/libcec/CMakeFiles/cec-shared.dir/DependInfo.cmake"
+  "src/libcec/CMakeFiles/cec-static.dir/DependInfo.cmake"
+  "src/libcec/emulator/CMakeFiles/usbcec-emulator.dir/DependInfo.cmake"
+  "src/libcec/emulator/CMakeFiles/cec-p8-emulator.dir/DependInfo.cmake"
+  "src/libcec/tests/CMakeFiles/cec-virtual-test.dir/DependInfo.cmake"
+  "src/libcec/tests/CMakeFiles/cec-usb-emulator-test.dir/DependInfo.cmake"
+  "src/libcec/tests/CMakeFiles/cec-vivid-test.dir/DependInfo.cmake"
+  "src/libcec/bench/CMakeFiles/libcec-bench.dir/DependInfo.cmake"
+  )
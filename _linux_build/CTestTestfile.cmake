@@ -0,0 +1,11 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo
+# Build directory: /root/repo/_linux_build
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+subdirs("src/cec-client")
+subdirs("src/cecc-client")
+subdirs("src/pyCecClient")
+subdirs("src/cec-daemon")
+subdirs("src/libcec")
@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/cec-client/cec-client.cpp" "src/cec-client/CMakeFiles/cec-client.dir/cec-client.cpp.o" "gcc" "src/cec-client/CMakeFiles/cec-client.dir/cec-client.cpp.o.d"
+  "/root/repo/src/cec-client/curses/CursesControl.cpp" "src/cec-client/CMakeFiles/cec-client.dir/curses/CursesControl.cpp.o" "gcc" "src/cec-client/CMakeFiles/cec-client.dir/curses/CursesControl.cpp.o.d"
+  "/root/repo/src/cec-client/metrics/MetricsExporter.cpp" "src/cec-client/CMakeFiles/cec-client.dir/metrics/MetricsExporter.cpp.o" "gcc" "src/cec-client/CMakeFiles/cec-client.dir/metrics/MetricsExporter.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
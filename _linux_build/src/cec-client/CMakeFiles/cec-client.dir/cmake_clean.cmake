@@ -0,0 +1,16 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cec-client.dir/cec-client.cpp.o"
+  "CMakeFiles/cec-client.dir/cec-client.cpp.o.d"
+  "CMakeFiles/cec-client.dir/curses/CursesControl.cpp.o"
+  "CMakeFiles/cec-client.dir/curses/CursesControl.cpp.o.d"
+  "CMakeFiles/cec-client.dir/metrics/MetricsExporter.cpp.o"
+  "CMakeFiles/cec-client.dir/metrics/MetricsExporter.cpp.o.d"
+  "cec-client"
+  "cec-client-8.1.6"
+  "cec-client.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cec-client.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cec-daemon.dir/cec-daemon.cpp.o"
+  "CMakeFiles/cec-daemon.dir/cec-daemon.cpp.o.d"
+  "cec-daemon"
+  "cec-daemon-8.1.6"
+  "cec-daemon.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cec-daemon.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
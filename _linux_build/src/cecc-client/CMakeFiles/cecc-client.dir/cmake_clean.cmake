@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cecc-client.dir/cecc-client.c.o"
+  "CMakeFiles/cecc-client.dir/cecc-client.c.o.d"
+  "cecc-client"
+  "cecc-client-8.1.6"
+  "cecc-client.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/cecc-client.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,29 @@
+#----------------------------------------------------------------
+# Generated CMake target import file.
+#----------------------------------------------------------------
+
+# Commands may need to know the format version.
+set(CMAKE_IMPORT_FILE_VERSION 1)
+
+# Import target "libcec::cec-shared" for configuration ""
+set_property(TARGET libcec::cec-shared APPEND PROPERTY IMPORTED_CONFIGURATIONS NOCONFIG)
+set_target_properties(libcec::cec-shared PROPERTIES
+  IMPORTED_LOCATION_NOCONFIG "${_IMPORT_PREFIX}/lib/libcec.so.8.1.6"
+  IMPORTED_SONAME_NOCONFIG "libcec.so.8"
+  )
+
+list(APPEND _cmake_import_check_targets libcec::cec-shared )
+list(APPEND _cmake_import_check_files_for_libcec::cec-shared "${_IMPORT_PREFIX}/lib/libcec.so.8.1.6" )
+
+# Import target "libcec::cec-static" for configuration ""
+set_property(TARGET libcec::cec-static APPEND PROPERTY IMPORTED_CONFIGURATIONS NOCONFIG)
+set_target_properties(libcec::cec-static PROPERTIES
+  IMPORTED_LINK_INTERFACE_LANGUAGES_NOCONFIG "CXX"
+  IMPORTED_LOCATION_NOCONFIG "${_IMPORT_PREFIX}/lib/libcec.a"
+  )
+
+list(APPEND _cmake_import_check_targets libcec::cec-static )
+list(APPEND _cmake_import_check_files_for_libcec::cec-static "${_IMPORT_PREFIX}/lib/libcec.a" )
+
+# Commands beyond this point should not need to know the version.
+set(CMAKE_IMPORT_FILE_VERSION)
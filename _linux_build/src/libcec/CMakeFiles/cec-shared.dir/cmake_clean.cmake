@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "libcec.pdb"
+  "libcec.so"
+  "libcec.so.8"
+  "libcec.so.8.1.6"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cec-shared.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
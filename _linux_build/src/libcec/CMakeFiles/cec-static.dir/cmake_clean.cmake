@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "libcec.a"
+  "libcec.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cec-static.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
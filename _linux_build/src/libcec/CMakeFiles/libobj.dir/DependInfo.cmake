@@ -0,0 +1,63 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/libcec/CECCallbackQueue.cpp" "src/libcec/CMakeFiles/libobj.dir/CECCallbackQueue.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/CECCallbackQueue.cpp.o.d"
+  "/root/repo/src/libcec/CECClient.cpp" "src/libcec/CMakeFiles/libobj.dir/CECClient.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/CECClient.cpp.o.d"
+  "/root/repo/src/libcec/CECLatencyStats.cpp" "src/libcec/CMakeFiles/libobj.dir/CECLatencyStats.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/CECLatencyStats.cpp.o.d"
+  "/root/repo/src/libcec/CECProcessor.cpp" "src/libcec/CMakeFiles/libobj.dir/CECProcessor.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/CECProcessor.cpp.o.d"
+  "/root/repo/src/libcec/CECTimerService.cpp" "src/libcec/CMakeFiles/libobj.dir/CECTimerService.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/CECTimerService.cpp.o.d"
+  "/root/repo/src/libcec/CECTrafficCapture.cpp" "src/libcec/CMakeFiles/libobj.dir/CECTrafficCapture.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/CECTrafficCapture.cpp.o.d"
+  "/root/repo/src/libcec/CECTransmitScheduler.cpp" "src/libcec/CMakeFiles/libobj.dir/CECTransmitScheduler.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/CECTransmitScheduler.cpp.o.d"
+  "/root/repo/src/libcec/LibCEC.cpp" "src/libcec/CMakeFiles/libobj.dir/LibCEC.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/LibCEC.cpp.o.d"
+  "/root/repo/src/libcec/LibCECC.cpp" "src/libcec/CMakeFiles/libobj.dir/LibCECC.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/LibCECC.cpp.o.d"
+  "/root/repo/src/libcec/adapter/AdapterFactory.cpp" "src/libcec/CMakeFiles/libobj.dir/adapter/AdapterFactory.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/adapter/AdapterFactory.cpp.o.d"
+  "/root/repo/src/libcec/adapter/Daemon/DaemonCECAdapterCommunication.cpp" "src/libcec/CMakeFiles/libobj.dir/adapter/Daemon/DaemonCECAdapterCommunication.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/adapter/Daemon/DaemonCECAdapterCommunication.cpp.o.d"
+  "/root/repo/src/libcec/adapter/Daemon/DaemonCECServer.cpp" "src/libcec/CMakeFiles/libobj.dir/adapter/Daemon/DaemonCECServer.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/adapter/Daemon/DaemonCECServer.cpp.o.d"
+  "/root/repo/src/libcec/adapter/Daemon/DaemonProtocol.cpp" "src/libcec/CMakeFiles/libobj.dir/adapter/Daemon/DaemonProtocol.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/adapter/Daemon/DaemonProtocol.cpp.o.d"
+  "/root/repo/src/libcec/adapter/Linux/LinuxCECAdapterCommunication.cpp" "src/libcec/CMakeFiles/libobj.dir/adapter/Linux/LinuxCECAdapterCommunication.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/adapter/Linux/LinuxCECAdapterCommunication.cpp.o.d"
+  "/root/repo/src/libcec/adapter/Linux/LinuxCECAdapterDetection.cpp" "src/libcec/CMakeFiles/libobj.dir/adapter/Linux/LinuxCECAdapterDetection.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/adapter/Linux/LinuxCECAdapterDetection.cpp.o.d"
+  "/root/repo/src/libcec/adapter/Pulse-Eight/USBCECAdapterCommands.cpp" "src/libcec/CMakeFiles/libobj.dir/adapter/Pulse-Eight/USBCECAdapterCommands.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/adapter/Pulse-Eight/USBCECAdapterCommands.cpp.o.d"
+  "/root/repo/src/libcec/adapter/Pulse-Eight/USBCECAdapterCommunication.cpp" "src/libcec/CMakeFiles/libobj.dir/adapter/Pulse-Eight/USBCECAdapterCommunication.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/adapter/Pulse-Eight/USBCECAdapterCommunication.cpp.o.d"
+  "/root/repo/src/libcec/adapter/Pulse-Eight/USBCECAdapterDetection.cpp" "src/libcec/CMakeFiles/libobj.dir/adapter/Pulse-Eight/USBCECAdapterDetection.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/adapter/Pulse-Eight/USBCECAdapterDetection.cpp.o.d"
+  "/root/repo/src/libcec/adapter/Pulse-Eight/USBCECAdapterMessage.cpp" "src/libcec/CMakeFiles/libobj.dir/adapter/Pulse-Eight/USBCECAdapterMessage.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/adapter/Pulse-Eight/USBCECAdapterMessage.cpp.o.d"
+  "/root/repo/src/libcec/adapter/Pulse-Eight/USBCECAdapterMessageQueue.cpp" "src/libcec/CMakeFiles/libobj.dir/adapter/Pulse-Eight/USBCECAdapterMessageQueue.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/adapter/Pulse-Eight/USBCECAdapterMessageQueue.cpp.o.d"
+  "/root/repo/src/libcec/adapter/Virtual/ReplayCECAdapterCommunication.cpp" "src/libcec/CMakeFiles/libobj.dir/adapter/Virtual/ReplayCECAdapterCommunication.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/adapter/Virtual/ReplayCECAdapterCommunication.cpp.o.d"
+  "/root/repo/src/libcec/adapter/Virtual/VirtualCECAdapterCommunication.cpp" "src/libcec/CMakeFiles/libobj.dir/adapter/Virtual/VirtualCECAdapterCommunication.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/adapter/Virtual/VirtualCECAdapterCommunication.cpp.o.d"
+  "/root/repo/src/libcec/adapter/Virtual/VirtualCECPeer.cpp" "src/libcec/CMakeFiles/libobj.dir/adapter/Virtual/VirtualCECPeer.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/adapter/Virtual/VirtualCECPeer.cpp.o.d"
+  "/root/repo/src/libcec/devices/CECAudioSystem.cpp" "src/libcec/CMakeFiles/libobj.dir/devices/CECAudioSystem.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/devices/CECAudioSystem.cpp.o.d"
+  "/root/repo/src/libcec/devices/CECBusDevice.cpp" "src/libcec/CMakeFiles/libobj.dir/devices/CECBusDevice.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/devices/CECBusDevice.cpp.o.d"
+  "/root/repo/src/libcec/devices/CECDeviceCache.cpp" "src/libcec/CMakeFiles/libobj.dir/devices/CECDeviceCache.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/devices/CECDeviceCache.cpp.o.d"
+  "/root/repo/src/libcec/devices/CECDeviceMap.cpp" "src/libcec/CMakeFiles/libobj.dir/devices/CECDeviceMap.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/devices/CECDeviceMap.cpp.o.d"
+  "/root/repo/src/libcec/devices/CECPlaybackDevice.cpp" "src/libcec/CMakeFiles/libobj.dir/devices/CECPlaybackDevice.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/devices/CECPlaybackDevice.cpp.o.d"
+  "/root/repo/src/libcec/devices/CECRecordingDevice.cpp" "src/libcec/CMakeFiles/libobj.dir/devices/CECRecordingDevice.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/devices/CECRecordingDevice.cpp.o.d"
+  "/root/repo/src/libcec/devices/CECTV.cpp" "src/libcec/CMakeFiles/libobj.dir/devices/CECTV.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/devices/CECTV.cpp.o.d"
+  "/root/repo/src/libcec/devices/CECTuner.cpp" "src/libcec/CMakeFiles/libobj.dir/devices/CECTuner.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/devices/CECTuner.cpp.o.d"
+  "/root/repo/src/libcec/implementations/ANCommandHandler.cpp" "src/libcec/CMakeFiles/libobj.dir/implementations/ANCommandHandler.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/implementations/ANCommandHandler.cpp.o.d"
+  "/root/repo/src/libcec/implementations/AQCommandHandler.cpp" "src/libcec/CMakeFiles/libobj.dir/implementations/AQCommandHandler.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/implementations/AQCommandHandler.cpp.o.d"
+  "/root/repo/src/libcec/implementations/CECCommandHandler.cpp" "src/libcec/CMakeFiles/libobj.dir/implementations/CECCommandHandler.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/implementations/CECCommandHandler.cpp.o.d"
+  "/root/repo/src/libcec/implementations/PHCommandHandler.cpp" "src/libcec/CMakeFiles/libobj.dir/implementations/PHCommandHandler.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/implementations/PHCommandHandler.cpp.o.d"
+  "/root/repo/src/libcec/implementations/RHCommandHandler.cpp" "src/libcec/CMakeFiles/libobj.dir/implementations/RHCommandHandler.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/implementations/RHCommandHandler.cpp.o.d"
+  "/root/repo/src/libcec/implementations/RLCommandHandler.cpp" "src/libcec/CMakeFiles/libobj.dir/implementations/RLCommandHandler.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/implementations/RLCommandHandler.cpp.o.d"
+  "/root/repo/src/libcec/implementations/SLCommandHandler.cpp" "src/libcec/CMakeFiles/libobj.dir/implementations/SLCommandHandler.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/implementations/SLCommandHandler.cpp.o.d"
+  "/root/repo/src/libcec/implementations/SYCommandHandler.cpp" "src/libcec/CMakeFiles/libobj.dir/implementations/SYCommandHandler.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/implementations/SYCommandHandler.cpp.o.d"
+  "/root/repo/src/libcec/implementations/VLCommandHandler.cpp" "src/libcec/CMakeFiles/libobj.dir/implementations/VLCommandHandler.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/implementations/VLCommandHandler.cpp.o.d"
+  "/root/repo/src/libcec/platform/adl/adl-edid.cpp" "src/libcec/CMakeFiles/libobj.dir/platform/adl/adl-edid.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/platform/adl/adl-edid.cpp.o.d"
+  "/root/repo/src/libcec/platform/drm/drm-edid.cpp" "src/libcec/CMakeFiles/libobj.dir/platform/drm/drm-edid.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/platform/drm/drm-edid.cpp.o.d"
+  "/root/repo/src/libcec/platform/nvidia/nv-edid.cpp" "src/libcec/CMakeFiles/libobj.dir/platform/nvidia/nv-edid.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/platform/nvidia/nv-edid.cpp.o.d"
+  "/root/repo/src/libcec/platform/posix/os-edid.cpp" "src/libcec/CMakeFiles/libobj.dir/platform/posix/os-edid.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/platform/posix/os-edid.cpp.o.d"
+  "/root/repo/src/libcec/platform/posix/serialport.cpp" "src/libcec/CMakeFiles/libobj.dir/platform/posix/serialport.cpp.o" "gcc" "src/libcec/CMakeFiles/libobj.dir/platform/posix/serialport.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,97 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/libobj.dir/CECCallbackQueue.cpp.o"
+  "CMakeFiles/libobj.dir/CECCallbackQueue.cpp.o.d"
+  "CMakeFiles/libobj.dir/CECClient.cpp.o"
+  "CMakeFiles/libobj.dir/CECClient.cpp.o.d"
+  "CMakeFiles/libobj.dir/CECLatencyStats.cpp.o"
+  "CMakeFiles/libobj.dir/CECLatencyStats.cpp.o.d"
+  "CMakeFiles/libobj.dir/CECProcessor.cpp.o"
+  "CMakeFiles/libobj.dir/CECProcessor.cpp.o.d"
+  "CMakeFiles/libobj.dir/CECTimerService.cpp.o"
+  "CMakeFiles/libobj.dir/CECTimerService.cpp.o.d"
+  "CMakeFiles/libobj.dir/CECTrafficCapture.cpp.o"
+  "CMakeFiles/libobj.dir/CECTrafficCapture.cpp.o.d"
+  "CMakeFiles/libobj.dir/CECTransmitScheduler.cpp.o"
+  "CMakeFiles/libobj.dir/CECTransmitScheduler.cpp.o.d"
+  "CMakeFiles/libobj.dir/LibCEC.cpp.o"
+  "CMakeFiles/libobj.dir/LibCEC.cpp.o.d"
+  "CMakeFiles/libobj.dir/LibCECC.cpp.o"
+  "CMakeFiles/libobj.dir/LibCECC.cpp.o.d"
+  "CMakeFiles/libobj.dir/adapter/AdapterFactory.cpp.o"
+  "CMakeFiles/libobj.dir/adapter/AdapterFactory.cpp.o.d"
+  "CMakeFiles/libobj.dir/adapter/Daemon/DaemonCECAdapterCommunication.cpp.o"
+  "CMakeFiles/libobj.dir/adapter/Daemon/DaemonCECAdapterCommunication.cpp.o.d"
+  "CMakeFiles/libobj.dir/adapter/Daemon/DaemonCECServer.cpp.o"
+  "CMakeFiles/libobj.dir/adapter/Daemon/DaemonCECServer.cpp.o.d"
+  "CMakeFiles/libobj.dir/adapter/Daemon/DaemonProtocol.cpp.o"
+  "CMakeFiles/libobj.dir/adapter/Daemon/DaemonProtocol.cpp.o.d"
+  "CMakeFiles/libobj.dir/adapter/Linux/LinuxCECAdapterCommunication.cpp.o"
+  "CMakeFiles/libobj.dir/adapter/Linux/LinuxCECAdapterCommunication.cpp.o.d"
+  "CMakeFiles/libobj.dir/adapter/Linux/LinuxCECAdapterDetection.cpp.o"
+  "CMakeFiles/libobj.dir/adapter/Linux/LinuxCECAdapterDetection.cpp.o.d"
+  "CMakeFiles/libobj.dir/adapter/Pulse-Eight/USBCECAdapterCommands.cpp.o"
+  "CMakeFiles/libobj.dir/adapter/Pulse-Eight/USBCECAdapterCommands.cpp.o.d"
+  "CMakeFiles/libobj.dir/adapter/Pulse-Eight/USBCECAdapterCommunication.cpp.o"
+  "CMakeFiles/libobj.dir/adapter/Pulse-Eight/USBCECAdapterCommunication.cpp.o.d"
+  "CMakeFiles/libobj.dir/adapter/Pulse-Eight/USBCECAdapterDetection.cpp.o"
+  "CMakeFiles/libobj.dir/adapter/Pulse-Eight/USBCECAdapterDetection.cpp.o.d"
+  "CMakeFiles/libobj.dir/adapter/Pulse-Eight/USBCECAdapterMessage.cpp.o"
+  "CMakeFiles/libobj.dir/adapter/Pulse-Eight/USBCECAdapterMessage.cpp.o.d"
+  "CMakeFiles/libobj.dir/adapter/Pulse-Eight/USBCECAdapterMessageQueue.cpp.o"
+  "CMakeFiles/libobj.dir/adapter/Pulse-Eight/USBCECAdapterMessageQueue.cpp.o.d"
+  "CMakeFiles/libobj.dir/adapter/Virtual/ReplayCECAdapterCommunication.cpp.o"
+  "CMakeFiles/libobj.dir/adapter/Virtual/ReplayCECAdapterCommunication.cpp.o.d"
+  "CMakeFiles/libobj.dir/adapter/Virtual/VirtualCECAdapterCommunication.cpp.o"
+  "CMakeFiles/libobj.dir/adapter/Virtual/VirtualCECAdapterCommunication.cpp.o.d"
+  "CMakeFiles/libobj.dir/adapter/Virtual/VirtualCECPeer.cpp.o"
+  "CMakeFiles/libobj.dir/adapter/Virtual/VirtualCECPeer.cpp.o.d"
+  "CMakeFiles/libobj.dir/devices/CECAudioSystem.cpp.o"
+  "CMakeFiles/libobj.dir/devices/CECAudioSystem.cpp.o.d"
+  "CMakeFiles/libobj.dir/devices/CECBusDevice.cpp.o"
+  "CMakeFiles/libobj.dir/devices/CECBusDevice.cpp.o.d"
+  "CMakeFiles/libobj.dir/devices/CECDeviceCache.cpp.o"
+  "CMakeFiles/libobj.dir/devices/CECDeviceCache.cpp.o.d"
+  "CMakeFiles/libobj.dir/devices/CECDeviceMap.cpp.o"
+  "CMakeFiles/libobj.dir/devices/CECDeviceMap.cpp.o.d"
+  "CMakeFiles/libobj.dir/devices/CECPlaybackDevice.cpp.o"
+  "CMakeFiles/libobj.dir/devices/CECPlaybackDevice.cpp.o.d"
+  "CMakeFiles/libobj.dir/devices/CECRecordingDevice.cpp.o"
+  "CMakeFiles/libobj.dir/devices/CECRecordingDevice.cpp.o.d"
+  "CMakeFiles/libobj.dir/devices/CECTV.cpp.o"
+  "CMakeFiles/libobj.dir/devices/CECTV.cpp.o.d"
+  "CMakeFiles/libobj.dir/devices/CECTuner.cpp.o"
+  "CMakeFiles/libobj.dir/devices/CECTuner.cpp.o.d"
+  "CMakeFiles/libobj.dir/implementations/ANCommandHandler.cpp.o"
+  "CMakeFiles/libobj.dir/implementations/ANCommandHandler.cpp.o.d"
+  "CMakeFiles/libobj.dir/implementations/AQCommandHandler.cpp.o"
+  "CMakeFiles/libobj.dir/implementations/AQCommandHandler.cpp.o.d"
+  "CMakeFiles/libobj.dir/implementations/CECCommandHandler.cpp.o"
+  "CMakeFiles/libobj.dir/implementations/CECCommandHandler.cpp.o.d"
+  "CMakeFiles/libobj.dir/implementations/PHCommandHandler.cpp.o"
+  "CMakeFiles/libobj.dir/implementations/PHCommandHandler.cpp.o.d"
+  "CMakeFiles/libobj.dir/implementations/RHCommandHandler.cpp.o"
+  "CMakeFiles/libobj.dir/implementations/RHCommandHandler.cpp.o.d"
+  "CMakeFiles/libobj.dir/implementations/RLCommandHandler.cpp.o"
+  "CMakeFiles/libobj.dir/implementations/RLCommandHandler.cpp.o.d"
+  "CMakeFiles/libobj.dir/implementations/SLCommandHandler.cpp.o"
+  "CMakeFiles/libobj.dir/implementations/SLCommandHandler.cpp.o.d"
+  "CMakeFiles/libobj.dir/implementations/SYCommandHandler.cpp.o"
+  "CMakeFiles/libobj.dir/implementations/SYCommandHandler.cpp.o.d"
+  "CMakeFiles/libobj.dir/implementations/VLCommandHandler.cpp.o"
+  "CMakeFiles/libobj.dir/implementations/VLCommandHandler.cpp.o.d"
+  "CMakeFiles/libobj.dir/platform/adl/adl-edid.cpp.o"
+  "CMakeFiles/libobj.dir/platform/adl/adl-edid.cpp.o.d"
+  "CMakeFiles/libobj.dir/platform/drm/drm-edid.cpp.o"
+  "CMakeFiles/libobj.dir/platform/drm/drm-edid.cpp.o.d"
+  "CMakeFiles/libobj.dir/platform/nvidia/nv-edid.cpp.o"
+  "CMakeFiles/libobj.dir/platform/nvidia/nv-edid.cpp.o.d"
+  "CMakeFiles/libobj.dir/platform/posix/os-edid.cpp.o"
+  "CMakeFiles/libobj.dir/platform/posix/os-edid.cpp.o.d"
+  "CMakeFiles/libobj.dir/platform/posix/serialport.cpp.o"
+  "CMakeFiles/libobj.dir/platform/posix/serialport.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/libobj.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,9 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/src/libcec
+# Build directory: /root/repo/_linux_build/src/libcec
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+subdirs("emulator")
+subdirs("tests")
+subdirs("bench")
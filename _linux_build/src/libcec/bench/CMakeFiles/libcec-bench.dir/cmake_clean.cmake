@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/libcec-bench.dir/libcec-bench.cpp.o"
+  "CMakeFiles/libcec-bench.dir/libcec-bench.cpp.o.d"
+  "libcec-bench"
+  "libcec-bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/libcec-bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
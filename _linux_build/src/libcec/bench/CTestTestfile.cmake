@@ -0,0 +1,8 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/src/libcec/bench
+# Build directory: /root/repo/_linux_build/src/libcec/bench
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(bench-smoke "/root/repo/_linux_build/src/libcec/bench/libcec-bench" "--iterations" "1" "--samples" "1" "--format" "json")
+set_tests_properties(bench-smoke PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/libcec/bench/CMakeLists.txt;7;add_test;/root/repo/src/libcec/bench/CMakeLists.txt;0;")
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cec-p8-emulator.dir/cec-p8-emulator.cpp.o"
+  "CMakeFiles/cec-p8-emulator.dir/cec-p8-emulator.cpp.o.d"
+  "cec-p8-emulator"
+  "cec-p8-emulator.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cec-p8-emulator.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/usbcec-emulator.dir/USBCECAdapterEmulator.cpp.o"
+  "CMakeFiles/usbcec-emulator.dir/USBCECAdapterEmulator.cpp.o.d"
+  "libusbcec-emulator.a"
+  "libusbcec-emulator.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/usbcec-emulator.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
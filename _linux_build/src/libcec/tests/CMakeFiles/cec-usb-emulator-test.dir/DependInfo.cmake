@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/libcec/tests/USBEmulatorTest.cpp" "src/libcec/tests/CMakeFiles/cec-usb-emulator-test.dir/USBEmulatorTest.cpp.o" "gcc" "src/libcec/tests/CMakeFiles/cec-usb-emulator-test.dir/USBEmulatorTest.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_linux_build/src/libcec/emulator/CMakeFiles/usbcec-emulator.dir/DependInfo.cmake"
+  "/root/repo/_linux_build/src/libcec/CMakeFiles/cec-shared.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
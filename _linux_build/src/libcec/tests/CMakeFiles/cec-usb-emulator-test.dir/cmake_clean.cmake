@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cec-usb-emulator-test.dir/USBEmulatorTest.cpp.o"
+  "CMakeFiles/cec-usb-emulator-test.dir/USBEmulatorTest.cpp.o.d"
+  "cec-usb-emulator-test"
+  "cec-usb-emulator-test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cec-usb-emulator-test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
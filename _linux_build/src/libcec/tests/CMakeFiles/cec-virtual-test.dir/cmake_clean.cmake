@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cec-virtual-test.dir/VirtualAdapterTest.cpp.o"
+  "CMakeFiles/cec-virtual-test.dir/VirtualAdapterTest.cpp.o.d"
+  "cec-virtual-test"
+  "cec-virtual-test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cec-virtual-test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cec-vivid-test.dir/VividIntegrationTest.cpp.o"
+  "CMakeFiles/cec-vivid-test.dir/VividIntegrationTest.cpp.o.d"
+  "cec-vivid-test"
+  "cec-vivid-test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cec-vivid-test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
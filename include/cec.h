@@ -501,6 +501,111 @@ namespace CEC
      * @return True when the command was acked, false otherwise.
      */
     virtual bool SendPlay(cec_logical_address iDestination, cec_play_mode mode) = 0;
+
+    /*!
+     * @brief Only pass log messages with one of these levels to the logMessage callback.
+     *        Messages that no client wants are dropped before they are formatted.
+     * @param iMask A combination of cec_log_level values. Defaults to CEC_LOG_ALL.
+     */
+    virtual void SetLogLevelMask(uint32_t iMask) = 0;
+
+    /*!
+     * @brief Only pass commands with one of these opcodes to the commandHandler callback.
+     *
+     * With iClaimTimeoutMs set to 0, the callback is called synchronously, and libCEC waits
+     * for its result before processing the next command. Otherwise, the callback is called
+     * without holding up libCEC, and matching commands that were sent to one of our devices
+     * are left to the client. These have to be claimed within iClaimTimeoutMs, by returning 1
+     * from the callback or by calling ClaimCommand(). libCEC answers unclaimed commands with
+     * a feature abort. Other matching commands, like broadcasts, are processed by libCEC too.
+     * @param opcodes The opcodes to pass, or nullptr to pass all opcodes (the default).
+     * @param iCount The number of opcodes in the list.
+     * @param iClaimTimeoutMs 0 for a synchronous callback, or the time in which the client
+     *        has to claim a command.
+     * @return True when the filter was set, false otherwise.
+     */
+    virtual bool SetCommandHandlerFilter(const cec_opcode *opcodes, uint8_t iCount, uint32_t iClaimTimeoutMs) = 0;
+
+    /*!
+     * @brief Claim a command that was passed to the commandHandler callback asynchronously,
+     *        so libCEC won't answer it with a feature abort.
+     * @param command The command that was passed to the callback.
+     * @return True when claimed, false when it wasn't waiting for a claim (anymore).
+     */
+    virtual bool ClaimCommand(const cec_command &command) = 0;
+
+    /*!
+     * @brief Find all devices on the CEC bus and get their properties. Unlike calling
+     *        GetDeviceVendorId(), GetDeviceOSDName() etc. for each device, the requests
+     *        for all devices are sent together, and the replies are awaited together.
+     *        Properties that are already known aren't requested again.
+     * @param scan The devices and the time the scan took.
+     * @return True when the bus was scanned, false otherwise.
+     */
+    virtual bool ScanBus(cec_bus_scan *scan) = 0;
+
+    /*!
+     * @brief Remember the properties of the devices on the bus in a file, so they don't have
+     *        to be requested again after a restart. The file is read by Open() and written by
+     *        Close(). Cached properties are checked in the background after opening, and are
+     *        dropped when a device doesn't respond or reports a different vendor, physical
+     *        address or CEC version. Entries expire after a week.
+     * @param strPath The path to the file, or NULL or an empty string to not use a cache. Call before Open().
+     */
+    virtual void SetDeviceCachePath(const char *strPath) = 0;
+
+    /*!
+     * @brief Write every frame that is received or transmitted to a pcap file, with the time,
+     *        the direction, whether it was acked and the line timeout that was used. The file
+     *        can be played back with the "replay:<path>" port.
+     * @param strPath The path to the file, or NULL or an empty string to stop capturing.
+     * @return True when the file was created, false otherwise.
+     */
+    virtual bool SetTrafficCapture(const char *strPath) = 0;
+
+    /*!
+     * @brief Transmit a sequence of raw CEC commands, e.g. a key press and its release, in
+     *        one call. All commands are queued at once, so the adapter doesn't wait for the
+     *        caller between frames. Commands to the same destination are sent in the given
+     *        order. Commands to different destinations may overlap when the adapter supports it.
+     * @param commands The commands to transmit.
+     * @param iCount The number of commands.
+     * @param results Filled in with the result of each command. May be NULL.
+     * @return True when all commands were acked, false otherwise.
+     */
+    virtual bool TransmitBatch(const cec_command *commands, size_t iCount, cec_transmit_result *results) = 0;
+
+    /*!
+     * @brief Get histograms of the time it took for frames to be acked and answered, by
+     *        opcode and by destination, of the number of retries, and of the time that
+     *        callbacks were queued.
+     * @param stats The statistics. version and size have to be filled in by the caller.
+     * @return True when filled in, false when the version isn't supported.
+     */
+    virtual bool GetLatencyStats(cec_latency_stats *stats) = 0;
+
+    /*!
+     * @brief Reset the statistics that are returned by GetLatencyStats().
+     */
+    virtual void ResetLatencyStats(void) = 0;
+
+    /*!
+     * @brief Get the last known status of the devices on the bus, and the number of
+     *        frames and callbacks that are queued. Nothing is sent on the bus, so this
+     *        can be called as often as needed.
+     * @param snapshot The status. version and size have to be filled in by the caller.
+     * @return True when filled in, false when the version isn't supported or when not connected.
+     */
+    virtual bool GetStatusSnapshot(cec_status_snapshot *snapshot) = 0;
+
+    /*!
+     * @brief Get the counters that don't fit in cec_adapter_stats: the latency of received
+     *        frames, the frames that the adapter dropped, and the callbacks that were dropped.
+     *        Counters that the adapter doesn't keep are 0.
+     * @param counters The counters. version and size have to be filled in by the caller.
+     * @return True when filled in, false when the version isn't supported or when not connected.
+     */
+    virtual bool GetAdapterCounters(cec_adapter_counters *counters) = 0;
   };
 };
 
@@ -94,6 +94,12 @@ extern DECLSPEC int libcec_mute_audio(libcec_connection_t connection, int bSendR
 extern DECLSPEC int libcec_send_keypress(libcec_connection_t connection, CEC_NAMESPACE cec_logical_address iDestination, CEC_NAMESPACE cec_user_control_code key, int bWait);
 extern DECLSPEC int libcec_send_key_release(libcec_connection_t connection, CEC_NAMESPACE cec_logical_address iDestination, int bWait);
 extern DECLSPEC int libcec_send_play(libcec_connection_t connection, CEC_NAMESPACE cec_logical_address iDestination, CEC_NAMESPACE cec_play_mode mode);
+extern DECLSPEC int libcec_set_log_level_mask(libcec_connection_t connection, uint32_t iMask);
+extern DECLSPEC int libcec_set_command_handler_filter(libcec_connection_t connection, const CEC_NAMESPACE cec_opcode* opcodes, uint8_t iCount, uint32_t iClaimTimeoutMs);
+extern DECLSPEC int libcec_claim_command(libcec_connection_t connection, const CEC_NAMESPACE cec_command* command);
+extern DECLSPEC int libcec_scan_bus(libcec_connection_t connection, CEC_NAMESPACE cec_bus_scan* scan);
+extern DECLSPEC int libcec_set_device_cache_path(libcec_connection_t connection, const char* strPath);
+extern DECLSPEC int libcec_set_traffic_capture(libcec_connection_t connection, const char* strPath);
 extern DECLSPEC int libcec_get_device_osd_name(libcec_connection_t connection, CEC_NAMESPACE cec_logical_address iAddress, CEC_NAMESPACE cec_osd_name name);
 extern DECLSPEC int libcec_set_stream_path_logical(libcec_connection_t connection, CEC_NAMESPACE cec_logical_address iAddress);
 extern DECLSPEC int libcec_set_stream_path_physical(libcec_connection_t connection, uint16_t iPhysicalAddress);
@@ -123,6 +129,11 @@ extern DECLSPEC int8_t libcec_detect_adapters(libcec_connection_t connection, CE
 #if CEC_LIB_VERSION_MAJOR >= 5
 extern DECLSPEC int libcec_get_stats(libcec_connection_t connection, struct CEC_NAMESPACE cec_adapter_stats* stats);
 #endif
+extern DECLSPEC int libcec_get_latency_stats(libcec_connection_t connection, CEC_NAMESPACE cec_latency_stats* stats);
+extern DECLSPEC int libcec_reset_latency_stats(libcec_connection_t connection);
+extern DECLSPEC int libcec_get_status_snapshot(libcec_connection_t connection, CEC_NAMESPACE cec_status_snapshot* snapshot);
+extern DECLSPEC int libcec_get_adapter_counters(libcec_connection_t connection, CEC_NAMESPACE cec_adapter_counters* counters);
+extern DECLSPEC int libcec_transmit_batch(libcec_connection_t connection, const CEC_NAMESPACE cec_command* commands, size_t iCount, CEC_NAMESPACE cec_transmit_result* results);
 #ifdef SWIG
 %cstring_bounded_output(char* buf, 50);
 #endif
@@ -924,7 +924,8 @@ typedef enum cec_adapter_type
   ADAPTERTYPE_LINUX            = 0x400,
   ADAPTERTYPE_AOCEC            = 0x500,
   ADAPTERTYPE_IMX              = 0x600,
-  ADAPTERTYPE_TEGRA            = 0x700
+  ADAPTERTYPE_TEGRA            = 0x700,
+  ADAPTERTYPE_VIRTUAL          = 0x800
 } cec_adapter_type;
 
 /** force exporting through swig */
@@ -1474,6 +1475,144 @@ struct cec_adapter_stats
   unsigned int rx_error;
 };
 
+/*!
+ * the version of cec_adapter_counters that this header describes
+ */
+#define CEC_ADAPTER_COUNTERS_VERSION  1
+
+/*!
+ * @brief Counters that are kept next to cec_adapter_stats, which can't grow
+ */
+typedef struct cec_adapter_counters
+{
+  uint32_t version;             /**< set to CEC_ADAPTER_COUNTERS_VERSION by the caller */
+  uint32_t size;                /**< set to sizeof(cec_adapter_counters) by the caller */
+  uint64_t rx_latency_total_us; /**< the sum of the time between the start of each received frame and its delivery, in microseconds. divide by rx_latency_count for the average */
+  uint32_t rx_latency_count;    /**< the number of received frames in rx_latency_total_us */
+  uint32_t rx_latency_max_us;   /**< the highest latency of a single received frame, in microseconds */
+  uint32_t rx_lost;             /**< the number of received frames that the adapter dropped before libCEC could read them */
+  uint32_t cb_overflow;         /**< the number of callback events that were dropped because the client's queue was full. dropped log messages aren't counted */
+} cec_adapter_counters;
+
+/*!
+ * the version of cec_latency_stats that this header describes
+ */
+#define CEC_LATENCY_STATS_VERSION     1
+
+/*!
+ * the number of buckets in a cec_latency_histogram
+ */
+#define CEC_LATENCY_BUCKETS           16
+
+/*!
+ * the upper limit (exclusive) of bucket i of a cec_latency_histogram, in microseconds.
+ * the limits double with every bucket, and the last bucket has no limit.
+ */
+#define CEC_LATENCY_BUCKET_LIMIT_US(i) (250u << (i))
+
+/*!
+ * the number of buckets in cec_transmit_stats.retries
+ */
+#define CEC_RETRY_BUCKETS             6
+
+/*!
+ * @brief A distribution of latencies
+ */
+typedef struct cec_latency_histogram
+{
+  uint32_t count;                        /**< the number of samples */
+  uint32_t max_us;                       /**< the highest latency, in microseconds */
+  uint64_t total_us;                     /**< the sum of all latencies, in microseconds. divide by count for the average */
+  uint32_t buckets[CEC_LATENCY_BUCKETS]; /**< the number of samples per bucket, see CEC_LATENCY_BUCKET_LIMIT_US() */
+} cec_latency_histogram;
+
+/*!
+ * @brief Latencies of the frames that were sent with one opcode, or to one destination
+ */
+typedef struct cec_transmit_stats
+{
+  cec_latency_histogram ack;                        /**< the time from the first attempt to send a frame until it was acked */
+  cec_latency_histogram response;                   /**< the time libCEC waited for a reply, for replies that were received */
+  uint32_t              nacks;                      /**< the number of frames that weren't acked, after all retries */
+  uint32_t              response_timeouts;          /**< the number of replies that didn't arrive in time */
+  uint32_t              retries[CEC_RETRY_BUCKETS]; /**< the number of frames that needed i retries. the last bucket holds the rest */
+} cec_transmit_stats;
+
+/*!
+ * @brief Latency statistics, since the connection was opened
+ */
+typedef struct cec_latency_stats
+{
+  uint32_t              version;          /**< set to CEC_LATENCY_STATS_VERSION by the caller */
+  uint32_t              size;             /**< set to sizeof(cec_latency_stats) by the caller */
+  cec_transmit_stats    opcodes[256];     /**< by opcode. polls are counted as CEC_OPCODE_NONE. responses by the opcode of the reply */
+  cec_transmit_stats    destinations[16]; /**< by the logical address of the destination */
+  cec_latency_histogram callbacks;        /**< the time that callbacks were queued before they were called */
+} cec_latency_stats;
+
+/*!
+ * the version of cec_status_snapshot that this header describes
+ */
+#define CEC_STATUS_SNAPSHOT_VERSION   1
+
+/*!
+ * @brief What libCEC knows about the bus and its own queues, without asking the devices
+ */
+typedef struct cec_status_snapshot
+{
+  uint32_t              version;              /**< set to CEC_STATUS_SNAPSHOT_VERSION by the caller */
+  uint32_t              size;                 /**< set to sizeof(cec_status_snapshot) by the caller */
+  cec_bus_device_status deviceStatus[16];     /**< the last known status of each logical address */
+  cec_power_status      powerStatus[16];      /**< the last known power status of each logical address */
+  uint16_t              physicalAddress[16];  /**< the last known physical address of each logical address */
+  uint32_t              inputQueue;           /**< received frames that weren't handled yet */
+  uint32_t              transmitQueue;        /**< frames that are waiting to be transmitted */
+  uint32_t              adapterWriteQueue;    /**< frames that are waiting to be written to the adapter. 0 when the adapter doesn't have a queue */
+  uint32_t              callbackQueue;        /**< callbacks that are waiting to be called, log messages excluded */
+  uint32_t              callbackLogQueue;     /**< log messages that are waiting to be passed to the client */
+} cec_status_snapshot;
+
+/*!
+ * @brief The properties of a device on the CEC bus, as found by ScanBus()
+ */
+typedef struct cec_device_info
+{
+  cec_logical_address logicalAddress;   /**< the logical address of the device */
+  uint16_t            iPhysicalAddress; /**< the physical address, or CEC_INVALID_PHYSICAL_ADDRESS if unknown */
+  uint32_t            iVendorId;        /**< the vendor id, or CEC_VENDOR_UNKNOWN */
+  cec_version         cecVersion;       /**< the CEC version, or CEC_VERSION_UNKNOWN */
+  cec_power_status    powerStatus;      /**< the power status, or CEC_POWER_STATUS_UNKNOWN */
+  cec_osd_name        strOSDName;       /**< the OSD name */
+  cec_menu_language   strMenuLanguage;  /**< the menu language, or "???" if unknown */
+  uint8_t             bActiveSource;    /**< 1 when this device is the active source */
+  uint8_t             bHandledByLibCEC; /**< 1 when this device is one of ours */
+} cec_device_info;
+
+/*!
+ * @brief The result of ScanBus()
+ */
+typedef struct cec_bus_scan
+{
+  cec_device_info     devices[16];      /**< the devices that are present */
+  uint8_t             iDeviceCount;     /**< the number of entries in devices */
+  cec_logical_address activeSource;     /**< the active source, or CECDEVICE_UNKNOWN */
+  uint8_t             iRequests;        /**< the number of requests that were sent */
+  uint8_t             iReplies;         /**< the number of requests that were answered */
+  uint32_t            iPollTimeMs;      /**< the time it took to find the devices that are present */
+  uint32_t            iRequestTimeMs;   /**< the time it took to request the properties and wait for the replies */
+} cec_bus_scan;
+
+/*!
+ * @brief The result of one of the frames that were sent with TransmitBatch()
+ */
+typedef enum cec_transmit_result
+{
+  CEC_TRANSMIT_RESULT_NOT_SENT = 0, /**< not passed to the adapter, because the frame was invalid or libCEC isn't connected */
+  CEC_TRANSMIT_RESULT_ACKED,        /**< sent and acked */
+  CEC_TRANSMIT_RESULT_NOT_ACKED,    /**< sent, but not acked after all retries */
+  CEC_TRANSMIT_RESULT_FAILED        /**< the adapter failed to send the frame, or didn't report the result in time */
+} cec_transmit_result;
+
 typedef struct libcec_configuration libcec_configuration;
 
 typedef struct ICECCallbacks
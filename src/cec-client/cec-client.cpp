@@ -41,6 +41,7 @@
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <vector>
 #include <signal.h>
 #include <stdlib.h>
 #include "platform/os.h"
@@ -49,6 +50,9 @@
 #if defined(HAVE_CURSES_API)
   #include "curses/CursesControl.h"
 #endif
+#if defined(HAVE_METRICS_EXPORTER)
+  #include "metrics/MetricsExporter.h"
+#endif
 
 using namespace CEC;
 
@@ -63,6 +67,8 @@ int                   g_cecDefaultLogLevel(CEC_LOG_ALL);
 std::ofstream         g_logOutput;
 bool                  g_bShortLog(false);
 std::string           g_strPort;
+std::string           g_strDeviceCache;
+std::string           g_strTrafficCapture;
 bool                  g_bSingleCommand(false);
 std::string           g_strCommand;
 volatile sig_atomic_t g_bExit(0);
@@ -73,6 +79,9 @@ ICECAdapter*          g_parser;
 bool                  g_cursesEnable(false);
 CCursesControl        g_cursesControl("1", "0");
 #endif
+#if defined(HAVE_METRICS_EXPORTER)
+std::string           g_strMetrics;
+#endif
 
 class CReconnect : public CThread
 {
@@ -341,6 +350,16 @@ void ShowHelpCommandLine(const char* strExec)
       "  --vendor-id {id}            The CEC vendor ID to announce for this device," << std::endl <<
       "                              as up to 6 hex digits (e.g. 00e091)." << std::endl <<
       "  -m --monitor                Start a monitor-only client." << std::endl <<
+      "  --device-cache {file}       Remember the devices on the bus in this file, so" << std::endl <<
+      "                              they're known right away on the next start." << std::endl <<
+      "  --capture {file}            Write all CEC traffic to this pcap file. Open the" << std::endl <<
+      "                              port replay:{file} to play it back." << std::endl <<
+#if defined(HAVE_METRICS_EXPORTER)
+      "  --metrics {[addr:]port|unix:path}" << std::endl <<
+      "                              Serve statistics in the OpenMetrics format on" << std::endl <<
+      "                              http://addr:port/metrics (addr defaults to" << std::endl <<
+      "                              127.0.0.1), or on a Unix socket." << std::endl <<
+#endif
 #if CEC_LIB_VERSION_MAJOR >= 5
       "  -aw --autowake {0|1}        Enable (1) or disable (0) waking the TV when this" << std::endl <<
       "                              client becomes the active source." << std::endl <<
@@ -374,6 +393,7 @@ void ShowHelpConsole(void)
   std::endl <<
   "[tx] {bytes}              transfer bytes over the CEC line." << std::endl <<
   "[txn] {bytes}             transfer bytes but don't wait for transmission ACK." << std::endl <<
+  "[txb] {bytes};{bytes}...  transfer several frames at once, and show which were ACKed." << std::endl <<
   "[on] {address}            power on the device with the given logical address." << std::endl <<
   "[standby] {address}       put the device with the given address in standby mode." << std::endl <<
   "[la] {logical address}    change the logical address of the CEC adapter." << std::endl <<
@@ -405,6 +425,8 @@ void ShowHelpConsole(void)
   "[self]                    show the list of addresses controlled by libCEC" << std::endl <<
   "[scan]                    scan the CEC bus and display device info" << std::endl <<
   "[mon] {1|0}               enable or disable CEC bus monitoring." << std::endl <<
+  "[latency] {reset}         show the ack and response latencies per opcode and per" << std::endl <<
+  "                          destination, or reset them." << std::endl <<
 #if CEC_LIB_VERSION_MAJOR >= 8
   "[am] {1|0}                enable or disable autonomous mode, or show it when no" << std::endl <<
   "                          value is given. saved to the adapter eeprom." << std::endl <<
@@ -510,6 +532,45 @@ bool ProcessCommandTX(ICECAdapter *parser, const std::string &command, std::stri
     return true;
   }
 
+  if (command == "txb")
+  {
+    std::vector<cec_command> commands;
+    std::string strFrames(arguments);
+    size_t iStart(0), iEnd;
+    do
+    {
+      iEnd = strFrames.find(';', iStart);
+      std::string strFrame(strFrames.substr(iStart, iEnd == std::string::npos ? std::string::npos : iEnd - iStart));
+      if (strFrame.find_first_not_of(" \t") != std::string::npos)
+        commands.push_back(parser->CommandFromString(strFrame.c_str()));
+      iStart = iEnd + 1;
+    } while (iEnd != std::string::npos);
+
+    std::vector<cec_transmit_result> results(commands.size(), CEC_TRANSMIT_RESULT_NOT_SENT);
+    parser->TransmitBatch(commands.data(), commands.size(), results.data());
+    for (size_t iPtr = 0; iPtr < results.size(); iPtr++)
+    {
+      const char *strResult("not sent");
+      switch (results[iPtr])
+      {
+      case CEC_TRANSMIT_RESULT_ACKED:
+        strResult = "acked";
+        break;
+      case CEC_TRANSMIT_RESULT_NOT_ACKED:
+        strResult = "not acked";
+        break;
+      case CEC_TRANSMIT_RESULT_FAILED:
+        strResult = "failed";
+        break;
+      default:
+        break;
+      }
+      PrintToStdOut("frame %u: %s", (unsigned)(iPtr + 1), strResult);
+    }
+
+    return true;
+  }
+
   return false;
 }
 
@@ -1010,7 +1071,7 @@ bool ProcessCommandH(ICECAdapter * UNUSED(parser), const std::string &command, s
   return false;
 }
 
-bool ProcessCommandLOG(ICECAdapter * UNUSED(parser), const std::string &command, std::string &arguments)
+bool ProcessCommandLOG(ICECAdapter *parser, const std::string &command, std::string &arguments)
 {
   if (command == "log")
   {
@@ -1021,6 +1082,7 @@ bool ProcessCommandLOG(ICECAdapter * UNUSED(parser), const std::string &command,
       if (iNewLevel >= CEC_LOG_ERROR && iNewLevel <= CEC_LOG_ALL)
       {
         g_cecLogLevel = iNewLevel;
+        parser->SetLogLevelMask((uint32_t)g_cecLogLevel);
 
         PrintToStdOut("log level changed to %s", strLevel.c_str());
         return true;
@@ -1039,36 +1101,32 @@ bool ProcessCommandSCAN(ICECAdapter *parser, const std::string &command, std::st
     PrintToStdOut("requesting CEC bus information ...");
 
     strLog.append("CEC bus information\n===================\n");
-    cec_logical_addresses addresses = parser->GetActiveDevices();
-    cec_logical_address activeSource = parser->GetActiveSource();
-    for (uint8_t iPtr = 0; iPtr < 16; iPtr++)
+    cec_bus_scan scan;
+    if (!parser->ScanBus(&scan))
     {
-      if (addresses[iPtr])
-      {
-        uint64_t iVendorId        = parser->GetDeviceVendorId((cec_logical_address)iPtr);
-        uint16_t iPhysicalAddress = parser->GetDevicePhysicalAddress((cec_logical_address)iPtr);
-        bool     bActive          = parser->IsActiveSource((cec_logical_address)iPtr);
-        cec_version iCecVersion   = parser->GetDeviceCecVersion((cec_logical_address)iPtr);
-        cec_power_status power    = parser->GetDevicePowerStatus((cec_logical_address)iPtr);
-        std::string osdName       = parser->GetDeviceOSDName((cec_logical_address)iPtr);
-        std::string strAddr;
-        strAddr = StringUtils::Format("%x.%x.%x.%x", (iPhysicalAddress >> 12) & 0xF, (iPhysicalAddress >> 8) & 0xF, (iPhysicalAddress >> 4) & 0xF, iPhysicalAddress & 0xF);
-        std::string lang          = parser->GetDeviceMenuLanguage((cec_logical_address)iPtr);
-
-        strLog += StringUtils::Format("device #%X: %s\n", (int)iPtr, parser->ToString((cec_logical_address)iPtr));
-        strLog += StringUtils::Format("address:       %s\n", strAddr.c_str());
-        strLog += StringUtils::Format("active source: %s\n", (bActive ? "yes" : "no"));
-        strLog += StringUtils::Format("vendor:        %s\n", parser->ToString((cec_vendor_id)iVendorId));
-        strLog += StringUtils::Format("osd string:    %s\n", osdName.c_str());
-        strLog += StringUtils::Format("CEC version:   %s\n", parser->ToString(iCecVersion));
-        strLog += StringUtils::Format("power status:  %s\n", parser->ToString(power));
-        strLog += StringUtils::Format("language:      %s\n", lang.c_str());
-        strLog.append("\n\n");
-      }
+      PrintToStdOut("failed to scan the CEC bus");
+      return true;
     }
 
-    activeSource = parser->GetActiveSource();
-    strLog += StringUtils::Format("currently active source: %s (%d)", parser->ToString(activeSource), (int)activeSource);
+    for (uint8_t iPtr = 0; iPtr < scan.iDeviceCount; iPtr++)
+    {
+      const cec_device_info &device = scan.devices[iPtr];
+      std::string strAddr;
+      strAddr = StringUtils::Format("%x.%x.%x.%x", (device.iPhysicalAddress >> 12) & 0xF, (device.iPhysicalAddress >> 8) & 0xF, (device.iPhysicalAddress >> 4) & 0xF, device.iPhysicalAddress & 0xF);
+
+      strLog += StringUtils::Format("device #%X: %s\n", (int)device.logicalAddress, parser->ToString(device.logicalAddress));
+      strLog += StringUtils::Format("address:       %s\n", strAddr.c_str());
+      strLog += StringUtils::Format("active source: %s\n", (device.bActiveSource ? "yes" : "no"));
+      strLog += StringUtils::Format("vendor:        %s\n", parser->ToString((cec_vendor_id)device.iVendorId));
+      strLog += StringUtils::Format("osd string:    %s\n", device.strOSDName);
+      strLog += StringUtils::Format("CEC version:   %s\n", parser->ToString(device.cecVersion));
+      strLog += StringUtils::Format("power status:  %s\n", parser->ToString(device.powerStatus));
+      strLog += StringUtils::Format("language:      %s\n", device.strMenuLanguage);
+      strLog.append("\n\n");
+    }
+
+    strLog += StringUtils::Format("currently active source: %s (%d)\n", parser->ToString(scan.activeSource), (int)scan.activeSource);
+    strLog += StringUtils::Format("scanned in %u ms (poll %u ms, %u of %u requests answered in %u ms)", scan.iPollTimeMs + scan.iRequestTimeMs, scan.iPollTimeMs, scan.iReplies, scan.iRequests, scan.iRequestTimeMs);
 
     PrintToStdOut(strLog.c_str());
     return true;
@@ -1091,6 +1149,19 @@ bool ProcessCommandSTATS(ICECAdapter *parser, const std::string &command, std::s
       strLog += StringUtils::Format("tx error:  %u\n", stats.tx_error);
       strLog += StringUtils::Format("rx total:  %u\n", stats.rx_total);
       strLog += StringUtils::Format("rx error:  %u\n", stats.rx_error);
+
+      cec_adapter_counters counters;
+      memset(&counters, 0, sizeof(counters));
+      counters.version = CEC_ADAPTER_COUNTERS_VERSION;
+      counters.size    = sizeof(cec_adapter_counters);
+      if (parser->GetAdapterCounters(&counters))
+      {
+        strLog += StringUtils::Format("rx latency: %u us avg, %u us max\n",
+                                      counters.rx_latency_count ? (unsigned int)(counters.rx_latency_total_us / counters.rx_latency_count) : 0,
+                                      counters.rx_latency_max_us);
+        strLog += StringUtils::Format("cb overflow: %u\n", counters.cb_overflow);
+        strLog += StringUtils::Format("rx lost:   %u\n", counters.rx_lost);
+      }
       PrintToStdOut(strLog.c_str());
     }
     else
@@ -1103,6 +1174,66 @@ bool ProcessCommandSTATS(ICECAdapter *parser, const std::string &command, std::s
 }
 #endif
 
+static std::string LatencyToString(const char *strName, const cec_transmit_stats &stats)
+{
+  if (stats.ack.count == 0 && stats.nacks == 0 && stats.response.count == 0 && stats.response_timeouts == 0)
+    return "";
+
+  uint32_t iRetried(0);
+  for (uint8_t iPtr = 1; iPtr < CEC_RETRY_BUCKETS; iPtr++)
+    iRetried += stats.retries[iPtr];
+
+  return StringUtils::Format("%-28s ack %5u %7u us avg %7u us max, nack %4u, retried %4u | reply %5u %7u us avg %7u us max, timeout %4u\n",
+                             strName,
+                             stats.ack.count,
+                             stats.ack.count ? (uint32_t)(stats.ack.total_us / stats.ack.count) : 0,
+                             stats.ack.max_us,
+                             stats.nacks,
+                             iRetried,
+                             stats.response.count,
+                             stats.response.count ? (uint32_t)(stats.response.total_us / stats.response.count) : 0,
+                             stats.response.max_us,
+                             stats.response_timeouts);
+}
+
+bool ProcessCommandLATENCY(ICECAdapter *parser, const std::string &command, std::string &arguments)
+{
+  if (command == "latency")
+  {
+    std::string strValue;
+    if (GetWord(arguments, strValue) && strValue == "reset")
+    {
+      parser->ResetLatencyStats();
+      return true;
+    }
+
+    cec_latency_stats *stats = new cec_latency_stats;
+    stats->version = CEC_LATENCY_STATS_VERSION;
+    stats->size    = sizeof(cec_latency_stats);
+    if (parser->GetLatencyStats(stats))
+    {
+      std::string strLog("by opcode:\n");
+      for (unsigned int iPtr = 0; iPtr < 256; iPtr++)
+        strLog += LatencyToString(iPtr == CEC_OPCODE_NONE ? "poll" : parser->ToString((cec_opcode)iPtr), stats->opcodes[iPtr]);
+      strLog += "by destination:\n";
+      for (uint8_t iPtr = 0; iPtr < 16; iPtr++)
+        strLog += LatencyToString(parser->ToString((cec_logical_address)iPtr), stats->destinations[iPtr]);
+      strLog += StringUtils::Format("callbacks: %u, %u us avg, %u us max\n",
+                                    stats->callbacks.count,
+                                    stats->callbacks.count ? (uint32_t)(stats->callbacks.total_us / stats->callbacks.count) : 0,
+                                    stats->callbacks.max_us);
+      PrintToStdOut(strLog.c_str());
+    }
+    else
+    {
+      PrintToStdOut("not supported\n");
+    }
+    delete stats;
+    return true;
+  }
+  return false;
+}
+
 bool ProcessConsoleCommand(ICECAdapter *parser, std::string &input)
 {
   if (!input.empty())
@@ -1148,7 +1279,8 @@ bool ProcessConsoleCommand(ICECAdapter *parser, std::string &input)
       ProcessCommandDA(parser, command, input) ||
       ProcessCommandGAS(parser, command, input) ||
       ProcessCommandGSAM(parser, command, input) ||
-      ProcessCommandSELF(parser, command, input)
+      ProcessCommandSELF(parser, command, input) ||
+      ProcessCommandLATENCY(parser, command, input)
 #if CEC_LIB_VERSION_MAJOR >= 5
    || ProcessCommandSTATS(parser, command, input)
 #endif
@@ -1377,6 +1509,38 @@ bool ProcessCommandLineArguments(int argc, char *argv[])
         g_config.bMonitorOnly = 1;
         ++iArgPtr;
       }
+      else if (!strcmp(argv[iArgPtr], "--device-cache"))
+      {
+        if (argc >= iArgPtr + 2)
+        {
+          g_strDeviceCache = argv[iArgPtr + 1];
+          std::cout << "using device cache '" << g_strDeviceCache << "'" << std::endl;
+          ++iArgPtr;
+        }
+        ++iArgPtr;
+      }
+      else if (!strcmp(argv[iArgPtr], "--capture"))
+      {
+        if (argc >= iArgPtr + 2)
+        {
+          g_strTrafficCapture = argv[iArgPtr + 1];
+          std::cout << "capturing traffic to '" << g_strTrafficCapture << "'" << std::endl;
+          ++iArgPtr;
+        }
+        ++iArgPtr;
+      }
+#if defined(HAVE_METRICS_EXPORTER)
+      else if (!strcmp(argv[iArgPtr], "--metrics"))
+      {
+        if (argc >= iArgPtr + 2)
+        {
+          g_strMetrics = argv[iArgPtr + 1];
+          std::cout << "serving metrics on '" << g_strMetrics << "'" << std::endl;
+          ++iArgPtr;
+        }
+        ++iArgPtr;
+      }
+#endif
       else if (!strcmp(argv[iArgPtr], "--vendor-id"))
       {
         if (argc >= iArgPtr + 2)
@@ -1531,9 +1695,22 @@ int main (int argc, char *argv[])
     return 1;
   }
 
+  // don't let libCEC format log messages that won't be printed
+  g_parser->SetLogLevelMask((uint32_t)g_cecLogLevel);
+
   // init video on targets that need this
   g_parser->InitVideoStandalone();
 
+  if (!g_strDeviceCache.empty())
+    g_parser->SetDeviceCachePath(g_strDeviceCache.c_str());
+
+  if (!g_strTrafficCapture.empty() && !g_parser->SetTrafficCapture(g_strTrafficCapture.c_str()))
+  {
+    std::cerr << "Cannot create traffic capture '" << g_strTrafficCapture << "'" << std::endl;
+    UnloadLibCec(g_parser);
+    return 1;
+  }
+
   if (!g_bSingleCommand)
   {
     std::string strLog;
@@ -1582,6 +1759,21 @@ int main (int argc, char *argv[])
     return 1;
   }
 
+#if defined(HAVE_METRICS_EXPORTER)
+  CMetricsExporter metrics(g_parser);
+  if (!g_strMetrics.empty())
+  {
+    std::string strError;
+    if (!metrics.Start(g_strMetrics, strError))
+    {
+      std::cerr << "Cannot serve metrics on '" << g_strMetrics << "': " << strError << std::endl;
+      g_parser->Close();
+      UnloadLibCec(g_parser);
+      return 1;
+    }
+  }
+#endif
+
 #if defined(HAVE_CURSES_API)
   if (g_cursesEnable)
     g_cursesControl.Init();
@@ -1636,6 +1828,10 @@ int main (int argc, char *argv[])
   // so it can't call into the adapter while we destroy it (#701)
   CReconnect::Get().Shutdown();
 
+#if defined(HAVE_METRICS_EXPORTER)
+  metrics.Stop();
+#endif
+
   g_parser->Close();
   UnloadLibCec(g_parser);
 
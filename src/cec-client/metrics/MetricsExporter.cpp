@@ -0,0 +1,453 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "env.h"
+#include "MetricsExporter.h"
+#include "cec.h"
+#include "platform/util/StringUtils.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace CEC;
+
+// the maximum size of a request, anything after this is ignored
+#define METRICS_MAX_REQUEST_SIZE 4096
+// the maximum time to wait for a request, or for a response to be written
+#define METRICS_IO_TIMEOUT_MS    1000
+
+namespace
+{
+  // "Recorder 1" -> "recorder_1"
+  std::string ToLabel(const char *strName)
+  {
+    std::string strLabel(strName);
+    for (std::string::iterator it = strLabel.begin(); it != strLabel.end(); ++it)
+    {
+      if (*it >= 'A' && *it <= 'Z')
+        *it = (char)(*it - 'A' + 'a');
+      else if (!((*it >= 'a' && *it <= 'z') || (*it >= '0' && *it <= '9')))
+        *it = '_';
+    }
+    return strLabel;
+  }
+
+  std::string OpcodeLabel(ICECAdapter *adapter, unsigned int iOpcode)
+  {
+    return iOpcode == CEC_OPCODE_NONE ?
+        std::string("poll") :
+        ToLabel(adapter->ToString((cec_opcode)iOpcode));
+  }
+
+  bool IsEmpty(const cec_transmit_stats &stats)
+  {
+    return stats.ack.count == 0 && stats.nacks == 0 && stats.response.count == 0 && stats.response_timeouts == 0;
+  }
+
+  void AddHistogram(std::string &strOut, const char *strName, const std::string &strLabels, const cec_latency_histogram &histogram)
+  {
+    const std::string strPrefix(strLabels.empty() ? std::string("") : strLabels + ",");
+    uint64_t iCumulative(0);
+    for (unsigned int iPtr = 0; iPtr < CEC_LATENCY_BUCKETS - 1; iPtr++)
+    {
+      iCumulative += histogram.buckets[iPtr];
+      strOut += StringUtils::Format("%s_bucket{%sle=\"%g\"} %llu\n", strName, strPrefix.c_str(), CEC_LATENCY_BUCKET_LIMIT_US(iPtr) / 1000000.0, (unsigned long long)iCumulative);
+    }
+    strOut += StringUtils::Format("%s_bucket{%sle=\"+Inf\"} %u\n", strName, strPrefix.c_str(), histogram.count);
+    const std::string strSuffix(strLabels.empty() ? std::string("") : "{" + strLabels + "}");
+    strOut += StringUtils::Format("%s_count%s %u\n", strName, strSuffix.c_str(), histogram.count);
+    strOut += StringUtils::Format("%s_sum%s %g\n", strName, strSuffix.c_str(), histogram.total_us / 1000000.0);
+  }
+
+  void AddRetries(std::string &strOut, const char *strName, const std::string &strLabels, const cec_transmit_stats &stats)
+  {
+    uint64_t iCumulative(0);
+    for (unsigned int iPtr = 0; iPtr < CEC_RETRY_BUCKETS - 1; iPtr++)
+    {
+      iCumulative += stats.retries[iPtr];
+      strOut += StringUtils::Format("%s_bucket{%s,le=\"%u\"} %llu\n", strName, strLabels.c_str(), iPtr, (unsigned long long)iCumulative);
+    }
+    iCumulative += stats.retries[CEC_RETRY_BUCKETS - 1];
+    strOut += StringUtils::Format("%s_bucket{%s,le=\"+Inf\"} %llu\n", strName, strLabels.c_str(), (unsigned long long)iCumulative);
+    strOut += StringUtils::Format("%s_count{%s} %llu\n", strName, strLabels.c_str(), (unsigned long long)iCumulative);
+  }
+
+  // adds the families for either the opcodes or the destinations
+  void AddTransmitStats(std::string &strOut, const char *strKind, const cec_transmit_stats *stats, const std::string *labels, unsigned int iCount)
+  {
+    std::string strName;
+
+    strName = StringUtils::Format("cec_%s_ack_latency_seconds", strKind);
+    strOut += StringUtils::Format("# TYPE %s histogram\n# UNIT %s seconds\n# HELP %s The time until a frame was acked.\n", strName.c_str(), strName.c_str(), strName.c_str());
+    for (unsigned int iPtr = 0; iPtr < iCount; iPtr++)
+      if (stats[iPtr].ack.count > 0)
+        AddHistogram(strOut, strName.c_str(), labels[iPtr], stats[iPtr].ack);
+
+    strName = StringUtils::Format("cec_%s_response_latency_seconds", strKind);
+    strOut += StringUtils::Format("# TYPE %s histogram\n# UNIT %s seconds\n# HELP %s The time spent waiting for a reply that was received.\n", strName.c_str(), strName.c_str(), strName.c_str());
+    for (unsigned int iPtr = 0; iPtr < iCount; iPtr++)
+      if (stats[iPtr].response.count > 0)
+        AddHistogram(strOut, strName.c_str(), labels[iPtr], stats[iPtr].response);
+
+    strName = StringUtils::Format("cec_%s_retries", strKind);
+    strOut += StringUtils::Format("# TYPE %s histogram\n# HELP %s The number of retries per frame.\n", strName.c_str(), strName.c_str());
+    for (unsigned int iPtr = 0; iPtr < iCount; iPtr++)
+      if (!IsEmpty(stats[iPtr]))
+        AddRetries(strOut, strName.c_str(), labels[iPtr], stats[iPtr]);
+
+    strName = StringUtils::Format("cec_%s_nacks", strKind);
+    strOut += StringUtils::Format("# TYPE %s counter\n# HELP %s Frames that weren't acked after all retries.\n", strName.c_str(), strName.c_str());
+    for (unsigned int iPtr = 0; iPtr < iCount; iPtr++)
+      if (!IsEmpty(stats[iPtr]))
+        strOut += StringUtils::Format("%s_total{%s} %u\n", strName.c_str(), labels[iPtr].c_str(), stats[iPtr].nacks);
+
+    strName = StringUtils::Format("cec_%s_response_timeouts", strKind);
+    strOut += StringUtils::Format("# TYPE %s counter\n# HELP %s Replies that didn't arrive in time.\n", strName.c_str(), strName.c_str());
+    for (unsigned int iPtr = 0; iPtr < iCount; iPtr++)
+      if (!IsEmpty(stats[iPtr]))
+        strOut += StringUtils::Format("%s_total{%s} %u\n", strName.c_str(), labels[iPtr].c_str(), stats[iPtr].response_timeouts);
+  }
+
+  bool WriteAll(int socket, const std::string &strData)
+  {
+    size_t iWritten(0);
+    while (iWritten < strData.size())
+    {
+      struct pollfd fd = { socket, POLLOUT, 0 };
+      if (poll(&fd, 1, METRICS_IO_TIMEOUT_MS) <= 0)
+        return false;
+      ssize_t iResult = send(socket, strData.c_str() + iWritten, strData.size() - iWritten, MSG_NOSIGNAL);
+      if (iResult <= 0)
+        return false;
+      iWritten += (size_t)iResult;
+    }
+    return true;
+  }
+}
+
+bool CMetricsExporter::Start(const std::string &strEndpoint, std::string &strError)
+{
+  Stop();
+
+  if (!strEndpoint.compare(0, 5, "unix:"))
+  {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    const std::string strPath(strEndpoint.substr(5));
+    if (strPath.empty() || strPath.size() >= sizeof(address.sun_path))
+    {
+      strError = "invalid socket path";
+      return false;
+    }
+    memcpy(address.sun_path, strPath.c_str(), strPath.size());
+
+    if ((m_socket = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+    {
+      strError = strerror(errno);
+      return false;
+    }
+
+    // a socket that was left behind by a previous run
+    unlink(strPath.c_str());
+    if (bind(m_socket, (struct sockaddr *)&address, sizeof(address)) < 0)
+    {
+      strError = strerror(errno);
+      Stop();
+      return false;
+    }
+    m_strUnixPath = strPath;
+  }
+  else
+  {
+    std::string strHost("127.0.0.1");
+    std::string strPort(strEndpoint);
+    const size_t iColon(strEndpoint.rfind(':'));
+    if (iColon != std::string::npos)
+    {
+      strHost = strEndpoint.substr(0, iColon);
+      strPort = strEndpoint.substr(iColon + 1);
+    }
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    const int iPort(atoi(strPort.c_str()));
+    if (iPort <= 0 || iPort > 65535 || inet_pton(AF_INET, strHost.c_str(), &address.sin_addr) != 1)
+    {
+      strError = "invalid address";
+      return false;
+    }
+    address.sin_port = htons((uint16_t)iPort);
+
+    if ((m_socket = socket(AF_INET, SOCK_STREAM, 0)) < 0)
+    {
+      strError = strerror(errno);
+      return false;
+    }
+
+    int iReuse(1);
+    setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &iReuse, sizeof(iReuse));
+    if (bind(m_socket, (struct sockaddr *)&address, sizeof(address)) < 0)
+    {
+      strError = strerror(errno);
+      Stop();
+      return false;
+    }
+  }
+
+  // Process() waits without a timeout, until a client connects or Stop() wakes it up
+  int fds[2];
+  if (pipe(fds) != 0)
+  {
+    strError = strerror(errno);
+    Stop();
+    return false;
+  }
+  m_wakeupRead  = fds[0];
+  m_wakeupWrite = fds[1];
+  fcntl(m_wakeupRead, F_SETFD, FD_CLOEXEC);
+  fcntl(m_wakeupWrite, F_SETFD, FD_CLOEXEC);
+  fcntl(m_wakeupWrite, F_SETFL, O_NONBLOCK);
+
+  if (listen(m_socket, 4) < 0 || !CreateThread())
+  {
+    strError = strerror(errno);
+    Stop();
+    return false;
+  }
+
+  return true;
+}
+
+void CMetricsExporter::Stop(void)
+{
+  StopThread(-1);
+  if (m_wakeupWrite >= 0 && write(m_wakeupWrite, "", 1) < 0) {} // a full pipe is still a pending wakeup
+  StopThread(0);
+
+  if (m_wakeupRead >= 0)
+  {
+    close(m_wakeupRead);
+    close(m_wakeupWrite);
+    m_wakeupRead = m_wakeupWrite = -1;
+  }
+
+  if (m_socket >= 0)
+  {
+    close(m_socket);
+    m_socket = -1;
+  }
+
+  if (!m_strUnixPath.empty())
+  {
+    unlink(m_strUnixPath.c_str());
+    m_strUnixPath.clear();
+  }
+}
+
+void *CMetricsExporter::Process(void)
+{
+  while (!IsStopped())
+  {
+    // sleep until a client connects, or until Stop() wakes us up
+    struct pollfd fds[2] = { { m_socket, POLLIN, 0 }, { m_wakeupRead, POLLIN, 0 } };
+    if (poll(fds, 2, -1) <= 0 || IsStopped() || !(fds[0].revents & POLLIN))
+      continue;
+
+    int connection = accept(m_socket, NULL, NULL);
+    if (connection >= 0)
+    {
+      HandleConnection(connection);
+      close(connection);
+    }
+  }
+
+  return NULL;
+}
+
+void CMetricsExporter::HandleConnection(int socket)
+{
+  // read the request line and the headers. the body of anything but a GET is ignored
+  std::string strRequest;
+  char buf[512];
+  while (strRequest.find("\r\n\r\n") == std::string::npos && strRequest.size() < METRICS_MAX_REQUEST_SIZE)
+  {
+    struct pollfd fd = { socket, POLLIN, 0 };
+    if (poll(&fd, 1, METRICS_IO_TIMEOUT_MS) <= 0)
+      return;
+    ssize_t iRead = recv(socket, buf, sizeof(buf), 0);
+    if (iRead <= 0)
+      return;
+    strRequest.append(buf, (size_t)iRead);
+  }
+
+  std::string strResponse;
+  if (!strRequest.compare(0, 13, "GET /metrics ") || !strRequest.compare(0, 6, "GET / "))
+  {
+    const std::string strBody(Render());
+    strResponse = StringUtils::Format("HTTP/1.0 200 OK\r\n"
+                                      "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+                                      "Content-Length: %u\r\n"
+                                      "Connection: close\r\n\r\n", (unsigned int)strBody.size());
+    strResponse += strBody;
+  }
+  else
+  {
+    strResponse = "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+  }
+
+  WriteAll(socket, strResponse);
+}
+
+std::string CMetricsExporter::Render(void)
+{
+  std::string strOut;
+
+  cec_adapter_stats adapterStats;
+  memset(&adapterStats, 0, sizeof(adapterStats));
+  if (m_adapter->GetStats(&adapterStats))
+  {
+    strOut += "# TYPE cec_transmitted_frames counter\n# HELP cec_transmitted_frames Frames that were transmitted, by result.\n";
+    strOut += StringUtils::Format("cec_transmitted_frames_total{result=\"ack\"} %u\n", adapterStats.tx_ack);
+    strOut += StringUtils::Format("cec_transmitted_frames_total{result=\"nack\"} %u\n", adapterStats.tx_nack);
+    strOut += StringUtils::Format("cec_transmitted_frames_total{result=\"error\"} %u\n", adapterStats.tx_error);
+    strOut += "# TYPE cec_received_frames counter\n# HELP cec_received_frames Frames that were received.\n";
+    strOut += StringUtils::Format("cec_received_frames_total %u\n", adapterStats.rx_total);
+    strOut += "# TYPE cec_receive_errors counter\n# HELP cec_receive_errors Frames that weren't received correctly.\n";
+    strOut += StringUtils::Format("cec_receive_errors_total %u\n", adapterStats.rx_error);
+  }
+
+  cec_adapter_counters counters;
+  memset(&counters, 0, sizeof(counters));
+  counters.version = CEC_ADAPTER_COUNTERS_VERSION;
+  counters.size    = sizeof(cec_adapter_counters);
+  if (m_adapter->GetAdapterCounters(&counters))
+  {
+    strOut += "# TYPE cec_lost_frames counter\n# HELP cec_lost_frames Frames that the adapter dropped before they could be read.\n";
+    strOut += StringUtils::Format("cec_lost_frames_total %u\n", counters.rx_lost);
+    strOut += "# TYPE cec_callback_overflows counter\n# HELP cec_callback_overflows Callbacks that were dropped because the queue was full, log messages excluded.\n";
+    strOut += StringUtils::Format("cec_callback_overflows_total %u\n", counters.cb_overflow);
+  }
+
+  cec_status_snapshot snapshot;
+  memset(&snapshot, 0, sizeof(snapshot));
+  snapshot.version = CEC_STATUS_SNAPSHOT_VERSION;
+  snapshot.size    = sizeof(cec_status_snapshot);
+  if (m_adapter->GetStatusSnapshot(&snapshot))
+  {
+    strOut += "# TYPE cec_queue_depth gauge\n# HELP cec_queue_depth The number of entries that are waiting in a queue.\n";
+    strOut += StringUtils::Format("cec_queue_depth{queue=\"input\"} %u\n", snapshot.inputQueue);
+    strOut += StringUtils::Format("cec_queue_depth{queue=\"transmit\"} %u\n", snapshot.transmitQueue);
+    strOut += StringUtils::Format("cec_queue_depth{queue=\"adapter_write\"} %u\n", snapshot.adapterWriteQueue);
+    strOut += StringUtils::Format("cec_queue_depth{queue=\"callback\"} %u\n", snapshot.callbackQueue);
+    strOut += StringUtils::Format("cec_queue_depth{queue=\"callback_log\"} %u\n", snapshot.callbackLogQueue);
+
+    static const struct
+    {
+      cec_power_status status;
+      const char *     strName;
+    } powerStates[] = {
+      { CEC_POWER_STATUS_ON,                          "on" },
+      { CEC_POWER_STATUS_STANDBY,                     "standby" },
+      { CEC_POWER_STATUS_IN_TRANSITION_STANDBY_TO_ON, "standby_to_on" },
+      { CEC_POWER_STATUS_IN_TRANSITION_ON_TO_STANDBY, "on_to_standby" },
+      { CEC_POWER_STATUS_UNKNOWN,                     "unknown" },
+    };
+
+    strOut += "# TYPE cec_device_present gauge\n# HELP cec_device_present 1 when a device responds on this logical address, 2 when it's handled by libCEC.\n";
+    for (uint8_t iPtr = CECDEVICE_TV; iPtr < CECDEVICE_BROADCAST; iPtr++)
+    {
+      const cec_bus_device_status status(snapshot.deviceStatus[iPtr]);
+      strOut += StringUtils::Format("cec_device_present{device=\"%s\"} %d\n",
+                                    ToLabel(m_adapter->ToString((cec_logical_address)iPtr)).c_str(),
+                                    status == CEC_DEVICE_STATUS_PRESENT ? 1 : status == CEC_DEVICE_STATUS_HANDLED_BY_LIBCEC ? 2 : 0);
+    }
+
+    strOut += "# TYPE cec_device_power stateset\n# HELP cec_device_power The last known power status of the devices that are present.\n";
+    for (uint8_t iPtr = CECDEVICE_TV; iPtr < CECDEVICE_BROADCAST; iPtr++)
+    {
+      if (snapshot.deviceStatus[iPtr] != CEC_DEVICE_STATUS_PRESENT && snapshot.deviceStatus[iPtr] != CEC_DEVICE_STATUS_HANDLED_BY_LIBCEC)
+        continue;
+      const std::string strDevice(ToLabel(m_adapter->ToString((cec_logical_address)iPtr)));
+      for (size_t iState = 0; iState < sizeof(powerStates) / sizeof(powerStates[0]); iState++)
+        strOut += StringUtils::Format("cec_device_power{device=\"%s\",cec_device_power=\"%s\"} %d\n",
+                                      strDevice.c_str(), powerStates[iState].strName, snapshot.powerStatus[iPtr] == powerStates[iState].status ? 1 : 0);
+    }
+
+    strOut += "# TYPE cec_device info\n# HELP cec_device The physical address of the devices that are present.\n";
+    for (uint8_t iPtr = CECDEVICE_TV; iPtr < CECDEVICE_BROADCAST; iPtr++)
+    {
+      if (snapshot.physicalAddress[iPtr] == CEC_INVALID_PHYSICAL_ADDRESS ||
+          (snapshot.deviceStatus[iPtr] != CEC_DEVICE_STATUS_PRESENT && snapshot.deviceStatus[iPtr] != CEC_DEVICE_STATUS_HANDLED_BY_LIBCEC))
+        continue;
+      const uint16_t iAddress(snapshot.physicalAddress[iPtr]);
+      strOut += StringUtils::Format("cec_device_info{device=\"%s\",physical_address=\"%x.%x.%x.%x\"} 1\n",
+                                    ToLabel(m_adapter->ToString((cec_logical_address)iPtr)).c_str(),
+                                    (iAddress >> 12) & 0xF, (iAddress >> 8) & 0xF, (iAddress >> 4) & 0xF, iAddress & 0xF);
+    }
+  }
+
+  // 50kB, too big for the stack of this thread
+  cec_latency_stats *latency = new cec_latency_stats;
+  latency->version = CEC_LATENCY_STATS_VERSION;
+  latency->size    = sizeof(cec_latency_stats);
+  if (m_adapter->GetLatencyStats(latency))
+  {
+    std::string opcodeLabels[256];
+    for (unsigned int iPtr = 0; iPtr < 256; iPtr++)
+      if (!IsEmpty(latency->opcodes[iPtr]))
+        opcodeLabels[iPtr] = StringUtils::Format("opcode=\"%s\"", OpcodeLabel(m_adapter, iPtr).c_str());
+    AddTransmitStats(strOut, "opcode", latency->opcodes, opcodeLabels, 256);
+
+    std::string destinationLabels[16];
+    for (uint8_t iPtr = 0; iPtr < 16; iPtr++)
+      destinationLabels[iPtr] = StringUtils::Format("destination=\"%s\"", ToLabel(m_adapter->ToString((cec_logical_address)iPtr)).c_str());
+    AddTransmitStats(strOut, "destination", latency->destinations, destinationLabels, 16);
+
+    strOut += "# TYPE cec_callback_delay_seconds histogram\n# UNIT cec_callback_delay_seconds seconds\n# HELP cec_callback_delay_seconds The time that callbacks were queued before they were called.\n";
+    AddHistogram(strOut, "cec_callback_delay_seconds", "", latency->callbacks);
+  }
+  delete latency;
+
+  strOut += "# EOF\n";
+  return strOut;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "platform/threads/threads.h"
+#include <string>
+
+namespace CEC
+{
+  class ICECAdapter;
+}
+
+/*!
+ * @brief Serves libCEC's statistics in the OpenMetrics text format, over HTTP on a local
+ *        TCP port or on a Unix socket. Everything is read from what libCEC already knows,
+ *        so a scrape doesn't send anything on the bus.
+ */
+class CMetricsExporter : public CEC::CThread
+{
+  public:
+    CMetricsExporter(CEC::ICECAdapter *adapter) :
+      m_adapter(adapter),
+      m_socket(-1),
+      m_wakeupRead(-1),
+      m_wakeupWrite(-1) {}
+    virtual ~CMetricsExporter(void) { Stop(); }
+
+    /*!
+     * @brief Start listening.
+     * @param strEndpoint "unix:" followed by the path of the socket, or a port number,
+     *        optionally preceded by the address to listen on and a colon. 127.0.0.1 is
+     *        used when no address is given.
+     * @param strError Set to the reason when listening failed.
+     * @return True when listening.
+     */
+    bool Start(const std::string &strEndpoint, std::string &strError);
+
+    /*!
+     * @brief Stop listening, and remove the Unix socket.
+     */
+    void Stop(void);
+
+    /*!
+     * @return The metrics, in the OpenMetrics text format.
+     */
+    std::string Render(void);
+
+    void *Process(void) override;
+
+  private:
+    void HandleConnection(int socket);
+
+    CEC::ICECAdapter *m_adapter;
+    int               m_socket;
+    int               m_wakeupRead;  /**< the read end of a pipe that wakes up Process() when stopping */
+    int               m_wakeupWrite;
+    std::string       m_strUnixPath;
+};
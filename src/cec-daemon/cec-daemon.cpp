@@ -0,0 +1,198 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+/*
+ * Shares one CEC adapter between several processes. Start this, and open the
+ * port "daemon" (or "daemon:/path/to/socket") in each libCEC client instead of
+ * the adapter itself. Every client takes its own logical addresses.
+ */
+
+#include "env.h"
+#include "cec.h"
+#include "LibCEC.h"
+#include "adapter/AdapterFactory.h"
+#include "adapter/Daemon/DaemonCECServer.h"
+#include <iostream>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+using namespace CEC;
+
+static volatile sig_atomic_t g_bExit(0);
+static int g_iLogLevel(CEC_LOG_ERROR | CEC_LOG_WARNING | CEC_LOG_NOTICE);
+
+static void sighandler(int UNUSED(iSignal))
+{
+  g_bExit = 1;
+}
+
+static void CecLogMessage(void *UNUSED(cbParam), const cec_log_message *message)
+{
+  if ((message->level & g_iLogLevel) != message->level)
+    return;
+
+  const char *strLevel("");
+  switch (message->level)
+  {
+  case CEC_LOG_ERROR:
+    strLevel = "ERROR:   ";
+    break;
+  case CEC_LOG_WARNING:
+    strLevel = "WARNING: ";
+    break;
+  case CEC_LOG_NOTICE:
+    strLevel = "NOTICE:  ";
+    break;
+  case CEC_LOG_TRAFFIC:
+    strLevel = "TRAFFIC: ";
+    break;
+  case CEC_LOG_DEBUG:
+    strLevel = "DEBUG:   ";
+    break;
+  default:
+    break;
+  }
+  fprintf(stderr, "%s[%16lld]\t%s\n", strLevel, (long long)message->time, message->message);
+}
+
+static void ShowHelpCommandLine(const char *strExec)
+{
+  std::cout << std::endl <<
+      strExec << " [options] [COM PORT]" << std::endl <<
+      std::endl <<
+      "parameters:" << std::endl <<
+      "  -h --help                   Shows this help text" << std::endl <<
+      "  -s --socket {path}          The socket that clients connect to." << std::endl <<
+      "                              Default: " << CEC_DAEMON_DEFAULT_SOCKET << std::endl <<
+      "  -d --log-level {level}      Sets the log level. See cectypes.h for values." << std::endl <<
+      "  [COM PORT]                  The adapter to share. The first one that is" << std::endl <<
+      "                              detected is used when none is given." << std::endl <<
+      std::endl <<
+      "Clients open the port 'daemon', or 'daemon:{path}' when another socket is used." << std::endl <<
+      std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+  std::string strSocket(CEC_DAEMON_DEFAULT_SOCKET);
+  std::string strPort;
+
+  for (int iArgPtr = 1; iArgPtr < argc; iArgPtr++)
+  {
+    const char *strArg = argv[iArgPtr];
+    const char *strValue = iArgPtr + 1 < argc ? argv[iArgPtr + 1] : NULL;
+
+    if (!strcmp(strArg, "-h") || !strcmp(strArg, "--help"))
+    {
+      ShowHelpCommandLine(argv[0]);
+      return 0;
+    }
+
+    if (strArg[0] != '-')
+    {
+      strPort = strArg;
+      continue;
+    }
+
+    if (!strValue)
+    {
+      std::cerr << "unknown or incomplete parameter: " << strArg << std::endl;
+      ShowHelpCommandLine(argv[0]);
+      return 1;
+    }
+
+    if (!strcmp(strArg, "-s") || !strcmp(strArg, "--socket"))
+      strSocket = strValue;
+    else if (!strcmp(strArg, "-d") || !strcmp(strArg, "--log-level"))
+      g_iLogLevel = atoi(strValue);
+    else
+    {
+      std::cerr << "unknown parameter: " << strArg << std::endl;
+      ShowHelpCommandLine(argv[0]);
+      return 1;
+    }
+    ++iArgPtr;
+  }
+
+  // the libCEC instance isn't opened. it's only used for logging
+  ICECCallbacks callbacks;
+  callbacks.Clear();
+  callbacks.logMessage = &CecLogMessage;
+
+  libcec_configuration config;
+  config.Clear();
+  snprintf(config.strDeviceName, sizeof(config.strDeviceName), "cec-daemon");
+  config.clientVersion = LIBCEC_VERSION_CURRENT;
+  config.callbacks     = &callbacks;
+
+  ICECAdapter *adapter = CECInitialise(&config);
+  if (!adapter)
+  {
+    std::cerr << "cannot initialise libCEC" << std::endl;
+    return 1;
+  }
+  CLibCEC *lib = static_cast<CLibCEC *>(adapter);
+
+  if (strPort.empty())
+  {
+    cec_adapter_descriptor devices[10];
+    if (CAdapterFactory(lib).DetectAdapters(devices, 10, NULL) <= 0)
+    {
+      std::cerr << "no adapter found" << std::endl;
+      CECDestroy(adapter);
+      return 1;
+    }
+    strPort = devices[0].strComName;
+  }
+
+  int iReturn(0);
+  CDaemonCECServer *server = new CDaemonCECServer(lib);
+  if (server->Start(strPort, strSocket))
+  {
+    signal(SIGINT, sighandler);
+    signal(SIGTERM, sighandler);
+    while (!g_bExit)
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  else
+  {
+    iReturn = 1;
+  }
+
+  delete server;
+  CECDestroy(adapter);
+  return iReturn;
+}
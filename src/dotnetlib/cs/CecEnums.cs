@@ -450,4 +450,19 @@ namespace CecSharp
     RaspberryPi             = 0x100,
     TDA995x                 = 0x200
   }
+
+  /// <summary>
+  /// The result of one of the commands that were sent with TransmitBatch()
+  /// </summary>
+  public enum CecTransmitResult
+  {
+    /// <summary>not passed to the adapter, because the command was invalid or libCEC isn't connected</summary>
+    NotSent   = 0,
+    /// <summary>sent and acked</summary>
+    Acked     = 1,
+    /// <summary>sent, but not acked after all retries</summary>
+    NotAcked  = 2,
+    /// <summary>the adapter failed to send the command, or didn't report the result in time</summary>
+    Failed    = 3
+  }
 }
@@ -136,6 +136,47 @@ namespace CecSharp
     public uint rx_error;
   }
 
+  [StructLayout(LayoutKind.Sequential)]
+  internal struct cec_adapter_counters
+  {
+    public const uint Version = 1; // CEC_ADAPTER_COUNTERS_VERSION
+
+    public uint  version;
+    public uint  size;
+    public ulong rx_latency_total_us;
+    public uint  rx_latency_count;
+    public uint  rx_latency_max_us;
+    public uint  rx_lost;
+    public uint  cb_overflow;
+  }
+
+  [StructLayout(LayoutKind.Sequential)]
+  internal unsafe struct cec_device_info
+  {
+    public int    logicalAddress; // cec_logical_address
+    public ushort iPhysicalAddress;
+    public uint   iVendorId;
+    public int    cecVersion;     // cec_version
+    public int    powerStatus;    // cec_power_status
+    public fixed byte strOSDName[14];
+    public fixed byte strMenuLanguage[4];
+    public byte   bActiveSource;
+    public byte   bHandledByLibCEC;
+  }
+
+  [StructLayout(LayoutKind.Sequential)]
+  internal struct cec_bus_scan
+  {
+    [MarshalAs(UnmanagedType.ByValArray, SizeConst = 16)]
+    public cec_device_info[] devices;
+    public byte iDeviceCount;
+    public int  activeSource; // cec_logical_address
+    public byte iRequests;
+    public byte iReplies;
+    public uint iPollTimeMs;
+    public uint iRequestTimeMs;
+  }
+
   // ICECCallbacks: table of C function pointers, filled from pinned delegates in
   // CecCallbackMethods and handed to libcec_set_callbacks / the config struct.
   [StructLayout(LayoutKind.Sequential)]
@@ -262,6 +303,9 @@ namespace CecSharp
     [DllImport(L, CallingConvention = C)]
     internal static extern int libcec_transmit(IntPtr connection, ref cec_command data);
 
+    [DllImport(L, CallingConvention = C)]
+    internal static extern int libcec_transmit_batch(IntPtr connection, [In] cec_command[] commands, UIntPtr count, [Out] int[] results);
+
     [DllImport(L, CallingConvention = C)]
     internal static extern int libcec_set_logical_address(IntPtr connection, int iLogicalAddress);
 
@@ -328,6 +372,15 @@ namespace CecSharp
     [DllImport(L, CallingConvention = C)]
     internal static extern int libcec_send_play(IntPtr connection, int iDestination, int mode);
 
+    [DllImport(L, CallingConvention = C)]
+    internal static extern int libcec_set_log_level_mask(IntPtr connection, uint iMask);
+
+    [DllImport(L, CallingConvention = C)]
+    internal static extern int libcec_set_command_handler_filter(IntPtr connection, int[] opcodes, byte iCount, uint iClaimTimeoutMs);
+
+    [DllImport(L, CallingConvention = C)]
+    internal static extern int libcec_claim_command(IntPtr connection, ref cec_command command);
+
     [DllImport(L, CallingConvention = C)]
     internal static extern int libcec_get_device_osd_name(IntPtr connection, int iAddress, [Out] byte[] name);
 
@@ -377,6 +430,18 @@ namespace CecSharp
     [DllImport(L, CallingConvention = C)]
     internal static extern int libcec_get_stats(IntPtr connection, ref cec_adapter_stats stats);
 
+    [DllImport(L, CallingConvention = C)]
+    internal static extern int libcec_get_adapter_counters(IntPtr connection, ref cec_adapter_counters counters);
+
+    [DllImport(L, CallingConvention = C)]
+    internal static extern int libcec_scan_bus(IntPtr connection, ref cec_bus_scan scan);
+
+    [DllImport(L, CallingConvention = C)]
+    internal static extern int libcec_set_device_cache_path(IntPtr connection, [MarshalAs(UnmanagedType.LPStr)] string strPath);
+
+    [DllImport(L, CallingConvention = C)]
+    internal static extern int libcec_set_traffic_capture(IntPtr connection, [MarshalAs(UnmanagedType.LPStr)] string strPath);
+
     [DllImport(L, CallingConvention = C)]
     internal static extern sbyte libcec_detect_adapters(IntPtr connection, [In, Out] cec_adapter_descriptor[] deviceList, byte iBufSize, [MarshalAs(UnmanagedType.LPStr)] string strDevicePath, int bQuickScan);
 
@@ -489,6 +554,28 @@ namespace CecSharp
         d->iFirmwareBuildDate, d->iPhysicalAddress);
     }
 
+    // ---- cec_bus_scan ---------------------------------------------------
+
+    internal static CecBusScan ToManaged(cec_bus_scan scan)
+    {
+      int count = Math.Min((int)scan.iDeviceCount, scan.devices.Length);
+      var devices = new CecDeviceInfo[count];
+      fixed (cec_device_info* p = scan.devices)
+      {
+        for (int i = 0; i < count; i++)
+        {
+          cec_device_info* d = &p[i];
+          devices[i] = new CecDeviceInfo(
+            (CecLogicalAddress)d->logicalAddress, d->iPhysicalAddress, d->iVendorId,
+            (CecVersion)d->cecVersion, (CecPowerStatus)d->powerStatus,
+            GetAnsi(d->strOSDName, 14), GetAnsi(d->strMenuLanguage, 4),
+            d->bActiveSource != 0, d->bHandledByLibCEC != 0);
+        }
+      }
+      return new CecBusScan(devices, (CecLogicalAddress)scan.activeSource, scan.iRequests, scan.iReplies,
+        scan.iPollTimeMs, scan.iRequestTimeMs);
+    }
+
     // ---- libcec_configuration ------------------------------------------
 
     internal static libcec_configuration ToNative(LibCECConfiguration cfg)
@@ -310,13 +310,18 @@ namespace CecSharp
   /// </summary>
   public class CecAdapterStats
   {
-    internal CecAdapterStats(cec_adapter_stats stats)
+    internal CecAdapterStats(cec_adapter_stats stats, cec_adapter_counters counters)
     {
       TxAck = stats.tx_ack;
       TxNack = stats.tx_nack;
       TxError = stats.tx_error;
       RxTotal = stats.rx_total;
       RxError = stats.rx_error;
+      RxLatencyTotalUs = counters.rx_latency_total_us;
+      RxLatencyCount = counters.rx_latency_count;
+      RxLatencyMaxUs = counters.rx_latency_max_us;
+      CallbackOverflow = counters.cb_overflow;
+      RxLost = counters.rx_lost;
     }
 
     public uint TxAck { get; set; }
@@ -324,5 +329,96 @@ namespace CecSharp
     public uint TxError { get; set; }
     public uint RxTotal { get; set; }
     public uint RxError { get; set; }
+    /// <summary>
+    /// Summed time from the start of each received frame to its delivery, in microseconds.
+    /// Divide by RxLatencyCount for the average
+    /// </summary>
+    public ulong RxLatencyTotalUs { get; set; }
+    /// <summary>
+    /// Received frames in RxLatencyTotalUs
+    /// </summary>
+    public uint RxLatencyCount { get; set; }
+    /// <summary>
+    /// The highest latency of a single received frame, in microseconds
+    /// </summary>
+    public uint RxLatencyMaxUs { get; set; }
+    /// <summary>
+    /// Callback events that were dropped because the client's queue was full. Dropped log messages aren't counted
+    /// </summary>
+    public uint CallbackOverflow { get; set; }
+    /// <summary>
+    /// Received frames that the adapter dropped before libCEC could read them
+    /// </summary>
+    public uint RxLost { get; set; }
+  }
+
+  /// <summary>
+  /// A device on the CEC bus, as found by ScanBus()
+  /// </summary>
+  public class CecDeviceInfo
+  {
+    internal CecDeviceInfo(CecLogicalAddress logicalAddress, ushort physicalAddress, uint vendorId,
+      CecVersion cecVersion, CecPowerStatus powerStatus, string osdName, string menuLanguage,
+      bool activeSource, bool handledByLibCEC)
+    {
+      LogicalAddress = logicalAddress;
+      PhysicalAddress = physicalAddress;
+      VendorId = vendorId;
+      CecVersion = cecVersion;
+      PowerStatus = powerStatus;
+      OSDName = osdName;
+      MenuLanguage = menuLanguage;
+      ActiveSource = activeSource;
+      HandledByLibCEC = handledByLibCEC;
+    }
+
+    public CecLogicalAddress LogicalAddress { get; set; }
+    public ushort PhysicalAddress { get; set; }
+    public uint VendorId { get; set; }
+    public CecVersion CecVersion { get; set; }
+    public CecPowerStatus PowerStatus { get; set; }
+    public string OSDName { get; set; }
+    public string MenuLanguage { get; set; }
+    public bool ActiveSource { get; set; }
+    /// <summary>
+    /// True when this is one of the addresses of this client
+    /// </summary>
+    public bool HandledByLibCEC { get; set; }
+  }
+
+  /// <summary>
+  /// All devices on the CEC bus, and the time it took to find them
+  /// </summary>
+  public class CecBusScan
+  {
+    internal CecBusScan(CecDeviceInfo[] devices, CecLogicalAddress activeSource, byte requests, byte replies,
+      uint pollTimeMs, uint requestTimeMs)
+    {
+      Devices = devices;
+      ActiveSource = activeSource;
+      Requests = requests;
+      Replies = replies;
+      PollTimeMs = pollTimeMs;
+      RequestTimeMs = requestTimeMs;
+    }
+
+    public CecDeviceInfo[] Devices { get; set; }
+    public CecLogicalAddress ActiveSource { get; set; }
+    /// <summary>
+    /// The number of requests for properties that weren't known yet
+    /// </summary>
+    public byte Requests { get; set; }
+    /// <summary>
+    /// The number of requests that were answered
+    /// </summary>
+    public byte Replies { get; set; }
+    /// <summary>
+    /// The time it took to find the devices that are present, in milliseconds
+    /// </summary>
+    public uint PollTimeMs { get; set; }
+    /// <summary>
+    /// The time it took to request the properties and wait for the replies, in milliseconds
+    /// </summary>
+    public uint RequestTimeMs { get; set; }
   }
 }
@@ -157,6 +157,29 @@ namespace CecSharp
       return LibCec.libcec_transmit(_handle, ref native) == 1;
     }
 
+    /// <summary>
+    /// Transmit a sequence of raw CEC commands, e.g. a key press and its release, in one call.
+    /// All commands are queued at once, so the adapter doesn't wait for the caller between
+    /// frames. Commands to the same destination are sent in the given order.
+    /// </summary>
+    /// <param name="commands">The commands to transmit.</param>
+    /// <returns>The result of each command, or null when not connected.</returns>
+    public CecTransmitResult[] TransmitBatch(CecCommand[] commands)
+    {
+      if (_handle == IntPtr.Zero || commands == null)
+        return null;
+      var native = new cec_command[commands.Length];
+      for (int i = 0; i < commands.Length; i++)
+        native[i] = Interop.ToNative(commands[i]);
+      var results = new int[commands.Length];
+      if (LibCec.libcec_transmit_batch(_handle, native, (UIntPtr)commands.Length, results) < 0)
+        return null;
+      var managed = new CecTransmitResult[results.Length];
+      for (int i = 0; i < results.Length; i++)
+        managed[i] = (CecTransmitResult)results[i];
+      return managed;
+    }
+
     /// <summary>Change the logical address of the CEC adapter (debugging only).</summary>
     public bool SetLogicalAddress(CecLogicalAddress logicalAddress)
     {
@@ -339,6 +362,36 @@ namespace CecSharp
       return _handle != IntPtr.Zero && LibCec.libcec_send_play(_handle, (int)destination, (int)mode) == 1;
     }
 
+    /// <summary>Only pass log messages of these levels to the log callback.</summary>
+    public bool SetLogLevelMask(CecLogLevel levels)
+    {
+      return _handle != IntPtr.Zero && LibCec.libcec_set_log_level_mask(_handle, (uint)levels) == 1;
+    }
+
+    /// <summary>
+    /// Only pass commands with one of these opcodes to the command handler callback, or all
+    /// commands when opcodes is null. With a claim timeout of 0, libCEC waits for the callback's
+    /// result. Otherwise the callback doesn't hold up libCEC, and commands to one of our devices
+    /// that aren't claimed within the timeout are answered with a feature abort. libCEC still
+    /// processes the other commands, like broadcasts, itself.
+    /// </summary>
+    public bool SetCommandHandlerFilter(CecOpcode[] opcodes, uint claimTimeoutMs)
+    {
+      if (_handle == IntPtr.Zero || (opcodes != null && opcodes.Length > byte.MaxValue))
+        return false;
+      int[] native = opcodes == null ? null : Array.ConvertAll(opcodes, o => (int)o);
+      return LibCec.libcec_set_command_handler_filter(_handle, native, (byte)(native == null ? 0 : native.Length), claimTimeoutMs) == 1;
+    }
+
+    /// <summary>Claim a command that was passed to the command handler callback asynchronously.</summary>
+    public bool ClaimCommand(CecCommand command)
+    {
+      if (_handle == IntPtr.Zero)
+        return false;
+      cec_command native = Interop.ToNative(command);
+      return LibCec.libcec_claim_command(_handle, ref native) == 1;
+    }
+
     /// <summary>Get the OSD name of a device on the CEC bus.</summary>
     public string GetDeviceOSDName(CecLogicalAddress logicalAddress)
     {
@@ -559,7 +612,60 @@ namespace CecSharp
       {
         // older native library without libcec_get_stats; report zeroed stats
       }
-      return new CecAdapterStats(native);
+
+      var counters = new cec_adapter_counters();
+      counters.version = cec_adapter_counters.Version;
+      counters.size = (uint)Marshal.SizeOf(typeof(cec_adapter_counters));
+      try
+      {
+        if (_handle != IntPtr.Zero)
+          LibCec.libcec_get_adapter_counters(_handle, ref counters);
+      }
+      catch (EntryPointNotFoundException)
+      {
+        // older native library without libcec_get_adapter_counters; report zeroed counters
+      }
+      return new CecAdapterStats(native, counters);
+    }
+
+    /// <summary>
+    /// Find all devices on the CEC bus and get their properties. The requests for all devices
+    /// are sent together, and the replies are awaited together.
+    /// </summary>
+    /// <returns>The devices, or null when the bus couldn't be scanned.</returns>
+    public CecBusScan ScanBus()
+    {
+      if (_handle == IntPtr.Zero)
+        return null;
+      var native = new cec_bus_scan();
+      if (LibCec.libcec_scan_bus(_handle, ref native) != 1)
+        return null;
+      return Interop.ToManaged(native);
+    }
+
+    /// <summary>
+    /// Remember the properties of the devices on the bus in a file, so they don't have to be
+    /// requested again after a restart. The file is read by Open() and written by Close().
+    /// Should be called before Open().
+    /// </summary>
+    /// <param name="strPath">The path to the file, or null to not use a cache.</param>
+    public void SetDeviceCachePath(string strPath)
+    {
+      if (_handle == IntPtr.Zero)
+        return;
+      LibCec.libcec_set_device_cache_path(_handle, strPath);
+    }
+
+    /// <summary>
+    /// Write every frame that is received or transmitted to a pcap file. The file can be
+    /// played back by opening the port "replay:" followed by its path.
+    /// </summary>
+    /// <param name="strPath">The path to the file, or null to stop capturing.</param>
+    /// <returns>True when the file was created, false otherwise.</returns>
+    public bool SetTrafficCapture(string strPath)
+    {
+      return _handle != IntPtr.Zero &&
+          LibCec.libcec_set_traffic_capture(_handle, strPath) == 1;
     }
 
     /// <summary>Get the (virtual) USB vendor id.</summary>
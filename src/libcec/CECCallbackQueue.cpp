@@ -0,0 +1,343 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "env.h"
+#include "CECCallbackQueue.h"
+#include "platform/util/timeutils.h"
+
+using namespace CEC;
+
+CCECCallbackQueue::CCECCallbackQueue(size_t iEventCapacity /* = CEC_CALLBACK_QUEUE_SIZE */, size_t iLogCapacity /* = CEC_CALLBACK_LOG_QUEUE_SIZE */, uint32_t iBlockTimeoutMs /* = CEC_CALLBACK_BLOCK_TIMEOUT */) :
+    m_bHasData(false),
+    m_bHasSpace(true),
+    m_bStopped(false),
+    m_iNextSequence(0),
+    m_iOverflows(0),
+    m_iLogOverflows(0),
+    m_iBlockTimeoutMs(iBlockTimeoutMs),
+    m_events(iEventCapacity),
+    m_iEventHead(0),
+    m_iEventCount(0),
+    m_logs(iLogCapacity),
+    m_logSequence(iLogCapacity),
+    m_iLogHead(0),
+    m_iLogCount(0),
+    m_bConfigPending(false),
+    m_iNextResultId(0)
+{
+  for (auto it = m_logs.begin(); it != m_logs.end(); ++it)
+    it->message.reserve(128);
+  for (size_t iPtr = 0; iPtr < CEC_CALLBACK_RESULT_SLOTS; ++iPtr)
+  {
+    m_results[iPtr].iId        = 0;
+    m_results[iPtr].iWaitingId = 0;
+    m_results[iPtr].iResult    = 0;
+  }
+  m_config.Clear();
+}
+
+CCECCallbackQueue::result_ready::operator bool() const
+{
+  const result_slot &slot(queue->m_results[iId % CEC_CALLBACK_RESULT_SLOTS]);
+  return queue->m_bStopped || slot.iId == iId;
+}
+
+bool CCECCallbackQueue::IsCallbackThread(void) const
+{
+  return m_callbackThread == std::this_thread::get_id();
+}
+
+bool CCECCallbackQueue::WaitForSpace(CLockObject &lock, bool bBlock)
+{
+  if (m_iEventCount < m_events.size())
+    return true;
+
+  // blocking the callback thread on its own queue would only delay the events
+  // that it should be delivering
+  if (bBlock && !m_bStopped && !IsCallbackThread())
+  {
+    m_bHasSpace = false;
+    m_spaceCondition.Wait(lock, m_bHasSpace, m_iBlockTimeoutMs);
+  }
+
+  if (m_iEventCount < m_events.size())
+    return true;
+
+  ++m_iOverflows;
+  return false;
+}
+
+bool CCECCallbackQueue::PushEvent(cec_callback_event &event, bool bBlock /* = true */)
+{
+  CLockObject lock(m_mutex);
+  if (!WaitForSpace(lock, bBlock))
+    return false;
+
+  event.iSequence = m_iNextSequence++;
+  event.iQueuedUs = GetTimeUs();
+  m_events[(m_iEventHead + m_iEventCount) % m_events.size()] = event;
+  ++m_iEventCount;
+
+  m_bHasData = true;
+  m_dataCondition.Signal();
+  return true;
+}
+
+void CCECCallbackQueue::PushCommand(const cec_command &command)
+{
+  cec_callback_event event;
+  event.type      = cec_callback_event::CEC_CB_COMMAND;
+  event.iResultId = 0;
+  event.command   = command;
+  PushEvent(event);
+}
+
+void CCECCallbackQueue::PushKey(const cec_keypress &key)
+{
+  cec_callback_event event;
+  event.type      = cec_callback_event::CEC_CB_KEY_PRESS;
+  event.iResultId = 0;
+  event.key       = key;
+  PushEvent(event);
+}
+
+void CCECCallbackQueue::PushLog(const cec_log_message_cpp &message)
+{
+  CLockObject lock(m_mutex);
+  if (m_logs.empty())
+    return;
+
+  if (m_iLogCount == m_logs.size())
+  {
+    // drop the oldest message
+    m_iLogHead = (m_iLogHead + 1) % m_logs.size();
+    --m_iLogCount;
+    ++m_iLogOverflows;
+  }
+
+  const size_t iPtr((m_iLogHead + m_iLogCount) % m_logs.size());
+  cec_log_message_cpp &entry(m_logs[iPtr]);
+  entry.message.assign(message.message);
+  entry.level = message.level;
+  entry.time  = message.time;
+  m_logSequence[iPtr] = m_iNextSequence++;
+  ++m_iLogCount;
+
+  m_bHasData = true;
+  m_dataCondition.Signal();
+}
+
+void CCECCallbackQueue::PushAlert(const libcec_alert type, const libcec_parameter &param)
+{
+  cec_callback_event event;
+  event.type        = cec_callback_event::CEC_CB_ALERT;
+  event.iResultId   = 0;
+  event.alert.type  = type;
+  event.alert.param = param;
+  PushEvent(event);
+}
+
+void CCECCallbackQueue::PushConfiguration(const libcec_configuration &config)
+{
+  CLockObject lock(m_mutex);
+  m_config = config;
+
+  // an earlier change that wasn't delivered yet will deliver this one
+  if (m_bConfigPending)
+    return;
+
+  if (!WaitForSpace(lock, true))
+    return;
+
+  cec_callback_event &event(m_events[(m_iEventHead + m_iEventCount) % m_events.size()]);
+  event.type      = cec_callback_event::CEC_CB_CONFIGURATION;
+  event.iResultId = 0;
+  event.iSequence = m_iNextSequence++;
+  event.iQueuedUs = GetTimeUs();
+  ++m_iEventCount;
+  m_bConfigPending = true;
+
+  m_bHasData = true;
+  m_dataCondition.Signal();
+}
+
+void CCECCallbackQueue::PushSourceActivated(bool bActivated, const cec_logical_address address)
+{
+  cec_callback_event event;
+  event.type              = cec_callback_event::CEC_CB_SOURCE_ACTIVATED;
+  event.iResultId         = 0;
+  event.source.bActivated = bActivated;
+  event.source.address    = address;
+  PushEvent(event);
+}
+
+int CCECCallbackQueue::Call(cec_callback_event &event, uint32_t iTimeout)
+{
+  {
+    CLockObject lock(m_mutex);
+    // 0 means "nobody's waiting"
+    if (++m_iNextResultId == 0)
+      ++m_iNextResultId;
+    event.iResultId = m_iNextResultId;
+    m_results[event.iResultId % CEC_CALLBACK_RESULT_SLOTS].iWaitingId = event.iResultId;
+  }
+
+  bool bQueued(PushEvent(event));
+
+  CLockObject lock(m_mutex);
+  result_slot &slot(m_results[event.iResultId % CEC_CALLBACK_RESULT_SLOTS]);
+  result_ready ready(this, event.iResultId);
+  const bool bReported(bQueued && m_resultCondition.Wait(lock, ready, iTimeout) && slot.iId == event.iResultId);
+
+  if (slot.iWaitingId == event.iResultId)
+    slot.iWaitingId = 0;
+  return bReported ? slot.iResult : 0;
+}
+
+int CCECCallbackQueue::CallMenuStateChanged(const cec_menu_state newState, uint32_t iTimeout)
+{
+  cec_callback_event event;
+  event.type      = cec_callback_event::CEC_CB_MENU_STATE;
+  event.menuState = newState;
+  return Call(event, iTimeout);
+}
+
+int CCECCallbackQueue::CallCommandHandler(const cec_command &command, uint32_t iTimeout)
+{
+  cec_callback_event event;
+  event.type    = cec_callback_event::CEC_CB_COMMAND_HANDLER;
+  event.command = command;
+  return Call(event, iTimeout);
+}
+
+bool CCECCallbackQueue::PushCommandHandler(const cec_command &command)
+{
+  cec_callback_event event;
+  event.type      = cec_callback_event::CEC_CB_COMMAND_HANDLER;
+  event.iResultId = 0;
+  event.command   = command;
+  return PushEvent(event, false);
+}
+
+bool CCECCallbackQueue::Report(const cec_callback_event &event, int iResult)
+{
+  if (event.iResultId == 0)
+    return false;
+
+  CLockObject lock(m_mutex);
+  result_slot &slot(m_results[event.iResultId % CEC_CALLBACK_RESULT_SLOTS]);
+  slot.iId     = event.iResultId;
+  slot.iResult = iResult;
+  m_resultCondition.Broadcast();
+
+  // the caller stops waiting after the timeout
+  return slot.iWaitingId == event.iResultId;
+}
+
+bool CCECCallbackQueue::Pop(cec_callback_event &event, cec_log_message_cpp &log, libcec_configuration &config, uint32_t iTimeout)
+{
+  CLockObject lock(m_mutex);
+  m_callbackThread = std::this_thread::get_id();
+
+  if (m_iEventCount == 0 && m_iLogCount == 0)
+  {
+    m_bHasData = false;
+    if (m_bStopped || !m_dataCondition.Wait(lock, m_bHasData, iTimeout))
+      return false;
+    if (m_iEventCount == 0 && m_iLogCount == 0)
+      return false;
+  }
+
+  // deliver whichever was queued first
+  if (m_iLogCount > 0 &&
+      (m_iEventCount == 0 || m_logSequence[m_iLogHead] < m_events[m_iEventHead].iSequence))
+  {
+    cec_log_message_cpp &entry(m_logs[m_iLogHead]);
+    // swap, so both strings keep their capacity
+    log.message.swap(entry.message);
+    log.level = entry.level;
+    log.time  = entry.time;
+    event.type      = cec_callback_event::CEC_CB_LOG_MESSAGE;
+    event.iSequence = m_logSequence[m_iLogHead];
+    event.iQueuedUs = 0;
+    event.iResultId = 0;
+
+    m_iLogHead = (m_iLogHead + 1) % m_logs.size();
+    --m_iLogCount;
+    return true;
+  }
+
+  event = m_events[m_iEventHead];
+  m_iEventHead = (m_iEventHead + 1) % m_events.size();
+  --m_iEventCount;
+
+  if (event.type == cec_callback_event::CEC_CB_CONFIGURATION)
+  {
+    config = m_config;
+    m_bConfigPending = false;
+  }
+
+  m_bHasSpace = true;
+  m_spaceCondition.Broadcast();
+  return true;
+}
+
+void CCECCallbackQueue::Stop(void)
+{
+  CLockObject lock(m_mutex);
+  m_bStopped  = true;
+  m_bHasData  = true;
+  m_bHasSpace = true;
+  m_dataCondition.Broadcast();
+  m_spaceCondition.Broadcast();
+  m_resultCondition.Broadcast();
+}
+
+unsigned int CCECCallbackQueue::Overflows(void)
+{
+  CLockObject lock(m_mutex);
+  return m_iOverflows;
+}
+
+unsigned int CCECCallbackQueue::LogOverflows(void)
+{
+  CLockObject lock(m_mutex);
+  return m_iLogOverflows;
+}
+
+void CCECCallbackQueue::Size(size_t &iEvents, size_t &iLogs)
+{
+  CLockObject lock(m_mutex);
+  iEvents = m_iEventCount;
+  iLogs   = m_iLogCount;
+}
@@ -0,0 +1,223 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "env.h"
+#include "LibCEC.h"
+#include "platform/threads/mutex.h"
+#include <thread>
+#include <vector>
+
+namespace CEC
+{
+  // the number of callback events that can be queued per client, logging excluded
+  #define CEC_CALLBACK_QUEUE_SIZE        128
+  // the number of log messages that can be queued per client
+  #define CEC_CALLBACK_LOG_QUEUE_SIZE    256
+  // the maximum time that a producer waits for space in a full queue
+  #define CEC_CALLBACK_BLOCK_TIMEOUT     1000
+  // the number of results of synchronous callbacks that are kept around for late waiters
+  #define CEC_CALLBACK_RESULT_SLOTS      16
+
+  /*!
+   * @brief One queued callback event. Log messages and configuration changes are
+   *        kept out of this record, see CCECCallbackQueue.
+   */
+  struct cec_callback_event
+  {
+    enum type {
+      CEC_CB_LOG_MESSAGE,
+      CEC_CB_KEY_PRESS,
+      CEC_CB_COMMAND,
+      CEC_CB_ALERT,
+      CEC_CB_CONFIGURATION,
+      CEC_CB_MENU_STATE,
+      CEC_CB_SOURCE_ACTIVATED,
+      CEC_CB_COMMAND_HANDLER,
+    } type;
+
+    uint64_t    iSequence; /**< the order in which events were queued, across the event and log queues */
+    int64_t     iQueuedUs; /**< the time at which the event was queued, 0 for log messages */
+    uint32_t    iResultId; /**< the result slot of a synchronous callback, 0 when none is waiting */
+    cec_command command;   /**< CEC_CB_COMMAND and CEC_CB_COMMAND_HANDLER */
+    union
+    {
+      cec_keypress   key;       /**< CEC_CB_KEY_PRESS */
+      cec_menu_state menuState; /**< CEC_CB_MENU_STATE */
+      struct
+      {
+        libcec_alert     type;
+        libcec_parameter param;
+      } alert;                  /**< CEC_CB_ALERT */
+      struct
+      {
+        bool                bActivated;
+        cec_logical_address address;
+      } source;                 /**< CEC_CB_SOURCE_ACTIVATED */
+    };
+  };
+
+  /*!
+   * @brief The queue between the threads that raise callbacks for a client and the
+   *        thread that calls them.
+   *
+   * All storage is allocated up front. When a queue is full, what happens depends
+   * on the type of event:
+   * - log messages: the oldest queued message is dropped
+   * - configuration changes: coalesced, only the most recent configuration is kept
+   *   and delivered in the position of the first change that wasn't delivered yet
+   * - everything else: the producer blocks until there's space, for at most
+   *   CEC_CALLBACK_BLOCK_TIMEOUT. the callback thread itself never blocks on its
+   *   own queue.
+   * Events that get dropped are counted in Overflows(), and log messages in
+   * LogOverflows(), so a chatty log doesn't hide lost key presses.
+   */
+  class CCECCallbackQueue
+  {
+  public:
+    CCECCallbackQueue(size_t iEventCapacity = CEC_CALLBACK_QUEUE_SIZE, size_t iLogCapacity = CEC_CALLBACK_LOG_QUEUE_SIZE, uint32_t iBlockTimeoutMs = CEC_CALLBACK_BLOCK_TIMEOUT);
+    virtual ~CCECCallbackQueue(void) {}
+
+    CCECCallbackQueue(const CCECCallbackQueue &) = delete;
+    CCECCallbackQueue &operator=(const CCECCallbackQueue &) = delete;
+
+    void PushCommand(const cec_command &command);
+    void PushKey(const cec_keypress &key);
+    void PushLog(const cec_log_message_cpp &message);
+    void PushAlert(const libcec_alert type, const libcec_parameter &param);
+    void PushConfiguration(const libcec_configuration &config);
+    void PushSourceActivated(bool bActivated, const cec_logical_address address);
+
+    /*!
+     * @brief Queue a command handler callback without waiting for its result, or for
+     *        space in the queue.
+     * @return True when queued, false when the queue is full.
+     */
+    bool PushCommandHandler(const cec_command &command);
+
+    /*!
+     * @brief Queue a callback and wait for its result.
+     * @return The value that was passed to Report(), or 0 on timeout.
+     */
+    int CallMenuStateChanged(const cec_menu_state newState, uint32_t iTimeout);
+    int CallCommandHandler(const cec_command &command, uint32_t iTimeout);
+
+    /*!
+     * @brief Get the next event, in the order in which they were queued. Only to be
+     *        called from the callback thread.
+     * @param event The event.
+     * @param log Set to the message when this is a CEC_CB_LOG_MESSAGE.
+     * @param config Set to the configuration when this is a CEC_CB_CONFIGURATION.
+     * @param iTimeout The maximum time to wait for an event.
+     * @return True when an event was returned.
+     */
+    bool Pop(cec_callback_event &event, cec_log_message_cpp &log, libcec_configuration &config, uint32_t iTimeout);
+
+    /*!
+     * @brief Report the result of a synchronous callback.
+     * @return True when the caller was still waiting for it.
+     */
+    bool Report(const cec_callback_event &event, int iResult);
+
+    /*!
+     * @brief Release everyone who's waiting on this queue. Nothing blocks after this.
+     */
+    void Stop(void);
+
+    /*!
+     * @return The number of events that were dropped because the queue was full. Log messages aren't included.
+     */
+    unsigned int Overflows(void);
+
+    /*!
+     * @return The number of log messages that were dropped because the log queue was full.
+     */
+    unsigned int LogOverflows(void);
+
+    /*!
+     * @brief Get the number of events and log messages that are queued.
+     */
+    void Size(size_t &iEvents, size_t &iLogs);
+
+  private:
+    struct result_slot
+    {
+      uint32_t iId;        /**< the id of the result in this slot */
+      uint32_t iWaitingId; /**< the id that a caller is waiting for */
+      int      iResult;
+    };
+
+    // the predicate for m_resultCondition, true once the result for iId is in or after Stop()
+    struct result_ready
+    {
+      result_ready(CCECCallbackQueue *queue, uint32_t iId) : queue(queue), iId(iId) {}
+      explicit operator bool() const;
+
+      CCECCallbackQueue *queue;
+      uint32_t           iId;
+    };
+
+    bool WaitForSpace(CLockObject &lock, bool bBlock);
+    bool PushEvent(cec_callback_event &event, bool bBlock = true);
+    int  Call(cec_callback_event &event, uint32_t iTimeout);
+    bool IsCallbackThread(void) const;
+
+    CMutex                           m_mutex;
+    CCondition<bool>                 m_dataCondition;
+    CCondition<bool>                 m_spaceCondition;
+    CCondition<result_ready>         m_resultCondition;
+    bool                             m_bHasData;
+    bool                             m_bHasSpace;
+    bool                             m_bStopped;
+    std::thread::id                  m_callbackThread; /**< the thread that pops events */
+    uint64_t                         m_iNextSequence;
+    unsigned int                     m_iOverflows;
+    unsigned int                     m_iLogOverflows;
+    uint32_t                         m_iBlockTimeoutMs;
+
+    std::vector<cec_callback_event>  m_events;         /**< ring of queued events */
+    size_t                           m_iEventHead;
+    size_t                           m_iEventCount;
+
+    std::vector<cec_log_message_cpp> m_logs;           /**< ring of queued log messages. the strings keep their capacity */
+    std::vector<uint64_t>            m_logSequence;
+    size_t                           m_iLogHead;
+    size_t                           m_iLogCount;
+
+    libcec_configuration             m_config;         /**< the most recent configuration change that wasn't delivered yet */
+    bool                             m_bConfigPending;
+
+    uint32_t                         m_iNextResultId;
+    result_slot                      m_results[CEC_CALLBACK_RESULT_SLOTS];
+  };
+};
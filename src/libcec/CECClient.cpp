@@ -37,6 +37,7 @@
 
 #include "CECProcessor.h"
 #include "LibCEC.h"
+#include "CECTimerService.h"
 #include "CECTypeUtils.h"
 #include "devices/CECPlaybackDevice.h"
 #include "devices/CECAudioSystem.h"
@@ -51,6 +52,8 @@ using namespace CEC;
 
 CCECClient::CCECClient(CCECProcessor *processor, const libcec_configuration &configuration) :
     m_processor(processor),
+    m_timers(processor->GetLib()->GetTimers()),
+    m_iKeypressTimer(0),
     m_bInitialised(false),
     m_bRegistered(false),
     m_iCurrentButton(CEC_USER_CONTROL_CODE_UNKNOWN),
@@ -63,8 +66,20 @@ CCECClient::CCECClient(CCECProcessor *processor, const libcec_configuration &con
     m_bSeenButtonRelease(false),
     m_iPreventForwardingPowerOffCommand(0),
     m_iLastKeypressTime(0),
-    m_iLastKeyreleaseTime(0)
+    m_iLastKeyreleaseTime(0),
+    m_iLogLevelMask(CEC_LOG_ALL),
+    m_bHasLogCallback(false),
+    m_bHasCommandHandler(false),
+    m_bFilterCommands(false),
+    m_iClaimTimeoutMs(0)
 {
+  for (size_t iPtr = 0; iPtr < sizeof(m_commandFilter) / sizeof(m_commandFilter[0]); iPtr++)
+    m_commandFilter[iPtr] = 0;
+  for (size_t iPtr = 0; iPtr < CEC_COMMAND_CLAIM_SLOTS; iPtr++)
+  {
+    m_claims[iPtr].command.Clear();
+    m_claims[iPtr].iDeadline = 0;
+  }
   m_lastKeypress.keycode = CEC_USER_CONTROL_CODE_UNKNOWN;
   m_lastKeypress.duration = 0;
   m_configuration.Clear();
@@ -75,11 +90,9 @@ CCECClient::CCECClient(CCECProcessor *processor, const libcec_configuration &con
 
 CCECClient::~CCECClient(void)
 {
+  m_timers->Cancel(m_iKeypressTimer);
+  m_callbackCalls.Stop();
   StopThread();
-  CCallbackWrap* cb;
-  while (!m_callbackCalls.IsEmpty())
-    if (m_callbackCalls.Pop(cb, 0))
-      delete cb;
 
   // unregister the client
   if (m_processor && IsRegistered())
@@ -411,6 +424,17 @@ bool CCECClient::AllocateLogicalAddresses(void)
     return false;
   }
 
+  // poll the addresses that all types can use at once, instead of one address at a time
+  cec_logical_addresses candidates; candidates.Clear();
+  for (uint8_t iPtr = 0; iPtr < 5; iPtr++)
+  {
+    cec_logical_addresses typeCandidates(GetLogicalAddressCandidates(m_configuration.deviceTypes.types[iPtr]));
+    for (uint8_t iAddress = CECDEVICE_TV; iAddress < CECDEVICE_BROADCAST; iAddress++)
+      if (typeCandidates[iAddress])
+        candidates.Set((cec_logical_address)iAddress);
+  }
+  cec_logical_addresses available(m_processor->ProbeLogicalAddresses(candidates));
+
   // check each entry of the list
   for (uint8_t iPtr = 0; iPtr < 5; iPtr++)
   {
@@ -420,15 +444,23 @@ bool CCECClient::AllocateLogicalAddresses(void)
     // find an LA for this type
     cec_logical_address address(CECDEVICE_UNKNOWN);
     if (m_configuration.deviceTypes.types[iPtr] == CEC_DEVICE_TYPE_TV)
+    {
       address = CECDEVICE_TV;
-    if (m_configuration.deviceTypes.types[iPtr] == CEC_DEVICE_TYPE_RECORDING_DEVICE)
-      address = AllocateLogicalAddressRecordingDevice();
-    if (m_configuration.deviceTypes.types[iPtr] == CEC_DEVICE_TYPE_TUNER)
-      address = AllocateLogicalAddressTuner();
-    if (m_configuration.deviceTypes.types[iPtr] == CEC_DEVICE_TYPE_PLAYBACK_DEVICE)
-      address = AllocateLogicalAddressPlaybackDevice();
-    if (m_configuration.deviceTypes.types[iPtr] == CEC_DEVICE_TYPE_AUDIO_SYSTEM)
-      address = AllocateLogicalAddressAudioSystem();
+    }
+    else
+    {
+      LIB_CEC->AddLog(CEC_LOG_DEBUG, "detecting logical address for type '%s'", ToString(m_configuration.deviceTypes.types[iPtr]));
+      cec_logical_addresses typeCandidates(GetLogicalAddressCandidates(m_configuration.deviceTypes.types[iPtr]));
+      for (uint8_t iAddress = CECDEVICE_TV; iAddress < CECDEVICE_BROADCAST; iAddress++)
+      {
+        if (typeCandidates[iAddress] && available[iAddress])
+        {
+          address = (cec_logical_address)iAddress;
+          available.Unset(address);
+          break;
+        }
+      }
+    }
 
     // display an error if no LA could be allocated
     if (address == CECDEVICE_UNKNOWN)
@@ -439,6 +471,8 @@ bool CCECClient::AllocateLogicalAddresses(void)
 
     // display the registered LA
     LIB_CEC->AddLog(CEC_LOG_DEBUG, "%s - device '%d', type '%s', LA '%X'", __FUNCTION__, iPtr, ToString(m_configuration.deviceTypes.types[iPtr]), address);
+    if (address != CECDEVICE_TV)
+      m_processor->GetDevice(address)->HandleLogicalAddressPoll(false, m_configuration.cecVersion);
     m_configuration.logicalAddresses.Set(address);
   }
 
@@ -447,62 +481,34 @@ bool CCECClient::AllocateLogicalAddresses(void)
   return true;
 }
 
-cec_logical_address CCECClient::AllocateLogicalAddressRecordingDevice(void)
-{
-  cec_logical_address retVal(CECDEVICE_UNKNOWN);
-
-  LIB_CEC->AddLog(CEC_LOG_DEBUG, "detecting logical address for type 'recording device'");
-  if (m_processor->TryLogicalAddress(CECDEVICE_RECORDINGDEVICE1, m_configuration.cecVersion))
-    retVal = CECDEVICE_RECORDINGDEVICE1;
-  else if (m_processor->TryLogicalAddress(CECDEVICE_RECORDINGDEVICE2, m_configuration.cecVersion))
-    retVal = CECDEVICE_RECORDINGDEVICE2;
-  else if (m_processor->TryLogicalAddress(CECDEVICE_RECORDINGDEVICE3, m_configuration.cecVersion))
-    retVal = CECDEVICE_RECORDINGDEVICE3;
-
-  return retVal;
-}
-
-cec_logical_address CCECClient::AllocateLogicalAddressTuner(void)
-{
-  cec_logical_address retVal(CECDEVICE_UNKNOWN);
-
-  LIB_CEC->AddLog(CEC_LOG_DEBUG, "detecting logical address for type 'tuner'");
-  if (m_processor->TryLogicalAddress(CECDEVICE_TUNER1, m_configuration.cecVersion))
-    retVal = CECDEVICE_TUNER1;
-  else if (m_processor->TryLogicalAddress(CECDEVICE_TUNER2, m_configuration.cecVersion))
-    retVal = CECDEVICE_TUNER2;
-  else if (m_processor->TryLogicalAddress(CECDEVICE_TUNER3, m_configuration.cecVersion))
-    retVal = CECDEVICE_TUNER3;
-  else if (m_processor->TryLogicalAddress(CECDEVICE_TUNER4, m_configuration.cecVersion))
-    retVal = CECDEVICE_TUNER4;
-
-  return retVal;
-}
-
-cec_logical_address CCECClient::AllocateLogicalAddressPlaybackDevice(void)
-{
-  cec_logical_address retVal(CECDEVICE_UNKNOWN);
-
-  LIB_CEC->AddLog(CEC_LOG_DEBUG, "detecting logical address for type 'playback device'");
-  if (m_processor->TryLogicalAddress(CECDEVICE_PLAYBACKDEVICE1, m_configuration.cecVersion))
-    retVal = CECDEVICE_PLAYBACKDEVICE1;
-  else if (m_processor->TryLogicalAddress(CECDEVICE_PLAYBACKDEVICE2, m_configuration.cecVersion))
-    retVal = CECDEVICE_PLAYBACKDEVICE2;
-  else if (m_processor->TryLogicalAddress(CECDEVICE_PLAYBACKDEVICE3, m_configuration.cecVersion))
-    retVal = CECDEVICE_PLAYBACKDEVICE3;
-
-  return retVal;
-}
-
-cec_logical_address CCECClient::AllocateLogicalAddressAudioSystem(void)
-{
-  cec_logical_address retVal(CECDEVICE_UNKNOWN);
-
-  LIB_CEC->AddLog(CEC_LOG_DEBUG, "detecting logical address for type 'audiosystem'");
-  if (m_processor->TryLogicalAddress(CECDEVICE_AUDIOSYSTEM, m_configuration.cecVersion))
-    retVal = CECDEVICE_AUDIOSYSTEM;
-
-  return retVal;
+cec_logical_addresses CCECClient::GetLogicalAddressCandidates(const cec_device_type type)
+{
+  cec_logical_addresses addresses; addresses.Clear();
+  switch (type)
+  {
+  case CEC_DEVICE_TYPE_RECORDING_DEVICE:
+    addresses.Set(CECDEVICE_RECORDINGDEVICE1);
+    addresses.Set(CECDEVICE_RECORDINGDEVICE2);
+    addresses.Set(CECDEVICE_RECORDINGDEVICE3);
+    break;
+  case CEC_DEVICE_TYPE_TUNER:
+    addresses.Set(CECDEVICE_TUNER1);
+    addresses.Set(CECDEVICE_TUNER2);
+    addresses.Set(CECDEVICE_TUNER3);
+    addresses.Set(CECDEVICE_TUNER4);
+    break;
+  case CEC_DEVICE_TYPE_PLAYBACK_DEVICE:
+    addresses.Set(CECDEVICE_PLAYBACKDEVICE1);
+    addresses.Set(CECDEVICE_PLAYBACKDEVICE2);
+    addresses.Set(CECDEVICE_PLAYBACKDEVICE3);
+    break;
+  case CEC_DEVICE_TYPE_AUDIO_SYSTEM:
+    addresses.Set(CECDEVICE_AUDIOSYSTEM);
+    break;
+  default:
+    break;
+  }
+  return addresses;
 }
 
 CCECBusDevice *CCECClient::GetDeviceByType(const cec_device_type type) const
@@ -590,6 +596,11 @@ bool CCECClient::Transmit(const cec_command &data, bool bIsReply)
   return m_processor ? m_processor->Transmit(data, bIsReply) : false;
 }
 
+bool CCECClient::TransmitBatch(const cec_command *commands, size_t iCount, cec_transmit_result *results)
+{
+  return m_processor ? m_processor->TransmitBatch(commands, iCount, results) : false;
+}
+
 bool CCECClient::SendPowerOnDevices(const cec_logical_address address /* = CECDEVICE_TV */)
 {
   // if the broadcast address if set as destination, read the wakeDevices setting
@@ -1279,6 +1290,25 @@ void CCECClient::AddKey(const cec_keypress &key)
     LIB_CEC->AddLog(CEC_LOG_DEBUG, "key pressed: %s (%1x, %d)", ToString(transmitKey.keycode), transmitKey.keycode, transmitKey.duration);
     QueueAddKey(transmitKey);
   }
+
+  ScheduleKeypressCheck();
+}
+
+void CCECClient::ScheduleKeypressCheck(void)
+{
+  CLockObject lock(m_mutex);
+  if (m_iCurrentButton == CEC_USER_CONTROL_CODE_UNKNOWN)
+    return;
+
+  // a single timer per client, that stops when no key is held anymore
+  if (!m_timers->Reschedule(m_iKeypressTimer, 0))
+  {
+    m_iKeypressTimer = m_timers->Schedule(0, [this]() {
+      uint16_t iTimeout = CheckKeypressTimeout();
+      CLockObject lock(m_mutex);
+      return m_iCurrentButton == CEC_USER_CONTROL_CODE_UNKNOWN ? (uint32_t)0 : (uint32_t)iTimeout;
+    });
+  }
 }
 
 void CCECClient::SetCurrentButton(const cec_user_control_code iButtonCode)
@@ -1370,12 +1400,10 @@ uint16_t CCECClient::CheckKeypressTimeout(void)
   if (key.keycode != CEC_USER_CONTROL_CODE_UNKNOWN)
     QueueAddKey(key);
 
-  // never return 0. this is the delay after which the processor thread should
-  // poll us again, and it hands it straight to CCECInputBuffer::Pop(), where 0
-  // means "wait forever" -- the opposite of SyncedBuffer::Pop(), where 0 means
-  // "return immediately". a 0 slipping out of the arithmetic above would park
-  // the processor on the input queue until the next incoming frame instead of
-  // servicing the next keypress deadline, so clamp to a 1ms poll.
+  // never return 0. this is the delay after which the keypress timer calls us
+  // again, and 0 stops that timer. a 0 slipping out of the arithmetic above
+  // would leave the key held until the next key press instead of servicing the
+  // next keypress deadline, so clamp to a 1ms poll.
   return (uint16_t)std::max<uint64_t>(timeout, 1);
 }
 
@@ -1394,12 +1422,125 @@ void CCECClient::ResetKeypressState(void)
 
 bool CCECClient::EnableCallbacks(void *cbParam, ICECCallbacks *callbacks)
 {
-  CLockObject lock(m_cbMutex);
-  m_configuration.callbackParam = cbParam;
-  m_configuration.callbacks     = callbacks;
+  {
+    CLockObject lock(m_cbMutex);
+    m_configuration.callbackParam = cbParam;
+    m_configuration.callbacks     = callbacks;
+    m_bHasLogCallback             = !!callbacks && !!callbacks->logMessage;
+    m_bHasCommandHandler          = !!callbacks && !!callbacks->commandHandler;
+  }
+
+  // update the mask outside of m_cbMutex, it's read from other clients too
+  if (m_processor)
+    LIB_CEC->UpdateLogLevelMask();
   return true;
 }
 
+void CCECClient::SetLogLevelMask(uint32_t iMask)
+{
+  m_iLogLevelMask = iMask;
+  if (m_processor)
+    LIB_CEC->UpdateLogLevelMask();
+}
+
+bool CCECClient::SetCommandHandlerFilter(const cec_opcode *opcodes, uint8_t iCount, uint32_t iClaimTimeoutMs)
+{
+  uint32_t filter[8] = { 0 };
+  for (uint8_t iPtr = 0; opcodes && iPtr < iCount; iPtr++)
+  {
+    const uint8_t iOpcode((uint8_t)opcodes[iPtr]);
+    filter[iOpcode >> 5] |= 1u << (iOpcode & 0x1f);
+  }
+
+  for (size_t iPtr = 0; iPtr < 8; iPtr++)
+    m_commandFilter[iPtr] = filter[iPtr];
+  m_bFilterCommands = !!opcodes;
+  m_iClaimTimeoutMs = iClaimTimeoutMs;
+
+  LIB_CEC->AddLog(CEC_LOG_DEBUG, "command handler filter: %s, claim timeout: %u ms", opcodes ? "on" : "off", iClaimTimeoutMs);
+  return true;
+}
+
+bool CCECClient::WantsCommand(const cec_opcode opcode) const
+{
+  if (!m_bFilterCommands)
+    return true;
+  const uint8_t iOpcode((uint8_t)opcode);
+  return (m_commandFilter[iOpcode >> 5] & (1u << (iOpcode & 0x1f))) != 0;
+}
+
+int CCECClient::AddCommandClaim(const cec_command &command, int64_t iDeadline)
+{
+  CLockObject lock(m_claimMutex);
+  for (int iPtr = 0; iPtr < CEC_COMMAND_CLAIM_SLOTS; iPtr++)
+  {
+    if (m_claims[iPtr].iDeadline == 0)
+    {
+      m_claims[iPtr].command   = command;
+      m_claims[iPtr].iDeadline = iDeadline;
+      return iPtr;
+    }
+  }
+  return -1;
+}
+
+bool CCECClient::ClaimCommand(const cec_command &command)
+{
+  CLockObject lock(m_claimMutex);
+  // the same command can be waiting more than once. claim the oldest one
+  command_claim *claim(nullptr);
+  for (size_t iPtr = 0; iPtr < CEC_COMMAND_CLAIM_SLOTS; iPtr++)
+  {
+    command_claim &slot(m_claims[iPtr]);
+    if (slot.iDeadline != 0 &&
+        slot.command.initiator == command.initiator &&
+        slot.command.destination == command.destination &&
+        slot.command.opcode == command.opcode &&
+        (!claim || slot.iDeadline < claim->iDeadline))
+      claim = &slot;
+  }
+
+  if (!claim)
+    return false;
+  claim->iDeadline = 0;
+  return true;
+}
+
+uint16_t CCECClient::CheckCommandClaimTimeout(void)
+{
+  // 0 when no commands are waiting to be claimed
+  uint64_t timeout = 0;
+  cec_command expired[CEC_COMMAND_CLAIM_SLOTS];
+  size_t iExpired(0);
+  {
+    CLockObject lock(m_claimMutex);
+    int64_t iNow(GetTimeMs());
+    for (size_t iPtr = 0; iPtr < CEC_COMMAND_CLAIM_SLOTS; iPtr++)
+    {
+      command_claim &slot(m_claims[iPtr]);
+      if (slot.iDeadline == 0)
+        continue;
+      if (slot.iDeadline <= iNow)
+      {
+        expired[iExpired++] = slot.command;
+        slot.iDeadline = 0;
+      }
+      else if (timeout == 0 || (uint64_t)(slot.iDeadline - iNow) < timeout)
+        timeout = (uint64_t)(slot.iDeadline - iNow);
+    }
+  }
+
+  // transmit outside of m_claimMutex, so the client can keep claiming
+  for (size_t iPtr = 0; iPtr < iExpired; iPtr++)
+  {
+    LIB_CEC->AddLog(CEC_LOG_DEBUG, "command '%s' from %s wasn't claimed in time", ToString(expired[iPtr].opcode), ToString(expired[iPtr].initiator));
+    m_processor->TransmitAbort(expired[iPtr].destination, expired[iPtr].initiator, expired[iPtr].opcode, CEC_ABORT_REASON_REFUSED);
+  }
+
+  // 0 would wait forever
+  return timeout > UINT16_MAX ? UINT16_MAX : (uint16_t)timeout;
+}
+
 bool CCECClient::PingAdapter(void)
 {
   return m_processor ? m_processor->PingAdapter() : false;
@@ -1657,6 +1798,13 @@ bool CCECClient::PollDevice(const cec_logical_address iAddress)
   return m_processor ? m_processor->PollDevice(iAddress) : false;
 }
 
+bool CCECClient::ScanBus(cec_bus_scan &scan)
+{
+  return m_processor ?
+      m_processor->ScanBus(GetPrimaryLogicalAddress(), scan) :
+      false;
+}
+
 cec_logical_addresses CCECClient::GetActiveDevices(void)
 {
   CECDEVICEVEC activeDevices;
@@ -1779,104 +1927,136 @@ uint32_t CCECClient::DoubleTapTimeoutMS(void)
 
 void CCECClient::QueueAddCommand(const cec_command& command)
 {
-  m_callbackCalls.Push(new CCallbackWrap(command));
+  m_callbackCalls.PushCommand(command);
 }
 
 void CCECClient::QueueAddKey(const cec_keypress& key)
 {
-  m_callbackCalls.Push(new CCallbackWrap(key));
+  m_callbackCalls.PushKey(key);
 }
 
 void CCECClient::QueueAddLog(const cec_log_message_cpp& message)
 {
-  m_callbackCalls.Push(new CCallbackWrap(message));
+  if ((LogLevelMask() & (uint32_t)message.level) != 0)
+    m_callbackCalls.PushLog(message);
 }
 
 void CCECClient::QueueAlert(const libcec_alert type, const libcec_parameter& param)
 {
-  m_callbackCalls.Push(new CCallbackWrap(type, param));
+  m_callbackCalls.PushAlert(type, param);
 }
 
 void CCECClient::QueueConfigurationChanged(const libcec_configuration& config)
 {
-  m_callbackCalls.Push(new CCallbackWrap(config));
+  m_callbackCalls.PushConfiguration(config);
 }
 
 int CCECClient::QueueMenuStateChanged(const cec_menu_state newState)
 {
-  CCallbackWrap *wrapState = new CCallbackWrap(newState);
-  m_callbackCalls.Push(wrapState);
-  int result(wrapState->Result(1000));
-
-  if (wrapState->m_keepResult)
-    delete wrapState;
-  return result;
+  return m_callbackCalls.CallMenuStateChanged(newState, 1000);
 }
 
 void CCECClient::QueueSourceActivated(bool bActivated, const cec_logical_address logicalAddress)
 {
-  m_callbackCalls.Push(new CCallbackWrap(bActivated, logicalAddress));
+  m_callbackCalls.PushSourceActivated(bActivated, logicalAddress);
 }
 
 int CCECClient::QueueCommandHandler(const cec_command& command)
 {
-  CCallbackWrap *wrapState = new CCallbackWrap(command, true);
-  m_callbackCalls.Push(wrapState);
-  int result(wrapState->Result(1000));
+  if (!m_bHasCommandHandler || !WantsCommand(command.opcode))
+    return 0;
+
+  const uint32_t iClaimTimeoutMs(m_iClaimTimeoutMs);
+  if (iClaimTimeoutMs == 0)
+    return m_callbackCalls.CallCommandHandler(command, 1000);
+
+  // only commands that were sent to one of our devices are answered when they're not claimed
+  int iClaim(-1);
+  if (command.destination != CECDEVICE_BROADCAST &&
+      command.opcode != CEC_OPCODE_FEATURE_ABORT &&
+      m_processor->IsHandledByLibCEC(command.destination))
+  {
+    // the claim has to be in place before the callback can be called
+    iClaim = AddCommandClaim(command, GetTimeMs() + iClaimTimeoutMs);
+    if (iClaim < 0)
+    {
+      LIB_CEC->AddLog(CEC_LOG_WARNING, "too many unclaimed commands, handling '%s' in libCEC", ToString(command.opcode));
+      return 0;
+    }
+  }
+
+  if (!m_callbackCalls.PushCommandHandler(command))
+  {
+    if (iClaim >= 0)
+    {
+      CLockObject lock(m_claimMutex);
+      m_claims[iClaim].iDeadline = 0;
+    }
+    LIB_CEC->AddLog(CEC_LOG_WARNING, "callback queue full, handling '%s' in libCEC", ToString(command.opcode));
+    return 0;
+  }
 
-  if (wrapState->m_keepResult)
-    delete wrapState;
-  return result;
+  // libCEC still handles the commands that it won't answer for the client
+  return iClaim >= 0 ? 1 : 0;
 }
 
 void* CCECClient::Process(void)
 {
-  CCallbackWrap* cb(NULL);
+  // the configuration is only filled in for configuration changes, and kept here
+  // rather than in every queued event
+  cec_callback_event event;
+  cec_log_message_cpp log;
+  libcec_configuration config;
+  config.Clear();
+
   while (!IsStopped())
   {
-    if (m_callbackCalls.Pop(cb, 500))
+    if (m_callbackCalls.Pop(event, log, config, 500))
     {
-      bool keepResult = cb->m_keepResult;
+      if (event.iQueuedUs > 0 && m_processor)
+        m_processor->GetLatencyStats().AddCallbackDelay(GetTimeUs() - event.iQueuedUs);
+
       try
       {
-        switch (cb->m_type)
+        switch (event.type)
         {
-        case CCallbackWrap::CEC_CB_LOG_MESSAGE:
-          CallbackAddLog(cb->m_message);
+        case cec_callback_event::CEC_CB_LOG_MESSAGE:
+          CallbackAddLog(log);
           break;
-        case CCallbackWrap::CEC_CB_KEY_PRESS:
-          CallbackAddKey(cb->m_key);
+        case cec_callback_event::CEC_CB_KEY_PRESS:
+          CallbackAddKey(event.key);
           break;
-        case CCallbackWrap::CEC_CB_COMMAND:
-          AddCommand(cb->m_command);
+        case cec_callback_event::CEC_CB_COMMAND:
+          AddCommand(event.command);
           break;
-        case CCallbackWrap::CEC_CB_ALERT:
-          CallbackAlert(cb->m_alertType, cb->m_alertParam);
+        case cec_callback_event::CEC_CB_ALERT:
+          CallbackAlert(event.alert.type, event.alert.param);
           break;
-        case CCallbackWrap::CEC_CB_CONFIGURATION:
-          CallbackConfigurationChanged(cb->m_config);
+        case cec_callback_event::CEC_CB_CONFIGURATION:
+          CallbackConfigurationChanged(config);
           break;
-        case CCallbackWrap::CEC_CB_MENU_STATE:
-          keepResult = cb->Report(CallbackMenuStateChanged(cb->m_menuState));
+        case cec_callback_event::CEC_CB_MENU_STATE:
+          m_callbackCalls.Report(event, CallbackMenuStateChanged(event.menuState));
           break;
-        case CCallbackWrap::CEC_CB_SOURCE_ACTIVATED:
-          CallbackSourceActivated(cb->m_bActivated, cb->m_logicalAddress);
+        case cec_callback_event::CEC_CB_SOURCE_ACTIVATED:
+          CallbackSourceActivated(event.source.bActivated, event.source.address);
           break;
-        case CCallbackWrap::CEC_CB_COMMAND_HANDLER:
-          keepResult = cb->Report(CallbackCommandHandler(cb->m_command));
-          if (!keepResult)
+        case cec_callback_event::CEC_CB_COMMAND_HANDLER:
+          if (event.iResultId == 0)
+          {
+            // asynchronous, returning 1 claims the command
+            if (CallbackCommandHandler(event.command) == 1)
+              ClaimCommand(event.command);
+          }
+          else if (!m_callbackCalls.Report(event, CallbackCommandHandler(event.command)))
             LIB_CEC->AddLog(CEC_LOG_WARNING, "Command callback timeout occured !");
-	  break;
+          break;
         default:
           break;
         }
-
-        if (!keepResult)
-          delete cb;
       } catch (...)
       {
          // don't log a warning but let the app deal with this
-         delete cb;
       }
     }
   }
@@ -2004,3 +2184,31 @@ bool CCECClient::GetStats(struct cec_adapter_stats* stats)
       false;
 }
 #endif
+
+bool CCECClient::GetAdapterCounters(cec_adapter_counters &counters)
+{
+  if (!m_processor)
+    return false;
+
+  // adapters that don't keep counters leave them at 0
+  const uint32_t iVersion(counters.version), iSize(counters.size);
+  memset(&counters, 0, sizeof(cec_adapter_counters));
+  counters.version = iVersion;
+  counters.size    = iSize;
+  m_processor->GetAdapterCounters(counters);
+
+  counters.cb_overflow = m_callbackCalls.Overflows();
+  return true;
+}
+
+bool CCECClient::GetStatusSnapshot(cec_status_snapshot &snapshot)
+{
+  if (!m_processor || !m_processor->GetStatusSnapshot(snapshot))
+    return false;
+
+  size_t iEvents(0), iLogs(0);
+  m_callbackCalls.Size(iEvents, iLogs);
+  snapshot.callbackQueue    = (uint32_t)iEvents;
+  snapshot.callbackLogQueue = (uint32_t)iLogs;
+  return true;
+}
@@ -34,159 +34,26 @@
 
 #include "env.h"
 #include "LibCEC.h"
+#include "CECCallbackQueue.h"
 #include "platform/threads/threads.h"
 #include "platform/util/buffer.h"
 #include "platform/threads/mutex.h"
+#include <atomic>
 #include <string>
 #include <memory>
 
 namespace CEC
 {
   class CCECProcessor;
+  class CCECTimerService;
   class CCECBusDevice;
   class CCECPlaybackDevice;
   class CCECClient;
 
   typedef std::shared_ptr<CCECClient> CECClientPtr;
 
-  class CCallbackWrap
-  {
-  public:
-    CCallbackWrap(const cec_command& command) :
-      m_type(CEC_CB_COMMAND),
-      m_command(command),
-      m_alertType(CEC_ALERT_SERVICE_DEVICE),
-      m_menuState(CEC_MENU_STATE_ACTIVATED),
-      m_bActivated(false),
-      m_logicalAddress(CECDEVICE_UNKNOWN),
-      m_keepResult(false),
-      m_result(0),
-      m_bSucceeded(false) {}
-
-    CCallbackWrap(const cec_keypress& key) :
-      m_type(CEC_CB_KEY_PRESS),
-      m_key(key),
-      m_alertType(CEC_ALERT_SERVICE_DEVICE),
-      m_menuState(CEC_MENU_STATE_ACTIVATED),
-      m_bActivated(false),
-      m_logicalAddress(CECDEVICE_UNKNOWN),
-      m_keepResult(false),
-      m_result(0),
-      m_bSucceeded(false) {}
-
-    CCallbackWrap(const cec_log_message_cpp& message) :
-      m_type(CEC_CB_LOG_MESSAGE),
-      m_message(message),
-      m_alertType(CEC_ALERT_SERVICE_DEVICE),
-      m_menuState(CEC_MENU_STATE_ACTIVATED),
-      m_bActivated(false),
-      m_logicalAddress(CECDEVICE_UNKNOWN),
-      m_keepResult(false),
-      m_result(0),
-      m_bSucceeded(false) {}
-
-    CCallbackWrap(const libcec_alert type, const libcec_parameter& param) :
-      m_type(CEC_CB_ALERT),
-      m_alertType(type),
-      m_alertParam(param),
-      m_menuState(CEC_MENU_STATE_ACTIVATED),
-      m_bActivated(false),
-      m_logicalAddress(CECDEVICE_UNKNOWN),
-      m_keepResult(false),
-      m_result(0),
-      m_bSucceeded(false) {}
-
-    CCallbackWrap(const libcec_configuration& config) :
-      m_type(CEC_CB_CONFIGURATION),
-      m_alertType(CEC_ALERT_SERVICE_DEVICE),
-      m_config(config),
-      m_menuState(CEC_MENU_STATE_ACTIVATED),
-      m_bActivated(false),
-      m_logicalAddress(CECDEVICE_UNKNOWN),
-      m_keepResult(false),
-      m_result(0),
-      m_bSucceeded(false) {}
-
-    CCallbackWrap(const cec_menu_state newState) :
-      m_type(CEC_CB_MENU_STATE),
-      m_alertType(CEC_ALERT_SERVICE_DEVICE),
-      m_menuState(newState),
-      m_bActivated(false),
-      m_logicalAddress(CECDEVICE_UNKNOWN),
-      m_keepResult(true),
-      m_result(0),
-      m_bSucceeded(false) {}
-
-    CCallbackWrap(bool bActivated, const cec_logical_address logicalAddress) :
-      m_type(CEC_CB_SOURCE_ACTIVATED),
-      m_alertType(CEC_ALERT_SERVICE_DEVICE),
-      m_menuState(CEC_MENU_STATE_ACTIVATED),
-      m_bActivated(bActivated),
-      m_logicalAddress(logicalAddress),
-      m_keepResult(false),
-      m_result(0),
-      m_bSucceeded(false) {}
-
-    CCallbackWrap(const cec_command& command, const bool unused) :
-      m_type(CEC_CB_COMMAND_HANDLER),
-      m_command(command),
-      m_alertType(CEC_ALERT_SERVICE_DEVICE),
-      m_menuState(CEC_MENU_STATE_ACTIVATED),
-      m_bActivated(false),
-      m_logicalAddress(CECDEVICE_UNKNOWN),
-      m_keepResult(true),
-      m_result(0),
-      m_bSucceeded(false) {
-        (void)unused;
-      }
-
-    int Result(uint32_t iTimeout)
-    {
-      CLockObject lock(m_mutex);
-
-      bool bReturn = m_bSucceeded ? true : m_condition.Wait(lock, m_bSucceeded, iTimeout);
-      if (bReturn)
-        return m_result;
-      m_keepResult = false;
-      return 0;
-    }
-
-    bool Report(int result)
-    {
-      CLockObject lock(m_mutex);
-
-      m_result = result;
-      m_bSucceeded = true;
-      m_condition.Signal();
-      return m_keepResult;
-    }
-
-    enum callbackWrapType {
-      CEC_CB_LOG_MESSAGE,
-      CEC_CB_KEY_PRESS,
-      CEC_CB_COMMAND,
-      CEC_CB_ALERT,
-      CEC_CB_CONFIGURATION,
-      CEC_CB_MENU_STATE,
-      CEC_CB_SOURCE_ACTIVATED,
-      CEC_CB_COMMAND_HANDLER,
-    } m_type;
-
-    cec_command                  m_command;
-    cec_keypress                 m_key;
-    cec_log_message_cpp          m_message;
-    libcec_alert                 m_alertType;
-    libcec_parameter             m_alertParam;
-    libcec_configuration         m_config;
-    cec_menu_state               m_menuState;
-    bool                         m_bActivated;
-    cec_logical_address          m_logicalAddress;
-    bool                         m_keepResult;
-    int                          m_result;
-    CCondition<bool>             m_condition;
-    CMutex                       m_mutex;
-    bool                         m_bSucceeded;
-  };
+  // the number of asynchronously handled commands per client that can wait for a claim
+  #define CEC_COMMAND_CLAIM_SLOTS 16
 
   class CCECClient : private CThread
   {
@@ -291,6 +158,7 @@ namespace CEC
     virtual bool                  EnableCallbacks(void *cbParam, ICECCallbacks *callbacks);
     virtual bool                  PingAdapter(void);
     virtual bool                  Transmit(const cec_command &data, bool bIsReply);
+    virtual bool                  TransmitBatch(const cec_command *commands, size_t iCount, cec_transmit_result *results);
     virtual bool                  SetLogicalAddress(const cec_logical_address iLogicalAddress);
     virtual bool                  SetPhysicalAddress(const uint16_t iPhysicalAddress);
     virtual bool                  SetHDMIPort(const cec_logical_address iBaseDevice, const uint8_t iPort, bool bForce = false);
@@ -323,6 +191,10 @@ namespace CEC
     virtual bool                  SendKeypress(const cec_logical_address iDestination, const cec_user_control_code key, bool bWait = true);
     virtual bool                  SendKeyRelease(const cec_logical_address iDestination, bool bWait = true);
     virtual bool                  SendPlay(const cec_logical_address iDestination, const cec_play_mode mode);
+    void                          SetLogLevelMask(uint32_t iMask);
+    virtual bool                  SetCommandHandlerFilter(const cec_opcode *opcodes, uint8_t iCount, uint32_t iClaimTimeoutMs);
+    virtual bool                  ClaimCommand(const cec_command &command);
+    virtual bool                  ScanBus(cec_bus_scan &scan);
     virtual std::string           GetDeviceOSDName(const cec_logical_address iAddress);
     virtual cec_logical_address   GetActiveSource(void);
     virtual bool                  IsActiveSource(const cec_logical_address iAddress);
@@ -333,6 +205,8 @@ namespace CEC
     virtual bool                  IsLibCECActiveSource(void);
     bool                          AudioEnable(bool enable);
     bool                          GetStats(struct cec_adapter_stats* stats);
+    bool                          GetStatusSnapshot(cec_status_snapshot &snapshot);
+    bool                          GetAdapterCounters(cec_adapter_counters &counters);
 
     // configuration
     virtual bool                  GetCurrentConfiguration(libcec_configuration &configuration);
@@ -341,6 +215,11 @@ namespace CEC
     virtual bool                  SaveConfiguration(const libcec_configuration &configuration);
     virtual bool                  SetPhysicalAddress(const libcec_configuration &configuration);
 
+    /*!
+     * @return The log levels that this client consumes, or 0 when it has no log callback.
+     */
+    uint32_t                      LogLevelMask(void) const { return m_bHasLogCallback ? m_iLogLevelMask.load() : 0; }
+
     void QueueAddCommand(const cec_command& command);
     void QueueAddKey(const cec_keypress& key);
     void QueueAddLog(const cec_log_message_cpp& message);
@@ -357,6 +236,12 @@ namespace CEC
     virtual void                  AddKey(const cec_keypress &key);
     virtual void                  SetCurrentButton(const cec_user_control_code iButtonCode);
     virtual uint16_t              CheckKeypressTimeout(void);
+
+    /*!
+     * @brief Answer asynchronously handled commands that weren't claimed in time with a feature abort.
+     * @return The time in ms after which this should be called again, or 0 when no commands are waiting to be claimed.
+     */
+    virtual uint16_t              CheckCommandClaimTimeout(void);
     virtual void                  SourceActivated(const cec_logical_address logicalAddress);
     virtual void                  SourceDeactivated(const cec_logical_address logicalAddress);
 
@@ -429,28 +314,12 @@ namespace CEC
     virtual bool AllocateLogicalAddresses(void);
 
     /*!
-     * @brief Try to allocate a logical address for a recording device controlled by this client.
-     * @return The logical address that was allocated, or CECDEVICE_UNKNOWN if none could be allocated.
+     * @brief Get the logical addresses that a device of the given type can use. The
+     *        lowest address that is free is used.
+     * @param type The device type.
+     * @return The addresses. Empty for the TV, which doesn't have to poll for its address.
      */
-    virtual cec_logical_address AllocateLogicalAddressRecordingDevice(void);
-
-    /*!
-     * @brief Try to allocate a logical address for a tuner controlled by this client.
-     * @return The logical address that was allocated, or CECDEVICE_UNKNOWN if none could be allocated.
-     */
-    virtual cec_logical_address AllocateLogicalAddressTuner(void);
-
-    /*!
-     * @brief Try to allocate a logical address for a playback device controlled by this client.
-     * @return The logical address that was allocated, or CECDEVICE_UNKNOWN if none could be allocated.
-     */
-    virtual cec_logical_address AllocateLogicalAddressPlaybackDevice(void);
-
-    /*!
-     * @brief Try to allocate a logical address for an audiosystem controlled by this client.
-     * @return The logical address that was allocated, or CECDEVICE_UNKNOWN if none could be allocated.
-     */
-    virtual cec_logical_address AllocateLogicalAddressAudioSystem(void);
+    static cec_logical_addresses GetLogicalAddressCandidates(const cec_device_type type);
 
     /*!
      * @brief Change the physical address of the devices controlled by this client.
@@ -500,7 +369,31 @@ namespace CEC
      */
     void ResetKeypressState(void);
 
+    /*!
+     * @brief Check the held key right away, and then for as long as a key is held.
+     */
+    void ScheduleKeypressCheck(void);
+
+    /*!
+     * @return True when commands with this opcode are passed to the command handler callback.
+     */
+    bool WantsCommand(const cec_opcode opcode) const;
+
+    /*!
+     * @brief Keep track of a command that has to be claimed before the deadline.
+     * @return The slot of the claim, or -1 when all slots are in use.
+     */
+    int AddCommandClaim(const cec_command &command, int64_t iDeadline);
+
+    struct command_claim
+    {
+      cec_command command;
+      int64_t     iDeadline; /**< the time at which the command is aborted, 0 when this slot is free */
+    };
+
     CCECProcessor *                          m_processor;                         /**< a pointer to the processor */
+    CCECTimerService *                       m_timers;                            /**< the timers of the libCEC instance that this client belongs to */
+    uint64_t                                 m_iKeypressTimer;                    /**< the timer that releases and repeats held keys */
     libcec_configuration                     m_configuration;                     /**< the configuration of this client */
     bool                                     m_bInitialised;                      /**< true when initialised, false otherwise */
     bool                                     m_bRegistered;                       /**< true when registered in the processor, false otherwise */
@@ -518,6 +411,14 @@ namespace CEC
     int64_t                                  m_iLastKeypressTime;                 /**< the timestamp of the last key press forwarded to the client */
     int64_t                                  m_iLastKeyreleaseTime;               /**< the timestamp of the last key release forwarded to the client, reset on each forwarded press, or 0 if none was forwarded since */
     cec_keypress                             m_lastKeypress;                      /**< the last key press forwarded to the client */
-    SyncedBuffer<CCallbackWrap*>             m_callbackCalls;
+    CCECCallbackQueue                        m_callbackCalls;                     /**< callbacks that are waiting to be called */
+    std::atomic<uint32_t>                    m_iLogLevelMask;                     /**< the log levels that are passed to the log callback */
+    std::atomic<bool>                        m_bHasLogCallback;                   /**< true when a log callback is set */
+    std::atomic<bool>                        m_bHasCommandHandler;                /**< true when a command handler callback is set */
+    std::atomic<bool>                        m_bFilterCommands;                   /**< true when only the opcodes in m_commandFilter are passed to the command handler */
+    std::atomic<uint32_t>                    m_commandFilter[8];                  /**< bitmap of the opcodes that are passed to the command handler */
+    std::atomic<uint32_t>                    m_iClaimTimeoutMs;                   /**< the time in which commands have to be claimed, 0 when the command handler is called synchronously */
+    CMutex                                   m_claimMutex;                        /**< mutex for m_claims */
+    command_claim                            m_claims[CEC_COMMAND_CLAIM_SLOTS];   /**< commands that are waiting to be claimed */
   };
 }
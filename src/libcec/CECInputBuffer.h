@@ -35,15 +35,31 @@
 #include "env.h"
 #include "platform/threads/mutex.h"
 #include "platform/util/buffer.h"
+#include "platform/util/timeutils.h"
+#include <atomic>
+#include <deque>
 
 namespace CEC
 {
+  // the number of frames that can be queued per priority class
+  #define CEC_INPUT_BUFFER_SIZE 128
+
   // a buffer that priotises the input from the TV.
-  // if we need more than this, we'll have to change it into a priority_queue
+  //
+  // frames are pushed by the adapter's reader thread and popped by the processor
+  // thread, through a lock-free ring per priority class. the mutex is only taken
+  // to put the processor to sleep and to wake it up again, so the reader thread
+  // never has to wait for the processor while it's busy handling a command.
   class CCECInputBuffer
   {
   public:
-    CCECInputBuffer(void) : m_bHasData(false) {}
+    CCECInputBuffer(void) :
+      m_bWaiting(false),
+      m_bSignaled(false),
+      m_bBroadcast(false),
+      m_tvInBuffer(CEC_INPUT_BUFFER_SIZE),
+      m_inBuffer(CEC_INPUT_BUFFER_SIZE) {}
+
     virtual ~CCECInputBuffer(void)
     {
       Broadcast();
@@ -52,48 +68,109 @@ namespace CEC
     void Broadcast(void)
     {
       CLockObject lock(m_mutex);
-      m_bHasData = true;
+      m_bBroadcast = true;
+      m_bSignaled  = true;
       m_condition.Broadcast();
     }
 
+    /*!
+     * @brief Queue a received frame. Only to be called from the adapter's reader thread.
+     * @return False when the queue for this frame's priority class is full.
+     */
     bool Push(const cec_command &command)
     {
-      bool bReturn(false);
-      CLockObject lock(m_mutex);
-      if (command.initiator == CECDEVICE_TV)
-        bReturn = m_tvInBuffer.Push(command);
-      else
-        bReturn = m_inBuffer.Push(command);
+      if (!(command.initiator == CECDEVICE_TV ? m_tvInBuffer.Push(command) : m_inBuffer.Push(command)))
+        return false;
 
-      m_bHasData |= bReturn;
-      if (m_bHasData)
+      // pairs with the fence in Pop(): either the processor sees this frame before
+      // it goes to sleep, or we see that it's sleeping and wake it up
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (m_bWaiting.load(std::memory_order_relaxed))
+      {
+        CLockObject lock(m_mutex);
+        m_bSignaled = true;
         m_condition.Signal();
+      }
+
+      return true;
+    }
 
-      return bReturn;
+    /*!
+     * @brief Queue a frame again, to be processed before the other frames that are
+     *        waiting, except for the ones from the TV. Frames that are queued again
+     *        keep their order. Only to be called from the processor thread.
+     */
+    void Requeue(const cec_command &command)
+    {
+      m_requeued.push_back(command);
     }
 
+    /*!
+     * @brief Get the next frame: TV frames first, then the frames that were queued
+     *        again, then the others. Only to be called from the processor thread.
+     * @param iTimeout The maximum time to wait for a frame, 0 waits forever.
+     */
     bool Pop(cec_command &command, uint16_t iTimeout)
     {
-      bool bReturn(false);
-      CLockObject lock(m_mutex);
-      if (m_tvInBuffer.IsEmpty() && m_inBuffer.IsEmpty() &&
-          !m_condition.Wait(lock, m_bHasData, iTimeout))
-        return bReturn;
+      CTimeout timeout(iTimeout);
+      while (!PopNoWait(command))
+      {
+        uint32_t iTimeLeft(0);
+        if (iTimeout != 0 && (iTimeLeft = timeout.TimeLeft()) == 0)
+          return false;
 
-      if (m_tvInBuffer.Pop(command))
-        bReturn = true;
-      else if (m_inBuffer.Pop(command))
-        bReturn = true;
+        CLockObject lock(m_mutex);
+        // drop a signal that was left behind by a frame that we already popped
+        m_bSignaled = m_bBroadcast;
+        m_bWaiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (m_tvInBuffer.IsEmpty() && m_inBuffer.IsEmpty())
+          m_condition.Wait(lock, m_bSignaled, iTimeLeft);
+
+        m_bWaiting.store(false, std::memory_order_relaxed);
+        if (m_bBroadcast)
+        {
+          m_bBroadcast = false;
+          return PopNoWait(command);
+        }
+      }
 
-      m_bHasData = !m_tvInBuffer.IsEmpty() || !m_inBuffer.IsEmpty();
-      return bReturn;
+      return true;
+    }
+
+    /*!
+     * @return The number of frames that were pushed and not popped yet. Frames that
+     *         were queued again by the processor aren't counted.
+     */
+    size_t Size(void) const
+    {
+      return m_tvInBuffer.Size() + m_inBuffer.Size();
     }
 
   private:
+    bool PopNoWait(cec_command &command)
+    {
+      if (m_tvInBuffer.Pop(command))
+        return true;
+
+      if (!m_requeued.empty())
+      {
+        command = m_requeued.front();
+        m_requeued.pop_front();
+        return true;
+      }
+
+      return m_inBuffer.Pop(command);
+    }
+
     CMutex                                m_mutex;
-    CCondition<volatile bool>             m_condition;
-    volatile bool                         m_bHasData;
-    SyncedBuffer<cec_command>             m_tvInBuffer;
-    SyncedBuffer<cec_command>             m_inBuffer;
+    CCondition<bool>                      m_condition;
+    std::atomic<bool>                     m_bWaiting;   /**< true while the processor thread is (about to start) waiting */
+    bool                                  m_bSignaled;
+    bool                                  m_bBroadcast; /**< set by Broadcast(), ends the next wait */
+    SPSCBuffer<cec_command>               m_tvInBuffer;
+    SPSCBuffer<cec_command>               m_inBuffer;
+    std::deque<cec_command>               m_requeued;   /**< frames queued again by the processor thread itself */
   };
 };
@@ -0,0 +1,113 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+
+#include "env.h"
+#include "CECLatencyStats.h"
+#include <string.h>
+
+using namespace CEC;
+
+CCECLatencyStats::CCECLatencyStats(void)
+{
+  Reset();
+}
+
+void CCECLatencyStats::Add(cec_latency_histogram &histogram, int64_t iLatencyUs)
+{
+  const uint32_t iUs(iLatencyUs <= 0 ? 0 : iLatencyUs >= UINT32_MAX ? UINT32_MAX : (uint32_t)iLatencyUs);
+
+  uint8_t iBucket(0);
+  while (iBucket < CEC_LATENCY_BUCKETS - 1 && iUs >= CEC_LATENCY_BUCKET_LIMIT_US(iBucket))
+    ++iBucket;
+
+  ++histogram.count;
+  ++histogram.buckets[iBucket];
+  histogram.total_us += iUs;
+  if (iUs > histogram.max_us)
+    histogram.max_us = iUs;
+}
+
+void CCECLatencyStats::AddTransmit(const cec_command &command, bool bAcked, int64_t iLatencyUs, uint8_t iRetries)
+{
+  const uint8_t iOpcode(command.opcode_set ? (uint8_t)command.opcode : (uint8_t)CEC_OPCODE_NONE);
+  const uint8_t iRetryBucket(iRetries < CEC_RETRY_BUCKETS ? iRetries : CEC_RETRY_BUCKETS - 1);
+
+  CLockObject lock(m_mutex);
+  cec_transmit_stats *entries[] = { &m_stats.opcodes[iOpcode], &m_stats.destinations[command.destination & 0xF] };
+  for (cec_transmit_stats *entry : entries)
+  {
+    if (bAcked)
+      Add(entry->ack, iLatencyUs);
+    else
+      ++entry->nacks;
+    ++entry->retries[iRetryBucket];
+  }
+}
+
+void CCECLatencyStats::AddResponse(cec_logical_address destination, cec_opcode opcode, bool bReceived, int64_t iLatencyUs)
+{
+  CLockObject lock(m_mutex);
+  cec_transmit_stats *entries[] = { &m_stats.opcodes[(uint8_t)opcode], &m_stats.destinations[destination & 0xF] };
+  for (cec_transmit_stats *entry : entries)
+  {
+    if (bReceived)
+      Add(entry->response, iLatencyUs);
+    else
+      ++entry->response_timeouts;
+  }
+}
+
+void CCECLatencyStats::AddCallbackDelay(int64_t iDelayUs)
+{
+  CLockObject lock(m_mutex);
+  Add(m_stats.callbacks, iDelayUs);
+}
+
+bool CCECLatencyStats::Get(cec_latency_stats &stats)
+{
+  if (stats.version != CEC_LATENCY_STATS_VERSION || stats.size != sizeof(cec_latency_stats))
+    return false;
+
+  CLockObject lock(m_mutex);
+  memcpy(&stats, &m_stats, sizeof(cec_latency_stats));
+  return true;
+}
+
+void CCECLatencyStats::Reset(void)
+{
+  CLockObject lock(m_mutex);
+  memset(&m_stats, 0, sizeof(cec_latency_stats));
+  m_stats.version = CEC_LATENCY_STATS_VERSION;
+  m_stats.size    = sizeof(cec_latency_stats);
+}
@@ -0,0 +1,93 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "env.h"
+#include "cectypes.h"
+#include "platform/threads/mutex.h"
+
+namespace CEC
+{
+  /*!
+   * @brief Collects the latencies that are returned by ICECAdapter::GetLatencyStats().
+   *        Thread safe, samples can be added from any thread.
+   */
+  class CCECLatencyStats
+  {
+  public:
+    CCECLatencyStats(void);
+
+    CCECLatencyStats(const CCECLatencyStats &) = delete;
+    CCECLatencyStats &operator=(const CCECLatencyStats &) = delete;
+
+    /*!
+     * @brief Add a frame that was transmitted.
+     * @param command The frame.
+     * @param bAcked True when it was acked.
+     * @param iLatencyUs The time from the first attempt until the last one completed.
+     * @param iRetries The number of times it was sent again.
+     */
+    void AddTransmit(const cec_command &command, bool bAcked, int64_t iLatencyUs, uint8_t iRetries);
+
+    /*!
+     * @brief Add the result of waiting for a reply.
+     * @param destination The device that was asked.
+     * @param opcode The opcode of the reply.
+     * @param bReceived True when the reply was received, false on timeout.
+     * @param iLatencyUs The time that was spent waiting.
+     */
+    void AddResponse(cec_logical_address destination, cec_opcode opcode, bool bReceived, int64_t iLatencyUs);
+
+    /*!
+     * @brief Add the time that a callback was queued before it was called.
+     */
+    void AddCallbackDelay(int64_t iDelayUs);
+
+    /*!
+     * @brief Copy the statistics.
+     * @return False when stats is a version that isn't supported.
+     */
+    bool Get(cec_latency_stats &stats);
+
+    void Reset(void);
+
+    /*!
+     * @brief Add a sample to a histogram.
+     */
+    static void Add(cec_latency_histogram &histogram, int64_t iLatencyUs);
+
+  private:
+    CMutex            m_mutex;
+    cec_latency_stats m_stats;
+  };
+};
@@ -44,46 +44,23 @@
 #include "implementations/CECCommandHandler.h"
 #include "LibCEC.h"
 #include "CECClient.h"
+#include "CECTimerService.h"
 #include "CECTypeUtils.h"
 #include "platform/util/timeutils.h"
 #include "platform/util/util.h"
 #include <stdio.h>
+#include <algorithm>
 
 using namespace CEC;
 
-#define ACTIVE_SOURCE_CHECK_INTERVAL   500
 #define TV_PRESENT_CHECK_INTERVAL      30000
+// reset the connection when the standby protection timer runs this much later
+// than it should have. it doesn't run when the system is suspended
+#define STANDBY_PROTECTION_INTERVAL    5000
+#define STANDBY_PROTECTION_MAX_DELAY   10000
 
 #define ToString(x) CCECTypeUtils::ToString(x)
 
-CCECStandbyProtection::CCECStandbyProtection(CCECProcessor* processor) :
-    m_processor(processor) {}
-CCECStandbyProtection::~CCECStandbyProtection(void) {}
-
-void* CCECStandbyProtection::Process(void)
-{
-  int64_t last = GetTimeMs();
-  int64_t next;
-  while (!IsStopped())
-  {
-    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-
-    next = GetTimeMs();
-
-    // reset the connection if the clock changed
-    if (next < last || next - last > 10000)
-    {
-      libcec_parameter param;
-      param.paramData = NULL; param.paramType = CEC_PARAMETER_TYPE_UNKOWN;
-      m_processor->GetLib()->Alert(CEC_ALERT_CONNECTION_LOST, param);
-      break;
-    }
-
-    last = next;
-  }
-  return NULL;
-}
-
 CCECProcessor::CCECProcessor(CLibCEC *libcec) :
     m_bInitialised(false),
     m_communication(NULL),
@@ -94,7 +71,13 @@ CCECProcessor::CCECProcessor(CLibCEC *libcec) :
     m_bMonitor(true),
     m_addrAllocator(NULL),
     m_bStallCommunication(false),
-    m_connCheck(NULL)
+    m_iActiveSourceTimer(0),
+    m_iActiveSourceCheck(0),
+    m_bCheckActiveSource(false),
+    m_bCheckTvPresent(false),
+    m_bCheckDeviceCache(false),
+    m_iStandbyCheck(0),
+    m_transmitScheduler(this)
 {
   m_busDevices = new CCECDeviceMap(this);
 }
@@ -133,11 +116,24 @@ void CCECProcessor::Close(void)
   SetCECInitialised(false);
 
   // stop the processor
-  SafeDelete(m_connCheck);
+  uint64_t iActiveSourceTimer(0);
+  {
+    CLockObject lock(m_timerMutex);
+    iActiveSourceTimer = m_iActiveSourceTimer;
+    m_iActiveSourceTimer = 0;
+    m_iActiveSourceCheck = 0;
+  }
+  m_libcec->GetTimers()->Cancel(iActiveSourceTimer);
   StopThread(-1);
   m_inBuffer.Broadcast();
   StopThread();
 
+  // fail what's still queued, and wait for what's being transmitted
+  m_transmitScheduler.Stop();
+
+  // remember the devices that were seen for the next connection
+  m_busDevices->SaveCache();
+
   // close the connection
   CLockObject lock(m_mutex);
   SafeDelete(m_communication);
@@ -153,6 +149,7 @@ void CCECProcessor::ResetMembers(void)
   m_iRetryLineTimeout = 3;
   m_iLastTransmission = 0;
   m_busDevices->ResetDeviceStatus();
+  m_latencyStats.Reset();
 }
 
 bool CCECProcessor::OpenConnection(const char *strPort, uint16_t iBaudRate, uint32_t iTimeoutMs, bool bStartListening /* = true */)
@@ -196,6 +193,18 @@ bool CCECProcessor::OpenConnection(const char *strPort, uint16_t iBaudRate, uint
 
   m_libcec->AddLog(CEC_LOG_NOTICE, "connection opened");
 
+  // use what's known about the devices on the bus from a previous connection
+  std::string strDeviceCachePath;
+  {
+    CLockObject lock(m_mutex);
+    strDeviceCachePath = m_strDeviceCachePath;
+  }
+  if (bStartListening && !strDeviceCachePath.empty())
+    m_busDevices->LoadCache(strDeviceCachePath, strPort);
+
+  // start transmitting
+  m_transmitScheduler.Start(m_communication->GetMaxPendingTransmits());
+
   // mark as initialised
   SetCECInitialised(true);
 
@@ -235,6 +244,105 @@ bool CCECProcessor::TryLogicalAddress(cec_logical_address address, cec_version l
   return false;
 }
 
+cec_logical_addresses CCECProcessor::ProbeLogicalAddresses(const cec_logical_addresses &addresses)
+{
+  cec_logical_addresses candidates; candidates.Clear();
+
+  // queue a poll for every candidate, then collect the results. each poll is sent
+  // once. TransmitNow() only retries it when the line failed
+  std::vector<std::pair<CCECBusDevice *, std::future<bool>>> polls;
+  for (uint8_t iPtr = CECDEVICE_TV; iPtr < CECDEVICE_BROADCAST; iPtr++)
+  {
+    // skip addresses that are already marked as present or used
+    CCECBusDevice *device = m_busDevices->At((cec_logical_address)iPtr);
+    if (!addresses[iPtr] || !device || device->IsPresent() || device->IsHandledByLibCEC())
+      continue;
+
+    m_libcec->AddLog(CEC_LOG_DEBUG, "trying logical address '%s'", device->GetLogicalAddressName());
+    cec_command command;
+    cec_command::Format(command, device->GetLogicalAddress(), device->GetLogicalAddress(), CEC_OPCODE_NONE);
+    polls.push_back(std::make_pair(device, TransmitAsync(command, false)));
+  }
+
+  // addresses that were taken are marked as present. the caller takes the free
+  // ones that it uses with CCECBusDevice::HandleLogicalAddressPoll()
+  for (auto &poll : polls)
+  {
+    if (poll.second.get())
+      poll.first->HandleLogicalAddressPoll(true);
+    else
+      candidates.Set(poll.first->GetLogicalAddress());
+  }
+
+  return candidates;
+}
+
+bool CCECProcessor::ScanBus(const cec_logical_address initiator, cec_bus_scan &scan)
+{
+  memset(&scan, 0, sizeof(scan));
+  scan.activeSource = CECDEVICE_UNKNOWN;
+  if (!CECInitialised() || !m_busDevices->At(initiator))
+    return false;
+
+  // poll all devices with an unknown status at once
+  int64_t iStart(GetTimeMs());
+  std::vector<std::pair<CCECBusDevice *, std::future<bool>>> polls;
+  for (CECDEVICEMAP::iterator it = m_busDevices->Begin(); it != m_busDevices->End(); ++it)
+  {
+    if (it->second->GetLogicalAddress() == initiator || !it->second->NeedsPoll())
+      continue;
+
+    m_libcec->AddLog(CEC_LOG_DEBUG, "<< %s (%X) -> %s (%X): POLL", ToString(initiator), initiator, it->second->GetLogicalAddressName(), it->second->GetLogicalAddress());
+    cec_command command;
+    cec_command::Format(command, initiator, it->second->GetLogicalAddress(), CEC_OPCODE_NONE);
+    polls.push_back(std::make_pair(it->second, TransmitAsync(command, false)));
+  }
+  for (auto &poll : polls)
+    poll.first->SetDeviceStatus(poll.second.get() ? CEC_DEVICE_STATUS_PRESENT : CEC_DEVICE_STATUS_NOT_PRESENT);
+
+  int64_t iPolled(GetTimeMs());
+  scan.iPollTimeMs = (uint32_t)(iPolled - iStart);
+
+  // request the properties that aren't known yet from all devices that are present
+  std::vector<device_request_t> requests;
+  for (CECDEVICEMAP::iterator it = m_busDevices->Begin(); it != m_busDevices->End(); ++it)
+    it->second->RequestDeviceInformation(initiator, requests);
+
+  // the active source answers with a broadcast, which is handled without waiting for it
+  if (!m_busDevices->GetActiveSource())
+    m_busDevices->At(initiator)->RequestActiveSource(false);
+
+  std::vector<device_request_t *> sent;
+  for (auto &request : requests)
+  {
+    if (request.transmitted.get())
+      sent.push_back(&request);
+  }
+  scan.iRequests = (uint8_t)sent.size();
+
+  // the replies arrive while waiting, so all of them get the same deadline
+  const int64_t iDeadline(GetTimeMs() + CEC_DEFAULT_TRANSMIT_WAIT);
+  for (auto request : sent)
+  {
+    const int64_t iRemaining(iDeadline - GetTimeMs());
+    if (request->device->WaitForOpcode(request->response, iRemaining > 0 ? (uint32_t)iRemaining : 1))
+      ++scan.iReplies;
+  }
+  scan.iRequestTimeMs = (uint32_t)(GetTimeMs() - iPolled);
+
+  for (CECDEVICEMAP::iterator it = m_busDevices->Begin(); it != m_busDevices->End(); ++it)
+  {
+    if (it->second->IsActive())
+      it->second->GetCurrentDeviceInformation(scan.devices[scan.iDeviceCount++]);
+  }
+  scan.activeSource = GetActiveSource(false);
+
+  m_libcec->AddLog(CEC_LOG_DEBUG, "bus scan: %u devices, %u of %u requests answered, poll %ums, requests %ums", scan.iDeviceCount, scan.iReplies, scan.iRequests, scan.iPollTimeMs, scan.iRequestTimeMs);
+  if (m_libcec->IsLogLevelEnabled(CEC_LOG_DEBUG))
+    m_libcec->AddLog(CEC_LOG_DEBUG, "bus topology:\n%s", m_busDevices->RoutingTreeToString().c_str());
+  return true;
+}
+
 void CCECProcessor::ReplaceHandlers(void)
 {
   CLockObject lock(m_mutex);
@@ -261,7 +369,19 @@ void CCECProcessor::ChangeDeviceType(CECClientPtr client, cec_device_type from,
 
 bool CCECProcessor::OnCommandReceived(const cec_command &command)
 {
-  return m_inBuffer.Push(command);
+  m_capture.Write(CEC_CAPTURE_RX, command, ADAPTER_MESSAGE_STATE_INCOMING);
+
+  if (!m_inBuffer.Push(command))
+  {
+    m_libcec->AddLog(CEC_LOG_WARNING, "input buffer full, dropping %s", ToString(command).c_str());
+    return false;
+  }
+  return true;
+}
+
+void CCECProcessor::RequeueCommand(const cec_command &command)
+{
+  m_inBuffer.Requeue(command);
 }
 
 void *CCECProcessor::Process(void)
@@ -269,13 +389,27 @@ void *CCECProcessor::Process(void)
   uint16_t timeout = CEC_PROCESSOR_SIGNAL_WAIT_TIME;
   m_libcec->AddLog(CEC_LOG_DEBUG, "processor thread started");
 
-  if (!m_connCheck)
-    m_connCheck = new CCECStandbyProtection(this);
-  m_connCheck->CreateThread();
+  // the periodic checks are timers, that wake up this thread when it's time to
+  // check. the checks themselves run here, because they transmit
+  CCECTimerService *timers(m_libcec->GetTimers());
+  m_iStandbyCheck = GetTimeMs();
+  uint64_t iStandbyTimer = timers->Schedule(STANDBY_PROTECTION_INTERVAL, [this]() { return OnStandbyProtectionTimer(); });
+  uint64_t iTvPresentTimer = timers->Schedule(TV_PRESENT_CHECK_INTERVAL, [this]() {
+    m_bCheckTvPresent = true;
+    m_inBuffer.Broadcast();
+    return (uint32_t)TV_PRESENT_CHECK_INTERVAL;
+  });
+  uint64_t iDeviceCacheTimer(0);
+  if (m_busDevices->HasCache())
+  {
+    iDeviceCacheTimer = timers->Schedule(CEC_DEVICE_CACHE_REVALIDATE_MS, [this]() {
+      m_bCheckDeviceCache = true;
+      m_inBuffer.Broadcast();
+      return (uint32_t)0;
+    });
+  }
 
   cec_command command; command.Clear();
-  CTimeout activeSourceCheck(ACTIVE_SOURCE_CHECK_INTERVAL);
-  CTimeout tvPresentCheck(TV_PRESENT_CHECK_INTERVAL);
 
   // as long as we're not being stopped and the connection is open
   while (!IsStopped() && m_communication->IsOpen())
@@ -286,45 +420,121 @@ void *CCECProcessor::Process(void)
 
     if (CECInitialised() && !IsStopped())
     {
-      // check clients for keypress timeouts
-      timeout = m_libcec->CheckKeypressTimeout();
+      // check clients for commands that weren't claimed in time. when none are
+      // waiting to be claimed, sleep until a command is received or a timer wakes us up
+      timeout = m_libcec->CheckCommandClaimTimeout();
 
       // check if we need to replace handlers
       ReplaceHandlers();
 
-      // check whether we need to activate a source, if it failed before
-      if (activeSourceCheck.TimeLeft() == 0)
-      {
-        if (CECInitialised())
-          TransmitPendingActiveSourceCommands();
-        activeSourceCheck.Init(ACTIVE_SOURCE_CHECK_INTERVAL);
-      }
+      // transmit active source commands that failed or were delayed before
+      if (m_bCheckActiveSource.exchange(false))
+        TransmitPendingActiveSourceCommands();
 
       // check whether the TV is present and responding
-      if (tvPresentCheck.TimeLeft() == 0)
-      {
-        CECClientPtr primary = GetPrimaryClient();
-        // only check whether the tv responds to polls when a client is connected and not in monitoring mode
-        if (primary && primary->GetConfiguration()->bMonitorOnly != 1)
-        {
-          if (!m_busDevices->At(CECDEVICE_TV)->IsPresent())
-          {
-            libcec_parameter param;
-            param.paramType = CEC_PARAMETER_TYPE_STRING;
-            param.paramData = (void*)"TV does not respond to CEC polls";
-            primary->Alert(CEC_ALERT_TV_POLL_FAILED, param);
-          }
-        }
-        tvPresentCheck.Init(TV_PRESENT_CHECK_INTERVAL);
-      }
+      if (m_bCheckTvPresent.exchange(false))
+        CheckTvPresent();
+
+      // check the devices that were taken from the device cache
+      if (m_bCheckDeviceCache.exchange(false))
+        m_busDevices->RevalidateCache(GetLogicalAddress());
     }
     else
       timeout = CEC_PROCESSOR_SIGNAL_WAIT_TIME;
   }
 
+  timers->Cancel(iDeviceCacheTimer);
+  timers->Cancel(iTvPresentTimer);
+  timers->Cancel(iStandbyTimer);
   return NULL;
 }
 
+bool CCECProcessor::SetTrafficCapture(const std::string &strPath)
+{
+  if (strPath.empty())
+  {
+    if (m_capture.IsOpen())
+      m_libcec->AddLog(CEC_LOG_NOTICE, "traffic capture stopped");
+    m_capture.Close();
+    return true;
+  }
+
+  if (!m_capture.Open(strPath))
+  {
+    m_libcec->AddLog(CEC_LOG_ERROR, "failed to create traffic capture '%s'", strPath.c_str());
+    return false;
+  }
+
+  m_libcec->AddLog(CEC_LOG_NOTICE, "capturing traffic to '%s'", strPath.c_str());
+  return true;
+}
+
+void CCECProcessor::SetDeviceCachePath(const std::string &strPath)
+{
+  CLockObject lock(m_mutex);
+  m_strDeviceCachePath = strPath;
+}
+
+void CCECProcessor::CheckTvPresent(void)
+{
+  CECClientPtr primary = GetPrimaryClient();
+  // only check whether the tv responds to polls when a client is connected and not in monitoring mode
+  if (primary && primary->GetConfiguration()->bMonitorOnly != 1)
+  {
+    if (!m_busDevices->At(CECDEVICE_TV)->IsPresent())
+    {
+      libcec_parameter param;
+      param.paramType = CEC_PARAMETER_TYPE_STRING;
+      param.paramData = (void*)"TV does not respond to CEC polls";
+      primary->Alert(CEC_ALERT_TV_POLL_FAILED, param);
+    }
+  }
+}
+
+uint32_t CCECProcessor::OnStandbyProtectionTimer(void)
+{
+  int64_t iNow = GetTimeMs();
+  int64_t iLast = m_iStandbyCheck;
+  m_iStandbyCheck = iNow;
+
+  // reset the connection if the clock changed
+  if (iNow < iLast || iNow - iLast > STANDBY_PROTECTION_INTERVAL + STANDBY_PROTECTION_MAX_DELAY)
+  {
+    libcec_parameter param;
+    param.paramData = NULL; param.paramType = CEC_PARAMETER_TYPE_UNKOWN;
+    m_libcec->Alert(CEC_ALERT_CONNECTION_LOST, param);
+    return 0;
+  }
+
+  return STANDBY_PROTECTION_INTERVAL;
+}
+
+void CCECProcessor::ScheduleActiveSourceCheck(int64_t iDelayMs)
+{
+  if (iDelayMs < 0)
+    iDelayMs = 0;
+
+  CLockObject lock(m_timerMutex);
+  int64_t iCheck = GetTimeMs() + iDelayMs;
+  if (m_iActiveSourceCheck != 0 && m_iActiveSourceCheck <= iCheck)
+    return;
+  m_iActiveSourceCheck = iCheck;
+
+  CCECTimerService *timers(m_libcec->GetTimers());
+  if (!timers->Reschedule(m_iActiveSourceTimer, (uint32_t)iDelayMs))
+  {
+    m_iActiveSourceTimer = timers->Schedule((uint32_t)iDelayMs, [this]() {
+      {
+        CLockObject lock(m_timerMutex);
+        m_iActiveSourceCheck = 0;
+      }
+      m_bCheckActiveSource = true;
+      m_inBuffer.Broadcast();
+      return (uint32_t)0;
+    });
+  }
+}
+
 bool CCECProcessor::ActivateSource(uint16_t iStreamPath)
 {
   bool bReturn(false);
@@ -349,6 +559,32 @@ bool CCECProcessor::GetStats(struct cec_adapter_stats* stats)
 }
 #endif
 
+bool CCECProcessor::GetStatusSnapshot(cec_status_snapshot &snapshot)
+{
+  if (!m_communication)
+    return false;
+
+  for (uint8_t iPtr = CECDEVICE_TV; iPtr <= CECDEVICE_BROADCAST; iPtr++)
+  {
+    CCECBusDevice *device = m_busDevices->At(iPtr);
+    snapshot.deviceStatus[iPtr]    = device ? device->GetCurrentStatus() : CEC_DEVICE_STATUS_UNKNOWN;
+    snapshot.powerStatus[iPtr]     = device ? device->GetCurrentPowerStatus() : CEC_POWER_STATUS_UNKNOWN;
+    snapshot.physicalAddress[iPtr] = device ? device->GetCurrentPhysicalAddress() : CEC_INVALID_PHYSICAL_ADDRESS;
+  }
+
+  snapshot.inputQueue        = (uint32_t)m_inBuffer.Size();
+  snapshot.transmitQueue     = (uint32_t)m_transmitScheduler.Size();
+  snapshot.adapterWriteQueue = m_communication->GetWriteQueueSize();
+  return true;
+}
+
+bool CCECProcessor::GetAdapterCounters(cec_adapter_counters &counters)
+{
+  return !!m_communication ?
+      m_communication->GetCounters(&counters) :
+      false;
+}
+
 void CCECProcessor::SetActiveSource(bool bSetTo, bool bClientUnregistered)
 {
   if (m_communication)
@@ -387,6 +623,9 @@ bool CCECProcessor::PhysicalAddressInUse(uint16_t iPhysicalAddress)
 
 void CCECProcessor::LogOutput(const cec_command &data)
 {
+  if (!m_libcec->IsLogLevelEnabled(CEC_LOG_TRAFFIC))
+    return;
+
   std::string strTx;
 
   // initiator and destination
@@ -461,26 +700,122 @@ bool CCECProcessor::IsActiveSource(cec_logical_address iAddress)
   return device && device->IsActiveSource();
 }
 
-bool CCECProcessor::Transmit(const cec_command &data, bool bIsReply)
+bool CCECProcessor::Transmit(const cec_command &data, bool bIsReply, cec_transmit_reply *reply /* = NULL */)
+{
+  return TransmitAsync(data, bIsReply, cec_transmit_callback(), NULL, reply).get();
+}
+
+bool CCECProcessor::SupportsReplyMatching(void)
+{
+  return m_communication && m_communication->SupportsReplyMatching();
+}
+
+std::future<bool> CCECProcessor::TransmitAsync(const cec_command &data, bool bIsReply, const cec_transmit_callback &callback /* = cec_transmit_callback() */, cec_adapter_message_state *state /* = NULL */, cec_transmit_reply *reply /* = NULL */)
 {
   cec_command transmitData(data);
   uint8_t iMaxTries(0);
-  bool bRetry(true);
-  uint8_t iTries(0);
 
   // get the current timeout setting
   uint8_t iLineTimeout(GetStandardLineTimeout());
 
-  // reset the state of this message to 'unknown'
-  cec_adapter_message_state adapterState = ADAPTER_MESSAGE_STATE_UNKNOWN;
+  std::promise<bool> failed;
+  failed.set_value(false);
 
   if (data.initiator == CECDEVICE_UNKNOWN && data.destination == CECDEVICE_UNKNOWN)
-    return false;
+  {
+    if (callback)
+      callback(false);
+    return failed.get_future();
+  }
 
-  CLockObject lock(m_mutex);
-  if (!m_communication)
-    return false;
+  {
+    CLockObject lock(m_mutex);
+    if (!m_communication || !CheckTransmit(transmitData))
+    {
+      if (callback)
+        callback(false);
+      return failed.get_future();
+    }
+
+    // wait until we finished allocating a new LA if it got lost if this is not a poll
+    if (data.opcode_set)
+    {
+      lock.unlock();
+      while (m_bStallCommunication) Sleep(5);
+      lock.lock();
+    }
+
+    m_iLastTransmission = GetTimeMs();
+    // set the number of tries
+    CCECBusDevice *initiator = m_busDevices->At(transmitData.initiator);
+    iMaxTries = initiator->GetHandler()->GetTransmitRetries() + 1;
+    initiator->MarkHandlerReady();
+
+    if (initiator->IsUnsupportedFeature(transmitData.opcode))
+    {
+      if (callback)
+        callback(false);
+      return failed.get_future();
+    }
+  }
+
+  // a completion callback that transmits waits for its own result when it's
+  // queued, so send it right away
+  if (m_transmitScheduler.IsWorkerThread())
+  {
+    std::promise<bool> result;
+    const bool bReturn(TransmitNow(transmitData, bIsReply, iMaxTries, iLineTimeout, state, reply));
+    if (callback)
+      callback(bReturn);
+    result.set_value(bReturn);
+    return result.get_future();
+  }
+
+  // the retries happen without holding m_mutex, and without holding up commands to other devices
+  return m_transmitScheduler.Queue(transmitData, bIsReply, iMaxTries, iLineTimeout, callback, state, reply);
+}
+
+bool CCECProcessor::TransmitBatch(const cec_command *commands, size_t iCount, cec_transmit_result *results)
+{
+  // queue everything before waiting for anything, so the workers can keep the line busy.
+  // the scheduler keeps the order of the commands for each destination
+  std::vector<cec_adapter_message_state> states(iCount, ADAPTER_MESSAGE_STATE_UNKNOWN);
+  std::vector<std::future<bool>> transmitted;
+  transmitted.reserve(iCount);
+  for (size_t iPtr = 0; iPtr < iCount; iPtr++)
+    transmitted.push_back(TransmitAsync(commands[iPtr], false, cec_transmit_callback(), &states[iPtr]));
+
+  bool bReturn(true);
+  for (size_t iPtr = 0; iPtr < iCount; iPtr++)
+  {
+    if (!transmitted[iPtr].get())
+      bReturn = false;
 
+    if (results)
+    {
+      switch (states[iPtr])
+      {
+      case ADAPTER_MESSAGE_STATE_UNKNOWN:
+        results[iPtr] = CEC_TRANSMIT_RESULT_NOT_SENT;
+        break;
+      case ADAPTER_MESSAGE_STATE_SENT_ACKED:
+        results[iPtr] = CEC_TRANSMIT_RESULT_ACKED;
+        break;
+      case ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED:
+        results[iPtr] = CEC_TRANSMIT_RESULT_NOT_ACKED;
+        break;
+      default:
+        results[iPtr] = CEC_TRANSMIT_RESULT_FAILED;
+        break;
+      }
+    }
+  }
+
+  return bReturn;
+}
+
+bool CCECProcessor::CheckTransmit(cec_command &transmitData)
+{
   if (!m_communication->SupportsSourceLogicalAddress(transmitData.initiator))
   {
     if (transmitData.initiator == CECDEVICE_UNREGISTERED && m_communication->SupportsSourceLogicalAddress(CECDEVICE_FREEUSE))
@@ -518,31 +853,38 @@ bool CCECProcessor::Transmit(const cec_command &data, bool bIsReply)
     }
   }
 
-  // wait until we finished allocating a new LA if it got lost if this is not a poll
-  if (data.opcode_set)
-  {
-    lock.unlock();
-    while (m_bStallCommunication) Sleep(5);
-    lock.lock();
-  }
+  return true;
+}
+
+bool CCECProcessor::TransmitNow(const cec_command &transmitData, bool bIsReply, uint8_t iMaxTries, uint8_t iLineTimeout, cec_adapter_message_state *state /* = NULL */, cec_transmit_reply *reply /* = NULL */)
+{
+  bool bRetry(true);
+  uint8_t iTries(0), iAttempts(0);
 
-  m_iLastTransmission = GetTimeMs();
-  // set the number of tries
-  iMaxTries = initiator->GetHandler()->GetTransmitRetries() + 1;
-  initiator->MarkHandlerReady();
+  // reset the state of this message to 'unknown'
+  cec_adapter_message_state adapterState = ADAPTER_MESSAGE_STATE_UNKNOWN;
+  const int64_t iStartUs(GetTimeUs());
 
-  // and try to send the command
+  // and try to send the command. m_communication is only deleted after the scheduler stopped
   while (bRetry && ++iTries < iMaxTries)
   {
-    if (initiator->IsUnsupportedFeature(transmitData.opcode))
-      return false;
-
+    if (reply)
+      reply->bReceived = false;
     adapterState = !IsStopped() && m_communication && m_communication->IsOpen() ?
-        m_communication->Write(transmitData, bRetry, iLineTimeout, bIsReply) :
+        (reply ?
+            m_communication->WriteRequest(transmitData, bRetry, iLineTimeout, *reply) :
+            m_communication->Write(transmitData, bRetry, iLineTimeout, bIsReply)) :
         ADAPTER_MESSAGE_STATE_ERROR;
+    m_capture.Write(CEC_CAPTURE_TX, transmitData, adapterState, iLineTimeout, bIsReply);
     iLineTimeout = m_iRetryLineTimeout;
+    ++iAttempts;
   }
 
+  if (iAttempts > 0)
+    m_latencyStats.AddTransmit(transmitData, adapterState == ADAPTER_MESSAGE_STATE_SENT_ACKED, GetTimeUs() - iStartUs, iAttempts - 1);
+  if (state)
+    *state = adapterState;
+
   return bIsReply ?
       adapterState == ADAPTER_MESSAGE_STATE_SENT_ACKED || adapterState == ADAPTER_MESSAGE_STATE_SENT || adapterState == ADAPTER_MESSAGE_STATE_WAITING_TO_BE_SENT :
       adapterState == ADAPTER_MESSAGE_STATE_SENT_ACKED;
@@ -557,13 +899,15 @@ void CCECProcessor::TransmitAbort(cec_logical_address source, cec_logical_addres
   command.parameters.PushBack((uint8_t)opcode);
   command.parameters.PushBack((uint8_t)reason);
 
-  Transmit(command, true);
+  // nobody waits for the result of an abort
+  TransmitAsync(command, true);
 }
 
 void CCECProcessor::ProcessCommand(const cec_command &command)
 {
   // log the command
-  m_libcec->AddLog(CEC_LOG_TRAFFIC, ToString(command).c_str());
+  if (m_libcec->IsLogLevelEnabled(CEC_LOG_TRAFFIC))
+    m_libcec->AddLog(CEC_LOG_TRAFFIC, ToString(command).c_str());
 
   // find the initiator
   CCECBusDevice *device = m_busDevices->At(command.initiator);
@@ -39,6 +39,11 @@
 #include "adapter/AdapterCommunication.h"
 #include "devices/CECDeviceMap.h"
 #include "CECInputBuffer.h"
+#include "CECTransmitScheduler.h"
+#include "CECTrafficCapture.h"
+#include "CECLatencyStats.h"
+#include <atomic>
+#include <future>
 #include <memory>
 
 namespace CEC
@@ -53,7 +58,6 @@ namespace CEC
   class CCECTV;
   class CCECClient;
   class CCECProcessor;
-  class CCECStandbyProtection;
   typedef std::shared_ptr<CCECClient> CECClientPtr;
 
   typedef struct
@@ -76,6 +80,8 @@ namespace CEC
 
   class CCECProcessor : public CThread, public IAdapterCommunicationCallback
   {
+    friend class CCECTransmitScheduler;
+
     public:
       CCECProcessor(CLibCEC *libcec);
       virtual ~CCECProcessor(void);
@@ -94,6 +100,7 @@ namespace CEC
       CECClientPtr GetClient(const cec_logical_address address);
 
       bool                  OnCommandReceived(const cec_command &command);
+      void                  RequeueCommand(const cec_command &command);
       void                  HandleLogicalAddressLost(cec_logical_address oldAddress);
       void                  HandlePhysicalAddressChanged(uint16_t iNewAddress);
 
@@ -126,6 +133,18 @@ namespace CEC
       bool ActivateSource(uint16_t iStreamPath);
       void SetActiveSource(bool bSetTo, bool bClientUnregistered);
       bool GetStats(struct cec_adapter_stats* stats);
+
+      /*!
+       * @brief Fill in the devices and queues in a snapshot, without sending anything.
+       * @return False when not connected.
+       */
+      bool GetStatusSnapshot(cec_status_snapshot &snapshot);
+
+      /*!
+       * @brief Fill in the counters that the adapter keeps.
+       * @return False when not connected, or when the adapter doesn't keep counters.
+       */
+      bool GetAdapterCounters(cec_adapter_counters &counters);
       bool PollDevice(cec_logical_address iAddress);
       void SetStandardLineTimeout(uint8_t iTimeout);
       uint8_t GetStandardLineTimeout(void);
@@ -138,7 +157,32 @@ namespace CEC
 
       bool SetLineTimeout(uint8_t iTimeout);
 
-      bool Transmit(const cec_command &data, bool bIsReply);
+      bool Transmit(const cec_command &data, bool bIsReply, cec_transmit_reply *reply = NULL);
+
+      /*!
+       * @return True when the adapter waits for the replies to requests itself, see IAdapterCommunication::WriteRequest().
+       */
+      bool SupportsReplyMatching(void);
+
+      /*!
+       * @brief Queue a command, without waiting for it to be transmitted.
+       * @param data The command to transmit.
+       * @param bIsReply True when this is a reply. Replies and broadcasts are sent before other commands.
+       * @param callback Called with the result when done. May be empty.
+       * @param state Set to what the adapter reported for the last try, before the result is ready. May be NULL.
+       * @param reply The reply that the adapter waits for, before the result is ready. May be NULL.
+       * @return The result of the transmission.
+       */
+      std::future<bool> TransmitAsync(const cec_command &data, bool bIsReply, const cec_transmit_callback &callback = cec_transmit_callback(), cec_adapter_message_state *state = NULL, cec_transmit_reply *reply = NULL);
+
+      /*!
+       * @brief Queue a sequence of commands at once, and wait until all of them were transmitted.
+       * @param commands The commands to transmit.
+       * @param iCount The number of commands.
+       * @param results Filled in with the result of each command. May be NULL.
+       * @return True when all commands were acked.
+       */
+      bool TransmitBatch(const cec_command *commands, size_t iCount, cec_transmit_result *results);
       void TransmitAbort(cec_logical_address source, cec_logical_address destination, cec_opcode opcode, cec_abort_reason reason = CEC_ABORT_REASON_UNRECOGNIZED_OPCODE);
 
       bool StartBootloader(const char *strPort = NULL);
@@ -150,13 +194,53 @@ namespace CEC
 
       bool TransmitPendingActiveSourceCommands(void);
 
+      /*!
+       * @brief Make the processor thread transmit the pending active source commands.
+       * @param iDelayMs The delay in ms after which to check. When a check is
+       *                 scheduled already, the earliest of the two is kept.
+       */
+      void ScheduleActiveSourceCheck(int64_t iDelayMs);
+
+      /*!
+       * @brief Set the file in which the properties of the devices on the bus are
+       *        remembered across connections. Used by the next call to Start().
+       * @param strPath The path to the file, or an empty string to not use a cache.
+       */
+      void SetDeviceCachePath(const std::string &strPath);
+
+      /*!
+       * @brief Write every frame that's received or transmitted to a capture file.
+       * @param strPath The path to the capture file, or an empty string to stop capturing.
+       * @return True when the capture was started or stopped, false when the file couldn't be created.
+       */
+      bool SetTrafficCapture(const std::string &strPath);
+
       CCECDeviceMap *GetDevices(void) const { return m_busDevices; }
+      CCECLatencyStats &GetLatencyStats(void) { return m_latencyStats; }
       CLibCEC *GetLib(void) const { return m_libcec; }
 
       bool IsHandledByLibCEC(const cec_logical_address address) const;
 
       bool TryLogicalAddress(cec_logical_address address, cec_version libCECSpecVersion = CEC_VERSION_1_4);
 
+      /*!
+       * @brief Poll a set of logical addresses at once. The polls are queued together and
+       *        sent once each, and addresses that acked are marked as present.
+       * @param addresses The addresses to poll.
+       * @return The addresses that weren't acked by any device and can be used.
+       */
+      cec_logical_addresses ProbeLogicalAddresses(const cec_logical_addresses &addresses);
+
+      /*!
+       * @brief Poll all devices with an unknown status, and request the properties that
+       *        aren't known yet from all devices that are present. The polls and requests
+       *        are queued together, and the replies are awaited together.
+       * @param initiator The logical address to send the polls and requests from.
+       * @param scan The devices that are present, and the time the scan took.
+       * @return True when the bus was scanned, false otherwise.
+       */
+      bool ScanBus(const cec_logical_address initiator, cec_bus_scan &scan);
+
       bool IsRunningLatestFirmware(void);
       void SwitchMonitoring(bool bSwitchTo);
 
@@ -174,11 +258,38 @@ namespace CEC
       bool ClearLogicalAddresses(void);
       bool SetLogicalAddresses(const cec_logical_addresses &addresses);
 
+      /*!
+       * @brief Check whether a command can be transmitted. Called with m_mutex held.
+       * @param transmitData The command. The initiator is changed when the adapter doesn't support it.
+       * @return True when it can be transmitted, false otherwise.
+       */
+      bool CheckTransmit(cec_command &transmitData);
+
+      /*!
+       * @brief Write a command to the adapter, and retry when needed. Called from the transmit scheduler.
+       * @param state Set to what the adapter reported for the last try. May be NULL.
+       * @param reply The reply that the adapter waits for. May be NULL.
+       * @return True when transmitted, false otherwise.
+       */
+      bool TransmitNow(const cec_command &transmitData, bool bIsReply, uint8_t iMaxTries, uint8_t iLineTimeout, cec_adapter_message_state *state = NULL, cec_transmit_reply *reply = NULL);
+
       void LogOutput(const cec_command &data);
       void ProcessCommand(const cec_command &command);
 
       void ResetMembers(void);
 
+      /*!
+       * @brief Check whether the TV is present, and alert the primary client when it's not.
+       */
+      void CheckTvPresent(void);
+
+      /*!
+       * @brief Called by the standby protection timer, that resets the connection
+       *        when the clock jumped, or when the system was suspended.
+       * @return The delay until the next check, or 0 when the connection was reset.
+       */
+      uint32_t OnStandbyProtectionTimer(void);
+
       bool                                        m_bInitialised;
       CMutex                                      m_mutex;
       IAdapterCommunication *                     m_communication;
@@ -192,18 +303,17 @@ namespace CEC
       bool                                        m_bMonitor;
       CCECAllocateLogicalAddress*                 m_addrAllocator;
       bool                                        m_bStallCommunication;
-      CCECStandbyProtection*                      m_connCheck;
+      CMutex                                      m_timerMutex;
+      uint64_t                                    m_iActiveSourceTimer;  /**< wakes up the processor thread to transmit pending active source commands */
+      int64_t                                     m_iActiveSourceCheck;  /**< the time at which m_iActiveSourceTimer expires, 0 when it's not set */
+      std::atomic<bool>                           m_bCheckActiveSource;
+      std::atomic<bool>                           m_bCheckTvPresent;
+      std::atomic<bool>                           m_bCheckDeviceCache;
+      std::string                                 m_strDeviceCachePath;
+      int64_t                                     m_iStandbyCheck;       /**< the last time the standby protection timer ran */
       std::vector<device_type_change_t>           m_deviceTypeChanges;
-  };
-
-  class CCECStandbyProtection : public CThread
-  {
-  public:
-    CCECStandbyProtection(CCECProcessor* processor);
-    virtual ~CCECStandbyProtection(void);
-    void* Process(void);
-
-  private:
-    CCECProcessor* m_processor;
+      CCECTransmitScheduler                       m_transmitScheduler;
+      CCECTrafficCapture                          m_capture;
+      CCECLatencyStats                            m_latencyStats;
   };
 };
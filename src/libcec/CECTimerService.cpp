@@ -0,0 +1,405 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+
+#include "env.h"
+#include "CECTimerService.h"
+#include "platform/util/timeutils.h"
+
+using namespace CEC;
+
+#define TIMER_LEVEL_SHIFT(level) (CEC_TIMER_WHEEL_BITS * (level))
+
+CCECTimerService::CCECTimerService(void) :
+    m_bChanged(false),
+    m_bCallbackDone(true),
+    m_iStartMs(GetTimeMs()),
+    m_iTick(0),
+    m_iWaitUntil(-1),
+    m_iNextId(1),
+    m_overflow(NULL),
+    m_iRunning(0),
+    m_bRunningCancelled(false),
+    m_iRunningDelay(-1),
+    m_bThreadStarted(false),
+    m_iWakeups(0)
+{
+  for (size_t iLevel = 0; iLevel < CEC_TIMER_WHEEL_LEVELS; iLevel++)
+  {
+    m_occupied[iLevel] = 0;
+    for (size_t iSlot = 0; iSlot < CEC_TIMER_WHEEL_SLOTS; iSlot++)
+      m_slots[iLevel][iSlot] = NULL;
+  }
+}
+
+CCECTimerService::~CCECTimerService(void)
+{
+  Stop();
+}
+
+void CCECTimerService::Stop(void)
+{
+  {
+    CLockObject lock(m_mutex);
+    StopThread(-1);
+    m_bChanged = true;
+    m_condition.Signal();
+  }
+  StopThread(0);
+}
+
+uint64_t CCECTimerService::Schedule(uint32_t iDelayMs, const cec_timer_callback &callback)
+{
+  CLockObject lock(m_mutex);
+  uint64_t iId(m_iNextId++);
+  timer_entry &entry(m_timers[iId]);
+  entry.iId      = iId;
+  entry.iExpiry  = Now() + iDelayMs;
+  entry.callback = callback;
+  entry.iLevel   = -1;
+  entry.iSlot    = 0;
+  entry.prev     = NULL;
+  entry.next     = NULL;
+  Link(&entry);
+
+  if (!m_bThreadStarted)
+  {
+    m_bThreadStarted = true;
+    CreateThread();
+  }
+  else
+  {
+    Wake(entry.iExpiry);
+  }
+  return iId;
+}
+
+bool CCECTimerService::Reschedule(uint64_t iTimerId, uint32_t iDelayMs)
+{
+  CLockObject lock(m_mutex);
+  std::map<uint64_t, timer_entry>::iterator it = m_timers.find(iTimerId);
+  if (it == m_timers.end())
+    return false;
+
+  if (m_iRunning == iTimerId)
+  {
+    // relinked when the callback returns
+    if (m_bRunningCancelled)
+      return false;
+    m_iRunningDelay = iDelayMs;
+    return true;
+  }
+
+  Unlink(&it->second);
+  it->second.iExpiry = Now() + iDelayMs;
+  Link(&it->second);
+  Wake(it->second.iExpiry);
+  return true;
+}
+
+bool CCECTimerService::Cancel(uint64_t iTimerId)
+{
+  if (iTimerId == 0)
+    return false;
+
+  CLockObject lock(m_mutex);
+  std::map<uint64_t, timer_entry>::iterator it = m_timers.find(iTimerId);
+  if (it == m_timers.end())
+    return false;
+
+  if (m_iRunning == iTimerId)
+  {
+    // removed by the timer thread when the callback returns
+    bool bReturn(!m_bRunningCancelled);
+    m_bRunningCancelled = true;
+    if (!IsTimerThread())
+      m_callbackCondition.Wait(lock, m_bCallbackDone);
+    return bReturn;
+  }
+
+  Unlink(&it->second);
+  m_timers.erase(it);
+  return true;
+}
+
+size_t CCECTimerService::Size(void)
+{
+  CLockObject lock(m_mutex);
+  return m_timers.size();
+}
+
+uint64_t CCECTimerService::GetWakeups(void)
+{
+  CLockObject lock(m_mutex);
+  return m_iWakeups;
+}
+
+void *CCECTimerService::Process(void)
+{
+  CLockObject lock(m_mutex);
+  m_threadId = std::this_thread::get_id();
+
+  while (!IsStopped())
+  {
+    Advance(Now());
+
+    // call the timers that expired
+    while (!m_due.empty() && !IsStopped())
+    {
+      std::map<uint64_t, timer_entry>::iterator it = m_timers.find(m_due.front());
+      m_due.pop_front();
+      if (it == m_timers.end())
+        continue;
+
+      // the entry stays in m_timers while the callback runs. Cancel() only marks
+      // it, and waits for us to remove it
+      timer_entry &entry(it->second);
+      m_iRunning          = entry.iId;
+      m_bRunningCancelled = false;
+      m_iRunningDelay     = -1;
+      m_bCallbackDone     = false;
+
+      lock.unlock();
+      uint32_t iDelayMs = entry.callback();
+      lock.lock();
+
+      // Reschedule() while the callback ran overrides what it returned, even when that's 0
+      if (m_bRunningCancelled || (iDelayMs == 0 && m_iRunningDelay < 0))
+      {
+        m_timers.erase(it);
+      }
+      else
+      {
+        entry.iExpiry = Now() + (m_iRunningDelay >= 0 ? m_iRunningDelay : (int64_t)iDelayMs);
+        Link(&entry);
+      }
+
+      m_iRunning      = 0;
+      m_bCallbackDone = true;
+      m_callbackCondition.Broadcast();
+    }
+
+    if (IsStopped())
+      break;
+
+    // sleep until the next timer expires, or has to move to a lower level
+    int64_t iNext(NextEvent());
+    int64_t iNow(Now());
+    if (iNext >= 0 && iNext <= iNow)
+      continue;
+
+    m_iWaitUntil = iNext;
+    m_bChanged   = false;
+    m_condition.Wait(lock, m_bChanged, iNext < 0 ? 0 : (uint32_t)(iNext - iNow));
+    m_iWaitUntil = -1;
+    ++m_iWakeups;
+  }
+
+  return NULL;
+}
+
+int64_t CCECTimerService::Now(void) const
+{
+  return GetTimeMs() - m_iStartMs;
+}
+
+void CCECTimerService::Link(timer_entry *entry)
+{
+  entry->prev = NULL;
+  entry->next = NULL;
+
+  if (entry->iExpiry <= m_iTick)
+  {
+    entry->iLevel = -1;
+    m_due.push_back(entry->iId);
+    return;
+  }
+
+  // the lowest level on which the expiry is in the same rotation as the current tick
+  timer_entry **list(&m_overflow);
+  entry->iLevel = CEC_TIMER_WHEEL_LEVELS;
+  for (int iLevel = 0; iLevel < CEC_TIMER_WHEEL_LEVELS; iLevel++)
+  {
+    if ((entry->iExpiry >> TIMER_LEVEL_SHIFT(iLevel + 1)) == (m_iTick >> TIMER_LEVEL_SHIFT(iLevel + 1)))
+    {
+      entry->iLevel = iLevel;
+      entry->iSlot  = (int)((entry->iExpiry >> TIMER_LEVEL_SHIFT(iLevel)) & (CEC_TIMER_WHEEL_SLOTS - 1));
+      list = &m_slots[iLevel][entry->iSlot];
+      m_occupied[iLevel] |= (uint64_t)1 << entry->iSlot;
+      break;
+    }
+  }
+
+  entry->next = *list;
+  if (*list)
+    (*list)->prev = entry;
+  *list = entry;
+}
+
+void CCECTimerService::Unlink(timer_entry *entry)
+{
+  if (entry->iLevel < 0)
+  {
+    for (std::deque<uint64_t>::iterator it = m_due.begin(); it != m_due.end(); ++it)
+    {
+      if (*it == entry->iId)
+      {
+        m_due.erase(it);
+        break;
+      }
+    }
+    return;
+  }
+
+  timer_entry **list(entry->iLevel == CEC_TIMER_WHEEL_LEVELS ?
+      &m_overflow :
+      &m_slots[entry->iLevel][entry->iSlot]);
+
+  if (entry->prev)
+    entry->prev->next = entry->next;
+  else
+    *list = entry->next;
+  if (entry->next)
+    entry->next->prev = entry->prev;
+
+  if (!*list && entry->iLevel < CEC_TIMER_WHEEL_LEVELS)
+    m_occupied[entry->iLevel] &= ~((uint64_t)1 << entry->iSlot);
+
+  entry->iLevel = -1;
+  entry->prev   = NULL;
+  entry->next   = NULL;
+}
+
+void CCECTimerService::Relink(timer_entry *&list)
+{
+  timer_entry *entry(list);
+  list = NULL;
+  while (entry)
+  {
+    timer_entry *next(entry->next);
+    Link(entry);
+    entry = next;
+  }
+}
+
+void CCECTimerService::Advance(int64_t iNow)
+{
+  int64_t iNext;
+  while ((iNext = NextEvent()) >= 0 && iNext <= iNow)
+  {
+    m_iTick = iNext;
+
+    // move the timers down from the levels that start a new rotation at this tick,
+    // highest first, so they end up in the right slot on level 0
+    if (m_overflow && (m_iTick & (((int64_t)1 << TIMER_LEVEL_SHIFT(CEC_TIMER_WHEEL_LEVELS)) - 1)) == 0)
+      Relink(m_overflow);
+
+    for (int iLevel = CEC_TIMER_WHEEL_LEVELS - 1; iLevel > 0; iLevel--)
+    {
+      if ((m_iTick & (((int64_t)1 << TIMER_LEVEL_SHIFT(iLevel)) - 1)) != 0)
+        continue;
+
+      int iSlot((int)((m_iTick >> TIMER_LEVEL_SHIFT(iLevel)) & (CEC_TIMER_WHEEL_SLOTS - 1)));
+      m_occupied[iLevel] &= ~((uint64_t)1 << iSlot);
+      Relink(m_slots[iLevel][iSlot]);
+    }
+
+    // and expire the timers on level 0
+    int iSlot((int)(m_iTick & (CEC_TIMER_WHEEL_SLOTS - 1)));
+    m_occupied[0] &= ~((uint64_t)1 << iSlot);
+    timer_entry *entry(m_slots[0][iSlot]);
+    m_slots[0][iSlot] = NULL;
+    while (entry)
+    {
+      timer_entry *next(entry->next);
+      entry->iLevel = -1;
+      entry->prev   = NULL;
+      entry->next   = NULL;
+      m_due.push_back(entry->iId);
+      entry = next;
+    }
+  }
+
+  if (iNow > m_iTick)
+    m_iTick = iNow;
+}
+
+int64_t CCECTimerService::NextEvent(void) const
+{
+  int64_t iReturn(-1);
+
+  // the occupied slots on each level are all ahead of the current tick, so the
+  // first one is either the next expiry (level 0) or the next time that timers
+  // have to move down a level
+  for (int iLevel = 0; iLevel < CEC_TIMER_WHEEL_LEVELS; iLevel++)
+  {
+    if (m_occupied[iLevel] == 0)
+      continue;
+
+    int iCurrent((int)((m_iTick >> TIMER_LEVEL_SHIFT(iLevel)) & (CEC_TIMER_WHEEL_SLOTS - 1)));
+    for (int iSlot = iCurrent + 1; iSlot < CEC_TIMER_WHEEL_SLOTS; iSlot++)
+    {
+      if (m_occupied[iLevel] & ((uint64_t)1 << iSlot))
+      {
+        int64_t iTick(((m_iTick >> TIMER_LEVEL_SHIFT(iLevel + 1)) << TIMER_LEVEL_SHIFT(iLevel + 1)) |
+                      ((int64_t)iSlot << TIMER_LEVEL_SHIFT(iLevel)));
+        if (iReturn < 0 || iTick < iReturn)
+          iReturn = iTick;
+        break;
+      }
+    }
+  }
+
+  if (m_overflow)
+  {
+    int64_t iTick(((m_iTick >> TIMER_LEVEL_SHIFT(CEC_TIMER_WHEEL_LEVELS)) + 1) << TIMER_LEVEL_SHIFT(CEC_TIMER_WHEEL_LEVELS));
+    if (iReturn < 0 || iTick < iReturn)
+      iReturn = iTick;
+  }
+
+  return iReturn;
+}
+
+void CCECTimerService::Wake(int64_t iExpiry)
+{
+  if (m_iWaitUntil < 0 || iExpiry < m_iWaitUntil)
+  {
+    m_bChanged = true;
+    m_condition.Signal();
+  }
+}
+
+bool CCECTimerService::IsTimerThread(void) const
+{
+  return std::this_thread::get_id() == m_threadId;
+}
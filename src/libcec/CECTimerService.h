@@ -0,0 +1,161 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "env.h"
+#include "platform/threads/threads.h"
+#include "platform/threads/mutex.h"
+#include <functional>
+#include <map>
+#include <thread>
+#include <deque>
+
+namespace CEC
+{
+  // the timer wheel has CEC_TIMER_WHEEL_LEVELS levels of CEC_TIMER_WHEEL_SLOTS slots.
+  // a slot on level 0 covers 1ms, a slot on level n covers 64^n ms, so the top
+  // level reaches about 4.6 hours ahead. timers further away than that wait in an
+  // overflow list, that is sorted in each time the top level wraps.
+  #define CEC_TIMER_WHEEL_BITS   6
+  #define CEC_TIMER_WHEEL_SLOTS  (1 << CEC_TIMER_WHEEL_BITS)
+  #define CEC_TIMER_WHEEL_LEVELS 4
+
+  /*!
+   * @brief Called on the timer thread when a timer expires.
+   * @return The delay in ms after which to call it again, or 0 when the timer is done.
+   */
+  typedef std::function<uint32_t(void)> cec_timer_callback;
+
+  /*!
+   * @brief Runs timed callbacks for the whole library, on a single thread.
+   *
+   * Timers are kept in a hierarchical timer wheel, and the thread only wakes up
+   * when a timer expires or when a timer on one of the higher levels has to be
+   * moved to a lower one, so it doesn't wake up at all when no timers are set.
+   *
+   * Callbacks run one at a time and hold up the other timers while they run, so
+   * they must not block for long. Work that waits for the bus, like transmitting
+   * a command, is better handed to a thread that's allowed to wait.
+   */
+  class CCECTimerService : public CThread
+  {
+  public:
+    CCECTimerService(void);
+    virtual ~CCECTimerService(void);
+
+    /*!
+     * @brief Stop the timer thread. Timers can still be added and cancelled, but don't run anymore.
+     */
+    void Stop(void);
+
+    /*!
+     * @brief Add a timer. The timer thread is started when the first timer is added.
+     * @param iDelayMs The delay in ms after which the callback is called.
+     * @param callback The callback.
+     * @return The id of the new timer, never 0.
+     */
+    uint64_t Schedule(uint32_t iDelayMs, const cec_timer_callback &callback);
+
+    /*!
+     * @brief Change the time at which a timer expires. When called while the
+     *        timer's callback runs, this replaces the delay that it returns.
+     * @param iTimerId The id of the timer.
+     * @param iDelayMs The new delay in ms, from now.
+     * @return False when the timer doesn't exist (anymore).
+     */
+    bool Reschedule(uint64_t iTimerId, uint32_t iDelayMs);
+
+    /*!
+     * @brief Remove a timer. When the timer's callback is running on another
+     *        thread, this waits for it to return, so the callback's resources can
+     *        be released after this call. Calling this from a callback is allowed.
+     * @param iTimerId The id of the timer. 0 is ignored.
+     * @return False when the timer doesn't exist (anymore).
+     */
+    bool Cancel(uint64_t iTimerId);
+
+    /*!
+     * @return The number of timers.
+     */
+    size_t Size(void);
+
+    /*!
+     * @return The number of times that the timer thread woke up.
+     */
+    uint64_t GetWakeups(void);
+
+    void *Process(void);
+
+  private:
+    struct timer_entry
+    {
+      uint64_t           iId;
+      int64_t            iExpiry;  /**< the tick at which this timer expires */
+      cec_timer_callback callback;
+      int                iLevel;   /**< the level this timer is linked to, CEC_TIMER_WHEEL_LEVELS for the overflow list, -1 when due or not linked */
+      int                iSlot;
+      timer_entry *      prev;
+      timer_entry *      next;
+    };
+
+    int64_t Now(void) const;
+    void Link(timer_entry *entry);
+    void Unlink(timer_entry *entry);
+    void Relink(timer_entry *&list);
+    void Advance(int64_t iNow);
+    int64_t NextEvent(void) const;
+    void Wake(int64_t iExpiry);
+    bool IsTimerThread(void) const;
+
+    CMutex                             m_mutex;
+    CCondition<bool>                   m_condition;
+    bool                               m_bChanged;                 /**< set to wake up the timer thread */
+    CCondition<bool>                   m_callbackCondition;
+    bool                               m_bCallbackDone;            /**< false while a callback runs */
+    int64_t                            m_iStartMs;                 /**< the time at tick 0 */
+    int64_t                            m_iTick;                    /**< the last tick that was processed */
+    int64_t                            m_iWaitUntil;               /**< the tick that the timer thread waits for, -1 when waiting for a change */
+    uint64_t                           m_iNextId;
+    std::map<uint64_t, timer_entry>    m_timers;
+    timer_entry *                      m_slots[CEC_TIMER_WHEEL_LEVELS][CEC_TIMER_WHEEL_SLOTS];
+    uint64_t                           m_occupied[CEC_TIMER_WHEEL_LEVELS]; /**< a bit for each slot that holds a timer */
+    timer_entry *                      m_overflow;
+    std::deque<uint64_t>               m_due;                      /**< timers that expired, in the order in which they expired */
+    uint64_t                           m_iRunning;                 /**< the timer whose callback runs, or 0 */
+    bool                               m_bRunningCancelled;
+    int64_t                            m_iRunningDelay;            /**< set by Reschedule() while the callback runs, -1 when not */
+    bool                               m_bThreadStarted;
+    std::thread::id                    m_threadId;
+    uint64_t                           m_iWakeups;
+  };
+};
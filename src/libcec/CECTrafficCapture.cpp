@@ -0,0 +1,228 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+
+#include "env.h"
+#include "CECTrafficCapture.h"
+
+#include "platform/util/timeutils.h"
+#include <string.h>
+
+using namespace CEC;
+
+namespace
+{
+  // pcap files are written in the byte order of the machine that wrote them.
+  // these are always written little endian, so captures can be moved around
+  void PutUInt16(uint8_t *buf, uint16_t iValue)
+  {
+    buf[0] = (uint8_t)iValue;
+    buf[1] = (uint8_t)(iValue >> 8);
+  }
+
+  void PutUInt32(uint8_t *buf, uint32_t iValue)
+  {
+    PutUInt16(buf, (uint16_t)iValue);
+    PutUInt16(buf + 2, (uint16_t)(iValue >> 16));
+  }
+
+  uint32_t GetUInt32(const uint8_t *buf)
+  {
+    return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+  }
+}
+
+CCECTrafficCapture::CCECTrafficCapture(void) :
+    m_bOpen(false),
+    m_file(NULL)
+{
+}
+
+CCECTrafficCapture::~CCECTrafficCapture(void)
+{
+  Close();
+}
+
+bool CCECTrafficCapture::Open(const std::string &strPath)
+{
+  Close();
+
+  CLockObject lock(m_mutex);
+  m_file = fopen(strPath.c_str(), "wb");
+  if (!m_file)
+    return false;
+
+  uint8_t header[24];
+  PutUInt32(header, CEC_CAPTURE_PCAP_MAGIC);
+  PutUInt16(header + 4, 2);  // version 2.4
+  PutUInt16(header + 6, 4);
+  PutUInt32(header + 8, 0);  // utc offset
+  PutUInt32(header + 12, 0); // timestamp accuracy
+  PutUInt32(header + 16, CEC_CAPTURE_SNAPLEN);
+  PutUInt32(header + 20, CEC_CAPTURE_LINKTYPE);
+  if (fwrite(header, sizeof(header), 1, m_file) != 1)
+  {
+    fclose(m_file);
+    m_file = NULL;
+    return false;
+  }
+
+  m_bOpen = true;
+  return true;
+}
+
+void CCECTrafficCapture::Close(void)
+{
+  CLockObject lock(m_mutex);
+  m_bOpen = false;
+  if (m_file)
+  {
+    fclose(m_file);
+    m_file = NULL;
+  }
+}
+
+void CCECTrafficCapture::Write(cec_capture_direction direction, const cec_command &command, cec_adapter_message_state state, uint8_t iLineTimeout /* = 0 */, bool bIsReply /* = false */)
+{
+  if (!m_bOpen)
+    return;
+
+  const int64_t iTimeUs(GetTimeUs());
+
+  uint8_t packet[16 + CEC_CAPTURE_SNAPLEN];
+  uint8_t *data = packet + 16;
+  size_t iSize(0);
+  data[iSize++] = (uint8_t)direction;
+  data[iSize++] = (uint8_t)state;
+  data[iSize++] = iLineTimeout;
+  data[iSize++] = (command.opcode_set ? CEC_CAPTURE_FLAG_OPCODE_SET : 0) | (bIsReply ? CEC_CAPTURE_FLAG_REPLY : 0);
+  data[iSize++] = (uint8_t)(((command.initiator & 0xF) << 4) | (command.destination & 0xF));
+  if (command.opcode_set)
+  {
+    data[iSize++] = (uint8_t)command.opcode;
+    for (uint8_t iPtr = 0; iPtr < command.parameters.size && iPtr < CEC_MAX_DATA_PACKET_SIZE; iPtr++)
+      data[iSize++] = command.parameters[iPtr];
+  }
+
+  PutUInt32(packet, (uint32_t)(iTimeUs / 1000000));
+  PutUInt32(packet + 4, (uint32_t)(iTimeUs % 1000000));
+  PutUInt32(packet + 8, (uint32_t)iSize);
+  PutUInt32(packet + 12, (uint32_t)iSize);
+
+  CLockObject lock(m_mutex);
+  if (m_file && fwrite(packet, 16 + iSize, 1, m_file) != 1)
+  {
+    // don't keep trying on a full disk
+    fclose(m_file);
+    m_file = NULL;
+    m_bOpen = false;
+  }
+}
+
+CCECTrafficCaptureReader::CCECTrafficCaptureReader(void) :
+    m_file(NULL)
+{
+}
+
+CCECTrafficCaptureReader::~CCECTrafficCaptureReader(void)
+{
+  Close();
+}
+
+bool CCECTrafficCaptureReader::Open(const std::string &strPath)
+{
+  Close();
+
+  m_file = fopen(strPath.c_str(), "rb");
+  if (!m_file)
+    return false;
+
+  uint8_t header[24];
+  if (fread(header, sizeof(header), 1, m_file) != 1 ||
+      GetUInt32(header) != CEC_CAPTURE_PCAP_MAGIC ||
+      GetUInt32(header + 20) != CEC_CAPTURE_LINKTYPE)
+  {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void CCECTrafficCaptureReader::Close(void)
+{
+  if (m_file)
+  {
+    fclose(m_file);
+    m_file = NULL;
+  }
+}
+
+bool CCECTrafficCaptureReader::Read(cec_capture_record &record)
+{
+  uint8_t header[16];
+  uint8_t data[CEC_CAPTURE_SNAPLEN];
+  while (m_file && fread(header, sizeof(header), 1, m_file) == 1)
+  {
+    const uint32_t iSize(GetUInt32(header + 8));
+    if (iSize > sizeof(data))
+    {
+      // not written by libCEC, skip it
+      if (fseek(m_file, (long)iSize, SEEK_CUR) != 0)
+        break;
+      continue;
+    }
+    if (iSize > 0 && fread(data, iSize, 1, m_file) != 1)
+      break;
+    if (iSize < CEC_CAPTURE_HEADER_SIZE + 1)
+      continue;
+
+    record.iTimeUs      = (int64_t)GetUInt32(header) * 1000000 + GetUInt32(header + 4);
+    record.direction    = data[0] == CEC_CAPTURE_TX ? CEC_CAPTURE_TX : CEC_CAPTURE_RX;
+    record.state        = (cec_adapter_message_state)data[1];
+    record.iLineTimeout = data[2];
+    record.bIsReply     = !!(data[3] & CEC_CAPTURE_FLAG_REPLY);
+
+    record.command.Clear();
+    record.command.initiator   = (cec_logical_address)(data[4] >> 4);
+    record.command.destination = (cec_logical_address)(data[4] & 0xF);
+    if ((data[3] & CEC_CAPTURE_FLAG_OPCODE_SET) && iSize > CEC_CAPTURE_HEADER_SIZE + 1)
+    {
+      record.command.opcode_set = 1;
+      record.command.opcode     = (cec_opcode)data[5];
+      for (uint32_t iPtr = CEC_CAPTURE_HEADER_SIZE + 2; iPtr < iSize; iPtr++)
+        record.command.parameters.PushBack(data[iPtr]);
+    }
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,142 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "env.h"
+#include "adapter/AdapterCommunication.h"
+#include "platform/threads/mutex.h"
+#include <atomic>
+#include <stdio.h>
+#include <string>
+
+namespace CEC
+{
+  /*
+   * Captures are pcap files, so the usual tools can open them. The link type is
+   * LINKTYPE_USER0, and each packet is a 4 byte header followed by the frame as it
+   * was on the line:
+   *   byte 0: direction, see cec_capture_direction
+   *   byte 1: the adapter state after the frame, see cec_adapter_message_state
+   *   byte 2: the line timeout that the frame was written with
+   *   byte 3: flags, see CEC_CAPTURE_FLAG_*
+   *   byte 4: initiator << 4 | destination
+   *   byte 5: the opcode, if set
+   *   byte 6+: the parameters
+   * Timestamps come from the monotonic clock, not from the wall clock, so only the
+   * time between packets means something.
+   */
+  #define CEC_CAPTURE_PCAP_MAGIC      0xa1b2c3d4
+  #define CEC_CAPTURE_LINKTYPE        147 /* LINKTYPE_USER0 */
+  #define CEC_CAPTURE_HEADER_SIZE     4
+  #define CEC_CAPTURE_SNAPLEN         (CEC_CAPTURE_HEADER_SIZE + 2 + CEC_MAX_DATA_PACKET_SIZE)
+
+  #define CEC_CAPTURE_FLAG_OPCODE_SET 0x01
+  #define CEC_CAPTURE_FLAG_REPLY      0x02
+
+  typedef enum cec_capture_direction
+  {
+    CEC_CAPTURE_RX = 0, /**< received by the adapter */
+    CEC_CAPTURE_TX = 1  /**< written to the adapter */
+  } cec_capture_direction;
+
+  typedef struct
+  {
+    int64_t                   iTimeUs;      /**< the time at which the frame was captured, in microseconds */
+    cec_capture_direction     direction;
+    cec_adapter_message_state state;
+    uint8_t                   iLineTimeout;
+    bool                      bIsReply;
+    cec_command               command;
+  } cec_capture_record;
+
+  /*!
+   * @brief Writes the frames that pass through the processor to a capture file.
+   */
+  class CCECTrafficCapture
+  {
+  public:
+    CCECTrafficCapture(void);
+    virtual ~CCECTrafficCapture(void);
+
+    /*!
+     * @brief Start writing to a new capture file. A capture that was open is closed first.
+     * @param strPath The path to the file. It's replaced when it exists.
+     * @return True when the file was created, false otherwise.
+     */
+    bool Open(const std::string &strPath);
+
+    /*!
+     * @brief Write what's buffered and close the file.
+     */
+    void Close(void);
+
+    bool IsOpen(void) const { return m_bOpen; }
+
+    /*!
+     * @brief Add a frame to the capture. Returns right away when no capture is open.
+     */
+    void Write(cec_capture_direction direction, const cec_command &command, cec_adapter_message_state state, uint8_t iLineTimeout = 0, bool bIsReply = false);
+
+  private:
+    CMutex            m_mutex;
+    std::atomic<bool> m_bOpen;
+    FILE *            m_file;
+  };
+
+  /*!
+   * @brief Reads the frames from a capture file.
+   */
+  class CCECTrafficCaptureReader
+  {
+  public:
+    CCECTrafficCaptureReader(void);
+    virtual ~CCECTrafficCaptureReader(void);
+
+    /*!
+     * @brief Open a capture file and check its header.
+     * @return True when it's a capture that can be read, false otherwise.
+     */
+    bool Open(const std::string &strPath);
+    void Close(void);
+
+    /*!
+     * @brief Read the next frame. Packets that can't be parsed are skipped.
+     * @param record The frame.
+     * @return True when a frame was read, false at the end of the file.
+     */
+    bool Read(cec_capture_record &record);
+
+  private:
+    FILE *m_file;
+  };
+};
@@ -0,0 +1,215 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+
+#include "env.h"
+#include "CECTransmitScheduler.h"
+#include "CECProcessor.h"
+#include <algorithm>
+
+using namespace CEC;
+
+CCECTransmitScheduler::CCECTransmitScheduler(CCECProcessor *processor) :
+    m_processor(processor),
+    m_bStopped(true),
+    m_iNextSequence(0),
+    m_iWorkers(0),
+    m_iBusyNormal(0)
+{
+  for (size_t iPtr = 0; iPtr < 16; iPtr++)
+    m_bLaneBusy[iPtr] = false;
+}
+
+CCECTransmitScheduler::~CCECTransmitScheduler(void)
+{
+  Stop();
+}
+
+void CCECTransmitScheduler::Start(uint8_t iWorkers)
+{
+  Stop();
+
+  CLockObject lock(m_mutex);
+  m_bStopped    = false;
+  m_iWorkers    = std::max<uint8_t>(1, std::min<uint8_t>(iWorkers, CEC_TRANSMIT_MAX_WORKERS));
+  m_iBusyNormal = 0;
+  for (uint8_t iPtr = 0; iPtr < m_iWorkers; iPtr++)
+  {
+    m_workers.push_back(std::unique_ptr<CWorker>(new CWorker(this)));
+    m_workers.back()->CreateThread(false);
+  }
+}
+
+void CCECTransmitScheduler::Stop(void)
+{
+  std::vector<job_ptr> failed;
+  std::vector<std::unique_ptr<CWorker>> workers;
+  {
+    CLockObject lock(m_mutex);
+    m_bStopped = true;
+    for (size_t iPtr = 0; iPtr < 16; iPtr++)
+    {
+      for (auto it = m_lanes[iPtr].begin(); it != m_lanes[iPtr].end(); ++it)
+        failed.push_back(std::move(*it));
+      m_lanes[iPtr].clear();
+    }
+    workers.swap(m_workers);
+    m_condition.Broadcast();
+  }
+
+  for (auto it = failed.begin(); it != failed.end(); ++it)
+    Complete(**it, false);
+
+  // wait for the workers to finish what they're transmitting
+  workers.clear();
+
+  CLockObject lock(m_mutex);
+  m_workerThreads.clear();
+}
+
+std::future<bool> CCECTransmitScheduler::Queue(const cec_command &command, bool bIsReply, uint8_t iMaxTries, uint8_t iLineTimeout, const cec_transmit_callback &callback, cec_adapter_message_state *state /* = NULL */, cec_transmit_reply *reply /* = NULL */)
+{
+  job_ptr job(new transmit_job);
+  job->command      = command;
+  job->bIsReply     = bIsReply;
+  job->bUrgent      = bIsReply || command.destination == CECDEVICE_BROADCAST;
+  job->iMaxTries    = iMaxTries;
+  job->iLineTimeout = iLineTimeout;
+  job->callback     = callback;
+  job->state        = state;
+  job->reply        = reply;
+  std::future<bool> result(job->result.get_future());
+
+  {
+    CLockObject lock(m_mutex);
+    if (!m_bStopped)
+    {
+      job->iSequence = m_iNextSequence++;
+      m_lanes[(uint8_t)command.destination & 0xF].push_back(std::move(job));
+      m_condition.Broadcast();
+      return result;
+    }
+  }
+
+  Complete(*job, false);
+  return result;
+}
+
+bool CCECTransmitScheduler::IsWorkerThread(void)
+{
+  CLockObject lock(m_mutex);
+  return std::find(m_workerThreads.begin(), m_workerThreads.end(), std::this_thread::get_id()) != m_workerThreads.end();
+}
+
+size_t CCECTransmitScheduler::Size(void)
+{
+  CLockObject lock(m_mutex);
+  size_t iSize(0);
+  for (uint8_t iPtr = 0; iPtr < 16; iPtr++)
+    iSize += m_lanes[iPtr].size();
+  return iSize;
+}
+
+int CCECTransmitScheduler::NextLane(void) const
+{
+  // keep one worker free for urgent jobs, when there's more than one
+  const bool bNormalAllowed(m_iWorkers <= 1 || m_iBusyNormal < m_iWorkers - 1);
+
+  int iLane(-1);
+  for (int iPtr = 0; iPtr < 16; iPtr++)
+  {
+    if (m_bLaneBusy[iPtr] || m_lanes[iPtr].empty())
+      continue;
+
+    const transmit_job &job(*m_lanes[iPtr].front());
+    if (!job.bUrgent && !bNormalAllowed)
+      continue;
+
+    // urgent jobs first, then the oldest one
+    if (iLane < 0)
+      iLane = iPtr;
+    else
+    {
+      const transmit_job &best(*m_lanes[iLane].front());
+      if ((job.bUrgent && !best.bUrgent) ||
+          (job.bUrgent == best.bUrgent && job.iSequence < best.iSequence))
+        iLane = iPtr;
+    }
+  }
+  return iLane;
+}
+
+void CCECTransmitScheduler::Complete(transmit_job &job, bool bSucceeded)
+{
+  if (job.callback)
+    job.callback(bSucceeded);
+  job.result.set_value(bSucceeded);
+}
+
+void CCECTransmitScheduler::Run(void)
+{
+  {
+    CLockObject lock(m_mutex);
+    m_workerThreads.push_back(std::this_thread::get_id());
+  }
+
+  for (;;)
+  {
+    job_ptr job;
+    int iLane(-1);
+    {
+      CLockObject lock(m_mutex);
+      work_ready ready(this);
+      m_condition.Wait(lock, ready);
+      if (m_bStopped)
+        return;
+
+      iLane = NextLane();
+      job = std::move(m_lanes[iLane].front());
+      m_lanes[iLane].pop_front();
+      m_bLaneBusy[iLane] = true;
+      if (!job->bUrgent)
+        ++m_iBusyNormal;
+    }
+
+    Complete(*job, m_processor->TransmitNow(job->command, job->bIsReply, job->iMaxTries, job->iLineTimeout, job->state, job->reply));
+
+    {
+      CLockObject lock(m_mutex);
+      m_bLaneBusy[iLane] = false;
+      if (!job->bUrgent)
+        --m_iBusyNormal;
+      m_condition.Broadcast();
+    }
+  }
+}
@@ -0,0 +1,163 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "env.h"
+#include "cectypes.h"
+#include "platform/threads/threads.h"
+#include "platform/threads/mutex.h"
+#include "adapter/AdapterCommunication.h"
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace CEC
+{
+  class CCECProcessor;
+
+  // the maximum number of threads that transmit at the same time
+  #define CEC_TRANSMIT_MAX_WORKERS 4
+
+  /*!
+   * @brief Called with the result of a transmission, on the thread that transmitted it.
+   */
+  typedef std::function<void(bool bSucceeded)> cec_transmit_callback;
+
+  /*!
+   * @brief Schedules outgoing commands over a small number of worker threads.
+   *
+   * Commands to the same destination are transmitted in the order in which they
+   * were queued, one at a time. Commands to different destinations don't wait for
+   * each other, so retries to a device that doesn't respond only hold up that
+   * device. Replies and broadcasts are picked before other commands, and when
+   * there's more than one worker, one of them is kept free for them.
+   */
+  class CCECTransmitScheduler
+  {
+  public:
+    CCECTransmitScheduler(CCECProcessor *processor);
+    virtual ~CCECTransmitScheduler(void);
+
+    CCECTransmitScheduler(const CCECTransmitScheduler &) = delete;
+    CCECTransmitScheduler &operator=(const CCECTransmitScheduler &) = delete;
+
+    /*!
+     * @brief Start the worker threads.
+     * @param iWorkers The number of commands that can be handed to the adapter at the same time.
+     */
+    void Start(uint8_t iWorkers);
+
+    /*!
+     * @brief Fail all queued commands and stop the workers, after they finished the command they're transmitting.
+     */
+    void Stop(void);
+
+    /*!
+     * @brief Queue a command.
+     * @param command The command to transmit.
+     * @param bIsReply True when this is a reply.
+     * @param iMaxTries The maximum number of tries.
+     * @param iLineTimeout The line timeout of the first try.
+     * @param callback Called with the result, before the future becomes ready. May be empty.
+     * @param state Set to what the adapter reported, before the future becomes ready. May be NULL.
+     * @param reply The reply that the adapter waits for, see IAdapterCommunication::WriteRequest(). May be NULL.
+     * @return The result of the transmission. False when the scheduler isn't running.
+     */
+    std::future<bool> Queue(const cec_command &command, bool bIsReply, uint8_t iMaxTries, uint8_t iLineTimeout, const cec_transmit_callback &callback, cec_adapter_message_state *state = NULL, cec_transmit_reply *reply = NULL);
+
+    /*!
+     * @return True when called from one of the worker threads.
+     */
+    bool IsWorkerThread(void);
+
+    /*!
+     * @return The number of commands that are queued and not being transmitted yet.
+     */
+    size_t Size(void);
+
+  private:
+    struct transmit_job
+    {
+      cec_command           command;
+      bool                  bIsReply;
+      bool                  bUrgent;   /**< replies and broadcasts */
+      uint8_t               iMaxTries;
+      uint8_t               iLineTimeout;
+      uint64_t              iSequence; /**< the order in which jobs were queued */
+      std::promise<bool>    result;
+      cec_transmit_callback callback;
+      cec_adapter_message_state *state; /**< set to what the adapter reported, when not NULL */
+      cec_transmit_reply    *reply;    /**< the reply that the adapter waits for, when not NULL */
+    };
+    typedef std::unique_ptr<transmit_job> job_ptr;
+
+    class CWorker : public CThread
+    {
+    public:
+      CWorker(CCECTransmitScheduler *scheduler) : m_scheduler(scheduler) {}
+      virtual ~CWorker(void) { StopThread(0); }
+      void *Process(void) { m_scheduler->Run(); return NULL; }
+
+    private:
+      CCECTransmitScheduler *m_scheduler;
+    };
+
+    // the predicate for m_condition, true when a job can be picked or when stopped
+    struct work_ready
+    {
+      work_ready(CCECTransmitScheduler *scheduler) : scheduler(scheduler) {}
+      explicit operator bool() const { return scheduler->m_bStopped || scheduler->NextLane() >= 0; }
+
+      CCECTransmitScheduler *scheduler;
+    };
+
+    void Run(void);
+    int NextLane(void) const;
+    static void Complete(transmit_job &job, bool bSucceeded);
+
+    CCECProcessor *             m_processor;
+    CMutex                      m_mutex;
+    CCondition<work_ready>      m_condition;
+    bool                        m_bStopped;
+    uint64_t                    m_iNextSequence;
+    uint8_t                     m_iWorkers;
+    uint8_t                     m_iBusyNormal;       /**< the number of workers that are transmitting something that isn't urgent */
+    std::deque<job_ptr>         m_lanes[16];         /**< queued jobs, by destination */
+    bool                        m_bLaneBusy[16];     /**< true while a job for this destination is being transmitted */
+    std::vector<std::unique_ptr<CWorker>> m_workers;
+    std::vector<std::thread::id> m_workerThreads;
+  };
+};
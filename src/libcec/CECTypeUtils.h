@@ -778,11 +778,36 @@ namespace CEC
         return "Linux";
       case ADAPTERTYPE_TEGRA:
         return "Tegra";
+      case ADAPTERTYPE_VIRTUAL:
+        return "Virtual";
       default:
         return "unknown";
       }
     }
 
+    /*!
+     * @return The number of levels below the tv of a physical address. 0 for the tv itself.
+     */
+    static uint8_t PhysicalAddressDepth(uint16_t iPhysicalAddress)
+    {
+      uint8_t iDepth(4);
+      while (iDepth > 0 && ((iPhysicalAddress >> 4*(4 - iDepth)) & 0xF) == 0)
+        --iDepth;
+      return iDepth;
+    }
+
+    /*!
+     * @return The physical address of the device that this one is connected to,
+     *         or CEC_INVALID_PHYSICAL_ADDRESS for the tv and invalid addresses.
+     */
+    static uint16_t PhysicalAddressParent(uint16_t iPhysicalAddress)
+    {
+      uint8_t iDepth = PhysicalAddressDepth(iPhysicalAddress);
+      if (iDepth == 0 || iPhysicalAddress == CEC_INVALID_PHYSICAL_ADDRESS)
+        return CEC_INVALID_PHYSICAL_ADDRESS;
+      return iPhysicalAddress & ~(0xF << 4*(4 - iDepth));
+    }
+
     static bool PhysicalAddressIsIncluded(uint16_t iParent, uint16_t iChild)
     {
       for (int iPtr = 3; iPtr >= 0; iPtr--)
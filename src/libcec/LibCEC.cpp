@@ -37,6 +37,7 @@
 #include "adapter/AdapterFactory.h"
 #include "adapter/AdapterCommunication.h"
 #include "CECProcessor.h"
+#include "CECTimerService.h"
 #include "devices/CECAudioSystem.h"
 #include "devices/CECBusDevice.h"
 #include "devices/CECPlaybackDevice.h"
@@ -52,7 +53,9 @@ using namespace CEC;
 
 CLibCEC::CLibCEC(void) :
     m_iStartTime(GetTimeMs()),
-    m_client(nullptr)
+    m_timers(new CCECTimerService),
+    m_client(nullptr),
+    m_iLogLevelMask(0)
 {
   m_cec = new CCECProcessor(this);
 }
@@ -65,11 +68,17 @@ CLibCEC::~CLibCEC(void)
 
   m_clients.clear();
 
+  // stop running timers, the objects that they call are deleted below
+  m_timers->Stop();
+
   // delete the adapter connection
   SafeDelete(m_cec);
 
   // delete active client
   m_client.reset();
+
+  // everything that set timers is gone now
+  SafeDelete(m_timers);
 }
 
 bool CLibCEC::Open(const char *strPort, uint32_t iTimeoutMs /* = CEC_DEFAULT_CONNECT_TIMEOUT */)
@@ -244,6 +253,14 @@ bool CLibCEC::Transmit(const cec_command &data)
   return m_client ? m_client->Transmit(data, false) : false;
 }
 
+bool CLibCEC::TransmitBatch(const cec_command *commands, size_t iCount, cec_transmit_result *results)
+{
+  if (results)
+    for (size_t iPtr = 0; iPtr < iCount; iPtr++)
+      results[iPtr] = CEC_TRANSMIT_RESULT_NOT_SENT;
+  return m_client && (commands || iCount == 0) ? m_client->TransmitBatch(commands, iCount, results) : false;
+}
+
 bool CLibCEC::SetLogicalAddress(cec_logical_address iLogicalAddress)
 {
   return m_client ? m_client->SetLogicalAddress(iLogicalAddress) : false;
@@ -387,6 +404,40 @@ bool CLibCEC::SendPlay(cec_logical_address iDestination, cec_play_mode mode)
   return m_client ? m_client->SendPlay(iDestination, mode) : false;
 }
 
+void CLibCEC::SetLogLevelMask(uint32_t iMask)
+{
+  if (!!m_client)
+    m_client->SetLogLevelMask(iMask);
+}
+
+bool CLibCEC::SetCommandHandlerFilter(const cec_opcode *opcodes, uint8_t iCount, uint32_t iClaimTimeoutMs)
+{
+  return m_client ? m_client->SetCommandHandlerFilter(opcodes, iCount, iClaimTimeoutMs) : false;
+}
+
+bool CLibCEC::ClaimCommand(const cec_command &command)
+{
+  return m_client ? m_client->ClaimCommand(command) : false;
+}
+
+bool CLibCEC::ScanBus(cec_bus_scan *scan)
+{
+  return m_client && scan ? m_client->ScanBus(*scan) : false;
+}
+
+void CLibCEC::SetDeviceCachePath(const char *strPath)
+{
+  if (m_cec)
+    m_cec->SetDeviceCachePath(strPath ? strPath : "");
+}
+
+bool CLibCEC::SetTrafficCapture(const char *strPath)
+{
+  return m_cec ?
+      m_cec->SetTrafficCapture(strPath ? strPath : "") :
+      false;
+}
+
 std::string CLibCEC::GetDeviceOSDName(cec_logical_address iAddress)
 {
   return !!m_client ?
@@ -443,14 +494,15 @@ bool CLibCEC::IsValidPhysicalAddress(uint16_t iPhysicalAddress)
          iPhysicalAddress <= CEC_MAX_PHYSICAL_ADDRESS;
 }
 
-uint16_t CLibCEC::CheckKeypressTimeout(void)
+uint16_t CLibCEC::CheckCommandClaimTimeout(void)
 {
-  uint16_t timeout = CEC_PROCESSOR_SIGNAL_WAIT_TIME;
+  // 0 when no client has commands that are waiting to be claimed
+  uint16_t timeout = 0;
   // check all clients
   for (std::vector<CECClientPtr>::iterator it = m_clients.begin(); it != m_clients.end(); it++)
   {
-    uint16_t t = (*it)->CheckKeypressTimeout();
-    if (t < timeout)
+    uint16_t t = (*it)->CheckCommandClaimTimeout();
+    if (t != 0 && (timeout == 0 || t < timeout))
       timeout = t;
   }
   return timeout;
@@ -458,6 +510,10 @@ uint16_t CLibCEC::CheckKeypressTimeout(void)
 
 void CLibCEC::AddLog(const cec_log_level level, const char *strFormat, ...)
 {
+  // don't format messages that no client will consume
+  if (!IsLogLevelEnabled(level))
+    return;
+
   // format the message
   va_list argList;
   cec_log_message_cpp message;
@@ -472,6 +528,14 @@ void CLibCEC::AddLog(const cec_log_level level, const char *strFormat, ...)
     (*it)->AddLog(message);
 }
 
+void CLibCEC::UpdateLogLevelMask(void)
+{
+  uint32_t iMask(0);
+  for (std::vector<CECClientPtr>::iterator it = m_clients.begin(); it != m_clients.end(); it++)
+    iMask |= (*it)->LogLevelMask();
+  m_iLogLevelMask = iMask;
+}
+
 void CLibCEC::AddCommand(const cec_command &command)
 {
   // send the command to all clients
@@ -510,6 +574,7 @@ CECClientPtr CLibCEC::RegisterClient(libcec_configuration &configuration)
   if (!newClient)
     return newClient;
   m_clients.push_back(newClient);
+  UpdateLogLevelMask();
 
   // if the default client isn't set, set it
   if (!m_client)
@@ -724,3 +789,40 @@ bool CLibCEC::GetStats(struct cec_adapter_stats* stats)
       false;
 }
 #endif
+
+bool CLibCEC::GetLatencyStats(cec_latency_stats *stats)
+{
+  return m_cec && stats ?
+      m_cec->GetLatencyStats().Get(*stats) :
+      false;
+}
+
+void CLibCEC::ResetLatencyStats(void)
+{
+  if (m_cec)
+    m_cec->GetLatencyStats().Reset();
+}
+
+bool CLibCEC::GetStatusSnapshot(cec_status_snapshot *snapshot)
+{
+  if (!snapshot ||
+      snapshot->version != CEC_STATUS_SNAPSHOT_VERSION ||
+      snapshot->size != sizeof(cec_status_snapshot))
+    return false;
+
+  return !!m_client ?
+      m_client->GetStatusSnapshot(*snapshot) :
+      false;
+}
+
+bool CLibCEC::GetAdapterCounters(cec_adapter_counters *counters)
+{
+  if (!counters ||
+      counters->version != CEC_ADAPTER_COUNTERS_VERSION ||
+      counters->size != sizeof(cec_adapter_counters))
+    return false;
+
+  return !!m_client ?
+      m_client->GetAdapterCounters(*counters) :
+      false;
+}
@@ -38,6 +38,7 @@
 #include "platform/util/buffer.h"
 #include "platform/threads/mutex.h"
 #include "CECTypeUtils.h"
+#include <atomic>
 #include <memory>
 
 #define CEC_PROCESSOR_SIGNAL_WAIT_TIME 1000
@@ -47,6 +48,7 @@ namespace CEC
   class CAdapterCommunication;
   class CCECProcessor;
   class CCECClient;
+  class CCECTimerService;
   typedef std::shared_ptr<CCECClient> CECClientPtr;
 
   typedef struct cec_log_message_cpp
@@ -105,6 +107,13 @@ namespace CEC
       bool SendKeypress(cec_logical_address iDestination, cec_user_control_code key, bool bWait = true);
       bool SendKeyRelease(cec_logical_address iDestination, bool bWait = true);
       bool SendPlay(cec_logical_address iDestination, cec_play_mode mode);
+      void SetLogLevelMask(uint32_t iMask);
+      bool SetCommandHandlerFilter(const cec_opcode *opcodes, uint8_t iCount, uint32_t iClaimTimeoutMs);
+      bool ClaimCommand(const cec_command &command);
+      bool ScanBus(cec_bus_scan *scan);
+      void SetDeviceCachePath(const char *strPath);
+      bool SetTrafficCapture(const char *strPath);
+      bool TransmitBatch(const cec_command *commands, size_t iCount, cec_transmit_result *results);
       std::string GetDeviceOSDName(cec_logical_address iAddress);
       cec_logical_address GetActiveSource(void);
       bool IsActiveSource(cec_logical_address iAddress);
@@ -145,9 +154,21 @@ namespace CEC
       bool GetDeviceInformation(const char *strPort, libcec_configuration *config, uint32_t iTimeoutMs = CEC_DEFAULT_CONNECT_TIMEOUT);
 
       void AddLog(const cec_log_level level, const char *strFormat, ...);
+
+      /*!
+       * @return True when at least one client consumes log messages of this level.
+       *         Check this before building an expensive log string.
+       */
+      bool IsLogLevelEnabled(const cec_log_level level) const { return (m_iLogLevelMask & (uint32_t)level) != 0; }
+
+      /*!
+       * @brief Recalculate the combined log level mask of all clients. Called when
+       *        a client is registered or changes its callbacks or log level mask.
+       */
+      void UpdateLogLevelMask(void);
       void AddCommand(const cec_command &command);
       bool CommandHandlerCB(const cec_command &command);
-      uint16_t CheckKeypressTimeout(void);
+      uint16_t CheckCommandClaimTimeout(void);
       void Alert(const libcec_alert type, const libcec_parameter &param);
 
       static bool IsValidPhysicalAddress(uint16_t iPhysicalAddress);
@@ -168,6 +189,15 @@ namespace CEC
       bool AudioEnable(bool enable);
       uint8_t SystemAudioModeStatus(void);
       bool GetStats(struct cec_adapter_stats* stats);
+      bool GetLatencyStats(cec_latency_stats *stats);
+      void ResetLatencyStats(void);
+      bool GetStatusSnapshot(cec_status_snapshot *snapshot);
+      bool GetAdapterCounters(cec_adapter_counters *counters);
+
+      /*!
+       * @return The timers that are shared by everything in this instance.
+       */
+      CCECTimerService *GetTimers(void) const { return m_timers; }
 
       CCECProcessor *           m_cec;
 
@@ -190,8 +220,11 @@ namespace CEC
       bool OpenFirstAdapter(uint32_t iTimeoutMs);
 
       int64_t                   m_iStartTime;
+      CCECTimerService *        m_timers;
       CECClientPtr              m_client;
       std::vector<CECClientPtr> m_clients;
+      // log levels that at least one client consumes
+      std::atomic<uint32_t>     m_iLogLevelMask;
       // serialises Open() against Close()
       CMutex                    m_mutex;
   };
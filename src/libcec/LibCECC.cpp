@@ -378,6 +378,56 @@ int libcec_send_play(libcec_connection_t connection, cec_logical_address iDestin
       -1;
 }
 
+int libcec_set_log_level_mask(libcec_connection_t connection, uint32_t iMask)
+{
+  ICECAdapter* adapter = static_cast<ICECAdapter*>(connection);
+  if (!adapter)
+    return -1;
+  adapter->SetLogLevelMask(iMask);
+  return 1;
+}
+
+int libcec_set_command_handler_filter(libcec_connection_t connection, const cec_opcode* opcodes, uint8_t iCount, uint32_t iClaimTimeoutMs)
+{
+  ICECAdapter* adapter = static_cast<ICECAdapter*>(connection);
+  return adapter ?
+      (adapter->SetCommandHandlerFilter(opcodes, iCount, iClaimTimeoutMs) ? 1 : 0) :
+      -1;
+}
+
+int libcec_claim_command(libcec_connection_t connection, const cec_command* command)
+{
+  ICECAdapter* adapter = static_cast<ICECAdapter*>(connection);
+  return (adapter && command) ?
+      (adapter->ClaimCommand(*command) ? 1 : 0) :
+      -1;
+}
+
+int libcec_scan_bus(libcec_connection_t connection, cec_bus_scan* scan)
+{
+  ICECAdapter* adapter = static_cast<ICECAdapter*>(connection);
+  return (adapter && scan) ?
+      (adapter->ScanBus(scan) ? 1 : 0) :
+      -1;
+}
+
+int libcec_set_device_cache_path(libcec_connection_t connection, const char* strPath)
+{
+  ICECAdapter* adapter = static_cast<ICECAdapter*>(connection);
+  if (!adapter)
+    return -1;
+  adapter->SetDeviceCachePath(strPath);
+  return 1;
+}
+
+int libcec_set_traffic_capture(libcec_connection_t connection, const char* strPath)
+{
+  ICECAdapter* adapter = static_cast<ICECAdapter*>(connection);
+  return adapter ?
+      (adapter->SetTrafficCapture(strPath) ? 1 : 0) :
+      -1;
+}
+
 int libcec_get_device_osd_name(libcec_connection_t connection, cec_logical_address iAddress, cec_osd_name name)
 {
   ICECAdapter* adapter = static_cast<ICECAdapter*>(connection);
@@ -587,6 +637,47 @@ int libcec_get_stats(libcec_connection_t connection, struct cec_adapter_stats* s
 }
 #endif
 
+int libcec_get_latency_stats(libcec_connection_t connection, cec_latency_stats* stats)
+{
+  ICECAdapter* adapter = static_cast<ICECAdapter*>(connection);
+  return (adapter && stats) ?
+      (adapter->GetLatencyStats(stats) ? 1 : 0) :
+      -1;
+}
+
+int libcec_reset_latency_stats(libcec_connection_t connection)
+{
+  ICECAdapter* adapter = static_cast<ICECAdapter*>(connection);
+  if (!adapter)
+    return -1;
+  adapter->ResetLatencyStats();
+  return 1;
+}
+
+int libcec_get_status_snapshot(libcec_connection_t connection, cec_status_snapshot* snapshot)
+{
+  ICECAdapter* adapter = static_cast<ICECAdapter*>(connection);
+  return (adapter && snapshot) ?
+      (adapter->GetStatusSnapshot(snapshot) ? 1 : 0) :
+      -1;
+}
+
+int libcec_get_adapter_counters(libcec_connection_t connection, cec_adapter_counters* counters)
+{
+  ICECAdapter* adapter = static_cast<ICECAdapter*>(connection);
+  return (adapter && counters) ?
+      (adapter->GetAdapterCounters(counters) ? 1 : 0) :
+      -1;
+}
+
+int libcec_transmit_batch(libcec_connection_t connection, const CEC::cec_command* commands, size_t iCount, CEC::cec_transmit_result* results)
+{
+  ICECAdapter* adapter = static_cast<ICECAdapter*>(connection);
+  return (adapter && (commands || iCount == 0)) ?
+      (adapter->TransmitBatch(commands, iCount, results) ? 1 : 0) :
+      -1;
+}
+
 void libcec_menu_state_to_string(const CEC_NAMESPACE cec_menu_state state, char* buf, size_t bufsize)
 {
   std::string strBuf(CCECTypeUtils::ToString(state));
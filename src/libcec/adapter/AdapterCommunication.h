@@ -50,6 +50,16 @@ namespace CEC
     ADAPTER_MESSAGE_STATE_ERROR               /**< an error occurred */
   } cec_adapter_message_state;
 
+  /*!
+   * @brief The reply that a request waits for, for adapters that match replies themselves.
+   */
+  typedef struct cec_transmit_reply
+  {
+    cec_opcode opcode;    /**< the opcode of the reply */
+    uint32_t   iWaitMs;   /**< how long to wait for the reply after the request was acked, in milliseconds */
+    bool       bReceived; /**< set to true when the reply was received */
+  } cec_transmit_reply;
+
   class IAdapterCommunicationCallback
   {
   public:
@@ -131,6 +141,47 @@ namespace CEC
      */
     virtual cec_adapter_message_state Write(const cec_command &data, bool &bRetry, uint8_t iLineTimeout, bool bIsReply) = 0;
 
+    /*!
+     * @return The number of threads that may call Write() at the same time. 1 for adapters that
+     *         can only handle one transmission at a time.
+     */
+    virtual uint8_t GetMaxPendingTransmits(void) const { return 1; }
+
+    /*!
+     * @return True when WriteRequest() waits for the reply to a request itself.
+     */
+    virtual bool SupportsReplyMatching(void) const { return false; }
+
+    /*!
+     * @brief Write a request, and wait for its reply in the same call. The reply is
+     *        passed to OnCommandReceived() before this returns, like any other command.
+     *        Only called for requests that aren't broadcast.
+     * @param data The request to write
+     * @param bRetry The command can be retried
+     * @param iLineTimeout The line timeout to be used
+     * @param reply The reply to wait for. bReceived is set to true when it arrived, and is
+     *        left false when it didn't arrive in time or the request was aborted.
+     * @return The last state of the transmitted request
+     */
+    virtual cec_adapter_message_state WriteRequest(const cec_command &data, bool &bRetry, uint8_t iLineTimeout, cec_transmit_reply &reply)
+    {
+      reply.bReceived = false;
+      return Write(data, bRetry, iLineTimeout, false);
+    }
+
+    /*!
+     * @return The number of frames that are waiting to be written to the adapter, for
+     *         adapters that queue them.
+     */
+    virtual uint32_t GetWriteQueueSize(void) { return 0; }
+
+    /*!
+     * @brief Copy the counters that this adapter keeps. cb_overflow is filled in by the client.
+     * @param counters The counters, with version and size already checked.
+     * @return False when this adapter doesn't keep any, in which case they're left at 0.
+     */
+    virtual bool GetCounters(cec_adapter_counters* UNUSED(counters)) { return false; }
+
     /*!
      * @brief Change the current line timeout on the CEC bus
      * @param iTimeout The new timeout
@@ -84,6 +84,15 @@
 #include "Tegra/TegraCECDev.h"
 #endif
 
+#if defined(HAVE_VIRTUAL_API)
+#include "Virtual/VirtualCECAdapterCommunication.h"
+#include "Virtual/ReplayCECAdapterCommunication.h"
+#endif
+
+#if defined(HAVE_DAEMON_API)
+#include "Daemon/DaemonCECAdapterCommunication.h"
+#endif
+
 using namespace CEC;
 
 namespace
@@ -97,6 +106,8 @@ namespace
       case ADAPTERTYPE_P8_EXTERNAL:
       case ADAPTERTYPE_P8_DAUGHTERBOARD:
         return "USB-CEC Adapter";
+      case ADAPTERTYPE_VIRTUAL:
+        return "Virtual";
       default:
         return "HDMI";
     }
@@ -283,7 +294,50 @@ int8_t CAdapterFactory::DetectAdapters(cec_adapter_descriptor *deviceList, uint8
 //   iAdaptersFound++;
 // #endif
 
-#if !defined(HAVE_RPI_API) && !defined(HAVE_P8_USB) && !defined(HAVE_TDA995X_API) && !defined(HAVE_EXYNOS_API) && !defined(HAVE_LINUX_API) && !defined(HAVE_AOCEC_API) && !defined(HAVE_IMX_API) && !defined(HAVE_TEGRA_API)
+#if defined(HAVE_VIRTUAL_API)
+  // there's always a virtual adapter, so it's only listed when asked for by name
+  if (iAdaptersFound < iBufSize && strDevicePath &&
+      !strncmp(strDevicePath, CEC_VIRTUAL_COM_PREFIX, strlen(CEC_VIRTUAL_COM_PREFIX)))
+  {
+    memset(&deviceList[iAdaptersFound], 0, sizeof(cec_adapter_descriptor));
+    snprintf(deviceList[iAdaptersFound].strComPath, sizeof(deviceList[iAdaptersFound].strComPath), "%s", strDevicePath);
+    snprintf(deviceList[iAdaptersFound].strComName, sizeof(deviceList[iAdaptersFound].strComName), "%s", strDevicePath);
+    deviceList[iAdaptersFound].iVendorId = VIRTUAL_ADAPTER_VID;
+    deviceList[iAdaptersFound].iProductId = VIRTUAL_ADAPTER_PID;
+    deviceList[iAdaptersFound].adapterType = ADAPTERTYPE_VIRTUAL;
+    iAdaptersFound++;
+  }
+
+  // same for replaying a traffic capture
+  if (iAdaptersFound < iBufSize && strDevicePath &&
+      !strncmp(strDevicePath, CEC_REPLAY_COM_PREFIX, strlen(CEC_REPLAY_COM_PREFIX)))
+  {
+    memset(&deviceList[iAdaptersFound], 0, sizeof(cec_adapter_descriptor));
+    snprintf(deviceList[iAdaptersFound].strComPath, sizeof(deviceList[iAdaptersFound].strComPath), "%s", strDevicePath);
+    snprintf(deviceList[iAdaptersFound].strComName, sizeof(deviceList[iAdaptersFound].strComName), "%s", strDevicePath);
+    deviceList[iAdaptersFound].iVendorId = REPLAY_ADAPTER_VID;
+    deviceList[iAdaptersFound].iProductId = REPLAY_ADAPTER_PID;
+    deviceList[iAdaptersFound].adapterType = ADAPTERTYPE_VIRTUAL;
+    iAdaptersFound++;
+  }
+#endif
+
+#if defined(HAVE_DAEMON_API)
+  // the adapter that's shared by cec-daemon isn't detected either
+  if (iAdaptersFound < iBufSize && strDevicePath &&
+      !strncmp(strDevicePath, CEC_DAEMON_COM_PREFIX, strlen(CEC_DAEMON_COM_PREFIX)))
+  {
+    memset(&deviceList[iAdaptersFound], 0, sizeof(cec_adapter_descriptor));
+    snprintf(deviceList[iAdaptersFound].strComPath, sizeof(deviceList[iAdaptersFound].strComPath), "%s", strDevicePath);
+    snprintf(deviceList[iAdaptersFound].strComName, sizeof(deviceList[iAdaptersFound].strComName), "%s", strDevicePath);
+    deviceList[iAdaptersFound].iVendorId = DAEMON_ADAPTER_VID;
+    deviceList[iAdaptersFound].iProductId = DAEMON_ADAPTER_PID;
+    deviceList[iAdaptersFound].adapterType = ADAPTERTYPE_VIRTUAL;
+    iAdaptersFound++;
+  }
+#endif
+
+#if !defined(HAVE_RPI_API) && !defined(HAVE_P8_USB) && !defined(HAVE_TDA995X_API) && !defined(HAVE_EXYNOS_API) && !defined(HAVE_LINUX_API) && !defined(HAVE_AOCEC_API) && !defined(HAVE_IMX_API) && !defined(HAVE_TEGRA_API) && !defined(HAVE_VIRTUAL_API)
 #error "libCEC doesn't have support for any type of adapter. please check your build system or configuration"
 #endif
 
@@ -293,50 +347,65 @@ int8_t CAdapterFactory::DetectAdapters(cec_adapter_descriptor *deviceList, uint8
   return iAdaptersFound;
 }
 
-IAdapterCommunication *CAdapterFactory::GetInstance(const char *strPort, uint16_t iBaudRate)
+IAdapterCommunication *CAdapterFactory::GetInstance(const char *strPort, uint16_t iBaudRate, IAdapterCommunicationCallback *callback /* = NULL */)
 {
+  if (!callback)
+    callback = m_lib->m_cec;
+
+#if defined(HAVE_VIRTUAL_API)
+  if (!strncmp(strPort, CEC_VIRTUAL_COM_PREFIX, strlen(CEC_VIRTUAL_COM_PREFIX)))
+    return new CVirtualCECAdapterCommunication(callback, strPort);
+  if (!strncmp(strPort, CEC_REPLAY_COM_PREFIX, strlen(CEC_REPLAY_COM_PREFIX)))
+    return new CReplayCECAdapterCommunication(callback, strPort);
+#endif
+
+#if defined(HAVE_DAEMON_API)
+  if (!strncmp(strPort, CEC_DAEMON_COM_PREFIX, strlen(CEC_DAEMON_COM_PREFIX)))
+    return new CDaemonCECAdapterCommunication(callback, strPort);
+#endif
+
 #if defined(HAVE_TDA995X_API)
   if (!strcmp(strPort, CEC_TDA995x_VIRTUAL_COM))
-    return new CTDA995xCECAdapterCommunication(m_lib->m_cec);
+    return new CTDA995xCECAdapterCommunication(callback);
 #endif
 
 #if defined(HAVE_TEGRA_API)
   if (!strcmp(strPort, TEGRA_CEC_DEV_PATH))
-    return new TegraCECAdapterCommunication(m_lib->m_cec);
+    return new TegraCECAdapterCommunication(callback);
 #endif
 
 #if defined(HAVE_EXYNOS_API)
   if (!strcmp(strPort, CEC_EXYNOS_VIRTUAL_COM))
-    return new CExynosCECAdapterCommunication(m_lib->m_cec);
+    return new CExynosCECAdapterCommunication(callback);
 #endif
 
 #if defined(HAVE_LINUX_API)
   if (!strcmp(strPort, CEC_LINUX_VIRTUAL_COM))
-    return new CLinuxCECAdapterCommunication(m_lib->m_cec);
+    return new CLinuxCECAdapterCommunication(callback);
   if (!strncmp(strPort, CEC_LINUX_PATH_PREFIX, strlen(CEC_LINUX_PATH_PREFIX)))
-    return new CLinuxCECAdapterCommunication(m_lib->m_cec, strPort);
+    return new CLinuxCECAdapterCommunication(callback, strPort);
 #endif
 
 #if defined(HAVE_AOCEC_API)
   if (!strcmp(strPort, CEC_AOCEC_VIRTUAL_COM))
-    return new CAOCECAdapterCommunication(m_lib->m_cec);
+    return new CAOCECAdapterCommunication(callback);
 #endif
 
 #if defined(HAVE_RPI_API)
   if (!strcmp(strPort, CEC_RPI_VIRTUAL_COM))
-    return new CRPiCECAdapterCommunication(m_lib->m_cec);
+    return new CRPiCECAdapterCommunication(callback);
 #endif
 
 #if defined(HAVE_IMX_API)
   if (!strcmp(strPort, CEC_IMX_VIRTUAL_COM))
-    return new CIMXCECAdapterCommunication(m_lib->m_cec);
+    return new CIMXCECAdapterCommunication(callback);
 #endif
 
 #if defined(HAVE_P8_USB)
-  return new CUSBCECAdapterCommunication(m_lib->m_cec, strPort, iBaudRate);
+  return new CUSBCECAdapterCommunication(callback, strPort, iBaudRate);
 #endif
 
-#if !defined(HAVE_RPI_API) && !defined(HAVE_P8_USB) && !defined(HAVE_TDA995X_API) && !defined(HAVE_EXYNOS_API) && !defined(HAVE_LINUX_API) && !defined(HAVE_AOCEC_API) && !defined(HAVE_IMX_API)
+#if !defined(HAVE_P8_USB)
   return NULL;
 #endif
 }
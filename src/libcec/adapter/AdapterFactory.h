@@ -40,6 +40,7 @@ namespace CEC
 {
   class CLibCEC;
   class IAdapterCommunication;
+  class IAdapterCommunicationCallback;
 
   class CAdapterFactory
   {
@@ -50,7 +51,7 @@ namespace CEC
 
     int8_t FindAdapters(cec_adapter *deviceList, uint8_t iBufSize, const char *strDevicePath = NULL);
     int8_t DetectAdapters(cec_adapter_descriptor *deviceList, uint8_t iBufSize, const char *strDevicePath = NULL);
-    IAdapterCommunication *GetInstance(const char *strPort, uint16_t iBaudRate = CEC_SERIAL_DEFAULT_BAUDRATE);
+    IAdapterCommunication *GetInstance(const char *strPort, uint16_t iBaudRate = CEC_SERIAL_DEFAULT_BAUDRATE, IAdapterCommunicationCallback *callback = NULL);
 
     static void InitVideoStandalone(void);
 
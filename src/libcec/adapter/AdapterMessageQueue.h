@@ -0,0 +1,270 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "env.h"
+#include "AdapterCommunication.h"
+#include "platform/threads/mutex.h"
+#include <stddef.h>
+#include <string.h>
+
+namespace CEC
+{
+  // the number of transmits that can wait for their result at the same time
+  #define CEC_ADAPTER_MAX_PENDING_TRANSMITS 8
+
+  /*!
+   * @brief The counters that GetStats() and GetCounters() report, kept like the
+   *        Pulse-Eight backend keeps them, for the adapters that are built into a SoC.
+   */
+  class CAdapterStats
+  {
+  public:
+    CAdapterStats(void)
+    {
+      memset(&m_stats, 0, sizeof(struct cec_adapter_stats));
+      memset(&m_counters, 0, sizeof(cec_adapter_counters));
+      m_counters.version = CEC_ADAPTER_COUNTERS_VERSION;
+      m_counters.size    = sizeof(cec_adapter_counters);
+    }
+
+    /*!
+     * @brief Count a received frame.
+     * @param iLatencyUs The time between the start of the frame and its delivery, or 0 when that isn't known.
+     */
+    void OnRxSuccess(int64_t iLatencyUs)
+    {
+      CLockObject lock(m_mutex);
+      ++m_stats.rx_total;
+      if (iLatencyUs > 0)
+      {
+        ++m_counters.rx_latency_count;
+        m_counters.rx_latency_total_us += (uint64_t)iLatencyUs;
+        if ((uint64_t)iLatencyUs > m_counters.rx_latency_max_us)
+          m_counters.rx_latency_max_us = (uint32_t)iLatencyUs;
+      }
+    }
+
+    void OnRxError(void)
+    {
+      CLockObject lock(m_mutex);
+      ++m_stats.rx_error;
+    }
+
+    /*!
+     * @brief Count the outcome of a transmit. Transmits that will be retried aren't counted.
+     */
+    void OnTxResult(cec_adapter_message_state state)
+    {
+      CLockObject lock(m_mutex);
+      switch (state)
+      {
+      case ADAPTER_MESSAGE_STATE_SENT_ACKED:
+        ++m_stats.tx_ack;
+        break;
+      case ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED:
+        ++m_stats.tx_nack;
+        break;
+      case ADAPTER_MESSAGE_STATE_WAITING_TO_BE_SENT:
+        break;
+      default:
+        ++m_stats.tx_error;
+        break;
+      }
+    }
+
+    bool Get(struct cec_adapter_stats *stats) const
+    {
+      CLockObject lock(m_mutex);
+      memcpy(stats, &m_stats, sizeof(struct cec_adapter_stats));
+      return true;
+    }
+
+    bool GetCounters(cec_adapter_counters *counters) const
+    {
+      CLockObject lock(m_mutex);
+      memcpy(counters, &m_counters, sizeof(cec_adapter_counters));
+      return true;
+    }
+
+  private:
+    mutable CMutex           m_mutex;
+    struct cec_adapter_stats m_stats;
+    cec_adapter_counters     m_counters;
+  };
+
+  /*!
+   * @brief Transmits that wait for the driver to report their result, for the
+   *        backends where that result arrives on another thread than the one
+   *        that sent the frame.
+   *
+   * The transmits are kept in a fixed number of slots, so nothing is allocated
+   * per frame. A result is handed to the oldest pending transmit that _Matcher
+   * accepts it for: a functor with
+   *   bool operator()(const cec_command &command, const _Result &result) const
+   */
+  template<typename _Result, typename _Matcher, size_t _Size = CEC_ADAPTER_MAX_PENDING_TRANSMITS>
+  class CAdapterMessageQueue
+  {
+  public:
+    CAdapterMessageQueue(void) :
+      m_iNextSequence(0) {}
+
+    virtual ~CAdapterMessageQueue(void)
+    {
+      Clear();
+    }
+
+    /*!
+     * @brief Reserve a slot for a transmit. Call this before passing the frame
+     *        to the driver, so a result that comes in right away isn't missed.
+     * @param command The frame that is sent.
+     * @return The slot, or -1 when _Size transmits are pending already.
+     */
+    int Add(const cec_command &command)
+    {
+      CLockObject lock(m_mutex);
+      for (size_t iSlot = 0; iSlot < _Size; iSlot++)
+      {
+        if (!m_slots[iSlot].bUsed)
+        {
+          m_slots[iSlot].bUsed      = true;
+          m_slots[iSlot].bSignalled = false;
+          m_slots[iSlot].bDone      = false;
+          m_slots[iSlot].iSequence  = ++m_iNextSequence;
+          m_slots[iSlot].command    = command;
+          return (int)iSlot;
+        }
+      }
+      return -1;
+    }
+
+    /*!
+     * @brief Wait for the result of a transmit, and release its slot.
+     * @param iSlot The slot that Add() returned.
+     * @param iTimeoutMs The time to wait. 0 waits forever.
+     * @param result Set to the result when it came in.
+     * @return True when the result came in before the timeout passed, false otherwise.
+     */
+    bool Wait(int iSlot, uint32_t iTimeoutMs, _Result &result)
+    {
+      CLockObject lock(m_mutex);
+      if (!IsValid(iSlot))
+        return false;
+
+      // every result wakes everyone up, and each waiter checks its own slot
+      pending_transmit &transmit = m_slots[iSlot];
+      if (!transmit.bSignalled)
+        m_condition.Wait(lock, transmit.bSignalled, iTimeoutMs);
+
+      bool bReturn(transmit.bDone);
+      if (bReturn)
+        result = transmit.result;
+      transmit.bUsed = false;
+      return bReturn;
+    }
+
+    /*!
+     * @brief Release a slot without waiting, eg. when the driver refused the frame.
+     */
+    void Remove(int iSlot)
+    {
+      CLockObject lock(m_mutex);
+      if (IsValid(iSlot))
+        m_slots[iSlot].bUsed = false;
+    }
+
+    /*!
+     * @brief Hand a result from the driver to the transmit that it belongs to.
+     * @return True when it matched a pending transmit, false otherwise.
+     */
+    bool MessageReceived(const _Result &result)
+    {
+      CLockObject lock(m_mutex);
+      pending_transmit *match(NULL);
+      for (size_t iSlot = 0; iSlot < _Size; iSlot++)
+      {
+        pending_transmit &transmit = m_slots[iSlot];
+        if (transmit.bUsed && !transmit.bSignalled &&
+            (!match || transmit.iSequence < match->iSequence) &&
+            m_matcher(transmit.command, result))
+          match = &transmit;
+      }
+
+      if (!match)
+        return false;
+
+      match->result     = result;
+      match->bDone      = true;
+      match->bSignalled = true;
+      m_condition.Broadcast();
+      return true;
+    }
+
+    /*!
+     * @brief Wake up everyone that is waiting, without a result.
+     */
+    void Clear(void)
+    {
+      CLockObject lock(m_mutex);
+      for (size_t iSlot = 0; iSlot < _Size; iSlot++)
+        m_slots[iSlot].bSignalled = true;
+      m_condition.Broadcast();
+    }
+
+  private:
+    typedef struct pending_transmit
+    {
+      pending_transmit(void) :
+        bUsed(false),
+        bSignalled(false),
+        bDone(false),
+        iSequence(0) {}
+
+      bool        bUsed;
+      bool        bSignalled; /**< the predicate to wait on: set when the result came in, or by Clear() */
+      bool        bDone;      /**< true when the result came in */
+      uint64_t    iSequence; /**< the order in which the transmits were added */
+      cec_command command;
+      _Result     result;
+    } pending_transmit;
+
+    bool IsValid(int iSlot) const { return iSlot >= 0 && (size_t)iSlot < _Size && m_slots[iSlot].bUsed; }
+
+    _Matcher          m_matcher;
+    CMutex            m_mutex;             /**< mutex for changes to this class */
+    CCondition<bool>  m_condition;         /**< signalled when a transmit got its result */
+    pending_transmit  m_slots[_Size];
+    uint64_t          m_iNextSequence;
+  };
+};
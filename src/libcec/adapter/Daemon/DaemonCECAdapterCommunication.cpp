@@ -0,0 +1,477 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "env.h"
+
+#if defined(HAVE_DAEMON_API)
+#include "DaemonCECAdapterCommunication.h"
+#include "LibCEC.h"
+#include "platform/sockets/socket.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using namespace CEC;
+
+#define LIB_CEC m_callback->GetLib()
+
+CDaemonCECAdapterCommunication::CDaemonCECAdapterCommunication(IAdapterCommunicationCallback *callback, const char *strPort) :
+    IAdapterCommunication(callback),
+    m_bOpen(false),
+    m_strPort(strPort),
+    m_strPath(CEC_DAEMON_DEFAULT_SOCKET),
+    m_iPhysicalAddress(CEC_INVALID_PHYSICAL_ADDRESS),
+    m_vendorId(CEC_VENDOR_UNKNOWN),
+    m_iFirmwareVersion(0),
+    m_adapterType(ADAPTERTYPE_UNKNOWN),
+    m_iSupportedAddresses(0),
+    m_iSequence(0),
+    m_iAddressesResult(-1),
+    m_iPongs(0)
+{
+  memset(&m_stats, 0, sizeof(struct cec_adapter_stats));
+  memset(m_subscription, 0xFF, sizeof(m_subscription));
+  m_logicalAddresses.Clear();
+  ParsePort(m_strPort.substr(strlen(CEC_DAEMON_COM_PREFIX)));
+}
+
+CDaemonCECAdapterCommunication::~CDaemonCECAdapterCommunication(void)
+{
+  Close();
+}
+
+void CDaemonCECAdapterCommunication::ParsePort(const std::string &strPort)
+{
+  // the path may contain commas, so options are taken off the end
+  std::string strPath(strPort);
+  size_t iComma;
+  while ((iComma = strPath.rfind(',')) != std::string::npos)
+  {
+    const std::string strOption(strPath.substr(iComma + 1));
+    if (!strOption.compare(0, 8, "opcodes="))
+    {
+      memset(m_subscription, 0, sizeof(m_subscription));
+      const char *strOpcode = strOption.c_str() + 8;
+      while (*strOpcode)
+      {
+        char *strEnd(NULL);
+        const unsigned long iOpcode = strtoul(strOpcode, &strEnd, 16);
+        if (strEnd == strOpcode)
+          break;
+        if (iOpcode <= 0xFF)
+          m_subscription[iOpcode / 8] |= (uint8_t)(1 << (iOpcode % 8));
+        strOpcode = *strEnd == '+' ? strEnd + 1 : strEnd;
+      }
+    }
+    else
+      break;
+    strPath.erase(iComma);
+  }
+
+  if (!strPath.empty() && strPath[0] == ':' && strPath.size() > 1)
+    m_strPath = strPath.substr(1);
+}
+
+bool CDaemonCECAdapterCommunication::Connect(uint32_t iTimeoutMs)
+{
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (m_strPath.size() >= sizeof(address.sun_path))
+  {
+    LIB_CEC->AddLog(CEC_LOG_ERROR, "%s - socket path '%s' is too long", __FUNCTION__, m_strPath.c_str());
+    return false;
+  }
+  memcpy(address.sun_path, m_strPath.c_str(), m_strPath.size());
+
+  socket_t fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd == INVALID_SOCKET_VALUE)
+    return false;
+  if (connect(fd, (struct sockaddr *)&address, sizeof(address)) < 0)
+  {
+    LIB_CEC->AddLog(CEC_LOG_ERROR, "%s - cannot connect to cec-daemon on '%s': %s", __FUNCTION__, m_strPath.c_str(), strerror(errno));
+    SocketClose(fd);
+    return false;
+  }
+
+  std::shared_ptr<CDaemonConnection> connection(new CDaemonConnection(fd));
+
+  cec_daemon_message message;
+  message.Clear(CEC_DAEMON_MSG_HELLO);
+  message.PushBack(CEC_DAEMON_PROTOCOL_VERSION);
+  for (uint8_t iPtr = 0; iPtr < CEC_DAEMON_SUBSCRIPTION_SIZE; iPtr++)
+    message.PushBack(m_subscription[iPtr]);
+  if (!connection->Write(message))
+    return false;
+
+  if (connection->Read(message, iTimeoutMs > 0 ? iTimeoutMs : CEC_DAEMON_REQUEST_TIMEOUT) <= 0 ||
+      message.type != CEC_DAEMON_MSG_WELCOME ||
+      message.size < 11)
+  {
+    LIB_CEC->AddLog(CEC_LOG_ERROR, "%s - cec-daemon on '%s' didn't answer", __FUNCTION__, m_strPath.c_str());
+    return false;
+  }
+  if (message.data[0] != CEC_DAEMON_PROTOCOL_VERSION)
+  {
+    LIB_CEC->AddLog(CEC_LOG_ERROR, "%s - cec-daemon uses protocol version %u, expected %u", __FUNCTION__, message.data[0], CEC_DAEMON_PROTOCOL_VERSION);
+    return false;
+  }
+
+  CLockObject lock(m_mutex);
+  m_iPhysicalAddress    = message.At16(1);
+  m_vendorId            = (cec_vendor_id)((message.data[3] << 16) | (message.data[4] << 8) | message.data[5]);
+  m_iFirmwareVersion    = message.At16(6);
+  m_adapterType         = (cec_adapter_type)message.data[8];
+  m_iSupportedAddresses = message.At16(9);
+  m_connection          = connection;
+
+  LIB_CEC->AddLog(CEC_LOG_DEBUG, "%s - connected to cec-daemon on '%s', physical address %04x", __FUNCTION__, m_strPath.c_str(), m_iPhysicalAddress);
+  return true;
+}
+
+bool CDaemonCECAdapterCommunication::Open(uint32_t iTimeoutMs, bool UNUSED(bSkipChecks), bool bStartListening)
+{
+  if (IsOpen())
+    Close();
+
+  if (!Connect(iTimeoutMs))
+    return false;
+
+  // only the welcome was needed to detect the adapter
+  if (!bStartListening)
+  {
+    CLockObject lock(m_mutex);
+    m_connection.reset();
+    return true;
+  }
+
+  {
+    CLockObject lock(m_mutex);
+    m_bOpen = true;
+    m_results.clear();
+    m_logicalAddresses.Clear();
+  }
+
+  if (CreateThread())
+    return true;
+
+  Close();
+  return false;
+}
+
+void CDaemonCECAdapterCommunication::Close(void)
+{
+  std::shared_ptr<CDaemonConnection> connection;
+  {
+    CLockObject lock(m_mutex);
+    m_bOpen = false;
+    connection = m_connection;
+    m_condition.Broadcast();
+  }
+
+  // wakes up the reader thread
+  if (connection)
+    connection->Shutdown();
+  StopThread(0);
+
+  CLockObject lock(m_mutex);
+  m_connection.reset();
+}
+
+bool CDaemonCECAdapterCommunication::IsOpen(void)
+{
+  CLockObject lock(m_mutex);
+  return m_bOpen;
+}
+
+bool CDaemonCECAdapterCommunication::WaitFor(CLockObject &lock, const std::function<bool(void)> &check, uint32_t iTimeoutMs)
+{
+  reply_predicate predicate;
+  predicate.check = [this, &check](void) { return !m_bOpen || check(); };
+  m_condition.Wait(lock, predicate, iTimeoutMs);
+  return check();
+}
+
+cec_adapter_message_state CDaemonCECAdapterCommunication::Write(const cec_command &data, bool &bRetry, uint8_t iLineTimeout, bool bIsReply)
+{
+  std::shared_ptr<CDaemonConnection> connection;
+  uint8_t iSequence;
+  {
+    CLockObject lock(m_mutex);
+    if (!m_bOpen)
+      return ADAPTER_MESSAGE_STATE_UNKNOWN;
+    connection = m_connection;
+    iSequence = m_iSequence++;
+    m_results.erase(iSequence);
+  }
+
+  cec_daemon_message message;
+  message.Clear(CEC_DAEMON_MSG_TRANSMIT);
+  message.PushBack(iSequence);
+  message.PushBack((uint8_t)((bRetry ? CEC_DAEMON_FLAG_RETRY : 0) | (bIsReply ? CEC_DAEMON_FLAG_REPLY : 0)));
+  message.PushBack(iLineTimeout);
+  DaemonEncodeFrame(data, message);
+  bRetry = false;
+
+  if (!connection->Write(message))
+  {
+    CLockObject lock(m_mutex);
+    ++m_stats.tx_error;
+    return ADAPTER_MESSAGE_STATE_ERROR;
+  }
+
+  CLockObject lock(m_mutex);
+  if (!WaitFor(lock, [this, iSequence](void) { return m_results.find(iSequence) != m_results.end(); }, CEC_DAEMON_TRANSMIT_TIMEOUT))
+  {
+    ++m_stats.tx_error;
+    return m_bOpen ? ADAPTER_MESSAGE_STATE_WAITING_TO_BE_SENT : ADAPTER_MESSAGE_STATE_ERROR;
+  }
+
+  const transmit_result result(m_results[iSequence]);
+  m_results.erase(iSequence);
+  bRetry = result.bRetry;
+
+  if (result.state == ADAPTER_MESSAGE_STATE_SENT_ACKED)
+    ++m_stats.tx_ack;
+  else if (result.state == ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED)
+    ++m_stats.tx_nack;
+  else
+    ++m_stats.tx_error;
+  return result.state;
+}
+
+bool CDaemonCECAdapterCommunication::SetLogicalAddresses(const cec_logical_addresses &addresses)
+{
+  std::shared_ptr<CDaemonConnection> connection;
+  {
+    CLockObject lock(m_mutex);
+    if (!m_bOpen)
+      return false;
+    connection = m_connection;
+    m_iAddressesResult = -1;
+  }
+
+  cec_daemon_message message;
+  message.Clear(CEC_DAEMON_MSG_SET_ADDRESSES);
+  message.PushBack16(addresses.AckMask());
+  if (!connection->Write(message))
+    return false;
+
+  CLockObject lock(m_mutex);
+  if (!WaitFor(lock, [this](void) { return m_iAddressesResult >= 0; }, CEC_DAEMON_REQUEST_TIMEOUT))
+    return false;
+  if (m_iAddressesResult == 0)
+  {
+    LIB_CEC->AddLog(CEC_LOG_WARNING, "%s - another client of cec-daemon uses one of the logical addresses %04x", __FUNCTION__, addresses.AckMask());
+    return false;
+  }
+
+  m_logicalAddresses = addresses;
+  return true;
+}
+
+cec_logical_addresses CDaemonCECAdapterCommunication::GetLogicalAddresses(void) const
+{
+  CLockObject lock(m_mutex);
+  return m_logicalAddresses;
+}
+
+bool CDaemonCECAdapterCommunication::PingAdapter(void)
+{
+  std::shared_ptr<CDaemonConnection> connection;
+  uint32_t iPongs;
+  {
+    CLockObject lock(m_mutex);
+    if (!m_bOpen)
+      return false;
+    connection = m_connection;
+    iPongs = m_iPongs;
+  }
+
+  cec_daemon_message message;
+  message.Clear(CEC_DAEMON_MSG_PING);
+  if (!connection->Write(message))
+    return false;
+
+  CLockObject lock(m_mutex);
+  return WaitFor(lock, [this, iPongs](void) { return m_iPongs != iPongs; }, CEC_DAEMON_REQUEST_TIMEOUT);
+}
+
+uint16_t CDaemonCECAdapterCommunication::GetFirmwareVersion(void)
+{
+  CLockObject lock(m_mutex);
+  return m_iFirmwareVersion;
+}
+
+uint16_t CDaemonCECAdapterCommunication::GetPhysicalAddress(void)
+{
+  CLockObject lock(m_mutex);
+  return m_iPhysicalAddress;
+}
+
+cec_vendor_id CDaemonCECAdapterCommunication::GetVendorId(void)
+{
+  CLockObject lock(m_mutex);
+  return m_vendorId;
+}
+
+bool CDaemonCECAdapterCommunication::SupportsSourceLogicalAddress(const cec_logical_address address)
+{
+  CLockObject lock(m_mutex);
+  return address >= CECDEVICE_TV && address <= CECDEVICE_BROADCAST && (m_iSupportedAddresses & (1 << address));
+}
+
+cec_adapter_type CDaemonCECAdapterCommunication::GetAdapterType(void)
+{
+  CLockObject lock(m_mutex);
+  return m_adapterType;
+}
+
+#if CEC_LIB_VERSION_MAJOR >= 5
+bool CDaemonCECAdapterCommunication::GetStats(struct cec_adapter_stats* stats)
+{
+  CLockObject lock(m_mutex);
+  memcpy(stats, &m_stats, sizeof(struct cec_adapter_stats));
+  return true;
+}
+#endif
+
+void CDaemonCECAdapterCommunication::HandleMessage(const cec_daemon_message &message)
+{
+  switch (message.type)
+  {
+  case CEC_DAEMON_MSG_TRANSMIT_RESULT:
+    if (message.size >= 3)
+    {
+      CLockObject lock(m_mutex);
+      transmit_result &result = m_results[message.data[0]];
+      result.state  = (cec_adapter_message_state)message.data[1];
+      result.bRetry = !!(message.data[2] & CEC_DAEMON_FLAG_RETRY);
+      m_condition.Broadcast();
+    }
+    break;
+  case CEC_DAEMON_MSG_ADDRESSES:
+    if (message.size >= 1)
+    {
+      CLockObject lock(m_mutex);
+      m_iAddressesResult = message.data[0] ? 1 : 0;
+      m_condition.Broadcast();
+    }
+    break;
+  case CEC_DAEMON_MSG_PONG:
+    {
+      CLockObject lock(m_mutex);
+      ++m_iPongs;
+      m_condition.Broadcast();
+    }
+    break;
+  case CEC_DAEMON_MSG_RECEIVED:
+    {
+      cec_command command;
+      const bool bValid(DaemonDecodeFrame(message, 0, command));
+      {
+        CLockObject lock(m_mutex);
+        if (bValid)
+          ++m_stats.rx_total;
+        else
+          ++m_stats.rx_error;
+      }
+      if (bValid)
+        m_callback->OnCommandReceived(command);
+    }
+    break;
+  case CEC_DAEMON_MSG_POLL:
+    if (message.size >= 1)
+      m_callback->HandlePoll((cec_logical_address)(message.data[0] >> 4), (cec_logical_address)(message.data[0] & 0xF));
+    break;
+  case CEC_DAEMON_MSG_ADDRESS_LOST:
+    if (message.size >= 1 && message.data[0] < CECDEVICE_BROADCAST)
+    {
+      {
+        CLockObject lock(m_mutex);
+        m_logicalAddresses.Unset((cec_logical_address)message.data[0]);
+      }
+      m_callback->HandleLogicalAddressLost((cec_logical_address)message.data[0]);
+    }
+    break;
+  case CEC_DAEMON_MSG_PHYSICAL_ADDRESS:
+    if (message.size >= 2)
+    {
+      {
+        CLockObject lock(m_mutex);
+        m_iPhysicalAddress = message.At16(0);
+      }
+      m_callback->HandlePhysicalAddressChanged(message.At16(0));
+    }
+    break;
+  default:
+    // sent by a newer daemon
+    break;
+  }
+}
+
+void *CDaemonCECAdapterCommunication::Process(void)
+{
+  std::shared_ptr<CDaemonConnection> connection;
+  {
+    CLockObject lock(m_mutex);
+    connection = m_connection;
+  }
+
+  cec_daemon_message message;
+  while (connection && !IsStopped() && connection->Read(message, 0) > 0)
+    HandleMessage(message);
+
+  // the connection was lost when it wasn't closed by Close()
+  bool bLost(false);
+  {
+    CLockObject lock(m_mutex);
+    bLost = m_bOpen;
+    m_bOpen = false;
+    m_condition.Broadcast();
+  }
+
+  if (bLost)
+  {
+    LIB_CEC->AddLog(CEC_LOG_ERROR, "%s - lost the connection to cec-daemon", __FUNCTION__);
+    libcec_parameter param;
+    param.paramData = NULL; param.paramType = CEC_PARAMETER_TYPE_UNKOWN;
+    LIB_CEC->Alert(CEC_ALERT_CONNECTION_LOST, param);
+  }
+
+  return NULL;
+}
+
+#endif
@@ -0,0 +1,170 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "env.h"
+
+#if defined(HAVE_DAEMON_API)
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include "platform/threads/mutex.h"
+#include "platform/threads/threads.h"
+#include "../AdapterCommunication.h"
+#include "DaemonProtocol.h"
+
+// the maximum time to wait for the result of a transmission
+#define CEC_DAEMON_TRANSMIT_TIMEOUT  5000
+
+namespace CEC
+{
+  /*!
+   * @brief Connects to an adapter that is shared by cec-daemon.
+   *
+   * libCEC runs as it would with its own adapter, and takes its own logical
+   * addresses, so several processes can use the same adapter at the same time.
+   * The frames that other clients of the daemon send are received like frames from
+   * other devices on the bus.
+   */
+  class CDaemonCECAdapterCommunication : public IAdapterCommunication, public CThread
+  {
+  public:
+    /*!
+     * @brief Create a new daemon communication handler.
+     * @param callback The callback to use for incoming CEC commands.
+     * @param strPort The port that was opened, "daemon" or "daemon:" followed by the
+     *        path to the socket of cec-daemon, CEC_DAEMON_DEFAULT_SOCKET by default.
+     *        Optionally followed by comma separated options:
+     *        - opcodes=XX+XX+...: only receive frames with these opcodes, in hex, and
+     *          frames that are sent to this client's logical addresses. fd selects
+     *          polls. All frames are received by default.
+     */
+    CDaemonCECAdapterCommunication(IAdapterCommunicationCallback *callback, const char *strPort);
+    virtual ~CDaemonCECAdapterCommunication(void);
+
+    /** @name IAdapterCommunication implementation */
+    ///{
+    bool Open(uint32_t iTimeoutMs = CEC_DEFAULT_CONNECT_TIMEOUT, bool bSkipChecks = false, bool bStartListening = true) override;
+    void Close(void) override;
+    bool IsOpen(void) override;
+    cec_adapter_message_state Write(const cec_command &data, bool &bRetry, uint8_t iLineTimeout, bool bIsReply) override;
+    uint8_t GetMaxPendingTransmits(void) const override { return 1; }
+
+    bool SetLineTimeout(uint8_t UNUSED(iTimeout)) override { return true; }
+    bool StartBootloader(void) override { return false; }
+    bool SetLogicalAddresses(const cec_logical_addresses &addresses) override;
+    cec_logical_addresses GetLogicalAddresses(void) const override;
+    bool PingAdapter(void) override;
+    uint16_t GetFirmwareVersion(void) override;
+    uint32_t GetFirmwareBuildDate(void) override { return 0; }
+    bool IsRunningLatestFirmware(void) override { return true; }
+    bool SetControlledMode(bool UNUSED(controlled)) override { return true; }
+    bool SaveConfiguration(const libcec_configuration & UNUSED(configuration)) override { return false; }
+    bool SetAutoMode(bool UNUSED(automode)) override { return false; }
+    bool GetConfiguration(libcec_configuration & UNUSED(configuration)) override { return false; }
+    std::string GetPortName(void) override { return m_strPort; }
+    uint16_t GetPhysicalAddress(void) override;
+    cec_vendor_id GetVendorId(void) override;
+    bool SupportsSourceLogicalAddress(const cec_logical_address address) override;
+    cec_adapter_type GetAdapterType(void) override;
+    uint16_t GetAdapterVendorId(void) const override { return DAEMON_ADAPTER_VID; }
+    uint16_t GetAdapterProductId(void) const override { return DAEMON_ADAPTER_PID; }
+    void SetActiveSource(bool UNUSED(bSetTo), bool UNUSED(bClientUnregistered)) override {}
+#if CEC_LIB_VERSION_MAJOR >= 5
+    bool GetStats(struct cec_adapter_stats* stats) override;
+#endif
+    ///}
+
+    /** @name CThread implementation */
+    ///{
+    void *Process(void) override;
+    ///}
+
+  private:
+    /*!
+     * @brief Split the options off the port name.
+     */
+    void ParsePort(const std::string &strPort);
+
+    /*!
+     * @brief Connect to the daemon and wait for its welcome.
+     */
+    bool Connect(uint32_t iTimeoutMs);
+
+    /*!
+     * @brief Handle a message from the daemon, on the reader thread.
+     */
+    void HandleMessage(const cec_daemon_message &message);
+
+    /*!
+     * @brief Wait until check returns true, the connection is closed, or the timeout passes. Call with m_mutex held.
+     * @return The value of check.
+     */
+    bool WaitFor(CLockObject &lock, const std::function<bool(void)> &check, uint32_t iTimeoutMs);
+
+    // evaluated again each time that m_condition wakes up, so different threads can wait for different replies
+    struct reply_predicate
+    {
+      std::function<bool(void)> check;
+      explicit operator bool(void) const { return check(); }
+    };
+
+    struct transmit_result
+    {
+      cec_adapter_message_state state;
+      bool                      bRetry;
+    };
+
+    mutable CMutex                        m_mutex;
+    CCondition<reply_predicate>           m_condition;
+    bool                                  m_bOpen;
+    std::shared_ptr<CDaemonConnection>    m_connection;
+    std::string                           m_strPort;
+    std::string                           m_strPath;
+    uint8_t                               m_subscription[CEC_DAEMON_SUBSCRIPTION_SIZE];
+    uint16_t                              m_iPhysicalAddress;
+    cec_vendor_id                         m_vendorId;
+    uint16_t                              m_iFirmwareVersion;
+    cec_adapter_type                      m_adapterType;
+    uint16_t                              m_iSupportedAddresses; /**< the source addresses that the adapter supports, 1 bit per address */
+    cec_logical_addresses                 m_logicalAddresses;
+    uint8_t                               m_iSequence;
+    std::map<uint8_t, transmit_result>    m_results;          /**< results that didn't reach Write() yet, by sequence number */
+    int                                   m_iAddressesResult; /**< the answer to the last SET_ADDRESSES, -1 while waiting */
+    uint32_t                              m_iPongs;
+    struct cec_adapter_stats              m_stats;
+  };
+};
+
+#endif
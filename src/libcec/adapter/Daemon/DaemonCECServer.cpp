@@ -0,0 +1,565 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "env.h"
+
+#if defined(HAVE_DAEMON_API)
+#include "DaemonCECServer.h"
+#include "LibCEC.h"
+#include "CECTypeUtils.h"
+#include "adapter/AdapterFactory.h"
+#include "platform/sockets/socket.h"
+#include "platform/util/timeutils.h"
+#include <chrono>
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace CEC;
+
+CDaemonCECServerClient::CDaemonCECServerClient(CDaemonCECServer *server, socket_t socket, unsigned int iId) :
+    m_iAckMask(0),
+    m_server(server),
+    m_connection(socket),
+    m_iId(iId),
+    m_bWelcomed(false),
+    m_bFinished(false)
+{
+  memset(m_subscription, 0, sizeof(m_subscription));
+}
+
+CDaemonCECServerClient::~CDaemonCECServerClient(void)
+{
+  Disconnect();
+  StopThread(0);
+}
+
+bool CDaemonCECServerClient::Wants(const cec_command &command) const
+{
+  if (!m_bWelcomed)
+    return false;
+  if (command.destination < CECDEVICE_BROADCAST && (m_iAckMask & (1 << command.destination)))
+    return true;
+  const uint8_t iOpcode(command.opcode_set ? (uint8_t)command.opcode : (uint8_t)CEC_OPCODE_NONE);
+  return !!(m_subscription[iOpcode / 8] & (1 << (iOpcode % 8)));
+}
+
+bool CDaemonCECServerClient::Send(const cec_daemon_message &message)
+{
+  if (!m_bWelcomed || !m_connection.IsOpen())
+    return false;
+  if (m_connection.Write(message, false))
+    return true;
+
+  m_server->m_lib->AddLog(CEC_LOG_WARNING, "cec-daemon: client %u doesn't read what it's sent, disconnecting", m_iId);
+  return false;
+}
+
+void CDaemonCECServerClient::Disconnect(void)
+{
+  m_connection.Shutdown();
+}
+
+bool CDaemonCECServerClient::IsFinished(void)
+{
+  return m_bFinished;
+}
+
+void *CDaemonCECServerClient::Process(void)
+{
+  cec_daemon_message message;
+  if (m_connection.Read(message, CEC_DAEMON_REQUEST_TIMEOUT) > 0 &&
+      message.type == CEC_DAEMON_MSG_HELLO &&
+      message.size >= 1 + CEC_DAEMON_SUBSCRIPTION_SIZE)
+  {
+    const bool bSameVersion(message.data[0] == CEC_DAEMON_PROTOCOL_VERSION);
+    memcpy(m_subscription, message.data + 1, CEC_DAEMON_SUBSCRIPTION_SIZE);
+
+    // the client checks the version, and disconnects when it's not the same
+    cec_daemon_message welcome;
+    {
+      CLockObject lock(m_server->m_mutex);
+      welcome = m_server->m_welcome;
+    }
+    if (m_connection.Write(welcome) && bSameVersion)
+    {
+      m_bWelcomed = true;
+      while (!IsStopped() && m_connection.Read(message, 0) > 0)
+        m_server->HandleMessage(this, message);
+    }
+  }
+
+  m_connection.Shutdown();
+  m_bFinished = true;
+  return NULL;
+}
+
+CDaemonCECServer::CDaemonCECServer(CLibCEC *lib) :
+    m_lib(lib),
+    m_adapter(NULL),
+    m_socket(INVALID_SOCKET_VALUE),
+    m_iAckMask(0),
+    m_iNextClientId(0)
+{
+  m_welcome.Clear(CEC_DAEMON_MSG_WELCOME);
+}
+
+CDaemonCECServer::~CDaemonCECServer(void)
+{
+  Stop();
+}
+
+bool CDaemonCECServer::Start(const std::string &strAdapterPort, const std::string &strSocketPath)
+{
+  Stop();
+
+  // open the adapter, the same way as CCECProcessor does
+  IAdapterCommunication *adapter = CAdapterFactory(m_lib).GetInstance(strAdapterPort.c_str(), CEC_SERIAL_DEFAULT_BAUDRATE, this);
+  if (!adapter)
+  {
+    m_lib->AddLog(CEC_LOG_ERROR, "cec-daemon: '%s' isn't a supported adapter", strAdapterPort.c_str());
+    return false;
+  }
+
+  bool bOpen(false);
+  CTimeout timeout(CEC_DEFAULT_CONNECT_TIMEOUT);
+  while (timeout.TimeLeft() > 0 && (bOpen = adapter->Open(timeout.TimeLeft() / CEC_CONNECT_TRIES, false, true)) == false)
+  {
+    adapter->Close();
+    std::this_thread::sleep_for(std::chrono::milliseconds(CEC_DEFAULT_CONNECT_RETRY_WAIT));
+  }
+  if (!bOpen)
+  {
+    m_lib->AddLog(CEC_LOG_ERROR, "cec-daemon: could not open a connection to '%s'", strAdapterPort.c_str());
+    delete adapter;
+    return false;
+  }
+
+  adapter->SetControlledMode(true);
+  cec_logical_addresses addresses;
+  addresses.Clear();
+  adapter->SetLogicalAddresses(addresses);
+
+  uint16_t iSupportedAddresses(0);
+  for (uint8_t iPtr = CECDEVICE_TV; iPtr <= CECDEVICE_BROADCAST; iPtr++)
+    if (adapter->SupportsSourceLogicalAddress((cec_logical_address)iPtr))
+      iSupportedAddresses |= (uint16_t)(1 << iPtr);
+
+  {
+    CLockObject lock(m_mutex);
+    m_adapter = adapter;
+    m_welcome.Clear(CEC_DAEMON_MSG_WELCOME);
+    m_welcome.PushBack(CEC_DAEMON_PROTOCOL_VERSION);
+    m_welcome.PushBack16(adapter->GetPhysicalAddress());
+    const uint32_t iVendorId((uint32_t)adapter->GetVendorId());
+    m_welcome.PushBack((uint8_t)(iVendorId >> 16));
+    m_welcome.PushBack((uint8_t)(iVendorId >> 8));
+    m_welcome.PushBack((uint8_t)iVendorId);
+    m_welcome.PushBack16(adapter->GetFirmwareVersion());
+    m_welcome.PushBack((uint8_t)adapter->GetAdapterType());
+    m_welcome.PushBack16(iSupportedAddresses);
+  }
+  {
+    CLockObject lock(m_addressMutex);
+    m_iAckMask = 0;
+  }
+
+  // create the socket. one that was left behind by a previous run is replaced
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (strSocketPath.empty() || strSocketPath.size() >= sizeof(address.sun_path))
+  {
+    m_lib->AddLog(CEC_LOG_ERROR, "cec-daemon: invalid socket path '%s'", strSocketPath.c_str());
+    Stop();
+    return false;
+  }
+  memcpy(address.sun_path, strSocketPath.c_str(), strSocketPath.size());
+
+  m_socket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  unlink(strSocketPath.c_str());
+  if (m_socket == INVALID_SOCKET_VALUE ||
+      bind(m_socket, (struct sockaddr *)&address, sizeof(address)) < 0 ||
+      listen(m_socket, 8) < 0)
+  {
+    m_lib->AddLog(CEC_LOG_ERROR, "cec-daemon: cannot listen on '%s': %s", strSocketPath.c_str(), strerror(errno));
+    Stop();
+    return false;
+  }
+  m_strSocketPath = strSocketPath;
+
+  if (!CreateThread())
+  {
+    Stop();
+    return false;
+  }
+
+  m_lib->AddLog(CEC_LOG_NOTICE, "cec-daemon: sharing '%s' on '%s'", strAdapterPort.c_str(), strSocketPath.c_str());
+  return true;
+}
+
+void CDaemonCECServer::Stop(void)
+{
+  StopThread(0);
+
+  if (m_socket != INVALID_SOCKET_VALUE)
+  {
+    SocketClose(m_socket);
+    m_socket = INVALID_SOCKET_VALUE;
+  }
+  if (!m_strSocketPath.empty())
+  {
+    unlink(m_strSocketPath.c_str());
+    m_strSocketPath.clear();
+  }
+
+  // the threads of the clients are stopped when they're deleted
+  std::vector<DaemonClientPtr> clients;
+  {
+    CLockObject lock(m_mutex);
+    clients.swap(m_clients);
+  }
+  for (std::vector<DaemonClientPtr>::iterator it = clients.begin(); it != clients.end(); ++it)
+    (*it)->Disconnect();
+  clients.clear();
+
+  IAdapterCommunication *adapter(NULL);
+  {
+    CLockObject lock(m_mutex);
+    adapter = m_adapter;
+    m_adapter = NULL;
+  }
+  if (adapter)
+  {
+    if (adapter->IsOpen())
+      adapter->SetControlledMode(false);
+    adapter->Close();
+    delete adapter;
+  }
+}
+
+size_t CDaemonCECServer::ClientCount(void)
+{
+  CLockObject lock(m_mutex);
+  return m_clients.size();
+}
+
+void *CDaemonCECServer::Process(void)
+{
+  while (!IsStopped())
+  {
+    // wake up regularly, to remove the clients that disconnected
+    const int iReady(SocketWaitReadable(m_socket, INVALID_SOCKET_VALUE, 500));
+    RemoveFinishedClients();
+    if (iReady < 0)
+      break;
+    if (iReady == 0)
+      continue;
+
+    socket_t socket = accept4(m_socket, NULL, NULL, SOCK_CLOEXEC);
+    if (socket == INVALID_SOCKET_VALUE)
+      continue;
+
+    DaemonClientPtr client;
+    {
+      CLockObject lock(m_mutex);
+      client = DaemonClientPtr(new CDaemonCECServerClient(this, socket, ++m_iNextClientId));
+      m_clients.push_back(client);
+    }
+    m_lib->AddLog(CEC_LOG_DEBUG, "cec-daemon: client %u connected", client->Id());
+    if (!client->CreateThread())
+      client->Disconnect();
+  }
+
+  return NULL;
+}
+
+void CDaemonCECServer::RemoveFinishedClients(void)
+{
+  std::vector<DaemonClientPtr> finished;
+  {
+    CLockObject lock(m_mutex);
+    for (std::vector<DaemonClientPtr>::iterator it = m_clients.begin(); it != m_clients.end();)
+    {
+      if ((*it)->IsFinished())
+      {
+        finished.push_back(*it);
+        it = m_clients.erase(it);
+      }
+      else
+        ++it;
+    }
+  }
+
+  if (finished.empty())
+    return;
+
+  for (std::vector<DaemonClientPtr>::iterator it = finished.begin(); it != finished.end(); ++it)
+    m_lib->AddLog(CEC_LOG_DEBUG, "cec-daemon: client %u disconnected", (*it)->Id());
+
+  // release the addresses that they used
+  UpdateAdapterAddresses();
+}
+
+void CDaemonCECServer::UpdateAdapterAddresses(void)
+{
+  CLockObject addressLock(m_addressMutex);
+
+  uint16_t iAckMask(0);
+  IAdapterCommunication *adapter(NULL);
+  {
+    CLockObject lock(m_mutex);
+    for (std::vector<DaemonClientPtr>::const_iterator it = m_clients.begin(); it != m_clients.end(); ++it)
+      iAckMask |= (*it)->m_iAckMask;
+    adapter = m_adapter;
+  }
+
+  if (!adapter || iAckMask == m_iAckMask)
+    return;
+
+  cec_logical_addresses addresses;
+  addresses.Clear();
+  for (uint8_t iPtr = CECDEVICE_TV; iPtr < CECDEVICE_BROADCAST; iPtr++)
+    if (iAckMask & (1 << iPtr))
+      addresses.Set((cec_logical_address)iPtr);
+
+  if (adapter->SetLogicalAddresses(addresses))
+    m_iAckMask = iAckMask;
+  else
+    m_lib->AddLog(CEC_LOG_ERROR, "cec-daemon: failed to set the logical addresses of the adapter to %04x", iAckMask);
+}
+
+bool CDaemonCECServer::SetAddresses(CDaemonCECServerClient *client, uint16_t iAckMask)
+{
+  {
+    CLockObject lock(m_mutex);
+    for (std::vector<DaemonClientPtr>::const_iterator it = m_clients.begin(); it != m_clients.end(); ++it)
+      if (it->get() != client && ((*it)->m_iAckMask & iAckMask))
+        return false;
+    client->m_iAckMask = iAckMask;
+  }
+
+  m_lib->AddLog(CEC_LOG_DEBUG, "cec-daemon: client %u uses logical addresses %04x", client->Id(), iAckMask);
+  UpdateAdapterAddresses();
+  return true;
+}
+
+void CDaemonCECServer::HandleMessage(CDaemonCECServerClient *client, const cec_daemon_message &message)
+{
+  cec_daemon_message reply;
+  switch (message.type)
+  {
+  case CEC_DAEMON_MSG_SET_ADDRESSES:
+    if (message.size >= 2)
+    {
+      const bool bSet(SetAddresses(client, message.At16(0)));
+      reply.Clear(CEC_DAEMON_MSG_ADDRESSES);
+      reply.PushBack(bSet ? 1 : 0);
+      {
+        CLockObject lock(m_mutex);
+        reply.PushBack16(client->m_iAckMask);
+      }
+      client->Send(reply);
+    }
+    break;
+  case CEC_DAEMON_MSG_TRANSMIT:
+    if (message.size >= 4)
+    {
+      cec_command command;
+      bool bRetry(!!(message.data[1] & CEC_DAEMON_FLAG_RETRY));
+      const cec_adapter_message_state state(DaemonDecodeFrame(message, 3, command) ?
+          Transmit(client, command, bRetry, message.data[2], !!(message.data[1] & CEC_DAEMON_FLAG_REPLY)) :
+          ADAPTER_MESSAGE_STATE_ERROR);
+
+      reply.Clear(CEC_DAEMON_MSG_TRANSMIT_RESULT);
+      reply.PushBack(message.data[0]);
+      reply.PushBack((uint8_t)state);
+      reply.PushBack(bRetry ? CEC_DAEMON_FLAG_RETRY : 0);
+      client->Send(reply);
+    }
+    break;
+  case CEC_DAEMON_MSG_PING:
+    reply.Clear(CEC_DAEMON_MSG_PONG);
+    client->Send(reply);
+    break;
+  default:
+    // sent by a newer client
+    break;
+  }
+}
+
+cec_adapter_message_state CDaemonCECServer::Transmit(CDaemonCECServerClient *client, const cec_command &command, bool &bRetry, uint8_t iLineTimeout, bool bIsReply)
+{
+  IAdapterCommunication *adapter(NULL);
+  DaemonClientPtr destination;
+  bool bClaimed(false);
+  {
+    CLockObject lock(m_mutex);
+    bClaimed = !!(client->m_iAckMask & (1 << command.initiator));
+    adapter = m_adapter;
+    if (command.destination < CECDEVICE_BROADCAST)
+      for (std::vector<DaemonClientPtr>::const_iterator it = m_clients.begin(); it != m_clients.end(); ++it)
+        if (it->get() != client && ((*it)->m_iAckMask & (1 << command.destination)))
+          destination = *it;
+  }
+
+  // clients only send from the addresses that they claimed. polls that check whether an address
+  // is free are sent from that address, and unregistered is nobody's
+  if (!bClaimed &&
+      command.initiator != CECDEVICE_UNREGISTERED &&
+      (command.opcode_set || command.initiator != command.destination))
+  {
+    m_lib->AddLog(CEC_LOG_WARNING, "cec-daemon: client %u didn't claim logical address %x, not sending the frame", client->Id(), (uint8_t)command.initiator);
+    bRetry = false;
+    return ADAPTER_MESSAGE_STATE_ERROR;
+  }
+
+  // frames for another client don't have to go out on the bus
+  if (destination)
+  {
+    bRetry = false;
+    if (command.opcode_set)
+    {
+      Deliver(command, client);
+    }
+    else
+    {
+      cec_daemon_message poll;
+      poll.Clear(CEC_DAEMON_MSG_POLL);
+      poll.PushBack((uint8_t)((command.initiator << 4) | command.destination));
+      destination->Send(poll);
+    }
+    return ADAPTER_MESSAGE_STATE_SENT_ACKED;
+  }
+
+  if (!adapter)
+    return ADAPTER_MESSAGE_STATE_ERROR;
+
+  cec_adapter_message_state state;
+  if (adapter->GetMaxPendingTransmits() > 1)
+  {
+    state = adapter->Write(command, bRetry, iLineTimeout, bIsReply);
+  }
+  else
+  {
+    CLockObject lock(m_transmitMutex);
+    state = adapter->Write(command, bRetry, iLineTimeout, bIsReply);
+  }
+
+  // the other clients see what went out on the bus, like the other devices do
+  if (state == ADAPTER_MESSAGE_STATE_SENT_ACKED ||
+      (command.destination == CECDEVICE_BROADCAST && state == ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED))
+    Deliver(command, client);
+
+  return state;
+}
+
+void CDaemonCECServer::Deliver(const cec_command &command, const CDaemonCECServerClient *sender)
+{
+  cec_daemon_message message;
+  message.Clear(CEC_DAEMON_MSG_RECEIVED);
+  DaemonEncodeFrame(command, message);
+
+  CLockObject lock(m_mutex);
+  for (std::vector<DaemonClientPtr>::const_iterator it = m_clients.begin(); it != m_clients.end(); ++it)
+    if (it->get() != sender && (*it)->Wants(command))
+      (*it)->Send(message);
+}
+
+bool CDaemonCECServer::OnCommandReceived(const cec_command &command)
+{
+  Deliver(command, NULL);
+  return true;
+}
+
+void CDaemonCECServer::HandlePoll(cec_logical_address initiator, cec_logical_address destination)
+{
+  cec_command command;
+  cec_command::Format(command, initiator, destination, CEC_OPCODE_NONE);
+
+  cec_daemon_message message;
+  message.Clear(CEC_DAEMON_MSG_POLL);
+  message.PushBack((uint8_t)((initiator << 4) | (destination & 0xF)));
+
+  CLockObject lock(m_mutex);
+  for (std::vector<DaemonClientPtr>::const_iterator it = m_clients.begin(); it != m_clients.end(); ++it)
+    if ((*it)->Wants(command))
+      (*it)->Send(message);
+}
+
+void CDaemonCECServer::HandleLogicalAddressLost(cec_logical_address oldAddress)
+{
+  if (oldAddress >= CECDEVICE_BROADCAST)
+    return;
+
+  m_lib->AddLog(CEC_LOG_NOTICE, "cec-daemon: logical address %x was taken by another device", oldAddress);
+
+  // the client allocates a new address and sends it. this is called from the
+  // thread of the adapter, so the addresses of the adapter can't be changed here
+  cec_daemon_message message;
+  message.Clear(CEC_DAEMON_MSG_ADDRESS_LOST);
+  message.PushBack((uint8_t)oldAddress);
+
+  CLockObject lock(m_mutex);
+  for (std::vector<DaemonClientPtr>::const_iterator it = m_clients.begin(); it != m_clients.end(); ++it)
+  {
+    if ((*it)->m_iAckMask & (1 << oldAddress))
+    {
+      (*it)->m_iAckMask &= (uint16_t)~(1 << oldAddress);
+      (*it)->Send(message);
+    }
+  }
+}
+
+void CDaemonCECServer::HandlePhysicalAddressChanged(uint16_t iNewAddress)
+{
+  m_lib->AddLog(CEC_LOG_NOTICE, "cec-daemon: physical address changed to %04x", iNewAddress);
+
+  cec_daemon_message message;
+  message.Clear(CEC_DAEMON_MSG_PHYSICAL_ADDRESS);
+  message.PushBack16(iNewAddress);
+
+  CLockObject lock(m_mutex);
+  if (m_welcome.size >= 3)
+  {
+    m_welcome.data[1] = (uint8_t)(iNewAddress >> 8);
+    m_welcome.data[2] = (uint8_t)(iNewAddress & 0xFF);
+  }
+  for (std::vector<DaemonClientPtr>::const_iterator it = m_clients.begin(); it != m_clients.end(); ++it)
+    (*it)->Send(message);
+}
+
+#endif
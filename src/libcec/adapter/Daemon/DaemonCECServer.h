@@ -0,0 +1,208 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "env.h"
+
+#if defined(HAVE_DAEMON_API)
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "platform/threads/mutex.h"
+#include "platform/threads/threads.h"
+#include "../AdapterCommunication.h"
+#include "DaemonProtocol.h"
+
+namespace CEC
+{
+  class CDaemonCECServer;
+
+  /*!
+   * @brief A process that is connected to cec-daemon.
+   */
+  class CDaemonCECServerClient : public CThread
+  {
+  public:
+    CDaemonCECServerClient(CDaemonCECServer *server, socket_t socket, unsigned int iId);
+    virtual ~CDaemonCECServerClient(void);
+
+    /*!
+     * @return True when this client wants to receive the frame: when it's sent to one
+     *         of its logical addresses, or when it subscribed to its opcode.
+     */
+    bool Wants(const cec_command &command) const;
+
+    /*!
+     * @brief Send a message without waiting. A client that doesn't read its messages
+     *        is disconnected.
+     */
+    bool Send(const cec_daemon_message &message);
+
+    /*!
+     * @brief Disconnect, and wake up the thread of this client.
+     */
+    void Disconnect(void);
+
+    /*!
+     * @return True when the connection was closed, and this client can be removed.
+     */
+    bool IsFinished(void);
+
+    unsigned int Id(void) const { return m_iId; }
+
+    /*!
+     * @brief The logical addresses that this client uses, 1 bit per address. Guarded by the lock of the server.
+     */
+    uint16_t m_iAckMask;
+
+    /** @name CThread implementation */
+    ///{
+    void *Process(void) override;
+    ///}
+
+  private:
+    CDaemonCECServer * m_server;
+    CDaemonConnection  m_connection;
+    unsigned int       m_iId;
+    uint8_t            m_subscription[CEC_DAEMON_SUBSCRIPTION_SIZE];
+    std::atomic<bool>  m_bWelcomed;   /**< set once the welcome was sent, nothing else is sent before it */
+    std::atomic<bool>  m_bFinished;
+  };
+
+  typedef std::shared_ptr<CDaemonCECServerClient> DaemonClientPtr;
+
+  /*!
+   * @brief The part of cec-daemon that shares one adapter between the processes that
+   *        connect to it with a "daemon:" port, see CDaemonCECAdapterCommunication.
+   *
+   * Each client takes its own logical addresses, and the adapter acks all of them.
+   * Frames that are received are passed to every client that wants them. Frames that
+   * a client sends to the address of another client don't go out on the bus, and
+   * frames that go out on the bus are passed to the other clients as well, as if they
+   * were received.
+   */
+  class CDaemonCECServer : public IAdapterCommunicationCallback, public CThread
+  {
+    friend class CDaemonCECServerClient;
+  public:
+    /*!
+     * @param lib The libCEC instance that the log messages go to.
+     */
+    CDaemonCECServer(CLibCEC *lib);
+    virtual ~CDaemonCECServer(void);
+
+    /*!
+     * @brief Open the adapter and start listening for clients.
+     * @param strAdapterPort The port of the adapter to share.
+     * @param strSocketPath The path of the socket to create. A socket that was left
+     *        behind by a previous run is replaced.
+     * @return True when the adapter was opened and clients can connect.
+     */
+    bool Start(const std::string &strAdapterPort, const std::string &strSocketPath);
+
+    /*!
+     * @brief Disconnect all clients, remove the socket and close the adapter.
+     */
+    void Stop(void);
+
+    /*!
+     * @return The number of clients that are connected.
+     */
+    size_t ClientCount(void);
+
+    /** @name IAdapterCommunicationCallback implementation */
+    ///{
+    bool OnCommandReceived(const cec_command &command) override;
+    void HandlePoll(cec_logical_address initiator, cec_logical_address destination) override;
+    bool HandleReceiveFailed(cec_logical_address UNUSED(initiator)) override { return true; }
+    void HandleLogicalAddressLost(cec_logical_address oldAddress) override;
+    void HandlePhysicalAddressChanged(uint16_t iNewAddress) override;
+    CLibCEC *GetLib(void) const override { return m_lib; }
+    ///}
+
+    /** @name CThread implementation */
+    ///{
+    void *Process(void) override;
+    ///}
+
+  private:
+    /*!
+     * @brief Handle a message from a client, on the thread of that client.
+     */
+    void HandleMessage(CDaemonCECServerClient *client, const cec_daemon_message &message);
+
+    /*!
+     * @brief Change the logical addresses of a client.
+     * @return False when another client uses one of them.
+     */
+    bool SetAddresses(CDaemonCECServerClient *client, uint16_t iAckMask);
+
+    /*!
+     * @brief Transmit a frame that was sent by a client.
+     */
+    cec_adapter_message_state Transmit(CDaemonCECServerClient *client, const cec_command &command, bool &bRetry, uint8_t iLineTimeout, bool bIsReply);
+
+    /*!
+     * @brief Pass a frame to the clients that want it.
+     * @param command The frame.
+     * @param sender The client that sent it, which doesn't get it back, or NULL when it was received.
+     */
+    void Deliver(const cec_command &command, const CDaemonCECServerClient *sender);
+
+    /*!
+     * @brief Give the adapter the logical addresses of all clients. Don't call this with
+     *        m_mutex held or from the thread of the adapter, which may have to answer.
+     */
+    void UpdateAdapterAddresses(void);
+
+    /*!
+     * @brief Remove the clients that disconnected.
+     */
+    void RemoveFinishedClients(void);
+
+    CLibCEC *                    m_lib;
+    IAdapterCommunication *      m_adapter;
+    CMutex                       m_mutex;
+    CMutex                       m_transmitMutex;    /**< held while transmitting, when the adapter can't handle more than one frame at a time */
+    CMutex                       m_addressMutex;     /**< held while the addresses of the adapter are changed */
+    std::vector<DaemonClientPtr> m_clients;
+    socket_t                     m_socket;
+    std::string                  m_strSocketPath;
+    cec_daemon_message           m_welcome;          /**< what the adapter told about itself when it was opened */
+    uint16_t                     m_iAckMask;         /**< the addresses that the adapter was given, guarded by m_addressMutex */
+    unsigned int                 m_iNextClientId;
+  };
+};
+
+#endif
@@ -0,0 +1,166 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "env.h"
+
+#if defined(HAVE_DAEMON_API)
+#include "DaemonProtocol.h"
+#include "platform/sockets/socket.h"
+#include "platform/util/timeutils.h"
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+
+using namespace CEC;
+
+void CEC::DaemonEncodeFrame(const cec_command &command, cec_daemon_message &message)
+{
+  message.PushBack((uint8_t)((command.initiator << 4) | (command.destination & 0xF)));
+  if (!command.opcode_set)
+    return;
+  message.PushBack((uint8_t)command.opcode);
+  for (uint8_t iPtr = 0; iPtr < command.parameters.size; iPtr++)
+    message.PushBack(command.parameters[iPtr]);
+}
+
+bool CEC::DaemonDecodeFrame(const cec_daemon_message &message, uint8_t iOffset, cec_command &command)
+{
+  if (iOffset >= message.size || message.size - iOffset > 2 + CEC_MAX_DATA_PACKET_SIZE)
+    return false;
+
+  cec_command::Format(command,
+                      (cec_logical_address)(message.data[iOffset] >> 4),
+                      (cec_logical_address)(message.data[iOffset] & 0xF),
+                      CEC_OPCODE_NONE);
+  for (size_t iPtr = iOffset + 1; iPtr < message.size; iPtr++)
+    command.PushBack(message.data[iPtr]);
+  return true;
+}
+
+CDaemonConnection::CDaemonConnection(socket_t socket) :
+    m_socket(socket),
+    m_bShutdown(false),
+    m_iBuffered(0)
+{
+}
+
+CDaemonConnection::~CDaemonConnection(void)
+{
+  Close();
+}
+
+int CDaemonConnection::Read(cec_daemon_message &message, uint32_t iTimeoutMs)
+{
+  CTimeout timeout(iTimeoutMs);
+  while (!m_bShutdown)
+  {
+    // return a message once it's complete
+    if (m_iBuffered >= CEC_DAEMON_HEADER_SIZE && m_iBuffered >= (size_t)CEC_DAEMON_HEADER_SIZE + m_buffer[1])
+    {
+      message.type = m_buffer[0];
+      message.size = m_buffer[1];
+      memcpy(message.data, m_buffer + CEC_DAEMON_HEADER_SIZE, message.size);
+
+      const size_t iUsed(CEC_DAEMON_HEADER_SIZE + message.size);
+      memmove(m_buffer, m_buffer + iUsed, m_iBuffered - iUsed);
+      m_iBuffered -= iUsed;
+      return 1;
+    }
+
+    uint32_t iWaitMs(0);
+    if (iTimeoutMs > 0 && (iWaitMs = timeout.TimeLeft()) == 0)
+      return 0;
+
+    const int iReady(SocketWaitReadable(m_socket, INVALID_SOCKET_VALUE, iWaitMs));
+    if (iReady < 0)
+      return -1;
+    if (iReady == 0)
+      continue;
+
+    // don't read past the end of the next message when it's the biggest there can be
+    ssize_t iRead = recv(m_socket, m_buffer + m_iBuffered, sizeof(m_buffer) - m_iBuffered, 0);
+    if (iRead < 0 && (errno == EINTR || errno == EAGAIN))
+      continue;
+    if (iRead <= 0)
+      return -1;
+    m_iBuffered += (size_t)iRead;
+  }
+
+  return -1;
+}
+
+bool CDaemonConnection::Write(const cec_daemon_message &message, bool bBlock /* = true */)
+{
+  uint8_t buffer[CEC_DAEMON_HEADER_SIZE + CEC_DAEMON_MAX_PAYLOAD];
+  buffer[0] = message.type;
+  buffer[1] = message.size;
+  memcpy(buffer + CEC_DAEMON_HEADER_SIZE, message.data, message.size);
+  const size_t iSize(CEC_DAEMON_HEADER_SIZE + message.size);
+
+  CLockObject lock(m_writeMutex);
+  size_t iWritten(0);
+  while (!m_bShutdown && iWritten < iSize)
+  {
+    ssize_t iResult = send(m_socket, buffer + iWritten, iSize - iWritten, MSG_NOSIGNAL | (bBlock ? 0 : MSG_DONTWAIT));
+    if (iResult < 0 && errno == EINTR)
+      continue;
+    if (iResult <= 0)
+    {
+      Shutdown();
+      return false;
+    }
+    iWritten += (size_t)iResult;
+  }
+
+  return iWritten == iSize;
+}
+
+void CDaemonConnection::Shutdown(void)
+{
+  if (!m_bShutdown.exchange(true) && m_socket != INVALID_SOCKET_VALUE)
+    shutdown(m_socket, SHUT_RDWR);
+}
+
+void CDaemonConnection::Close(void)
+{
+  Shutdown();
+  SocketClose(m_socket);
+  m_socket = INVALID_SOCKET_VALUE;
+}
+
+bool CDaemonConnection::IsOpen(void)
+{
+  return !m_bShutdown;
+}
+
+#endif
@@ -0,0 +1,165 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "env.h"
+
+#if defined(HAVE_DAEMON_API)
+#include "platform/os.h"
+#include "platform/threads/mutex.h"
+#include <atomic>
+
+// ports starting with this prefix connect to cec-daemon, see CDaemonCECAdapterCommunication
+#define CEC_DAEMON_COM_PREFIX        "daemon"
+#define CEC_DAEMON_DEFAULT_SOCKET    "/run/cec-daemon.sock"
+#define DAEMON_ADAPTER_VID           0x2548
+#define DAEMON_ADAPTER_PID           0x1102
+
+namespace CEC
+{
+  /*
+   * cec-daemon shares one adapter between several processes. Each of them runs its
+   * own libCEC with its own logical addresses, and only the frames go over the
+   * socket. Every message is a 2 byte header followed by the payload:
+   *   byte 0: the type, see cec_daemon_message_type
+   *   byte 1: the size of the payload
+   * Frames are sent as they are on the line: initiator << 4 | destination, followed
+   * by the opcode and the parameters when the opcode is set. Numbers are big endian.
+   */
+  #define CEC_DAEMON_PROTOCOL_VERSION  1
+  #define CEC_DAEMON_HEADER_SIZE       2
+  #define CEC_DAEMON_MAX_PAYLOAD       255
+  // 1 bit per opcode. polls and other frames without an opcode use CEC_OPCODE_NONE
+  #define CEC_DAEMON_SUBSCRIPTION_SIZE 32
+
+  // the maximum time to wait for the other end to answer a request
+  #define CEC_DAEMON_REQUEST_TIMEOUT   1000
+
+  #define CEC_DAEMON_FLAG_RETRY        0x01
+  #define CEC_DAEMON_FLAG_REPLY        0x02
+
+  typedef enum cec_daemon_message_type
+  {
+    CEC_DAEMON_MSG_HELLO            = 1,  /**< client: version (1), opcode subscription (32) */
+    CEC_DAEMON_MSG_WELCOME          = 2,  /**< daemon: version (1), physical address (2), vendor id (3), firmware version (2), adapter type (1), the mask of supported source addresses (2) */
+    CEC_DAEMON_MSG_SET_ADDRESSES    = 3,  /**< client: logical address mask (2) */
+    CEC_DAEMON_MSG_ADDRESSES        = 4,  /**< daemon: 1 when set, 0 when used by another client (1), the mask of this client (2) */
+    CEC_DAEMON_MSG_TRANSMIT         = 5,  /**< client: sequence number (1), CEC_DAEMON_FLAG_* (1), line timeout (1), frame */
+    CEC_DAEMON_MSG_TRANSMIT_RESULT  = 6,  /**< daemon: sequence number (1), cec_adapter_message_state (1), CEC_DAEMON_FLAG_RETRY when it may be retried (1) */
+    CEC_DAEMON_MSG_RECEIVED         = 7,  /**< daemon: frame, received from the bus or sent by another client */
+    CEC_DAEMON_MSG_POLL             = 8,  /**< daemon: initiator << 4 | destination of a poll that was seen on the bus */
+    CEC_DAEMON_MSG_ADDRESS_LOST     = 9,  /**< daemon: a logical address of this client that was taken by another device (1) */
+    CEC_DAEMON_MSG_PHYSICAL_ADDRESS = 10, /**< daemon: the new physical address of the adapter (2) */
+    CEC_DAEMON_MSG_PING             = 11, /**< client: no payload */
+    CEC_DAEMON_MSG_PONG             = 12  /**< daemon: no payload */
+  } cec_daemon_message_type;
+
+  typedef struct cec_daemon_message
+  {
+    uint8_t type;
+    uint8_t size;
+    uint8_t data[CEC_DAEMON_MAX_PAYLOAD];
+
+    void Clear(uint8_t iType) { type = iType; size = 0; }
+    void PushBack(uint8_t iByte) { if (size < CEC_DAEMON_MAX_PAYLOAD) data[size++] = iByte; }
+    void PushBack16(uint16_t iValue) { PushBack((uint8_t)(iValue >> 8)); PushBack((uint8_t)(iValue & 0xFF)); }
+    uint16_t At16(uint8_t iPos) const { return (uint16_t)((data[iPos] << 8) | data[iPos + 1]); }
+  } cec_daemon_message;
+
+  /*!
+   * @brief Append a frame to a message, as it is on the line.
+   */
+  void DaemonEncodeFrame(const cec_command &command, cec_daemon_message &message);
+
+  /*!
+   * @brief Read a frame that starts at iOffset in a message.
+   * @return True when the frame is valid, false otherwise.
+   */
+  bool DaemonDecodeFrame(const cec_daemon_message &message, uint8_t iOffset, cec_command &command);
+
+  /*!
+   * @brief One end of a connection between cec-daemon and a client. Messages are
+   *        read from a single thread, and can be written from any thread.
+   */
+  class CDaemonConnection
+  {
+  public:
+    /*!
+     * @param socket The connected socket. It's closed by Close() or the destructor.
+     */
+    CDaemonConnection(socket_t socket);
+    virtual ~CDaemonConnection(void);
+
+    CDaemonConnection(const CDaemonConnection &) = delete;
+    CDaemonConnection &operator=(const CDaemonConnection &) = delete;
+
+    /*!
+     * @brief Wait for the next message.
+     * @param message The message that was read.
+     * @param iTimeoutMs The maximum time to wait, or 0 to wait until a message arrives.
+     * @return 1 when a message was read, 0 on timeout, or -1 when the connection was closed.
+     */
+    int Read(cec_daemon_message &message, uint32_t iTimeoutMs);
+
+    /*!
+     * @brief Write a message.
+     * @param message The message to write.
+     * @param bBlock False to give up instead of waiting for the peer to make room. The
+     *        connection is closed when that happens, since a message may have been cut
+     *        in half.
+     * @return True when written, false when the connection was closed.
+     */
+    bool Write(const cec_daemon_message &message, bool bBlock = true);
+
+    /*!
+     * @brief Wake up a thread that is blocked in Read() and make further reads fail.
+     */
+    void Shutdown(void);
+
+    /*!
+     * @brief Close the socket. Only call this when no other thread uses the connection.
+     */
+    void Close(void);
+
+    bool IsOpen(void);
+
+  private:
+    CMutex            m_writeMutex;
+    socket_t          m_socket;
+    std::atomic<bool> m_bShutdown;
+    uint8_t           m_buffer[CEC_DAEMON_HEADER_SIZE + CEC_DAEMON_MAX_PAYLOAD];
+    size_t            m_iBuffered;
+  };
+};
+
+#endif
@@ -38,6 +38,10 @@
 #include "platform/util/timeutils.h"
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <time.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
 
 #if defined(HAVE_LINUX_API)
@@ -45,6 +49,7 @@
 #include "CECTypeUtils.h"
 #include "LibCEC.h"
 #include "platform/util/buffer.h"
+#include <algorithm>
 #include <linux/cec.h>
 
 using namespace CEC;
@@ -54,6 +59,15 @@ using namespace CEC;
 // Required capabilities
 #define CEC_LINUX_CAPABILITIES (CEC_CAP_LOG_ADDRS | CEC_CAP_TRANSMIT | CEC_CAP_PASSTHROUGH)
 
+// How long Write() waits for the kernel to report the result of a transmit.
+// The kernel always reports one, unless it dropped it because we didn't read
+// our message queue fast enough
+#define CEC_LINUX_TRANSMIT_TIMEOUT_MS 2000
+
+// How long SetLogAddrs() waits for the kernel to finish claiming logical
+// addresses. It polls each address, and retries the ones that are busy
+#define CEC_LINUX_CONFIGURE_TIMEOUT_MS 10000
+
 // The vendor ID to register with the CEC framework - the kernel announces it
 // in a <Device Vendor ID> broadcast at every logical address claim, so use
 // the configured vendor ID (when set) to keep the announced identity
@@ -76,11 +90,29 @@ CLinuxCECAdapterCommunication::CLinuxCECAdapterCommunication(IAdapterCommunicati
     m_path(strPath)
 {
   m_fd = INVALID_SOCKET_VALUE;
+  m_iAvailableLogAddrs = 1;
+  m_claimedMask = 0;
+  m_claimedPrimary = CECDEVICE_UNKNOWN;
+  m_iClaimedTs = 0;
+  m_bLogAddrsDone = false;
+  m_iLogAddrsTs = 0;
+  m_physAddr = CEC_INVALID_PHYSICAL_ADDRESS;
+  m_bPhysAddrChanged = false;
+  // the wakeup descriptor lives as long as this object, so Process() can be
+  // restarted when the device is closed and reopened
+  m_wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  memset(&m_stats, 0, sizeof(struct cec_adapter_stats));
+  memset(&m_counters, 0, sizeof(cec_adapter_counters));
+  m_counters.version = CEC_ADAPTER_COUNTERS_VERSION;
+  m_counters.size    = sizeof(cec_adapter_counters);
 }
 
 CLinuxCECAdapterCommunication::~CLinuxCECAdapterCommunication(void)
 {
   Close();
+
+  if (m_wakeup >= 0)
+    close(m_wakeup);
 }
 
 bool CLinuxCECAdapterCommunication::IsCapableDevice(const std::string &strPath)
@@ -144,13 +176,23 @@ bool CLinuxCECAdapterCommunication::Open(uint32_t iTimeoutMs, bool UNUSED(bSkipC
   // giving up on the first failure. a zero timeout leaves TimeLeft() at 0, ie.
   // a single attempt, which is what this did before
   CTimeout timeout(iTimeoutMs);
-  while ((m_fd = open(strPath.c_str(), O_RDWR)) < 0 && timeout.TimeLeft() > 0)
+  // non-blocking, so Process() can drain everything that's queued on each
+  // wakeup, and so transmits are completed from Process() too
+  while ((m_fd = open(strPath.c_str(), O_RDWR | O_NONBLOCK)) < 0 && timeout.TimeLeft() > 0)
     std::this_thread::sleep_for(std::chrono::milliseconds(250));
 
   if (m_fd >= 0)
   {
     LIB_CEC->AddLog(CEC_LOG_DEBUG, "CLinuxCECAdapterCommunication::Open - path=%s m_fd=%d bStartListening=%d", strPath.c_str(), m_fd, bStartListening);
 
+    {
+      // SetLogAddrs() reads the first events, before Process() runs
+      CLockObject lock(m_mutex);
+      m_claimedMask = 0;
+      m_physAddr = CEC_INVALID_PHYSICAL_ADDRESS;
+      m_bPhysAddrChanged = false;
+    }
+
     // Ensure the CEC device supports required capabilities
     struct cec_caps caps = {};
     if (ioctl(m_fd, CEC_ADAP_G_CAPS, &caps) || (caps.capabilities & CEC_LINUX_CAPABILITIES) != CEC_LINUX_CAPABILITIES)
@@ -159,6 +201,7 @@ bool CLinuxCECAdapterCommunication::Open(uint32_t iTimeoutMs, bool UNUSED(bSkipC
       Close();
       return false;
     }
+    m_iAvailableLogAddrs = caps.available_log_addrs > CEC_MAX_LOG_ADDRS ? CEC_MAX_LOG_ADDRS : (uint8_t)caps.available_log_addrs;
 
     if (!bStartListening)
     {
@@ -190,7 +233,7 @@ bool CLinuxCECAdapterCommunication::Open(uint32_t iTimeoutMs, bool UNUSED(bSkipC
 
     // Clear existing logical addresses and set the CEC device to the unconfigured state
     struct cec_log_addrs log_addrs = {};
-    if (ioctl(m_fd, CEC_ADAP_S_LOG_ADDRS, &log_addrs))
+    if (SetLogAddrs(&log_addrs))
     {
       LIB_CEC->AddLog(CEC_LOG_ERROR, "CLinuxCECAdapterCommunication::Open - ioctl CEC_ADAP_S_LOG_ADDRS failed - errno=%d", errno);
       Close();
@@ -209,7 +252,7 @@ bool CLinuxCECAdapterCommunication::Open(uint32_t iTimeoutMs, bool UNUSED(bSkipC
     log_addrs.primary_device_type[0] = CEC_OP_PRIM_DEVTYPE_SWITCH;
     log_addrs.log_addr_type[0] = CEC_LOG_ADDR_TYPE_UNREGISTERED;
     log_addrs.all_device_types[0] = CEC_OP_ALL_DEVTYPE_SWITCH;
-    if (ioctl(m_fd, CEC_ADAP_S_LOG_ADDRS, &log_addrs))
+    if (SetLogAddrs(&log_addrs))
     {
       LIB_CEC->AddLog(CEC_LOG_ERROR, "CLinuxCECAdapterCommunication::Open - ioctl CEC_ADAP_S_LOG_ADDRS failed - errno=%d", errno);
       Close();
@@ -229,7 +272,11 @@ bool CLinuxCECAdapterCommunication::Open(uint32_t iTimeoutMs, bool UNUSED(bSkipC
 
 void CLinuxCECAdapterCommunication::Close(void)
 {
+  // flag the thread, so it doesn't go back to sleep after the wakeup
+  StopThread(-1);
+  Interrupt();
   StopThread(0);
+  AbortTransmits();
 
   LIB_CEC->AddLog(CEC_LOG_DEBUG, "CLinuxCECAdapterCommunication::Close - m_fd=%d", m_fd);
 
@@ -243,6 +290,20 @@ bool CLinuxCECAdapterCommunication::IsOpen(void)
 }
 
 cec_adapter_message_state CLinuxCECAdapterCommunication::Write(const cec_command &data, bool &bRetry, uint8_t UNUSED(iLineTimeout), bool UNUSED(bIsReply))
+{
+  // The CEC driver will make re-transmission attempts
+  bRetry = false;
+  return Transmit(data, NULL);
+}
+
+cec_adapter_message_state CLinuxCECAdapterCommunication::WriteRequest(const cec_command &data, bool &bRetry, uint8_t UNUSED(iLineTimeout), cec_transmit_reply &reply)
+{
+  bRetry = false;
+  reply.bReceived = false;
+  return Transmit(data, &reply);
+}
+
+cec_adapter_message_state CLinuxCECAdapterCommunication::Transmit(const cec_command &data, cec_transmit_reply *reply)
 {
   if (IsOpen())
   {
@@ -259,29 +320,127 @@ cec_adapter_message_state CLinuxCECAdapterCommunication::Write(const cec_command
     }
     msg.len = len;
 
-    if (ioctl(m_fd, CEC_TRANSMIT, &msg))
+    // let the kernel wait for the reply, so it arrives together with the
+    // result of the transmit. it's not passed on to us as a received frame then
+    uint32_t iTimeoutMs(CEC_LINUX_TRANSMIT_TIMEOUT_MS);
+    if (reply && reply->opcode != CEC_OPCODE_NONE && data.destination != CECDEVICE_BROADCAST)
     {
-      LIB_CEC->AddLog(CEC_LOG_ERROR, "CLinuxCECAdapterCommunication::Write - ioctl CEC_TRANSMIT failed - tx_status=%02x errno=%d", msg.tx_status, errno);
-      return ADAPTER_MESSAGE_STATE_ERROR;
+      msg.reply   = (uint8_t)reply->opcode;
+      msg.timeout = reply->iWaitMs;
+      iTimeoutMs += msg.timeout;
     }
 
-    LIB_CEC->AddLog(CEC_LOG_DEBUG, "CLinuxCECAdapterCommunication::Write - ioctl CEC_TRANSMIT - tx_status=%02x len=%d addr=%02x opcode=%02x", msg.tx_status, msg.len, msg.msg[0], cec_msg_opcode(&msg));
+    // the fd is non-blocking, so this only queues the frame. the kernel
+    // reports the result in our message queue, where Process() picks it up
+    linux_cec_transmit transmit = {};
+    {
+      // register it under the same lock as the ioctl, or Process() could see
+      // the result before we know which sequence number to look for
+      CLockObject lock(m_mutex);
+      if (ioctl(m_fd, CEC_TRANSMIT, &msg))
+      {
+        int err = errno;
+        ++m_stats.tx_error;
+        lock.unlock();
+        LIB_CEC->AddLog(CEC_LOG_ERROR, "CLinuxCECAdapterCommunication::Write - ioctl CEC_TRANSMIT failed - tx_status=%02x errno=%d", msg.tx_status, err);
+        return ADAPTER_MESSAGE_STATE_ERROR;
+      }
 
-    // The CEC driver will make re-transmission attempts
-    bRetry = false;
+      transmit.sequence = msg.sequence;
+      m_transmits.push_back(&transmit);
+    }
 
-    if (msg.tx_status & CEC_TX_STATUS_OK)
-      return ADAPTER_MESSAGE_STATE_SENT_ACKED;
+    cec_adapter_message_state state(ADAPTER_MESSAGE_STATE_ERROR);
+    {
+      CLockObject lock(m_mutex);
+      if (!m_transmitCondition.Wait(lock, transmit.bDone, iTimeoutMs))
+        m_transmits.erase(std::remove(m_transmits.begin(), m_transmits.end(), &transmit), m_transmits.end());
 
-    if (msg.tx_status & CEC_TX_STATUS_NACK)
-      return ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED;
+      if (transmit.tx_status & CEC_TX_STATUS_OK)
+      {
+        ++m_stats.tx_ack;
+        state = ADAPTER_MESSAGE_STATE_SENT_ACKED;
+      }
+      else if (transmit.tx_status & CEC_TX_STATUS_NACK)
+      {
+        ++m_stats.tx_nack;
+        state = ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED;
+      }
+      else
+        ++m_stats.tx_error;
+    }
 
-    return ADAPTER_MESSAGE_STATE_ERROR;
+    // a <Feature Abort> for the request also comes with CEC_RX_STATUS_OK
+    if (msg.reply)
+      reply->bReceived = (transmit.rx_status & CEC_RX_STATUS_OK) && !(transmit.rx_status & CEC_RX_STATUS_FEATURE_ABORT);
+
+    if (!transmit.bDone)
+      LIB_CEC->AddLog(CEC_LOG_ERROR, "CLinuxCECAdapterCommunication::Write - CEC_TRANSMIT timed out - sequence=%u", msg.sequence);
+    else
+      LIB_CEC->AddLog(CEC_LOG_DEBUG, "CLinuxCECAdapterCommunication::Write - CEC_TRANSMIT - sequence=%u tx_status=%02x rx_status=%02x len=%d addr=%02x opcode=%02x reply=%02x", msg.sequence, transmit.tx_status, transmit.rx_status, msg.len, msg.msg[0], cec_msg_opcode(&msg), msg.reply);
+
+    return state;
   }
 
   return ADAPTER_MESSAGE_STATE_UNKNOWN;
 }
 
+// The clock that the kernel timestamps frames and events with
+static uint64_t GetMonotonicNs(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+// Fill in entry iIndex of log_addrs for a logical address. The kernel picks
+// the address by its type, but tries the one that's in log_addr[] first
+static void SetLogAddrEntry(struct cec_log_addrs &log_addrs, uint8_t iIndex, cec_logical_address address)
+{
+  log_addrs.log_addr[iIndex] = (uint8_t)address;
+
+  switch (address)
+  {
+    case CECDEVICE_AUDIOSYSTEM:
+      log_addrs.primary_device_type[iIndex] = CEC_OP_PRIM_DEVTYPE_AUDIOSYSTEM;
+      log_addrs.log_addr_type[iIndex] = CEC_LOG_ADDR_TYPE_AUDIOSYSTEM;
+      log_addrs.all_device_types[iIndex] = CEC_OP_ALL_DEVTYPE_AUDIOSYSTEM;
+      break;
+    case CECDEVICE_PLAYBACKDEVICE1:
+    case CECDEVICE_PLAYBACKDEVICE2:
+    case CECDEVICE_PLAYBACKDEVICE3:
+      log_addrs.primary_device_type[iIndex] = CEC_OP_PRIM_DEVTYPE_PLAYBACK;
+      log_addrs.log_addr_type[iIndex] = CEC_LOG_ADDR_TYPE_PLAYBACK;
+      log_addrs.all_device_types[iIndex] = CEC_OP_ALL_DEVTYPE_PLAYBACK;
+      break;
+    case CECDEVICE_RECORDINGDEVICE1:
+    case CECDEVICE_RECORDINGDEVICE2:
+    case CECDEVICE_RECORDINGDEVICE3:
+      log_addrs.primary_device_type[iIndex] = CEC_OP_PRIM_DEVTYPE_RECORD;
+      log_addrs.log_addr_type[iIndex] = CEC_LOG_ADDR_TYPE_RECORD;
+      log_addrs.all_device_types[iIndex] = CEC_OP_ALL_DEVTYPE_RECORD;
+      break;
+    case CECDEVICE_TUNER1:
+    case CECDEVICE_TUNER2:
+    case CECDEVICE_TUNER3:
+    case CECDEVICE_TUNER4:
+      log_addrs.primary_device_type[iIndex] = CEC_OP_PRIM_DEVTYPE_TUNER;
+      log_addrs.log_addr_type[iIndex] = CEC_LOG_ADDR_TYPE_TUNER;
+      log_addrs.all_device_types[iIndex] = CEC_OP_ALL_DEVTYPE_TUNER;
+      break;
+    case CECDEVICE_TV:
+      log_addrs.primary_device_type[iIndex] = CEC_OP_PRIM_DEVTYPE_TV;
+      log_addrs.log_addr_type[iIndex] = CEC_LOG_ADDR_TYPE_TV;
+      log_addrs.all_device_types[iIndex] = CEC_OP_ALL_DEVTYPE_TV;
+      break;
+    default:
+      log_addrs.primary_device_type[iIndex] = CEC_OP_PRIM_DEVTYPE_SWITCH;
+      log_addrs.log_addr_type[iIndex] = CEC_LOG_ADDR_TYPE_UNREGISTERED;
+      log_addrs.all_device_types[iIndex] = CEC_OP_ALL_DEVTYPE_SWITCH;
+      break;
+  }
+}
+
 bool CLinuxCECAdapterCommunication::SetLogicalAddresses(const cec_logical_addresses &addresses)
 {
   if (IsOpen())
@@ -295,11 +454,17 @@ bool CLinuxCECAdapterCommunication::SetLogicalAddresses(const cec_logical_addres
 
     // TODO: Claiming a logical address will only work when CEC device has a valid physical address
 
+    {
+      // the state changes that the reconfiguration causes aren't addresses that were lost
+      CLockObject lock(m_mutex);
+      m_claimedMask = 0;
+    }
+
     // Clear existing logical addresses and set the CEC device to the unconfigured state
     if (log_addrs.num_log_addrs)
     {
       log_addrs = {};
-      if (ioctl(m_fd, CEC_ADAP_S_LOG_ADDRS, &log_addrs))
+      if (SetLogAddrs(&log_addrs))
       {
         LIB_CEC->AddLog(CEC_LOG_ERROR, "CLinuxCECAdapterCommunication::SetLogicalAddresses - ioctl CEC_ADAP_S_LOG_ADDRS failed - errno=%d", errno);
         return false;
@@ -315,55 +480,38 @@ bool CLinuxCECAdapterCommunication::SetLogicalAddresses(const cec_logical_addres
       log_addrs.cec_version = CEC_OP_CEC_VERSION_1_4;
       log_addrs.vendor_id = GetConfiguredVendorId(m_callback);
 
-      // TODO: Support more then the primary logical address
-      log_addrs.num_log_addrs = 1;
-      log_addrs.log_addr[0] = addresses.primary;
-
-      switch (addresses.primary)
+      // claim all addresses at once, the primary one first. the kernel takes
+      // each address type once, an unregistered address only on its own, and
+      // no more addresses than the adapter supports
+      uint8_t iTypes(0);
+      log_addrs.num_log_addrs = 0;
+      for (int iPtr = -1; iPtr < (int)CECDEVICE_BROADCAST; iPtr++)
       {
-        case CECDEVICE_AUDIOSYSTEM:
-          log_addrs.primary_device_type[0] = CEC_OP_PRIM_DEVTYPE_AUDIOSYSTEM;
-          log_addrs.log_addr_type[0] = CEC_LOG_ADDR_TYPE_AUDIOSYSTEM;
-          log_addrs.all_device_types[0] = CEC_OP_ALL_DEVTYPE_AUDIOSYSTEM;
-          break;
-        case CECDEVICE_PLAYBACKDEVICE1:
-        case CECDEVICE_PLAYBACKDEVICE2:
-        case CECDEVICE_PLAYBACKDEVICE3:
-          log_addrs.primary_device_type[0] = CEC_OP_PRIM_DEVTYPE_PLAYBACK;
-          log_addrs.log_addr_type[0] = CEC_LOG_ADDR_TYPE_PLAYBACK;
-          log_addrs.all_device_types[0] = CEC_OP_ALL_DEVTYPE_PLAYBACK;
-          break;
-        case CECDEVICE_RECORDINGDEVICE1:
-        case CECDEVICE_RECORDINGDEVICE2:
-        case CECDEVICE_RECORDINGDEVICE3:
-          log_addrs.primary_device_type[0] = CEC_OP_PRIM_DEVTYPE_RECORD;
-          log_addrs.log_addr_type[0] = CEC_LOG_ADDR_TYPE_RECORD;
-          log_addrs.all_device_types[0] = CEC_OP_ALL_DEVTYPE_RECORD;
-          break;
-        case CECDEVICE_TUNER1:
-        case CECDEVICE_TUNER2:
-        case CECDEVICE_TUNER3:
-        case CECDEVICE_TUNER4:
-          log_addrs.primary_device_type[0] = CEC_OP_PRIM_DEVTYPE_TUNER;
-          log_addrs.log_addr_type[0] = CEC_LOG_ADDR_TYPE_TUNER;
-          log_addrs.all_device_types[0] = CEC_OP_ALL_DEVTYPE_TUNER;
-          break;
-        case CECDEVICE_TV:
-          log_addrs.primary_device_type[0] = CEC_OP_PRIM_DEVTYPE_TV;
-          log_addrs.log_addr_type[0] = CEC_LOG_ADDR_TYPE_TV;
-          log_addrs.all_device_types[0] = CEC_OP_ALL_DEVTYPE_TV;
-          break;
-        default:
-          log_addrs.primary_device_type[0] = CEC_OP_PRIM_DEVTYPE_SWITCH;
-          log_addrs.log_addr_type[0] = CEC_LOG_ADDR_TYPE_UNREGISTERED;
-          log_addrs.all_device_types[0] = CEC_OP_ALL_DEVTYPE_SWITCH;
-          break;
+        cec_logical_address address(iPtr < 0 ? addresses.primary : (cec_logical_address)iPtr);
+        if ((iPtr >= 0 && (address == addresses.primary || !addresses.IsSet(address))) ||
+            address >= CECDEVICE_BROADCAST)
+          continue;
+
+        uint8_t iIndex(log_addrs.num_log_addrs);
+        SetLogAddrEntry(log_addrs, iIndex, address);
+
+        const uint8_t iType(log_addrs.log_addr_type[iIndex]);
+        if (iIndex >= m_iAvailableLogAddrs ||
+            (iTypes & (1 << iType)) ||
+            (iIndex > 0 && iType == CEC_LOG_ADDR_TYPE_UNREGISTERED))
+        {
+          LIB_CEC->AddLog(CEC_LOG_WARNING, "CLinuxCECAdapterCommunication::SetLogicalAddresses - can't claim logical address %x together with the others", address);
+          continue;
+        }
+
+        iTypes |= (uint8_t)(1 << iType);
+        log_addrs.num_log_addrs++;
       }
     }
     else
       log_addrs.num_log_addrs = 0;
 
-    if (ioctl(m_fd, CEC_ADAP_S_LOG_ADDRS, &log_addrs))
+    if (SetLogAddrs(&log_addrs))
     {
       LIB_CEC->AddLog(CEC_LOG_ERROR, "CLinuxCECAdapterCommunication::SetLogicalAddresses - ioctl CEC_ADAP_S_LOG_ADDRS failed - errno=%d", errno);
       return false;
@@ -374,12 +522,87 @@ bool CLinuxCECAdapterCommunication::SetLogicalAddresses(const cec_logical_addres
     if (log_addrs.num_log_addrs && !log_addrs.log_addr_mask)
         return false;
 
+    {
+      // state changes from before this moment describe the old configuration
+      CLockObject lock(m_mutex);
+      m_claimedMask = log_addrs.log_addr_mask;
+      m_claimedPrimary = log_addrs.num_log_addrs && log_addrs.log_addr[0] < CECDEVICE_BROADCAST ?
+          (cec_logical_address)log_addrs.log_addr[0] :
+          CECDEVICE_UNKNOWN;
+      m_iClaimedTs = GetMonotonicNs();
+    }
+
     return true;
   }
 
   return false;
 }
 
+int CLinuxCECAdapterCommunication::SetLogAddrs(struct cec_log_addrs *log_addrs)
+{
+  {
+    // events from before this moment describe an earlier configuration
+    CLockObject lock(m_mutex);
+    m_bLogAddrsDone = false;
+    m_iLogAddrsTs = GetMonotonicNs();
+  }
+
+  if (ioctl(m_fd, CEC_ADAP_S_LOG_ADDRS, log_addrs))
+    return -1;
+
+  // clearing the addresses is done before the ioctl returns, and without a
+  // valid physical address the kernel doesn't start claiming until it gets one
+  uint16_t addr(CEC_PHYS_ADDR_INVALID);
+  if (!log_addrs->num_log_addrs ||
+      ioctl(m_fd, CEC_ADAP_G_PHYS_ADDR, &addr) ||
+      addr == CEC_PHYS_ADDR_INVALID)
+    return 0;
+
+  CTimeout timeout(CEC_LINUX_CONFIGURE_TIMEOUT_MS);
+  bool bDone(false);
+  if (ReadsOwnEvents())
+  {
+    while (!bDone && timeout.TimeLeft() > 0)
+    {
+      struct pollfd fd;
+      fd.fd      = m_fd;
+      fd.events  = POLLPRI;
+      fd.revents = 0;
+      if (poll(&fd, 1, (int)timeout.TimeLeft()) < 0 && errno != EINTR)
+        break;
+
+      if ((fd.revents & POLLPRI) && !ReadEvents())
+        return -1;
+
+      CLockObject lock(m_mutex);
+      bDone = m_bLogAddrsDone;
+    }
+  }
+  else
+  {
+    CLockObject lock(m_mutex);
+    bDone = m_logAddrsCondition.Wait(lock, m_bLogAddrsDone, CEC_LINUX_CONFIGURE_TIMEOUT_MS);
+  }
+
+  if (!bDone)
+    LIB_CEC->AddLog(CEC_LOG_WARNING, "CLinuxCECAdapterCommunication::SetLogAddrs - the kernel didn't finish claiming logical addresses in time");
+
+  // report what was claimed, like the ioctl does on a blocking fd
+  return m_fd != INVALID_SOCKET_VALUE ?
+      ioctl(m_fd, CEC_ADAP_G_LOG_ADDRS, log_addrs) :
+      -1;
+}
+
+bool CLinuxCECAdapterCommunication::ReadsOwnEvents(void)
+{
+  if (!IsRunning())
+    return true;
+
+  // Process() reports address changes to the client, which reconfigures from that thread
+  CLockObject lock(m_mutex);
+  return m_processThread == std::this_thread::get_id();
+}
+
 cec_logical_addresses CLinuxCECAdapterCommunication::GetLogicalAddresses(void) const
 {
   cec_logical_addresses addresses;
@@ -394,8 +617,10 @@ cec_logical_addresses CLinuxCECAdapterCommunication::GetLogicalAddresses(void) c
       return addresses;
     }
 
+    // entries that the kernel couldn't claim are CEC_LOG_ADDR_INVALID
     for (int i = 0; i < log_addrs.num_log_addrs; i++)
-      addresses.Set(cec_logical_address(log_addrs.log_addr[i]));
+      if (log_addrs.log_addr[i] < CECDEVICE_BROADCAST)
+        addresses.Set(cec_logical_address(log_addrs.log_addr[i]));
   }
 
   return addresses;
@@ -441,6 +666,7 @@ bool CLinuxCECAdapterCommunication::DeviceGone(int err)
   LIB_CEC->AddLog(CEC_LOG_NOTICE, "CLinuxCECAdapterCommunication::Process - device removed - m_fd=%d", m_fd);
   close(m_fd);
   m_fd = INVALID_SOCKET_VALUE;
+  AbortTransmits();
 
   // notify the client so it reconnects (and rescans /dev/cec*, since the node
   // may reappear at a different minor). Mirrors the Pulse-Eight USB backend,
@@ -453,100 +679,288 @@ bool CLinuxCECAdapterCommunication::DeviceGone(int err)
   return true;
 }
 
-void *CLinuxCECAdapterCommunication::Process(void)
+#if CEC_LIB_VERSION_MAJOR >= 5
+bool CLinuxCECAdapterCommunication::GetStats(struct cec_adapter_stats* stats)
 {
-  CTimeout phys_addr_timeout;
-  bool phys_addr_changed = false;
-  uint16_t phys_addr = CEC_INVALID_PHYSICAL_ADDRESS;
-  fd_set rd_fds;
-  fd_set ex_fds;
+  CLockObject lock(m_mutex);
+  memcpy(stats, &m_stats, sizeof(struct cec_adapter_stats));
+  return true;
+}
+#endif
 
-  while (!IsStopped())
+bool CLinuxCECAdapterCommunication::GetCounters(cec_adapter_counters* counters)
+{
+  CLockObject lock(m_mutex);
+  memcpy(counters, &m_counters, sizeof(cec_adapter_counters));
+  return true;
+}
+
+void CLinuxCECAdapterCommunication::CompleteTransmit(uint32_t sequence, uint8_t tx_status, uint8_t rx_status)
+{
+  CLockObject lock(m_mutex);
+  for (std::vector<linux_cec_transmit *>::iterator it = m_transmits.begin(); it != m_transmits.end(); ++it)
   {
-    struct timeval timeval = {};
-    timeval.tv_sec = 1;
+    if ((*it)->sequence == sequence)
+    {
+      (*it)->tx_status = tx_status;
+      (*it)->rx_status = rx_status;
+      (*it)->bDone     = true;
+      m_transmits.erase(it);
+      m_transmitCondition.Broadcast();
+      return;
+    }
+  }
+}
+
+void CLinuxCECAdapterCommunication::AbortTransmits(void)
+{
+  CLockObject lock(m_mutex);
+  for (std::vector<linux_cec_transmit *>::iterator it = m_transmits.begin(); it != m_transmits.end(); ++it)
+  {
+    (*it)->tx_status = CEC_TX_STATUS_ERROR;
+    (*it)->bDone     = true;
+  }
+  m_transmits.clear();
+  m_transmitCondition.Broadcast();
+
+  m_bLogAddrsDone = true;
+  m_logAddrsCondition.Broadcast();
+}
 
-    FD_ZERO(&rd_fds);
-    FD_ZERO(&ex_fds);
-    FD_SET(m_fd, &rd_fds);
-    FD_SET(m_fd, &ex_fds);
+void CLinuxCECAdapterCommunication::Interrupt(void)
+{
+  uint64_t iValue(1);
+  if (m_wakeup >= 0 && write(m_wakeup, &iValue, sizeof(iValue)) < 0) {} // a full counter is still a pending wakeup
+}
 
-    if (select(m_fd + 1, &rd_fds, NULL, &ex_fds, &timeval) < 0)
+bool CLinuxCECAdapterCommunication::ReadEvents(void)
+{
+  // not stopped by IsStopped(): SetLogAddrs() reads events before Process() runs
+  for (;;)
+  {
+    struct cec_event ev = {};
+    if (ioctl(m_fd, CEC_DQEVENT, &ev))
     {
       int err = errno;
-      LIB_CEC->AddLog(CEC_LOG_ERROR, "CLinuxCECAdapterCommunication::Process - select failed - errno=%d", err);
-      DeviceGone(err);
-      break;
+      if (err == EAGAIN)
+        return true;
+
+      LIB_CEC->AddLog(CEC_LOG_ERROR, "CLinuxCECAdapterCommunication::Process - ioctl CEC_DQEVENT failed - errno=%d", err);
+      return !DeviceGone(err);
     }
 
-    if (FD_ISSET(m_fd, &ex_fds))
+    if (ev.event == CEC_EVENT_STATE_CHANGE)
     {
-      struct cec_event ev = {};
-      if (ioctl(m_fd, CEC_DQEVENT, &ev))
+      LIB_CEC->AddLog(CEC_LOG_DEBUG, "CLinuxCECAdapterCommunication::Process - CEC_DQEVENT - CEC_EVENT_STATE_CHANGE - log_addr_mask=%04x phys_addr=%04x", ev.state_change.log_addr_mask, ev.state_change.phys_addr);
+
       {
-        int err = errno;
-        LIB_CEC->AddLog(CEC_LOG_ERROR, "CLinuxCECAdapterCommunication::Process - ioctl CEC_DQEVENT failed - errno=%d", err);
-        if (DeviceGone(err))
-          break;
+        // the configuration that SetLogAddrs() started finished
+        CLockObject lock(m_mutex);
+        if (!m_bLogAddrsDone && ev.ts >= m_iLogAddrsTs)
+        {
+          m_bLogAddrsDone = true;
+          m_logAddrsCondition.Broadcast();
+        }
       }
-      else if (ev.event == CEC_EVENT_STATE_CHANGE)
-      {
-        LIB_CEC->AddLog(CEC_LOG_DEBUG, "CLinuxCECAdapterCommunication::Process - CEC_DQEVENT - CEC_EVENT_STATE_CHANGE - log_addr_mask=%04x phys_addr=%04x", ev.state_change.log_addr_mask, ev.state_change.phys_addr);
 
-        // TODO: handle ev.state_change.log_addr_mask change
+      HandleLogicalAddressChange(ev);
 
-        phys_addr = ev.state_change.phys_addr;
-        phys_addr_changed = true;
+      m_physAddr = ev.state_change.phys_addr;
+      m_bPhysAddrChanged = true;
 
-        if (ev.state_change.phys_addr == CEC_PHYS_ADDR_INVALID)
-        {
-          // Debounce change to invalid physical address with 2 seconds because
-          // EDID refresh and other events may cause short periods of invalid physical address
-          phys_addr_timeout.Init(2000);
-        }
-        else
-        {
-          // Debounce change to valid physical address with 500 ms when no logical address have been claimed
-          phys_addr_timeout.Init(ev.state_change.log_addr_mask ? 0 : 500);
-        }
+      if (ev.state_change.phys_addr == CEC_PHYS_ADDR_INVALID)
+      {
+        // Debounce change to invalid physical address with 2 seconds because
+        // EDID refresh and other events may cause short periods of invalid physical address
+        m_physAddrTimeout.Init(2000);
       }
+      else
+      {
+        // Debounce change to valid physical address with 500 ms when no logical address have been claimed
+        m_physAddrTimeout.Init(ev.state_change.log_addr_mask ? 0 : 500);
+      }
+    }
+    else if (ev.event == CEC_EVENT_LOST_MSGS)
+    {
+      // our message queue in the kernel overflowed, and it dropped the oldest frames
+      LIB_CEC->AddLog(CEC_LOG_WARNING, "CLinuxCECAdapterCommunication::Process - CEC_DQEVENT - CEC_EVENT_LOST_MSGS - lost_msgs=%u", ev.lost_msgs.lost_msgs);
+
+      CLockObject lock(m_mutex);
+      m_counters.rx_lost += ev.lost_msgs.lost_msgs;
     }
+  }
 
-    if (phys_addr_changed && !phys_addr_timeout.TimeLeft() && !IsStopped())
+  return true;
+}
+
+void CLinuxCECAdapterCommunication::HandleLogicalAddressChange(const struct cec_event &ev)
+{
+  // an empty mask means that the kernel is (re)configuring, eg. after the
+  // physical address changed, and it reports the claimed addresses after that.
+  // addresses that are missing then were taken by another device
+  cec_logical_address lost(CECDEVICE_UNKNOWN);
+  {
+    CLockObject lock(m_mutex);
+    const uint16_t iLostMask = m_claimedMask & ~ev.state_change.log_addr_mask;
+    if (!ev.state_change.log_addr_mask || !iLostMask || ev.ts < m_iClaimedTs)
+      return;
+
+    // the client reallocates all of its addresses, so report one: the primary one when it's lost
+    if (m_claimedPrimary != CECDEVICE_UNKNOWN && (iLostMask & (1 << m_claimedPrimary)))
+      lost = m_claimedPrimary;
+    else
     {
-      phys_addr_changed = false;
-      m_callback->HandlePhysicalAddressChanged(phys_addr);
+      for (uint8_t iPtr = CECDEVICE_TV; iPtr < CECDEVICE_BROADCAST && lost == CECDEVICE_UNKNOWN; iPtr++)
+        if (iLostMask & (1 << iPtr))
+          lost = (cec_logical_address)iPtr;
     }
 
-    if (FD_ISSET(m_fd, &rd_fds))
+    m_claimedMask = ev.state_change.log_addr_mask;
+  }
+
+  LIB_CEC->AddLog(CEC_LOG_NOTICE, "CLinuxCECAdapterCommunication::Process - logical address %x lost - log_addr_mask=%04x", lost, ev.state_change.log_addr_mask);
+  if (!IsStopped())
+    m_callback->HandleLogicalAddressLost(lost);
+}
+
+void CLinuxCECAdapterCommunication::Deliver(const struct cec_msg &msg)
+{
+  LIB_CEC->AddLog(CEC_LOG_DEBUG, "CLinuxCECAdapterCommunication::Process - ioctl CEC_RECEIVE - rx_status=%02x len=%d addr=%02x opcode=%02x", msg.rx_status, msg.len, msg.msg[0], cec_msg_opcode(&msg));
+
+  cec_command cmd;
+  // msg.len comes from the kernel; clamp it so a bogus length can never
+  // make PushArray read past the msg buffer
+  cmd.PushArray(msg.len > sizeof(msg.msg) ? sizeof(msg.msg) : msg.len, msg.msg);
+
+  {
+    // rx_ts is the time at which the kernel received the frame
+    int64_t iLatencyUs = msg.rx_ts ?
+        ((int64_t)GetMonotonicNs() - (int64_t)msg.rx_ts) / 1000 :
+        0;
+
+    CLockObject lock(m_mutex);
+    ++m_stats.rx_total;
+    if (iLatencyUs > 0)
     {
-      struct cec_msg msg = {};
-      if (ioctl(m_fd, CEC_RECEIVE, &msg))
-      {
-        int err = errno;
-        LIB_CEC->AddLog(CEC_LOG_ERROR, "CLinuxCECAdapterCommunication::Process - ioctl CEC_RECEIVE failed - rx_status=%02x errno=%d", msg.rx_status, err);
-        if (DeviceGone(err))
-          break;
-      }
-      else if (msg.len > 0)
-      {
-        LIB_CEC->AddLog(CEC_LOG_DEBUG, "CLinuxCECAdapterCommunication::Process - ioctl CEC_RECEIVE - rx_status=%02x len=%d addr=%02x opcode=%02x", msg.rx_status, msg.len, msg.msg[0], cec_msg_opcode(&msg));
+      ++m_counters.rx_latency_count;
+      m_counters.rx_latency_total_us += (uint64_t)iLatencyUs;
+      if ((uint64_t)iLatencyUs > m_counters.rx_latency_max_us)
+        m_counters.rx_latency_max_us = (uint32_t)iLatencyUs;
+    }
+  }
 
-        cec_command cmd;
-        // msg.len comes from the kernel; clamp it so a bogus length can never
-        // make PushArray read past the msg buffer
-        cmd.PushArray(msg.len > sizeof(msg.msg) ? sizeof(msg.msg) : msg.len, msg.msg);
+  if (!IsStopped())
+    m_callback->OnCommandReceived(cmd);
+}
 
-        if (!IsStopped())
-          m_callback->OnCommandReceived(cmd);
-      }
+bool CLinuxCECAdapterCommunication::ReadMessages(void)
+{
+  while (!IsStopped())
+  {
+    struct cec_msg msg = {};
+    if (ioctl(m_fd, CEC_RECEIVE, &msg))
+    {
+      int err = errno;
+      if (err == EAGAIN)
+        return true;
+
+      LIB_CEC->AddLog(CEC_LOG_ERROR, "CLinuxCECAdapterCommunication::Process - ioctl CEC_RECEIVE failed - rx_status=%02x errno=%d", msg.rx_status, err);
+      if (DeviceGone(err))
+        return false;
+
+      CLockObject lock(m_mutex);
+      ++m_stats.rx_error;
+      return true;
+    }
+
+    // the kernel only sets a sequence number on the result of one of our own
+    // transmits. when we asked for a reply, the result carries it too: pass it
+    // on before the transmit completes, so it's processed like any other frame
+    if (msg.sequence)
+    {
+      if ((msg.rx_status & CEC_RX_STATUS_OK) && msg.len > 0)
+        Deliver(msg);
+      CompleteTransmit(msg.sequence, msg.tx_status, msg.rx_status);
+      continue;
+    }
+
+    if (msg.len > 0)
+      Deliver(msg);
+  }
+
+  return true;
+}
+
+void *CLinuxCECAdapterCommunication::Process(void)
+{
+  {
+    CLockObject lock(m_mutex);
+    m_processThread = std::this_thread::get_id();
+  }
+
+  struct pollfd fds[2];
+
+  while (!IsStopped())
+  {
+    fds[0].fd      = m_fd;
+    fds[0].events  = POLLIN | POLLPRI;
+    fds[0].revents = 0;
+    fds[1].fd      = m_wakeup;
+    fds[1].events  = POLLIN;
+    fds[1].revents = 0;
+
+    // sleep until there's something to read, we're woken up, or a physical
+    // address change has been debounced. without a wakeup descriptor, poll
+    // for the stop flag instead
+    int iTimeoutMs = m_bPhysAddrChanged ? (int)m_physAddrTimeout.TimeLeft() : -1;
+    if (m_wakeup < 0 && (iTimeoutMs < 0 || iTimeoutMs > 1000))
+      iTimeoutMs = 1000;
+
+    if (poll(fds, m_wakeup >= 0 ? 2 : 1, iTimeoutMs) < 0)
+    {
+      int err = errno;
+      if (err == EINTR)
+        continue;
+
+      LIB_CEC->AddLog(CEC_LOG_ERROR, "CLinuxCECAdapterCommunication::Process - poll failed - errno=%d", err);
+      DeviceGone(err);
+      break;
+    }
+
+    if (fds[1].revents & POLLIN)
+    {
+      uint64_t iValue;
+      while (read(m_wakeup, &iValue, sizeof(iValue)) > 0) {}
     }
 
-    if (!IsStopped())
-      Sleep(5);
+    if (IsStopped())
+      break;
+
+    // drain everything that's queued, rather than one event and one frame per wakeup
+    if ((fds[0].revents & POLLPRI) && !ReadEvents())
+      break;
+
+    if ((fds[0].revents & POLLIN) && !ReadMessages())
+      break;
+
+    if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL))
+    {
+      LIB_CEC->AddLog(CEC_LOG_ERROR, "CLinuxCECAdapterCommunication::Process - poll reported an error - revents=%04x", fds[0].revents);
+      if (DeviceGone((fds[0].revents & POLLNVAL) ? EBADF : ENODEV))
+        break;
+    }
+
+    if (m_bPhysAddrChanged && !m_physAddrTimeout.TimeLeft() && !IsStopped())
+    {
+      m_bPhysAddrChanged = false;
+      m_callback->HandlePhysicalAddressChanged(m_physAddr);
+    }
   }
 
   LIB_CEC->AddLog(CEC_LOG_DEBUG, "CLinuxCECAdapterCommunication::Process - stopped - m_fd=%d", m_fd);
+
+  CLockObject lock(m_mutex);
+  m_processThread = std::thread::id();
   return 0;
 }
 
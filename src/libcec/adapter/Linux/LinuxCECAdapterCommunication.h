@@ -39,12 +39,31 @@
 
 #if defined(HAVE_LINUX_API)
 #include <string>
+#include <thread>
 #include <vector>
+#include "platform/threads/mutex.h"
 #include "platform/threads/threads.h"
+#include "platform/util/timeutils.h"
 #include "../AdapterCommunication.h"
 
+// from <linux/cec.h>
+struct cec_event;
+struct cec_log_addrs;
+struct cec_msg;
+
 namespace CEC
 {
+  /*!
+   * @brief A transmit that was queued in the kernel and that is waiting for its result.
+   */
+  struct linux_cec_transmit
+  {
+    uint32_t sequence;  /**< the sequence number that the kernel assigned to the transmit */
+    uint8_t  tx_status; /**< the kernel's CEC_TX_STATUS_* flags, once the transmit completed */
+    uint8_t  rx_status; /**< the kernel's CEC_RX_STATUS_* flags for the reply, when one was requested */
+    bool     bDone;     /**< true when the transmit completed or was aborted */
+  };
+
   class CLinuxCECAdapterCommunication : public IAdapterCommunication, public CThread
   {
   public:
@@ -85,6 +104,9 @@ namespace CEC
     void Close(void) override;
     bool IsOpen(void) override;
     cec_adapter_message_state Write(const cec_command &data, bool &bRetry, uint8_t iLineTimeout, bool bIsReply) override;
+    uint8_t GetMaxPendingTransmits(void) const override { return 3; }
+    bool SupportsReplyMatching(void) const override { return true; }
+    cec_adapter_message_state WriteRequest(const cec_command &data, bool &bRetry, uint8_t iLineTimeout, cec_transmit_reply &reply) override;
 
     bool SetLineTimeout(uint8_t UNUSED(iTimeout)) override { return true; }
     bool StartBootloader(void) override { return false; }
@@ -107,8 +129,9 @@ namespace CEC
     uint16_t GetAdapterProductId(void) const override { return 1; }
     void SetActiveSource(bool UNUSED(bSetTo), bool UNUSED(bClientUnregistered)) override {}
 #if CEC_LIB_VERSION_MAJOR >= 5
-    bool GetStats(struct cec_adapter_stats* UNUSED(stats)) override { return false; }
+    bool GetStats(struct cec_adapter_stats* stats) override;
 #endif
+    bool GetCounters(cec_adapter_counters* counters) override;
     ///}
 
     /** @name CThread implementation */
@@ -120,13 +143,93 @@ namespace CEC
     /*!
      * @brief Release the fd and mark the adapter closed when an ioctl reports
      *        that the device node has been removed (adapter unregistered).
-     * @param err The errno captured from the failing ioctl/select call.
+     * @param err The errno captured from the failing ioctl/poll call.
      * @return True when the device was gone and the fd has been released.
      */
     bool DeviceGone(int err);
 
-    int         m_fd;
-    std::string m_path;
+    /*!
+     * @brief Dequeue every pending event until the kernel reports EAGAIN.
+     *        Only called by Process(), or while Process() isn't running.
+     * @return False when the device is gone.
+     */
+    bool ReadEvents(void);
+
+    /*!
+     * @brief Dequeue every pending frame and transmit result until the kernel reports EAGAIN.
+     * @return False when the device is gone.
+     */
+    bool ReadMessages(void);
+
+    /*!
+     * @brief Configure the logical addresses with CEC_ADAP_S_LOG_ADDRS, and wait
+     *        until the kernel claimed them. m_fd is non-blocking, so the ioctl
+     *        returns before the claim finished, and the kernel reports the end of
+     *        it with a state change event.
+     * @param log_addrs The addresses to claim. Filled in with the claimed ones.
+     * @return The result of the ioctl, with errno set when it failed.
+     */
+    int SetLogAddrs(struct cec_log_addrs *log_addrs);
+
+    /*!
+     * @return True when events have to be read by the caller of SetLogAddrs(),
+     *         because Process() isn't running, or because it is the caller.
+     */
+    bool ReadsOwnEvents(void);
+
+    /*!
+     * @brief Queue a frame in the kernel, and wait until Process() sees its result.
+     * @param data The frame to transmit.
+     * @param reply The reply for the kernel to wait for, or NULL.
+     * @return The state of the transmitted frame.
+     */
+    cec_adapter_message_state Transmit(const cec_command &data, cec_transmit_reply *reply);
+
+    /*!
+     * @brief Report a logical address that was claimed and that the kernel
+     *        no longer holds, because another device took it.
+     */
+    void HandleLogicalAddressChange(const struct cec_event &ev);
+
+    /*!
+     * @brief Pass a received frame on to the processor.
+     */
+    void Deliver(const struct cec_msg &msg);
+
+    /*!
+     * @brief Complete the waiting transmit that the kernel assigned this sequence number.
+     */
+    void CompleteTransmit(uint32_t sequence, uint8_t tx_status, uint8_t rx_status);
+
+    /*!
+     * @brief Fail all waiting transmits, and stop waiting in SetLogAddrs(), because the fd is being closed.
+     */
+    void AbortTransmits(void);
+
+    /*!
+     * @brief Wake up Process() so it sees that it was asked to stop.
+     */
+    void Interrupt(void);
+
+    int                               m_fd;
+    int                               m_wakeup;     /**< eventfd that wakes up Process() */
+    std::string                       m_path;
+    CMutex                            m_mutex;
+    CCondition<bool>                  m_transmitCondition;
+    std::vector<linux_cec_transmit *> m_transmits;  /**< transmits that are waiting for their result */
+    cec_adapter_stats                 m_stats;
+    cec_adapter_counters              m_counters;
+    uint8_t                           m_iAvailableLogAddrs; /**< the number of logical addresses that the adapter can claim at once */
+    uint16_t                          m_claimedMask;        /**< the logical addresses that SetLogicalAddresses() claimed */
+    cec_logical_address               m_claimedPrimary;
+    uint64_t                          m_iClaimedTs;         /**< when they were claimed, in CLOCK_MONOTONIC nanoseconds */
+    CCondition<bool>                  m_logAddrsCondition;
+    bool                              m_bLogAddrsDone;      /**< true when the configuration that SetLogAddrs() waits for finished */
+    uint64_t                          m_iLogAddrsTs;        /**< when SetLogAddrs() started it, in CLOCK_MONOTONIC nanoseconds */
+    std::thread::id                   m_processThread;      /**< the thread that runs Process() */
+    uint16_t                          m_physAddr;           /**< the last physical address that the kernel reported */
+    bool                              m_bPhysAddrChanged;   /**< true while a physical address change is debounced */
+    CTimeout                          m_physAddrTimeout;
   };
 };
 
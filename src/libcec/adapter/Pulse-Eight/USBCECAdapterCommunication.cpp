@@ -47,6 +47,7 @@
 #include "platform/drm/drm-edid.h"
 #include "LibCEC.h"
 #include "CECProcessor.h"
+#include "CECTimerService.h"
 
 using namespace CEC;
 
@@ -70,22 +71,30 @@ CUSBCECAdapterCommunication::CUSBCECAdapterCommunication(IAdapterCommunicationCa
     m_iLineTimeout(0),
     m_lastPollDestination(CECDEVICE_UNKNOWN),
     m_bInitialised(false),
-    m_pingThread(NULL),
-    m_eepromWriteThread(NULL),
+    m_iPingTimer(0),
+    m_iPingFailures(0),
+    m_iEepromWriteTimer(0),
+    m_iLastEepromWrite(0),
+    m_maintenanceThread(NULL),
     m_commands(NULL),
     m_adapterMessageQueue(NULL)
 {
   memset(&m_stats, 0, sizeof(struct cec_adapter_stats));
+  memset(&m_counters, 0, sizeof(cec_adapter_counters));
+  m_counters.version = CEC_ADAPTER_COUNTERS_VERSION;
+  m_counters.size    = sizeof(cec_adapter_counters);
   m_logicalAddresses.Clear();
   for (unsigned int iPtr = CECDEVICE_TV; iPtr < CECDEVICE_BROADCAST; iPtr++)
     m_bWaitingForAck[iPtr] = false;
   m_port = new CSerialPort(strPort, iBaudRate);
   m_commands = new CUSBCECAdapterCommands(this);
+  m_maintenanceThread = new CAdapterMaintenanceThread(this);
 }
 
 CUSBCECAdapterCommunication::~CUSBCECAdapterCommunication(void)
 {
   Close();
+  SafeDelete(m_maintenanceThread);
   SafeDelete(m_commands);
   SafeDelete(m_adapterMessageQueue);
   SafeDelete(m_port);
@@ -175,27 +184,22 @@ bool CUSBCECAdapterCommunication::Open(uint32_t iTimeoutMs /* = CEC_DEFAULT_CONN
   }
   else if (bStartListening)
   {
-    /* start the eeprom write thread, that handles all eeprom writes async */
-    m_eepromWriteThread = new CAdapterEepromWriteThread(this);
-    if (!m_eepromWriteThread->CreateThread())
+    /* the timers only wake up the maintenance thread, that waits for the adapter */
+    if (!m_maintenanceThread->CreateThread())
     {
       bConnectionOpened = false;
-      LIB_CEC->AddLog(CEC_LOG_ERROR, "could not create the eeprom write thread");
+      LIB_CEC->AddLog(CEC_LOG_ERROR, "could not create the maintenance thread");
     }
     else
     {
-      /* start a ping thread, that will ping the adapter every 15 seconds
-         if it doesn't receive any ping for 30 seconds, it'll switch to auto mode */
-      m_pingThread = new CAdapterPingThread(this, CEC_ADAPTER_PING_TIMEOUT);
-      if (m_pingThread->CreateThread())
-      {
-        bConnectionOpened = true;
-      }
-      else
-      {
-        bConnectionOpened = false;
-        LIB_CEC->AddLog(CEC_LOG_ERROR, "could not create a ping thread");
-      }
+      /* ping the adapter every 15 seconds. if it doesn't receive any ping for 30
+         seconds, it'll switch to auto mode */
+      m_iPingFailures = 0;
+      m_iPingTimer = LIB_CEC->GetTimers()->Schedule(CEC_ADAPTER_PING_TIMEOUT, [this]() {
+        m_maintenanceThread->Ping();
+        return (uint32_t)CEC_ADAPTER_PING_TIMEOUT;
+      });
+      bConnectionOpened = true;
     }
   }
 
@@ -207,11 +211,28 @@ bool CUSBCECAdapterCommunication::Open(uint32_t iTimeoutMs /* = CEC_DEFAULT_CONN
 
 void CUSBCECAdapterCommunication::Close(void)
 {
+  /* stop the maintenance thread first, so it doesn't schedule a retry after the
+     timers were stopped. a queued write is committed below */
+  m_maintenanceThread->Stop();
+  uint64_t iEepromWriteTimer(0);
+  {
+    CLockObject lock(m_eepromMutex);
+    iEepromWriteTimer = m_iEepromWriteTimer;
+    m_iEepromWriteTimer = 0;
+  }
+  LIB_CEC->GetTimers()->Cancel(iEepromWriteTimer);
+  LIB_CEC->GetTimers()->Cancel(m_iPingTimer);
+  m_iPingTimer = 0;
+
   /* commit any deferred eeprom write before IsOpen() turns false below */
   if (IsOpen() && m_commands)
     m_commands->WriteEEPROM();
 
-  /* stop the reader thread */
+  /* stop the reader thread. it waits for data without a timeout, so wake it up
+     after it was told to stop */
+  StopThread(-1);
+  if (m_port)
+    m_port->Interrupt();
   StopThread(0);
 
   CLockObject lock(m_mutex);
@@ -232,14 +253,6 @@ void CUSBCECAdapterCommunication::Close(void)
   if (m_adapterMessageQueue)
     m_adapterMessageQueue->Clear();
 
-  /* stop and delete the write thread */
-  if (m_eepromWriteThread)
-    m_eepromWriteThread->Stop();
-  SafeDelete(m_eepromWriteThread);
-
-  /* stop and delete the ping thread */
-  SafeDelete(m_pingThread);
-
   /* close and delete the com port connection */
   if (m_port)
     m_port->Close();
@@ -251,7 +264,8 @@ cec_adapter_message_state CUSBCECAdapterCommunication::Write(const cec_command &
   if (!IsRunning())
     return retVal;
 
-  CCECAdapterMessage *output = new CCECAdapterMessage(data, iLineTimeout);
+  CCECAdapterMessage *output = m_adapterMessageQueue->AllocateMessage();
+  output->Format(data, iLineTimeout);
   output->bFireAndForget = bIsReply;
 
   /* mark as waiting for an ack from the destination */
@@ -270,7 +284,7 @@ cec_adapter_message_state CUSBCECAdapterCommunication::Write(const cec_command &
       Sleep(CEC_DEFAULT_TRANSMIT_RETRY_WAIT);
     retVal = output->state;
 
-    delete output;
+    m_adapterMessageQueue->ReleaseMessage(output);
   }
   return retVal;
 }
@@ -281,8 +295,17 @@ void *CUSBCECAdapterCommunication::Process(void)
 
   while (!IsStopped())
   {
-    /* read from the serial port */
-    if (!ReadFromDevice(50, 5))
+    /* wait for the adapter to send something. this doesn't hold any lock, so
+       commands can be written while we're waiting. Close() wakes us up */
+    int iWait = m_port->WaitForData(1000);
+    if (IsStopped())
+      break;
+
+    if (iWait < 0)
+      LIB_CEC->AddLog(CEC_LOG_ERROR, "error waiting for the serial port: %s", strerror(-iWait));
+
+    /* and read everything that arrived in one go */
+    if (iWait < 0 || !ReadFromDevice())
     {
       libcec_parameter param;
       param.paramData = NULL; param.paramType = CEC_PARAMETER_TYPE_UNKOWN;
@@ -290,10 +313,6 @@ void *CUSBCECAdapterCommunication::Process(void)
 
       break;
     }
-
-    /* TODO sleep 5 ms so other threads can get a lock */
-    if (!IsStopped())
-      Sleep(5);
   }
 
   m_adapterMessageQueue->Clear();
@@ -402,42 +421,42 @@ bool CUSBCECAdapterCommunication::WriteToDevice(CCECAdapterMessage *message)
   return true;
 }
 
-bool CUSBCECAdapterCommunication::ReadFromDevice(uint32_t iTimeout, size_t iSize /* = 256 */)
+bool CUSBCECAdapterCommunication::ReadFromDevice(void)
 {
-  ssize_t iBytesRead(0);
   uint8_t buff[256];
-  if (iSize > 256)
-    iSize = 256;
 
-  /* read from the serial port */
+  for (;;)
   {
-    CLockObject lock(m_mutex);
-    if (!IsOpen())
-      return false;
+    ssize_t iBytesRead(0);
 
-    do {
-      /* retry Read() if it was interrupted */
-      iBytesRead = m_port->Read(buff, sizeof(uint8_t) * iSize, iTimeout);
-    } while(m_port->GetErrorNumber() == EINTR);
+    /* read from the serial port */
+    {
+      CLockObject lock(m_mutex);
+      if (!IsOpen())
+        return false;
 
+      iBytesRead = m_port->ReadAvailable(buff, sizeof(buff));
 
-    if (m_port->GetErrorNumber())
-    {
-      LIB_CEC->AddLog(CEC_LOG_ERROR, "error reading from serial port: %s", m_port->GetError().c_str());
-      // let the higher level close the port
-      return false;
+      if (m_port->GetErrorNumber())
+      {
+        LIB_CEC->AddLog(CEC_LOG_ERROR, "error reading from serial port: %s", m_port->GetError().c_str());
+        // let the higher level close the port
+        return false;
+      }
     }
-  }
 
-  if (iBytesRead < 0 || iBytesRead > 256)
-    return false;
-  else if (iBytesRead > 0)
-  {
+    if (iBytesRead < 0 || iBytesRead > (ssize_t)sizeof(buff))
+      return false;
+    else if (iBytesRead == 0)
+      return true;
+
     /* add the data to the current frame */
     m_adapterMessageQueue->AddData(buff, iBytesRead);
-  }
 
-  return true;
+    /* a partially filled buffer means that we've drained the port */
+    if (iBytesRead < (ssize_t)sizeof(buff))
+      return true;
+  }
 }
 
 CCECAdapterMessage *CUSBCECAdapterCommunication::SendCommand(cec_adapter_messagecode msgCode, CCECAdapterMessage &params, bool bIsRetry /* = false */)
@@ -446,7 +465,7 @@ CCECAdapterMessage *CUSBCECAdapterCommunication::SendCommand(cec_adapter_message
     return NULL;
 
   /* create the adapter message for this command */
-  CCECAdapterMessage *output = new CCECAdapterMessage;
+  CCECAdapterMessage *output = m_adapterMessageQueue->AllocateMessage();
   output->PushBack(MSGSTART);
   output->PushEscaped((uint8_t)msgCode);
   output->Append(params);
@@ -469,7 +488,7 @@ CCECAdapterMessage *CUSBCECAdapterCommunication::SendCommand(cec_adapter_message
          to set controlled mode, then the controller probably switched to auto mode. set controlled
          mode and retry */
       LIB_CEC->AddLog(CEC_LOG_DEBUG, "setting controlled mode and retrying");
-      delete output;
+      ReleaseMessage(output);
       if (SetControlledMode(true))
         return SendCommand(msgCode, params, true);
       // output is gone, and every caller null checks the result
@@ -480,6 +499,17 @@ CCECAdapterMessage *CUSBCECAdapterCommunication::SendCommand(cec_adapter_message
   return output;
 }
 
+void CUSBCECAdapterCommunication::ReleaseMessage(CCECAdapterMessage *message)
+{
+  if (!message)
+    return;
+
+  if (m_adapterMessageQueue)
+    m_adapterMessageQueue->ReleaseMessage(message);
+  else
+    delete message;
+}
+
 bool CUSBCECAdapterCommunication::CheckAdapter(uint32_t iTimeoutMs /* = CEC_DEFAULT_CONNECT_TIMEOUT */)
 {
   bool bReturn(false);
@@ -657,6 +687,20 @@ bool CUSBCECAdapterCommunication::GetStats(struct cec_adapter_stats* stats)
 }
 #endif
 
+bool CUSBCECAdapterCommunication::GetCounters(cec_adapter_counters* counters)
+{
+  CLockObject lock(m_statsMutex);
+  memcpy(counters, &m_counters, sizeof(cec_adapter_counters));
+  return true;
+}
+
+uint32_t CUSBCECAdapterCommunication::GetWriteQueueSize(void)
+{
+  return m_adapterMessageQueue ?
+      (uint32_t)m_adapterMessageQueue->WriteQueueSize() :
+      0;
+}
+
 bool CUSBCECAdapterCommunication::IsRunningLatestFirmware(void)
 {
   return GetFirmwareBuildDate() >= CEC_LATEST_ADAPTER_FW_DATE &&
@@ -666,14 +710,14 @@ bool CUSBCECAdapterCommunication::IsRunningLatestFirmware(void)
 bool CUSBCECAdapterCommunication::SaveConfiguration(const libcec_configuration &configuration)
 {
   return IsOpen() ?
-      m_commands->SaveConfiguration(configuration) && m_eepromWriteThread->Write() :
+      m_commands->SaveConfiguration(configuration) && ScheduleEepromWrite() :
       false;
 }
 
 bool CUSBCECAdapterCommunication::SetAutoMode(bool automode)
 {
   return IsOpen() ?
-      m_commands->SetSettingAutoEnabled(automode) && m_eepromWriteThread->Write() :
+      m_commands->SetSettingAutoEnabled(automode) && ScheduleEepromWrite() :
       false;
 }
 
@@ -739,10 +783,17 @@ uint16_t CUSBCECAdapterCommunication::GetPhysicalAddress(void)
   return iPA;
 }
 
-void CUSBCECAdapterCommunication::OnRxSuccess(void)
+void CUSBCECAdapterCommunication::OnRxSuccess(int64_t iLatencyUs)
 {
   CLockObject lock(m_statsMutex);
   ++m_stats.rx_total;
+  if (iLatencyUs > 0)
+  {
+    ++m_counters.rx_latency_count;
+    m_counters.rx_latency_total_us += (uint64_t)iLatencyUs;
+    if ((uint64_t)iLatencyUs > m_counters.rx_latency_max_us)
+      m_counters.rx_latency_max_us = (uint32_t)iLatencyUs;
+  }
 }
 
 void CUSBCECAdapterCommunication::OnRxError(void)
@@ -769,107 +820,123 @@ void CUSBCECAdapterCommunication::OnTxError(void)
   ++m_stats.tx_error;
 }
 
-void *CAdapterPingThread::Process(void)
+void CUSBCECAdapterCommunication::OnPing(void)
 {
-  while (!IsStopped())
+  if (PingAdapter())
   {
-    if (m_timeout.TimeLeft() == 0)
-    {
-      /* reinit the timeout */
-      m_timeout.Init(CEC_ADAPTER_PING_TIMEOUT);
+    m_iPingFailures = 0;
+    return;
+  }
 
-      /* send a ping to the adapter */
-      bool bPinged(false);
-      int iFailedCounter(0);
-      while (!bPinged && iFailedCounter < 3 && !IsStopped())
-      {
-        if (!m_com->PingAdapter())
-        {
-          /* sleep and retry */
-          Sleep(CEC_DEFAULT_TRANSMIT_RETRY_WAIT);
-          ++iFailedCounter;
-        }
-        else
-        {
-          bPinged = true;
-        }
-      }
+  /* retry in a bit */
+  if (++m_iPingFailures < 3)
+  {
+    LIB_CEC->GetTimers()->Reschedule(m_iPingTimer, CEC_DEFAULT_TRANSMIT_RETRY_WAIT);
+    return;
+  }
 
-      if (iFailedCounter == 3 && !IsStopped())
-      {
-        /* failed to ping the adapter 3 times in a row. something must be wrong with the connection */
-        m_com->LIB_CEC->AddLog(CEC_LOG_ERROR, "failed to ping the adapter 3 times in a row. closing the connection.");
-        // don't wait for it: the alert below is what tells the client the
-        // connection is gone, and it must not be gated on the read thread dying
-        m_com->StopThread(-1);
+  /* failed to ping the adapter 3 times in a row. something must be wrong with the connection */
+  LIB_CEC->AddLog(CEC_LOG_ERROR, "failed to ping the adapter 3 times in a row. closing the connection.");
+  LIB_CEC->GetTimers()->Cancel(m_iPingTimer);
+  // don't wait for it: the alert below is what tells the client the
+  // connection is gone, and it must not be gated on the read thread dying
+  StopThread(-1);
 
-        libcec_parameter param;
-        param.paramData = NULL; param.paramType = CEC_PARAMETER_TYPE_UNKOWN;
-        m_com->LIB_CEC->Alert(CEC_ALERT_CONNECTION_LOST, param);
+  libcec_parameter param;
+  param.paramData = NULL; param.paramType = CEC_PARAMETER_TYPE_UNKOWN;
+  LIB_CEC->Alert(CEC_ALERT_CONNECTION_LOST, param);
+}
 
-        break;
-      }
-    }
+bool CUSBCECAdapterCommunication::ScheduleEepromWrite(void)
+{
+  CLockObject lock(m_eepromMutex);
+  /* the write that is queued already writes the latest settings */
+  if (m_iEepromWriteTimer != 0)
+    return true;
 
-    Sleep(5);
+  int64_t iNow = GetTimeMs();
+  int64_t iDelay(0);
+  if (m_iLastEepromWrite + CEC_ADAPTER_EEPROM_WRITE_INTERVAL > iNow)
+  {
+    iDelay = m_iLastEepromWrite + CEC_ADAPTER_EEPROM_WRITE_INTERVAL - iNow;
+    LIB_CEC->AddLog(CEC_LOG_DEBUG, "delaying eeprom write by %ld ms", iDelay);
   }
-  return NULL;
+
+  m_iEepromWriteTimer = LIB_CEC->GetTimers()->Schedule((uint32_t)iDelay, [this]() {
+    m_maintenanceThread->WriteEeprom();
+    return (uint32_t)0;
+  });
+  return true;
 }
 
-void CAdapterEepromWriteThread::Stop(void)
+void CUSBCECAdapterCommunication::OnEepromWrite(void)
 {
-  StopThread(-1);
+  /* settings that change while writing queue another write */
   {
-    CLockObject lock(m_mutex);
-    if (m_iScheduleEepromWrite > 0)
-      m_com->LIB_CEC->AddLog(CEC_LOG_WARNING, "write thread stopped while a write was queued");
-    m_bWrite = true;
-    m_condition.Signal();
+    CLockObject lock(m_eepromMutex);
+    m_iEepromWriteTimer = 0;
   }
-  StopThread();
+
+  bool bWritten(m_commands->WriteEEPROM());
+
+  CLockObject lock(m_eepromMutex);
+  if (bWritten)
+    m_iLastEepromWrite = GetTimeMs();
+  else if (m_iEepromWriteTimer == 0)
+    m_iEepromWriteTimer = LIB_CEC->GetTimers()->Schedule(CEC_ADAPTER_EEPROM_WRITE_RETRY, [this]() {
+      m_maintenanceThread->WriteEeprom();
+      return (uint32_t)0;
+    });
 }
 
-void *CAdapterEepromWriteThread::Process(void)
+void CAdapterMaintenanceThread::Ping(void)
 {
-  while (!IsStopped())
+  CLockObject lock(m_mutex);
+  m_bPing = true;
+  m_bSignaled = true;
+  m_condition.Signal();
+}
+
+void CAdapterMaintenanceThread::WriteEeprom(void)
+{
+  CLockObject lock(m_mutex);
+  m_bWriteEeprom = true;
+  m_bSignaled = true;
+  m_condition.Signal();
+}
+
+void CAdapterMaintenanceThread::Stop(void)
+{
+  StopThread(-1);
   {
     CLockObject lock(m_mutex);
-    if ((m_iScheduleEepromWrite > 0 && m_iScheduleEepromWrite < GetTimeMs()) ||
-        m_condition.Wait(lock, m_bWrite, 100))
-    {
-      if (IsStopped())
-        break;
-      m_bWrite = false;
-      if (m_com->m_commands->WriteEEPROM())
-      {
-        m_iLastEepromWrite = GetTimeMs();
-        m_iScheduleEepromWrite = 0;
-      }
-      else
-      {
-        m_iScheduleEepromWrite = GetTimeMs() + CEC_ADAPTER_EEPROM_WRITE_RETRY;
-      }
-    }
+    m_bSignaled = true;
+    m_condition.Signal();
   }
-  return NULL;
+  StopThread(0);
 }
 
-bool CAdapterEepromWriteThread::Write(void)
+void *CAdapterMaintenanceThread::Process(void)
 {
-  CLockObject lock(m_mutex);
-  if (m_iScheduleEepromWrite == 0)
+  while (!IsStopped())
   {
-    int64_t iNow = GetTimeMs();
-    if (m_iLastEepromWrite + CEC_ADAPTER_EEPROM_WRITE_INTERVAL > iNow)
+    bool bPing(false), bWriteEeprom(false);
     {
-      m_com->LIB_CEC->AddLog(CEC_LOG_DEBUG, "delaying eeprom write by %ld ms", m_iLastEepromWrite + CEC_ADAPTER_EEPROM_WRITE_INTERVAL - iNow);
-      m_iScheduleEepromWrite = m_iLastEepromWrite + CEC_ADAPTER_EEPROM_WRITE_INTERVAL;
-    }
-    else
-    {
-      m_bWrite = true;
-      m_condition.Signal();
+      CLockObject lock(m_mutex);
+      m_condition.Wait(lock, m_bSignaled);
+      m_bSignaled = false;
+      bPing = m_bPing;
+      m_bPing = false;
+      bWriteEeprom = m_bWriteEeprom;
+      m_bWriteEeprom = false;
     }
+
+    if (IsStopped())
+      break;
+    if (bWriteEeprom)
+      m_com->OnEepromWrite();
+    if (bPing)
+      m_com->OnPing();
   }
-  return true;
+  return NULL;
 }
@@ -46,8 +46,7 @@ namespace CEC
 namespace CEC
 {
   class CCECProcessor;
-  class CAdapterPingThread;
-  class CAdapterEepromWriteThread;
+  class CAdapterMaintenanceThread;
   class CUSBCECAdapterCommands;
   class CCECAdapterMessageQueue;
   class CCECAdapterMessage;
@@ -56,7 +55,7 @@ namespace CEC
   {
     friend class CUSBCECAdapterCommands;
     friend class CCECAdapterMessageQueue;
-    friend class CAdapterEepromWriteThread;
+    friend class CAdapterMaintenanceThread;
 
   public:
     /*!
@@ -98,11 +97,13 @@ namespace CEC
 #if CEC_LIB_VERSION_MAJOR >= 5
     bool GetStats(struct cec_adapter_stats* stats);
 #endif
+    bool GetCounters(cec_adapter_counters* counters);
+    uint32_t GetWriteQueueSize(void);
     ///}
 
     bool ProvidesExtendedResponse(void);
 
-    void OnRxSuccess(void);
+    void OnRxSuccess(int64_t iLatencyUs);
     void OnRxError(void);
     void OnTxAck(void);
     void OnTxNack(void);
@@ -129,10 +130,16 @@ namespace CEC
      * @param msgCode The command to send.
      * @param params The parameters to the command.
      * @param bIsRetry True when this command is being retried, false otherwise.
-     * @return The message. Delete when done with it.
+     * @return The message. Pass it to ReleaseMessage() when done with it.
      */
     CCECAdapterMessage *SendCommand(cec_adapter_messagecode msgCode, CCECAdapterMessage &params, bool bIsRetry = false);
 
+    /*!
+     * @brief Return a message that was returned by SendCommand() to the message pool.
+     * @param message The message to release. NULL is ignored.
+     */
+    void ReleaseMessage(CCECAdapterMessage *message);
+
     /*!
      * @brief Change the "initialised" status.
      * @param bSetTo The new value.
@@ -159,12 +166,10 @@ namespace CEC
     bool HandlePoll(const CCECAdapterMessage &msg);
 
     /*!
-     * @brief Read data from the device.
-     * @param iTimeout The read timeout to use.
-     * @param iSize The maximum read size.
-     * @return True when something was read, false otherwise.
+     * @brief Read everything that the device has sent, without blocking.
+     * @return False when the connection was lost, true otherwise.
      */
-    bool ReadFromDevice(uint32_t iTimeout, size_t iSize = 256);
+    bool ReadFromDevice(void);
 
     /*!
      * @brief Writes a message to the serial port.
@@ -184,55 +189,67 @@ namespace CEC
      */
     void ResetMessageQueue(void);
 
+    /*!
+     * @brief Write the settings to the eeprom, at most once every 30 seconds.
+     * @return True when the write was scheduled.
+     */
+    bool ScheduleEepromWrite(void);
+
+    /*!
+     * @brief Ping the adapter, after the ping timer expired. Called on the maintenance thread.
+     */
+    void OnPing(void);
+
+    /*!
+     * @brief Write the eeprom, after the eeprom write timer expired. Called on the maintenance thread.
+     */
+    void OnEepromWrite(void);
+
     CSerialPort *                                m_port;                 /**< the com port connection */
     mutable CMutex                               m_mutex;                /**< mutex for changes in this class */
     uint8_t                                      m_iLineTimeout;         /**< the current line timeout on the CEC line */
     cec_logical_address                          m_lastPollDestination;  /**< the destination of the last poll message that was received */
     bool                                         m_bInitialised;         /**< true when the connection is initialised, false otherwise */
     bool                                         m_bWaitingForAck[15];   /**< array in which we store from which devices we're expecting acks */
-    CAdapterPingThread *                         m_pingThread;           /**< ping thread, that pings the adapter every 15 seconds */
-    CAdapterEepromWriteThread *                  m_eepromWriteThread;    /**< eeprom writes are done async */
+    uint64_t                                     m_iPingTimer;           /**< the timer that pings the adapter every 15 seconds */
+    int                                          m_iPingFailures;        /**< the number of pings in a row that failed */
+    uint64_t                                     m_iEepromWriteTimer;    /**< the timer for the next eeprom write, 0 when none is queued */
+    int64_t                                      m_iLastEepromWrite;     /**< last time that this instance did an eeprom write */
+    CMutex                                       m_eepromMutex;
+    CAdapterMaintenanceThread *                  m_maintenanceThread;    /**< pings the adapter and writes the eeprom when the timers expire */
     CUSBCECAdapterCommands *                     m_commands;             /**< commands that can be sent to the adapter */
     CCECAdapterMessageQueue *                    m_adapterMessageQueue;  /**< the incoming and outgoing message queue */
     cec_logical_addresses                        m_logicalAddresses;     /**< the logical address list that this instance is using */
     struct cec_adapter_stats                     m_stats;
+    cec_adapter_counters                         m_counters;
     CMutex                                       m_statsMutex;
     CMutex                                       m_waitingMutex;
   };
 
-  class CAdapterEepromWriteThread : public CThread
+  /*!
+   * @brief Does the work of the ping and eeprom write timers. Both wait for the
+   *        adapter to reply, so they don't run on the shared timer thread.
+   */
+  class CAdapterMaintenanceThread : public CThread
   {
   public:
-    CAdapterEepromWriteThread(CUSBCECAdapterCommunication *com) :
+    CAdapterMaintenanceThread(CUSBCECAdapterCommunication *com) :
         m_com(com),
-        m_bWrite(false),
-        m_iLastEepromWrite(0),
-        m_iScheduleEepromWrite(0) {}
-    virtual ~CAdapterEepromWriteThread(void) {}
+        m_bSignaled(false),
+        m_bPing(false),
+        m_bWriteEeprom(false) {}
+    virtual ~CAdapterMaintenanceThread(void) {}
 
-    bool Write(void);
-    void* Process(void);
+    void Ping(void);
+    void WriteEeprom(void);
     void Stop(void);
+    void* Process(void);
   private:
     CUSBCECAdapterCommunication *m_com;
-    bool                         m_bWrite;
+    bool                         m_bSignaled;
+    bool                         m_bPing;
+    bool                         m_bWriteEeprom;
     CCondition<bool>             m_condition;
     CMutex                       m_mutex;
-    int64_t                      m_iLastEepromWrite;     /**< last time that this instance did an eeprom write */
-    int64_t                      m_iScheduleEepromWrite; /**< in case there were more than 2 changes within 30 seconds, do another write at this time */
-  };
-
-  class CAdapterPingThread : public CThread
-  {
-  public:
-    CAdapterPingThread(CUSBCECAdapterCommunication *com, uint32_t iTimeout) :
-        m_com(com),
-        m_timeout(iTimeout){}
-    virtual ~CAdapterPingThread(void) {}
-
-    void* Process(void);
-  private:
-    CUSBCECAdapterCommunication* m_com;
-    CTimeout                     m_timeout;
   };
 };
@@ -44,6 +44,11 @@ CCECAdapterMessage::CCECAdapterMessage(void)
 }
 
 CCECAdapterMessage::CCECAdapterMessage(const cec_command &command, uint8_t iLineTimeout /* = 3 */)
+{
+  Format(command, iLineTimeout);
+}
+
+void CCECAdapterMessage::Format(const cec_command &command, uint8_t iLineTimeout /* = 3 */)
 {
   Clear();
 
@@ -112,6 +112,14 @@ namespace CEC
      */
     CCECAdapterMessage(const cec_command &command, uint8_t iLineTimeout = 3);
 
+    /*!
+     * @brief Clear this message and fill it with a command that is to be transmitted over the CEC line.
+     *        Used to recycle messages instead of creating new ones.
+     * @param command The command to transmit.
+     * @param iLineTimeout The line timeout to use when sending this message.
+     */
+    void Format(const cec_command &command, uint8_t iLineTimeout = 3);
+
     /*!
      * @return the message as human readable string.
      */
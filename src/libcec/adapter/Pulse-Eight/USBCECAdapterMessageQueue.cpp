@@ -37,22 +37,38 @@
 #include "USBCECAdapterCommunication.h"
 #include "USBCECAdapterMessage.h"
 #include "platform/sockets/socket.h"
+#include "platform/util/timeutils.h"
 #include "LibCEC.h"
 
 using namespace CEC;
 
 #define MESSAGE_QUEUE_SIGNAL_WAIT_TIME 1000
 
-CCECAdapterMessageQueueEntry::CCECAdapterMessageQueueEntry(CCECAdapterMessageQueue *queue, CCECAdapterMessage *message) :
-    m_queue(queue),
-    m_message(message),
-    m_iPacketsLeft(message->IsTransmission() ? message->Size() / 4 : 1),
+CCECAdapterMessageQueueEntry::CCECAdapterMessageQueueEntry(void) :
+    m_queue(NULL),
+    m_message(NULL),
+    m_iPacketsLeft(0),
     m_bSucceeded(false),
-    m_bWaiting(true),
-    m_queueTimeout(message->transmit_timeout) {}
+    m_bWaiting(false) {}
+
+CCECAdapterMessageQueueEntry::CCECAdapterMessageQueueEntry(CCECAdapterMessageQueue *queue, CCECAdapterMessage *message)
+{
+  Reset(queue, message);
+}
 
 CCECAdapterMessageQueueEntry::~CCECAdapterMessageQueueEntry(void) { }
 
+void CCECAdapterMessageQueueEntry::Reset(CCECAdapterMessageQueue *queue, CCECAdapterMessage *message)
+{
+  CLockObject lock(m_mutex);
+  m_queue        = queue;
+  m_message      = message;
+  m_iPacketsLeft = message->IsTransmission() ? message->Size() / 4 : 1;
+  m_bSucceeded   = false;
+  m_bWaiting     = true;
+  m_queueTimeout.Init(message->transmit_timeout);
+}
+
 void CCECAdapterMessageQueueEntry::Broadcast(void)
 {
   CLockObject lock(m_mutex);
@@ -309,8 +325,19 @@ bool CCECAdapterMessageQueueEntry::TimedOutOrSucceeded(void) const
 CCECAdapterMessageQueue::CCECAdapterMessageQueue(CUSBCECAdapterCommunication *com) :
   CThread(),
   m_com(com),
-  m_iNextMessage(0)
+  m_iOldestMessage(0),
+  m_iNextMessage(0),
+  m_iFreeMessages(MESSAGE_QUEUE_SLOTS),
+  m_iFreeEntries(MESSAGE_QUEUE_SLOTS),
+  m_iDataReceivedUs(0),
+  m_iFrameStartUs(0)
 {
+  for (size_t iPtr = 0; iPtr < MESSAGE_QUEUE_SLOTS; iPtr++)
+  {
+    m_messages[iPtr]     = NULL;
+    m_freeMessages[iPtr] = &m_messagePool[iPtr];
+    m_freeEntries[iPtr]  = &m_entryPool[iPtr];
+  }
   m_incomingAdapterMessage = new CCECAdapterMessage;
   m_currentCECFrame.Clear();
 }
@@ -328,7 +355,105 @@ void CCECAdapterMessageQueue::Clear(void)
   StopThread(5);
   CLockObject lock(m_mutex);
   m_writeQueue.Clear();
-  m_messages.clear();
+
+  /* nobody waits for fire and forget messages, so release them here. the others
+     are released by the thread that's waiting in Write() */
+  for (uint64_t iSequence = m_iOldestMessage; iSequence < m_iNextMessage; iSequence++)
+  {
+    CCECAdapterMessageQueueEntry *entry = m_messages[iSequence % MESSAGE_QUEUE_SLOTS];
+    m_messages[iSequence % MESSAGE_QUEUE_SLOTS] = NULL;
+    if (entry && entry->m_message->bFireAndForget)
+    {
+      ReleaseMessage(entry->m_message);
+      ReleaseEntry(entry);
+    }
+  }
+  m_iOldestMessage = m_iNextMessage;
+}
+
+CCECAdapterMessage *CCECAdapterMessageQueue::AllocateMessage(void)
+{
+  {
+    CLockObject lock(m_poolMutex);
+    if (m_iFreeMessages > 0)
+    {
+      CCECAdapterMessage *message = m_freeMessages[--m_iFreeMessages];
+      message->Clear();
+      return message;
+    }
+  }
+  return new CCECAdapterMessage;
+}
+
+void CCECAdapterMessageQueue::ReleaseMessage(CCECAdapterMessage *message)
+{
+  if (!message)
+    return;
+
+  if (message < &m_messagePool[0] || message >= &m_messagePool[MESSAGE_QUEUE_SLOTS])
+  {
+    delete message;
+    return;
+  }
+
+  CLockObject lock(m_poolMutex);
+  m_freeMessages[m_iFreeMessages++] = message;
+}
+
+void CCECAdapterMessageQueue::PoolSize(size_t &iMessages, size_t &iEntries)
+{
+  CLockObject lock(m_poolMutex);
+  iMessages = m_iFreeMessages;
+  iEntries  = m_iFreeEntries;
+}
+
+CCECAdapterMessageQueueEntry *CCECAdapterMessageQueue::AllocateEntry(CCECAdapterMessage *message)
+{
+  CCECAdapterMessageQueueEntry *entry(NULL);
+  {
+    CLockObject lock(m_poolMutex);
+    if (m_iFreeEntries > 0)
+      entry = m_freeEntries[--m_iFreeEntries];
+  }
+
+  if (!entry)
+    return new CCECAdapterMessageQueueEntry(this, message);
+
+  entry->Reset(this, message);
+  return entry;
+}
+
+void CCECAdapterMessageQueue::ReleaseEntry(CCECAdapterMessageQueueEntry *entry)
+{
+  if (entry < &m_entryPool[0] || entry >= &m_entryPool[MESSAGE_QUEUE_SLOTS])
+  {
+    delete entry;
+    return;
+  }
+
+  CLockObject lock(m_poolMutex);
+  m_freeEntries[m_iFreeEntries++] = entry;
+}
+
+bool CCECAdapterMessageQueue::AddPending(CCECAdapterMessageQueueEntry *entry, uint64_t &iSequence)
+{
+  if (m_iNextMessage - m_iOldestMessage >= MESSAGE_QUEUE_SLOTS)
+    return false;
+
+  iSequence = m_iNextMessage++;
+  m_messages[iSequence % MESSAGE_QUEUE_SLOTS] = entry;
+  return true;
+}
+
+void CCECAdapterMessageQueue::RemovePending(CCECAdapterMessageQueueEntry *entry, uint64_t iSequence)
+{
+  /* the slot may have been reused after Clear() */
+  if (iSequence < m_iOldestMessage || m_messages[iSequence % MESSAGE_QUEUE_SLOTS] != entry)
+    return;
+
+  m_messages[iSequence % MESSAGE_QUEUE_SLOTS] = NULL;
+  while (m_iOldestMessage < m_iNextMessage && !m_messages[m_iOldestMessage % MESSAGE_QUEUE_SLOTS])
+    ++m_iOldestMessage;
 }
 
 void *CCECAdapterMessageQueue::Process(void)
@@ -339,13 +464,18 @@ void *CCECAdapterMessageQueue::Process(void)
     /* wait for a new message */
     if (m_writeQueue.Pop(message, MESSAGE_QUEUE_SIGNAL_WAIT_TIME) && message)
     {
-      /* write this message */
+      /* write this message. the reply can arrive before WriteToDevice() returns,
+         and the writer releases the entry as soon as it has seen the reply and
+         removed it from m_messages, which needs m_mutex. so only look at the
+         entry while holding it */
+      bool bStop(false);
       {
         CLockObject lock(m_mutex);
         m_com->WriteToDevice(message->m_message);
+        bStop = message->m_message->state == ADAPTER_MESSAGE_STATE_ERROR ||
+            message->m_message->Message() == MSGCODE_START_BOOTLOADER;
       }
-      if (message->m_message->state == ADAPTER_MESSAGE_STATE_ERROR ||
-          message->m_message->Message() == MSGCODE_START_BOOTLOADER)
+      if (bStop)
       {
         message->Signal();
         Clear();
@@ -361,24 +491,18 @@ void *CCECAdapterMessageQueue::Process(void)
 void CCECAdapterMessageQueue::CheckTimedOutMessages(void)
 {
   CLockObject lock(m_mutex);
-  std::vector<uint64_t> timedOut;
-  for (std::map<uint64_t, CCECAdapterMessageQueueEntry *>::iterator it = m_messages.begin(); it != m_messages.end(); it++)
+  for (uint64_t iSequence = m_iOldestMessage; iSequence < m_iNextMessage; iSequence++)
   {
-    if (it->second->TimedOutOrSucceeded())
+    CCECAdapterMessageQueueEntry *entry = m_messages[iSequence % MESSAGE_QUEUE_SLOTS];
+    if (entry && entry->TimedOutOrSucceeded())
     {
-      timedOut.push_back(it->first);
-      if (!it->second->m_bSucceeded)
-        m_com->m_callback->GetLib()->AddLog(CEC_LOG_DEBUG, "command '%s' was not acked by the controller", CCECAdapterMessage::ToString(it->second->m_message->Message()));
-      delete it->second->m_message;
-      delete it->second;
+      if (!entry->m_bSucceeded)
+        m_com->m_callback->GetLib()->AddLog(CEC_LOG_DEBUG, "command '%s' was not acked by the controller", CCECAdapterMessage::ToString(entry->m_message->Message()));
+      RemovePending(entry, iSequence);
+      ReleaseMessage(entry->m_message);
+      ReleaseEntry(entry);
     }
   }
-
-  for (std::vector<uint64_t>::iterator it = timedOut.begin(); it != timedOut.end(); it++)
-  {
-    uint64_t iEntryId = *it;
-    m_messages.erase(iEntryId);
-  }
 }
 
 void CCECAdapterMessageQueue::MessageReceived(const CCECAdapterMessage &msg)
@@ -386,8 +510,12 @@ void CCECAdapterMessageQueue::MessageReceived(const CCECAdapterMessage &msg)
   bool bHandled(false);
   CLockObject lock(m_mutex);
   /* send the received message to each entry in the queue until it is handled */
-  for (auto it = m_messages.begin(); !bHandled && it != m_messages.end(); ++it)
-    bHandled = it->second->MessageReceived(msg);
+  for (uint64_t iSequence = m_iOldestMessage; !bHandled && iSequence < m_iNextMessage; iSequence++)
+  {
+    CCECAdapterMessageQueueEntry *entry = m_messages[iSequence % MESSAGE_QUEUE_SLOTS];
+    if (entry)
+      bHandled = entry->MessageReceived(msg);
+  }
 
   if (!bHandled)
   {
@@ -403,13 +531,16 @@ void CCECAdapterMessageQueue::MessageReceived(const CCECAdapterMessage &msg)
     }
 #endif
 
+    if (msg.Message() == MSGCODE_FRAME_START)
+      m_iFrameStartUs = m_iDataReceivedUs;
+
     /* push this message to the current frame */
     if (!bIsError && msg.PushToCecCommand(m_currentCECFrame))
     {
       /* and push the current frame back over the callback method when a full command was received */
       if (m_com->IsInitialised())
       {
-        m_com->OnRxSuccess();
+        m_com->OnRxSuccess(GetTimeUs() - m_iFrameStartUs);
         m_com->m_callback->OnCommandReceived(m_currentCECFrame);
       }
 
@@ -421,6 +552,8 @@ void CCECAdapterMessageQueue::MessageReceived(const CCECAdapterMessage &msg)
 
 void CCECAdapterMessageQueue::AddData(uint8_t *data, size_t len)
 {
+  m_iDataReceivedUs = GetTimeUs();
+
   for (size_t ptr = 0; ptr < len; ++ptr)
   {
     if (m_incomingAdapterMessage->PushReceivedByte(data[ptr]))
@@ -442,21 +575,22 @@ bool CCECAdapterMessageQueue::Write(CCECAdapterMessage *msg)
     m_com->SetLineTimeout(msg->lineTimeout);
   }
 
-  CCECAdapterMessageQueueEntry *entry = new CCECAdapterMessageQueueEntry(this, msg);
-  if (!entry)
-  {
-    m_com->m_callback->GetLib()->AddLog(CEC_LOG_ERROR, "couldn't create queue entry for '%s'", CCECAdapterMessage::ToString(msg->Message()));
-    msg->state = ADAPTER_MESSAGE_STATE_ERROR;
-    return false;
-  }
+  CCECAdapterMessageQueueEntry *entry = AllocateEntry(msg);
 
   uint64_t iEntryId(0);
   /* add to the wait for ack queue */
   if (msg->Message() != MSGCODE_START_BOOTLOADER)
   {
     CLockObject lock(m_mutex);
-    iEntryId = m_iNextMessage++;
-    m_messages.insert(std::make_pair(iEntryId, entry));
+    if (!AddPending(entry, iEntryId))
+    {
+      m_com->m_callback->GetLib()->AddLog(CEC_LOG_ERROR, "couldn't queue '%s', %d messages are waiting for a response already", CCECAdapterMessage::ToString(msg->Message()), MESSAGE_QUEUE_SLOTS);
+      ReleaseEntry(entry);
+      msg->state = ADAPTER_MESSAGE_STATE_ERROR;
+      if (msg->bFireAndForget)
+        ReleaseMessage(msg);
+      return false;
+    }
   }
 
   /* add the message to the write queue */
@@ -475,13 +609,13 @@ bool CCECAdapterMessageQueue::Write(CCECAdapterMessage *msg)
     if (msg->Message() != MSGCODE_START_BOOTLOADER)
     {
       CLockObject lock(m_mutex);
-      m_messages.erase(iEntryId);
+      RemovePending(entry, iEntryId);
     }
 
     if (msg->ReplyIsError() && msg->state != ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED)
       msg->state = ADAPTER_MESSAGE_STATE_ERROR;
 
-    delete entry;
+    ReleaseEntry(entry);
   }
 
   return bReturn;
@@ -36,9 +36,12 @@
 #include "platform/threads/threads.h"
 #include "platform/util/buffer.h"
 #include "platform/util/timeutils.h"
-#include <map>
 #include "USBCECAdapterMessage.h"
 
+/* the number of messages that can be waiting for a response at the same time.
+   this also sizes the pools of recycled messages and queue entries */
+#define MESSAGE_QUEUE_SLOTS 32
+
 namespace CEC
 {
   class CUSBCECAdapterCommunication;
@@ -48,9 +51,17 @@ namespace CEC
   class CCECAdapterMessageQueueEntry
   {
   public:
+    CCECAdapterMessageQueueEntry(void);
     CCECAdapterMessageQueueEntry(CCECAdapterMessageQueue *queue, CCECAdapterMessage *message);
     virtual ~CCECAdapterMessageQueueEntry(void);
 
+    /*!
+     * @brief Reset this entry to wait for a response to a new command.
+     * @param queue The queue this entry is in.
+     * @param message The command that is sent.
+     */
+    void Reset(CCECAdapterMessageQueue *queue, CCECAdapterMessage *message);
+
     /*!
      * @brief Signal waiting threads
      */
@@ -177,17 +188,69 @@ namespace CEC
 
     bool ProvidesExtendedResponse(void);
 
+    /*!
+     * @return The number of messages that are waiting to be written.
+     */
+    size_t WriteQueueSize(void) { return m_writeQueue.Size(); }
+
     virtual void *Process(void);
 
     void CheckTimedOutMessages(void);
 
+    /*!
+     * @brief Get an empty message from the pool, or a new one when the pool is empty.
+     * @return The message. Pass it to ReleaseMessage() when done with it.
+     */
+    CCECAdapterMessage *AllocateMessage(void);
+
+    /*!
+     * @brief Return a message to the pool, or delete it if it didn't come from there.
+     * @param message The message to release.
+     */
+    void ReleaseMessage(CCECAdapterMessage *message);
+
+    /*!
+     * @brief Get the number of messages and queue entries that are left in the pools.
+     * @param iMessages Set to the number of unused messages.
+     * @param iEntries Set to the number of unused queue entries.
+     */
+    void PoolSize(size_t &iMessages, size_t &iEntries);
+
   private:
+    CCECAdapterMessageQueueEntry *AllocateEntry(CCECAdapterMessage *message);
+    void ReleaseEntry(CCECAdapterMessageQueueEntry *entry);
+
+    /*!
+     * @brief Add an entry to the messages that are waiting for a response. Call with m_mutex held.
+     * @param entry The entry to add.
+     * @param iSequence Set to the sequence number of the entry.
+     * @return True when added, false when MESSAGE_QUEUE_SLOTS messages are waiting already.
+     */
+    bool AddPending(CCECAdapterMessageQueueEntry *entry, uint64_t &iSequence);
+
+    /*!
+     * @brief Remove an entry from the messages that are waiting for a response. Call with m_mutex held.
+     * @param entry The entry to remove.
+     * @param iSequence The sequence number that AddPending() returned.
+     */
+    void RemovePending(CCECAdapterMessageQueueEntry *entry, uint64_t iSequence);
+
     CUSBCECAdapterCommunication *                            m_com;                    /**< the communication handler */
     CMutex                                                   m_mutex;                  /**< mutex for changes to this class */
-    std::map<uint64_t, CCECAdapterMessageQueueEntry *>       m_messages;               /**< the outgoing message queue */
+    CCECAdapterMessageQueueEntry *                           m_messages[MESSAGE_QUEUE_SLOTS]; /**< the messages waiting for a response, indexed by sequence number */
+    uint64_t                                                 m_iOldestMessage;         /**< the sequence number of the oldest message that may still be waiting */
     SyncedBuffer<CCECAdapterMessageQueueEntry *>             m_writeQueue;             /**< the queue for messages that are to be written */
-    uint64_t                                                 m_iNextMessage;           /**< the index of the next message */
+    uint64_t                                                 m_iNextMessage;           /**< the sequence number of the next message */
+    CMutex                                                   m_poolMutex;              /**< mutex for the pools */
+    CCECAdapterMessage                                       m_messagePool[MESSAGE_QUEUE_SLOTS]; /**< outgoing messages, recycled */
+    CCECAdapterMessage *                                     m_freeMessages[MESSAGE_QUEUE_SLOTS]; /**< the unused messages in m_messagePool */
+    size_t                                                   m_iFreeMessages;          /**< the number of unused messages in m_messagePool */
+    CCECAdapterMessageQueueEntry                             m_entryPool[MESSAGE_QUEUE_SLOTS]; /**< queue entries, recycled */
+    CCECAdapterMessageQueueEntry *                           m_freeEntries[MESSAGE_QUEUE_SLOTS]; /**< the unused entries in m_entryPool */
+    size_t                                                   m_iFreeEntries;           /**< the number of unused entries in m_entryPool */
     CCECAdapterMessage                                    *  m_incomingAdapterMessage; /**< the current incoming message that's being assembled */
     cec_command                                              m_currentCECFrame;        /**< the current incoming CEC command that's being assembled */
+    int64_t                                                  m_iDataReceivedUs;        /**< the time at which the data that's being processed was read */
+    int64_t                                                  m_iFrameStartUs;          /**< the time at which the start of m_currentCECFrame was read */
   };
 }
@@ -189,7 +189,8 @@ void CRPiCECAdapterCommunication::OnDataReceived(uint32_t header, uint32_t p0, u
       for (uint8_t iPtr = 1; iPtr < message.length && iPtr < sizeof(message.payload); iPtr++)
         command.PushBack(message.payload[iPtr]);
 
-      // send to libCEC
+      // send to libCEC. VideoCore hands over whole frames, so there's no latency to measure
+      m_stats.OnRxSuccess(0);
       m_callback->OnCommandReceived(command);
     }
     break;
@@ -211,6 +212,7 @@ void CRPiCECAdapterCommunication::OnDataReceived(uint32_t header, uint32_t p0, u
       command.parameters.PushBack((uint8_t)CEC_CB_OPERAND1(p0));
 
       // send to libCEC
+      m_stats.OnRxSuccess(0);
       m_callback->OnCommandReceived(command);
     }
     break;
@@ -226,6 +228,7 @@ void CRPiCECAdapterCommunication::OnDataReceived(uint32_t header, uint32_t p0, u
       command.parameters.PushBack((uint8_t)CEC_CB_OPERAND1(p0));
 
       // send to libCEC
+      m_stats.OnRxSuccess(0);
       m_callback->OnCommandReceived(command);
     }
     break;
@@ -388,10 +391,12 @@ cec_adapter_message_state CRPiCECAdapterCommunication::Write(const cec_command &
           (rc = m_queue->Write(data, bRetry, iTimeout, bIsReply, vcAnswer)));
 
     SetDisableCallback(false);
+    m_stats.OnTxResult(rc);
     return rc;
   }
 
   rc = m_queue->Write(data, bRetry, iTimeout, bIsReply, vcAnswer);
+  m_stats.OnTxResult(rc);
 #ifdef CEC_DEBUGGING
   LIB_CEC->AddLog(CEC_LOG_DEBUG, "sending data: result %s", ToString(vcAnswer));
 #endif
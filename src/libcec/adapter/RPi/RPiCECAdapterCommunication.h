@@ -36,6 +36,7 @@
 #if defined(HAVE_RPI_API)
 
 #include "adapter/AdapterCommunication.h"
+#include "adapter/AdapterMessageQueue.h"
 #include "platform/threads/threads.h"
 
 #define RPI_ADAPTER_VID 0x2708
@@ -89,8 +90,9 @@ namespace CEC
     uint16_t GetAdapterProductId(void) const { return RPI_ADAPTER_PID; }
     void SetActiveSource(bool UNUSED(bSetTo), bool UNUSED(bClientUnregistered)) {}
     #if CEC_LIB_VERSION_MAJOR >= 5
-    bool GetStats(struct cec_adapter_stats* UNUSED(stats)) { return false; }
+    bool GetStats(struct cec_adapter_stats* stats) { return m_stats.Get(stats); }
     #endif
+    bool GetCounters(cec_adapter_counters* counters) { return m_stats.GetCounters(counters); }
     ///}
 
     bool IsInitialised(void);
@@ -117,6 +119,7 @@ namespace CEC
     bool                          m_bLogicalAddressRegistered;
 
     bool                          m_bDisableCallbacks;
+    CAdapterStats                 m_stats;
   };
 };
 
@@ -53,85 +53,23 @@ using namespace CEC;
 
 #define LIB_CEC m_com->m_callback->GetLib()
 
-// initialise new msg with unsuccesfull status, also
-// set default return state to "UNKNOWN" - instead
-// of NACK (which has special meaning for dev POLLing)
-CRPiCECAdapterMessageQueueEntry::CRPiCECAdapterMessageQueueEntry(CRPiCECAdapterMessageQueue *queue, const cec_command &command) :
-    m_queue(queue),
-    m_bWaiting(true),
-    m_command(command),
-    m_retval(VC_CEC_ERROR_BUSY),
-    m_bSucceeded(false)
-{
-
-}
-
-void CRPiCECAdapterMessageQueueEntry::Broadcast(void)
-{
-  CLockObject lock(m_mutex);
-  m_condition.Broadcast();
-}
-
-bool CRPiCECAdapterMessageQueueEntry::MessageReceived(cec_opcode opcode, cec_logical_address initiator, cec_logical_address destination, uint32_t response)
-{
-  if ((m_command.opcode_set && m_command.opcode == opcode &&
-     m_command.initiator == initiator &&
-     m_command.destination == destination)
-     ||
-     (!m_command.opcode_set &&
-     m_command.destination == destination))
-  {
-    CLockObject lock(m_mutex);
-    m_retval = response;
-    m_bSucceeded = true;
-    m_condition.Signal();
-    return true;
-  }
-
-  return false;
-}
-
-bool CRPiCECAdapterMessageQueueEntry::Wait(uint32_t iTimeout)
-{
-  bool bReturn(false);
-  /* wait until we receive a signal when the tranmission succeeded */
-  {
-    CLockObject lock(m_mutex);
-    bReturn = m_bSucceeded ? true : m_condition.Wait(lock, m_bSucceeded, iTimeout);
-    m_bWaiting = false;
-  }
-  return bReturn;
-}
-
-bool CRPiCECAdapterMessageQueueEntry::IsWaiting(void)
-{
-  CLockObject lock(m_mutex);
-  return m_bWaiting;
-}
-
 void CRPiCECAdapterMessageQueue::Clear(void)
 {
-  CLockObject lock(m_mutex);
-  m_messages.clear();
+  m_transmits.Clear();
 }
 
 void CRPiCECAdapterMessageQueue::MessageReceived(cec_opcode opcode, cec_logical_address initiator, cec_logical_address destination, uint32_t response)
 {
-  bool bHandled(false);
-  CLockObject lock(m_mutex);
-  /* send the received message to each entry in the queue until it is handled */
-  for (std::map<uint64_t, CRPiCECAdapterMessageQueueEntry *>::iterator it = m_messages.begin(); !bHandled && it != m_messages.end(); it++)
-    bHandled = it->second->MessageReceived(opcode, initiator, destination, response);
+  rpi_transmit_result result;
+  result.opcode      = opcode;
+  result.initiator   = initiator;
+  result.destination = destination;
+  result.response    = response;
 
-  if (!bHandled)
+  if (!m_transmits.MessageReceived(result))
     LIB_CEC->AddLog(CEC_LOG_WARNING, "unhandled response received: opcode=%x initiator=%x destination=%x response=%x", (int)opcode, (int)initiator, (int)destination, response);
 }
 
-uint32_t CRPiCECAdapterMessageQueueEntry::Result() const
-{
-  return m_retval;
-}
-
 cec_adapter_message_state CRPiCECAdapterMessageQueue::Write(const cec_command &command, bool &bRetry, uint32_t iLineTimeout, bool bIsReply, VC_CEC_ERROR_T &vcReply)
 {
   // handle POLL (msg like '11') in a special way - the way it was
@@ -155,27 +93,25 @@ cec_adapter_message_state CRPiCECAdapterMessageQueue::Write(const cec_command &c
       return ADAPTER_MESSAGE_STATE_WAITING_TO_BE_SENT;
   }
 
-  CRPiCECAdapterMessageQueueEntry *entry = new CRPiCECAdapterMessageQueueEntry(this, command);
-  uint64_t iEntryId(0);
-  /* add to the wait for ack queue */
-  {
-    CLockObject lock(m_mutex);
-    iEntryId = m_iNextMessage++;
-    m_messages.insert(std::make_pair(iEntryId, entry));
-  }
-
   // opcode + operands must fit a CEC frame; refuse an over-long command rather
   // than overrunning the fixed payload buffer built below
   if (command.opcode_set && command.parameters.size + 1 > CEC_MAX_XMIT_LENGTH)
   {
     LIB_CEC->AddLog(CEC_LOG_WARNING, "command '%s' not sent: %u parameter byte(s) exceed the maximum CEC frame size",
         CCECTypeUtils::ToString(command.opcode), (unsigned)command.parameters.size);
-    CLockObject lock(m_mutex);
-    m_messages.erase(iEntryId);
-    delete entry;
     return ADAPTER_MESSAGE_STATE_ERROR;
   }
 
+  /* add to the wait for ack queue */
+  int iSlot = m_transmits.Add(command);
+  if (iSlot < 0)
+  {
+    LIB_CEC->AddLog(CEC_LOG_WARNING, "command '%s' not sent: too many pending transmits", CCECTypeUtils::ToString(command.opcode));
+    bRetry = true;
+    vcReply = VC_CEC_ERROR_BUSY;
+    return ADAPTER_MESSAGE_STATE_WAITING_TO_BE_SENT;
+  }
+
 #if defined(RPI_USE_SEND_MESSAGE2)
   VC_CEC_MESSAGE_T message;
   message.initiator = (CEC_AllDevices_T)command.initiator;
@@ -230,41 +166,34 @@ cec_adapter_message_state CRPiCECAdapterMessageQueue::Write(const cec_command &c
   if (iReturn != VCHIQ_SUCCESS)
   {
     LIB_CEC->AddLog(CEC_LOG_DEBUG, "sending command '%s' failed (%d)", CCECTypeUtils::ToString(command.opcode), iReturn);
-    CLockObject lock(m_mutex);
-    delete entry;
-    m_messages.erase(iEntryId);
+    m_transmits.Remove(iSlot);
     return ADAPTER_MESSAGE_STATE_ERROR;
   }
 
+  // the status stays "busy" rather than NACK when no result comes in, since a
+  // NACK has a special meaning for polls
   cec_adapter_message_state bReturn(ADAPTER_MESSAGE_STATE_ERROR);
-  if (entry)
+  rpi_transmit_result result;
+  result.response = VC_CEC_ERROR_BUSY;
+  if (m_transmits.Wait(iSlot, iLineTimeout, result))
   {
-    if (entry->Wait(iLineTimeout))
-    {
-      int status = entry->Result();
-
-      if (status == VC_CEC_ERROR_NO_ACK)
-        bReturn = ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED;
-      else if (status == VC_CEC_SUCCESS)
-        bReturn = ADAPTER_MESSAGE_STATE_SENT_ACKED;
-      else
-        bReturn = ADAPTER_MESSAGE_STATE_SENT;
-    }
+    if (result.response == VC_CEC_ERROR_NO_ACK)
+      bReturn = ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED;
+    else if (result.response == VC_CEC_SUCCESS)
+      bReturn = ADAPTER_MESSAGE_STATE_SENT_ACKED;
     else
-    {
-      bRetry = true;
-      LIB_CEC->AddLog(CEC_LOG_DEBUG, "command '%s' timeout", CCECTypeUtils::ToString(command.opcode));
-      std::this_thread::sleep_for(std::chrono::milliseconds(CEC_DEFAULT_TRANSMIT_RETRY_WAIT));
-      bReturn = ADAPTER_MESSAGE_STATE_WAITING_TO_BE_SENT;
-    }
-
-    vcReply = (VC_CEC_ERROR_T)entry->Result();
-
-    CLockObject lock(m_mutex);
-    m_messages.erase(iEntryId);
-    delete entry;
+      bReturn = ADAPTER_MESSAGE_STATE_SENT;
+  }
+  else
+  {
+    bRetry = true;
+    LIB_CEC->AddLog(CEC_LOG_DEBUG, "command '%s' timeout", CCECTypeUtils::ToString(command.opcode));
+    std::this_thread::sleep_for(std::chrono::milliseconds(CEC_DEFAULT_TRANSMIT_RETRY_WAIT));
+    bReturn = ADAPTER_MESSAGE_STATE_WAITING_TO_BE_SENT;
   }
 
+  vcReply = (VC_CEC_ERROR_T)result.response;
+
   return bReturn;
 }
 
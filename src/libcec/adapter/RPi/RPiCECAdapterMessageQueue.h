@@ -33,9 +33,8 @@
  */
 
 #include "env.h"
-#include "platform/util/buffer.h"
-#include <map>
 #include "adapter/AdapterCommunication.h"
+#include "adapter/AdapterMessageQueue.h"
 
 extern "C" {
 #include <interface/vmcs_host/vc_cecservice.h>
@@ -45,65 +44,40 @@ extern "C" {
 namespace CEC
 {
   class CRPiCECAdapterCommunication;
-  class CRPiCECAdapterMessageQueue;
 
-  class CRPiCECAdapterMessageQueueEntry
+  /*!
+   * @brief The result of a transmit, as VideoCore reports it in a VC_CEC_TX callback.
+   */
+  typedef struct rpi_transmit_result
   {
-  public:
-    CRPiCECAdapterMessageQueueEntry(CRPiCECAdapterMessageQueue *queue, const cec_command &command);
-    virtual ~CRPiCECAdapterMessageQueueEntry(void) {}
-
-    /*!
-     * @brief Signal waiting threads
-     */
-    void Broadcast(void);
-
-    bool MessageReceived(cec_opcode opcode, cec_logical_address initiator, cec_logical_address destination, uint32_t response);
-
-    /*!
-     * @brief Wait for a response to this command.
-     * @param iTimeout The timeout to use while waiting.
-     * @return True when a response was received before the timeout passed, false otherwise.
-     */
-    bool Wait(uint32_t iTimeout);
-
-    /*!
-     * @return True while a thread is waiting for a signal or isn't waiting yet, false otherwise.
-     */
-    bool IsWaiting(void);
+    cec_opcode          opcode;
+    cec_logical_address initiator;
+    cec_logical_address destination;
+    uint32_t            response;    /**< a VC_CEC_ERROR_T */
+  } rpi_transmit_result;
 
-    /*!
-     * @brief Query result from worker thread
-     */
-    uint32_t Result() const;
-
-    /*!
-     * @return The command that was sent in human readable form.
-     */
-    const char *ToString(void) const { return "CEC transmission"; }
-
-    CRPiCECAdapterMessageQueue * m_queue;
-    bool                         m_bWaiting;     /**< true while a thread is waiting or when it hasn't started waiting yet */
-    CCondition<bool>             m_condition;    /**< the condition to wait on */
-    CMutex                       m_mutex;        /**< mutex for changes to this class */
-    cec_command                  m_command;
-    uint32_t                     m_retval;
-    bool                         m_bSucceeded;
+  struct CRPiTransmitMatcher
+  {
+    bool operator()(const cec_command &command, const rpi_transmit_result &result) const
+    {
+      // VideoCore doesn't report the initiator and opcode of a frame without an opcode
+      return command.opcode_set ?
+          command.opcode == result.opcode &&
+            command.initiator == result.initiator &&
+            command.destination == result.destination :
+          command.destination == result.destination;
+    }
   };
 
   class CRPiCECAdapterMessageQueue
   {
-    friend class CRPiCECAdapterMessageQueueEntry;
-
   public:
     /*!
      * @brief Create a new message queue.
      * @param com The communication handler callback to use.
-     * @param iQueueSize The outgoing message queue size.
      */
     CRPiCECAdapterMessageQueue(CRPiCECAdapterCommunication *com) :
-      m_com(com),
-      m_iNextMessage(0)
+      m_com(com)
     {
     }
 
@@ -113,7 +87,7 @@ namespace CEC
     }
 
     /*!
-     * @brief Signal and delete everything in the queue
+     * @brief Wake up everything that waits for a result
      */
     void Clear(void);
 
@@ -122,9 +96,7 @@ namespace CEC
     cec_adapter_message_state Write(const cec_command &command, bool &bRetry, uint32_t iLineTimeout, bool bIsReply, VC_CEC_ERROR_T &vcReply);
 
   private:
-    CRPiCECAdapterCommunication *                             m_com;                    /**< the communication handler */
-    CMutex                                                    m_mutex;                  /**< mutex for changes to this class */
-    std::map<uint64_t, CRPiCECAdapterMessageQueueEntry *>     m_messages;               /**< the outgoing message queue */
-    uint64_t                                                  m_iNextMessage;           /**< the index of the next message */
+    CRPiCECAdapterCommunication *                                     m_com;       /**< the communication handler */
+    CAdapterMessageQueue<rpi_transmit_result, CRPiTransmitMatcher>    m_transmits; /**< the transmits that wait for their result */
   };
 };
@@ -50,8 +50,6 @@ extern "C" {
 
 using namespace CEC;
 
-#include "AdapterMessageQueue.h"
-
 #define LIB_CEC m_callback->GetLib()
 
 // these are defined in nxp private header file
@@ -71,7 +69,6 @@ CTDA995xCECAdapterCommunication::CTDA995xCECAdapterCommunication(IAdapterCommuni
 { 
   CLockObject lock(m_mutex);
 
-  m_iNextMessage = 0;
   m_logicalAddresses.Clear();
   m_dev = new CCDevSocket(CEC_TDA995x_PATH);
 }
@@ -142,6 +139,7 @@ bool CTDA995xCECAdapterCommunication::Open(uint32_t iTimeoutMs, bool UNUSED(bSki
 void CTDA995xCECAdapterCommunication::Close(void)
 {
   StopThread(0);
+  m_transmits.Clear();
 
   unsigned char raw_mode = 0;
   m_dev->Ioctl(CEC_IOCTL_SET_RAW_MODE, &raw_mode);
@@ -161,7 +159,6 @@ cec_adapter_message_state CTDA995xCECAdapterCommunication::Write(
   const cec_command &data, bool &UNUSED(bRetry), uint8_t UNUSED(iLineTimeout), bool UNUSED(bIsReply))
 {
   cec_frame frame;
-  CAdapterMessageQueueEntry *entry;
   cec_adapter_message_state rc = ADAPTER_MESSAGE_STATE_ERROR;
 
   frame.service = 0;
@@ -177,38 +174,34 @@ cec_adapter_message_state CTDA995xCECAdapterCommunication::Write(
 
   frame.size = iDataSize + 3;
 
-  entry = new CAdapterMessageQueueEntry(data);
-  
-  CLockObject messageLock(m_messageMutex);
-  uint32_t msgKey = ++m_iNextMessage;
-  m_messages.insert(std::make_pair(msgKey, entry));
+  int iSlot = m_transmits.Add(data);
+  if (iSlot < 0)
+  {
+    LIB_CEC->AddLog(CEC_LOG_ERROR, "%s: too many pending transmits !", __func__);
+    m_stats.OnTxResult(rc);
+    return rc;
+  }
 
   if (m_dev->Write((char *)&frame, sizeof(frame)) == sizeof(frame))
   {
-    messageLock.unlock();
-
-    if (entry->Wait(CEC_DEFAULT_TRANSMIT_WAIT))
+    tda995x_transmit_result result;
+    if (m_transmits.Wait(iSlot, CEC_DEFAULT_TRANSMIT_WAIT, result))
     {
-      uint32_t status = entry->Result();
-     
-      if (status == CEC_MSG_FAIL_DEST_NOT_ACK)
+      if (result.status == CEC_MSG_FAIL_DEST_NOT_ACK)
         rc = ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED;
-      else if (status == CEC_MSG_SUCCESS)
+      else if (result.status == CEC_MSG_SUCCESS)
         rc = ADAPTER_MESSAGE_STATE_SENT_ACKED;
     }
     else
       LIB_CEC->AddLog(CEC_LOG_ERROR, "%s: command timed out !", __func__);
-    
-    messageLock.lock();
   }
   else
-     LIB_CEC->AddLog(CEC_LOG_ERROR, "%s: write failed !", __func__);
-
-  m_messages.erase(msgKey);
-  messageLock.unlock();
-
-  delete entry;
+  {
+    m_transmits.Remove(iSlot);
+    LIB_CEC->AddLog(CEC_LOG_ERROR, "%s: write failed !", __func__);
+  }
 
+  m_stats.OnTxResult(rc);
   return rc;
 }
 
@@ -324,9 +317,7 @@ void CTDA995xCECAdapterCommunication::HandleLogicalAddressLost(cec_logical_addre
 
 void *CTDA995xCECAdapterCommunication::Process(void)
 {
-  bool bHandled;
   cec_frame frame;
-  uint32_t opcode, status;
   cec_logical_address initiator, destination;
 
   while (!IsStopped())
@@ -350,25 +341,21 @@ void *CTDA995xCECAdapterCommunication::Process(void)
         for( uint8_t i = 1; i < frame.size-3 && i < sizeof(frame.data); i++ )
           cmd.parameters.PushBack(frame.data[i]);
 
+        // the driver hands over whole frames, so there's no latency to measure
+        m_stats.OnRxSuccess(0);
+
         if (!IsStopped())
           m_callback->OnCommandReceived(cmd);
       }
       else if (frame.service == CEC_ACK_PKT)
       {
-        bHandled = false;
-        status = ( frame.size > 3 ) ? frame.data[0] : 255;
-        opcode = ( frame.size > 4 ) ? frame.data[1] : (uint32_t)CEC_OPCODE_NONE;
+        tda995x_transmit_result result;
+        result.initiator   = initiator;
+        result.destination = destination;
+        result.status      = ( frame.size > 3 ) ? frame.data[0] : 255;
+        result.opcode      = ( frame.size > 4 ) ? frame.data[1] : (uint32_t)CEC_OPCODE_NONE;
 
-        {
-          CLockObject lock(m_messageMutex);
-          for (std::map<uint32_t, CAdapterMessageQueueEntry *>::iterator it = m_messages.begin();
-               !bHandled && it != m_messages.end(); it++)
-          {
-            bHandled = it->second->CheckMatch(opcode, initiator, destination, status);
-          }
-        }
-      
-        if (!bHandled)
+        if (!m_transmits.MessageReceived(result))
           LIB_CEC->AddLog(CEC_LOG_WARNING, "%s: unhandled response received !", __func__);
       }
       else if (frame.service == CEC_HPD_PKT)
@@ -39,7 +39,7 @@
 #include "platform/threads/threads.h"
 #include "platform/sockets/socket.h"
 #include "adapter/AdapterCommunication.h"
-#include <map>
+#include "adapter/AdapterMessageQueue.h"
 
 #define TDA995X_ADAPTER_VID 0x0471
 #define TDA995X_ADAPTER_PID 0x1001
@@ -52,7 +52,26 @@ namespace CEC
 
 namespace CEC
 {
-  class CAdapterMessageQueueEntry;
+  /*!
+   * @brief The result of a transmit, as the driver reports it in a CEC_ACK_PKT.
+   */
+  typedef struct tda995x_transmit_result
+  {
+    uint32_t            opcode;      /**< the opcode of the frame, or CEC_OPCODE_NONE for a poll */
+    cec_logical_address initiator;
+    cec_logical_address destination;
+    uint32_t            status;      /**< CEC_MSG_SUCCESS or one of the CEC_MSG_FAIL_ codes */
+  } tda995x_transmit_result;
+
+  struct CTDA995xTransmitMatcher
+  {
+    bool operator()(const cec_command &command, const tda995x_transmit_result &result) const
+    {
+      return command.initiator == result.initiator &&
+          command.destination == result.destination &&
+          (command.opcode_set ? (uint32_t)command.opcode : (uint32_t)CEC_OPCODE_NONE) == result.opcode;
+    }
+  };
 
   class CTDA995xCECAdapterCommunication : public IAdapterCommunication, public CThread
   {
@@ -94,8 +113,9 @@ namespace CEC
     void HandleLogicalAddressLost(cec_logical_address oldAddress);
     void SetActiveSource(bool UNUSED(bSetTo), bool UNUSED(bClientUnregistered)) {}
     #if CEC_LIB_VERSION_MAJOR >= 5
-    bool GetStats(struct cec_adapter_stats* UNUSED(stats)) { return false; }
+    bool GetStats(struct cec_adapter_stats* stats) { return m_stats.Get(stats); }
     #endif
+    bool GetCounters(cec_adapter_counters* counters) { return m_stats.GetCounters(counters); }
     ///}
 
     /** @name CThread implementation */
@@ -115,9 +135,8 @@ namespace CEC
     mutable CMutex              m_mutex;
     CCDevSocket     *m_dev;	/**< the device connection */
 
-    CMutex                      m_messageMutex;
-    uint32_t                    m_iNextMessage;
-    std::map<uint32_t, CAdapterMessageQueueEntry *> m_messages;
+    CAdapterMessageQueue<tda995x_transmit_result, CTDA995xTransmitMatcher> m_transmits; /**< the transmits that wait for their ack */
+    CAdapterStats               m_stats;
   };
 
 };
@@ -45,8 +45,6 @@
 using namespace std;
 using namespace CEC;
 
-#include "AdapterMessageQueue.h"
-
 #define LIB_CEC m_callback->GetLib()
 
 TegraCECAdapterCommunication::TegraCECAdapterCommunication(IAdapterCommunicationCallback *callback) :
@@ -55,7 +53,6 @@ TegraCECAdapterCommunication::TegraCECAdapterCommunication(IAdapterCommunication
 {
   CLockObject lock(m_mutex);
   LIB_CEC->AddLog(CEC_LOG_ERROR, "%s: Creating Adaptor", __func__);
-  m_iNextMessage = 0;
   m_logicalAddresses.Clear();
   fd = INVALID_SOCKET_VALUE;
   fdAddr = INVALID_SOCKET_VALUE;
@@ -137,26 +134,30 @@ cec_adapter_message_state TegraCECAdapterCommunication::Write(
   int size = data.Serialize(cmdData, sizeof(cmdData));
   if (size < 0){
     LIB_CEC->AddLog(CEC_LOG_ERROR, "%s: Command Longer Than %i Bytes", __func__, TEGRA_CEC_FRAME_MAX_LENGTH);
+    m_stats.OnTxResult(ADAPTER_MESSAGE_STATE_ERROR);
     return ADAPTER_MESSAGE_STATE_ERROR;
   }
 
+  cec_adapter_message_state rc;
   int status = write(fd,cmdData,size);
 
   if (status < 0){
 
     if(errno == ECONNRESET || errno == EHOSTUNREACH){
       LIB_CEC->AddLog(CEC_LOG_TRAFFIC, "%s: Write OK But Not ACKED (%s)", __func__, strerror(errno));
-      return ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED;
+      rc = ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED;
     } else {
       LIB_CEC->AddLog(CEC_LOG_ERROR, "%s: Write Error (%s)", __func__, strerror(errno));
-      return ADAPTER_MESSAGE_STATE_ERROR;
+      rc = ADAPTER_MESSAGE_STATE_ERROR;
     }
 
   } else {
     LIB_CEC->AddLog(CEC_LOG_TRAFFIC, "%s: Write OK And ACKED", __func__);
-    return ADAPTER_MESSAGE_STATE_SENT_ACKED;
+    rc = ADAPTER_MESSAGE_STATE_SENT_ACKED;
   }
 
+  m_stats.OnTxResult(rc);
+  return rc;
 }
 
 uint16_t TegraCECAdapterCommunication::GetFirmwareVersion(void)
@@ -259,6 +260,8 @@ void *TegraCECAdapterCommunication::Process(void)
         continue;
     }
 
+    // the frame arrives a word at a time, so time it from the first one, like the Pulse-Eight backend does
+    int64_t iFrameStartUs = GetTimeUs();
     initiator = cec_logical_address(buffer[0] >> 4);
     destination = cec_logical_address(buffer[0] & 0x0f);
 
@@ -270,6 +273,7 @@ void *TegraCECAdapterCommunication::Process(void)
 
       if (read(fd,buffer,2) != 2){
         LIB_CEC->AddLog(CEC_LOG_ERROR, "%s: Failed To Read From Tegra CEC Device", __func__);
+        m_stats.OnRxError();
         continue;
       }
 
@@ -300,7 +304,11 @@ void *TegraCECAdapterCommunication::Process(void)
     // the operand loop only breaks early on a read error, leaving the
     // end-of-data flag set. drop the partial frame instead of handing it up
     if (isNotEndOfData > 0)
+    {
+      m_stats.OnRxError();
       continue;
+    }
+    m_stats.OnRxSuccess(GetTimeUs() - iFrameStartUs);
 
     //LIB_CEC->AddLog(CEC_LOG_TRAFFIC, "%s: Reading Data Len : %i", __func__, cmd.parameters.size);
     if (!IsStopped())
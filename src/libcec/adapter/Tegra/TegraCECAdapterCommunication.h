@@ -37,15 +37,13 @@
 #include "platform/threads/threads.h"
 #include "platform/sockets/socket.h"
 #include "adapter/AdapterCommunication.h"
-#include <map>
+#include "adapter/AdapterMessageQueue.h"
 
 #define TEGRA_ADAPTER_VID 0x0001
 #define TEGRA_ADAPTER_PID 0x0001
 
 namespace CEC
 {
-  class CAdapterMessageQueueEntry;
-
   class TegraCECAdapterCommunication : public IAdapterCommunication, public CThread
   {
   public:
@@ -88,8 +86,9 @@ namespace CEC
     void HandleLogicalAddressLost(cec_logical_address oldAddress);
     void SetActiveSource(bool UNUSED(bSetTo), bool UNUSED(bClientUnregistered)) {}
 #if CEC_LIB_VERSION_MAJOR >= 5
-    bool GetStats(struct cec_adapter_stats* UNUSED(stats)) override { return false; }
+    bool GetStats(struct cec_adapter_stats* stats) override { return m_stats.Get(stats); }
 #endif
+    bool GetCounters(cec_adapter_counters* counters) override { return m_stats.GetCounters(counters); }
 
     ///}
 
@@ -109,9 +108,8 @@ namespace CEC
 
     CMutex                        m_mutex;
 
-    CMutex                        m_messageMutex;
-    uint32_t                    m_iNextMessage;
-    std::map<uint32_t, CAdapterMessageQueueEntry *> m_messages;
+    // writes block until the frame is acked, so there's no queue of pending transmits here
+    CAdapterStats                 m_stats;
   };
   
 };
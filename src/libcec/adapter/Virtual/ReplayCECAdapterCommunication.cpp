@@ -0,0 +1,285 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+
+#include "env.h"
+
+#if defined(HAVE_VIRTUAL_API)
+#include "ReplayCECAdapterCommunication.h"
+#include "LibCEC.h"
+#include "platform/util/timeutils.h"
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace CEC;
+
+#define LIB_CEC m_callback->GetLib()
+
+namespace
+{
+  bool IsSameFrame(const cec_command &a, const cec_command &b)
+  {
+    if (a.initiator != b.initiator || a.destination != b.destination || a.opcode_set != b.opcode_set)
+      return false;
+    if (!a.opcode_set)
+      return true;
+    if (a.opcode != b.opcode || a.parameters.size != b.parameters.size)
+      return false;
+    return !memcmp(a.parameters.data, b.parameters.data, a.parameters.size);
+  }
+}
+
+CReplayCECAdapterCommunication::CReplayCECAdapterCommunication(IAdapterCommunicationCallback *callback, const char *strPort) :
+    IAdapterCommunication(callback),
+    m_bOpen(false),
+    m_bWakeUp(false),
+    m_bFinished(false),
+    m_strPort(strPort),
+    m_iPhysicalAddress(0x1000),
+    m_iSpeed(1)
+{
+  memset(&m_stats, 0, sizeof(struct cec_adapter_stats));
+  ParsePort(m_strPort.substr(strlen(CEC_REPLAY_COM_PREFIX)));
+}
+
+CReplayCECAdapterCommunication::~CReplayCECAdapterCommunication(void)
+{
+  Close();
+}
+
+void CReplayCECAdapterCommunication::ParsePort(const std::string &strPort)
+{
+  // the path may contain commas, so options are taken off the end
+  m_strPath = strPort;
+  size_t iComma;
+  while ((iComma = m_strPath.rfind(',')) != std::string::npos)
+  {
+    const std::string strOption(m_strPath.substr(iComma + 1));
+    if (!strOption.compare(0, 3, "pa="))
+      m_iPhysicalAddress = (uint16_t)strtoul(strOption.c_str() + 3, NULL, 16);
+    else if (!strOption.compare(0, 6, "speed="))
+      m_iSpeed = (uint32_t)strtoul(strOption.c_str() + 6, NULL, 10);
+    else
+      break;
+    m_strPath.erase(iComma);
+  }
+}
+
+bool CReplayCECAdapterCommunication::Open(uint32_t UNUSED(iTimeoutMs), bool UNUSED(bSkipChecks), bool bStartListening)
+{
+  if (IsOpen())
+    Close();
+
+  CCECTrafficCaptureReader reader;
+  if (!reader.Open(m_strPath))
+  {
+    LIB_CEC->AddLog(CEC_LOG_ERROR, "%s - '%s' is not a traffic capture", __FUNCTION__, m_strPath.c_str());
+    return false;
+  }
+
+  // there's nothing to detect
+  if (!bStartListening)
+    return true;
+
+  {
+    CLockObject lock(m_mutex);
+    m_records.clear();
+
+    replay_record entry;
+    entry.bTransmitted = false;
+    while (reader.Read(entry.record))
+      m_records.push_back(entry);
+
+    LIB_CEC->AddLog(CEC_LOG_DEBUG, "%s - path=%s frames=%u speed=%u", __FUNCTION__, m_strPath.c_str(), (unsigned int)m_records.size(), m_iSpeed);
+    m_bOpen = true;
+    m_bWakeUp = false;
+    m_bFinished = false;
+  }
+
+  if (CreateThread())
+    return true;
+
+  Close();
+  return false;
+}
+
+void CReplayCECAdapterCommunication::Close(void)
+{
+  {
+    CLockObject lock(m_mutex);
+    m_bOpen = false;
+    m_bWakeUp = true;
+    m_condition.Broadcast();
+  }
+
+  StopThread(0);
+}
+
+bool CReplayCECAdapterCommunication::IsOpen(void)
+{
+  CLockObject lock(m_mutex);
+  return m_bOpen;
+}
+
+bool CReplayCECAdapterCommunication::IsFinished(void) const
+{
+  CLockObject lock(m_mutex);
+  return m_bFinished;
+}
+
+cec_adapter_message_state CReplayCECAdapterCommunication::Write(const cec_command &data, bool &bRetry, uint8_t UNUSED(iLineTimeout), bool UNUSED(bIsReply))
+{
+  // retries were captured as separate frames
+  bRetry = false;
+
+  CLockObject lock(m_mutex);
+  if (!m_bOpen)
+    return ADAPTER_MESSAGE_STATE_UNKNOWN;
+
+  // the first frame in the capture that matches decides the result
+  for (std::vector<replay_record>::iterator it = m_records.begin(); it != m_records.end(); ++it)
+  {
+    if (it->record.direction == CEC_CAPTURE_TX && !it->bTransmitted && IsSameFrame(it->record.command, data))
+    {
+      it->bTransmitted = true;
+      m_bWakeUp = true;
+      m_condition.Broadcast();
+
+      const cec_adapter_message_state state(it->record.state);
+      if (state == ADAPTER_MESSAGE_STATE_SENT_ACKED)
+        ++m_stats.tx_ack;
+      else if (state == ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED)
+        ++m_stats.tx_nack;
+      else
+        ++m_stats.tx_error;
+      return state;
+    }
+  }
+
+  // frames that weren't in the capture are acked, except for polls for a free
+  // logical address, so libCEC can still allocate one
+  if (!data.opcode_set && data.initiator == data.destination)
+  {
+    ++m_stats.tx_nack;
+    return ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED;
+  }
+  ++m_stats.tx_ack;
+  return ADAPTER_MESSAGE_STATE_SENT_ACKED;
+}
+
+bool CReplayCECAdapterCommunication::SetLogicalAddresses(const cec_logical_addresses &addresses)
+{
+  CLockObject lock(m_mutex);
+  m_logicalAddresses = addresses;
+  return true;
+}
+
+cec_logical_addresses CReplayCECAdapterCommunication::GetLogicalAddresses(void) const
+{
+  CLockObject lock(m_mutex);
+  return m_logicalAddresses;
+}
+
+#if CEC_LIB_VERSION_MAJOR >= 5
+bool CReplayCECAdapterCommunication::GetStats(struct cec_adapter_stats* stats)
+{
+  CLockObject lock(m_mutex);
+  memcpy(stats, &m_stats, sizeof(struct cec_adapter_stats));
+  return true;
+}
+#endif
+
+void *CReplayCECAdapterCommunication::Process(void)
+{
+  int64_t iPreviousUs(-1);
+  int64_t iPlayedUs(GetTimeUs());
+  size_t iPtr(0);
+
+  while (!IsStopped())
+  {
+    cec_capture_record record;
+    {
+      CLockObject lock(m_mutex);
+      if (!m_bOpen)
+        break;
+      if (iPtr == m_records.size())
+      {
+        m_bFinished = true;
+        LIB_CEC->AddLog(CEC_LOG_DEBUG, "%s - replay finished", __FUNCTION__);
+        break;
+      }
+      record = m_records[iPtr].record;
+
+      // keep the time in between frames
+      if (m_iSpeed > 0 && iPreviousUs >= 0 && record.iTimeUs > iPreviousUs)
+      {
+        const int64_t iDueUs(iPlayedUs + (record.iTimeUs - iPreviousUs) / m_iSpeed);
+        int64_t iWaitUs;
+        while (m_bOpen && (iWaitUs = iDueUs - GetTimeUs()) > 0)
+        {
+          m_bWakeUp = false;
+          m_condition.Wait(lock, m_bWakeUp, (uint32_t)((iWaitUs + 999) / 1000));
+        }
+      }
+
+      // wait for libCEC to send the same frame again
+      if (record.direction == CEC_CAPTURE_TX)
+      {
+        const int64_t iTimeoutUs(GetTimeUs() + (int64_t)CEC_REPLAY_TRANSMIT_TIMEOUT * 1000);
+        int64_t iWaitUs;
+        while (m_bOpen && !m_records[iPtr].bTransmitted && (iWaitUs = iTimeoutUs - GetTimeUs()) > 0)
+        {
+          m_bWakeUp = false;
+          m_condition.Wait(lock, m_bWakeUp, (uint32_t)((iWaitUs + 999) / 1000));
+        }
+      }
+
+      if (!m_bOpen)
+        break;
+      if (record.direction == CEC_CAPTURE_RX)
+        ++m_stats.rx_total;
+    }
+
+    if (record.direction == CEC_CAPTURE_RX)
+      m_callback->OnCommandReceived(record.command);
+
+    iPreviousUs = record.iTimeUs;
+    iPlayedUs = GetTimeUs();
+    ++iPtr;
+  }
+
+  return NULL;
+}
+
+#endif
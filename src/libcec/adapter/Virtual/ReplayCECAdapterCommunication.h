@@ -0,0 +1,149 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "env.h"
+
+#if defined(HAVE_VIRTUAL_API)
+#include <string>
+#include <vector>
+#include "platform/threads/mutex.h"
+#include "platform/threads/threads.h"
+#include "../AdapterCommunication.h"
+#include "CECTrafficCapture.h"
+
+// ports starting with this prefix replay a traffic capture, see the constructor
+#define CEC_REPLAY_COM_PREFIX        "replay:"
+#define REPLAY_ADAPTER_VID           0x2548
+#define REPLAY_ADAPTER_PID           0x1101
+// the maximum time to wait for libCEC to send a frame that was sent in the capture
+#define CEC_REPLAY_TRANSMIT_TIMEOUT  1000
+
+namespace CEC
+{
+  /*!
+   * @brief An adapter that plays back a capture that was written by SetTrafficCapture().
+   *
+   * Frames are played back in the order in which they were captured, with the same
+   * time in between. A received frame is passed on once the frames that were
+   * transmitted before it in the capture were transmitted again, so replies don't
+   * arrive before the request. Waiting for a frame that libCEC doesn't send again
+   * stops after CEC_REPLAY_TRANSMIT_TIMEOUT. Transmitted frames get the result
+   * that the same frame got in the capture.
+   */
+  class CReplayCECAdapterCommunication : public IAdapterCommunication, public CThread
+  {
+  public:
+    /*!
+     * @brief Create a new replay communication handler.
+     * @param callback The callback to use for incoming CEC commands.
+     * @param strPort The port that was opened, "replay:" followed by the path to the
+     *        capture, optionally followed by comma separated options:
+     *        - pa=XXXX: the physical address of the adapter in hex, 1000 by default
+     *        - speed=N: play back N times faster than captured, or without any
+     *          delays when 0
+     */
+    CReplayCECAdapterCommunication(IAdapterCommunicationCallback *callback, const char *strPort);
+    virtual ~CReplayCECAdapterCommunication(void);
+
+    /** @name IAdapterCommunication implementation */
+    ///{
+    bool Open(uint32_t iTimeoutMs = CEC_DEFAULT_CONNECT_TIMEOUT, bool bSkipChecks = false, bool bStartListening = true) override;
+    void Close(void) override;
+    bool IsOpen(void) override;
+    cec_adapter_message_state Write(const cec_command &data, bool &bRetry, uint8_t iLineTimeout, bool bIsReply) override;
+    uint8_t GetMaxPendingTransmits(void) const override { return 1; }
+
+    bool SetLineTimeout(uint8_t UNUSED(iTimeout)) override { return true; }
+    bool StartBootloader(void) override { return false; }
+    bool SetLogicalAddresses(const cec_logical_addresses &addresses) override;
+    cec_logical_addresses GetLogicalAddresses(void) const override;
+    bool PingAdapter(void) override { return IsOpen(); }
+    uint16_t GetFirmwareVersion(void) override { return 0; }
+    uint32_t GetFirmwareBuildDate(void) override { return 0; }
+    bool IsRunningLatestFirmware(void) override { return true; }
+    bool SetControlledMode(bool UNUSED(controlled)) override { return true; }
+    bool SaveConfiguration(const libcec_configuration & UNUSED(configuration)) override { return false; }
+    bool SetAutoMode(bool UNUSED(automode)) override { return false; }
+    bool GetConfiguration(libcec_configuration & UNUSED(configuration)) override { return false; }
+    std::string GetPortName(void) override { return m_strPort; }
+    uint16_t GetPhysicalAddress(void) override { return m_iPhysicalAddress; }
+    cec_vendor_id GetVendorId(void) override { return CEC_VENDOR_UNKNOWN; }
+    bool SupportsSourceLogicalAddress(const cec_logical_address address) override { return address >= CECDEVICE_TV && address <= CECDEVICE_BROADCAST; }
+    cec_adapter_type GetAdapterType(void) override { return ADAPTERTYPE_VIRTUAL; }
+    uint16_t GetAdapterVendorId(void) const override { return REPLAY_ADAPTER_VID; }
+    uint16_t GetAdapterProductId(void) const override { return REPLAY_ADAPTER_PID; }
+    void SetActiveSource(bool UNUSED(bSetTo), bool UNUSED(bClientUnregistered)) override {}
+#if CEC_LIB_VERSION_MAJOR >= 5
+    bool GetStats(struct cec_adapter_stats* stats) override;
+#endif
+    ///}
+
+    /** @name CThread implementation */
+    ///{
+    void *Process(void) override;
+    ///}
+
+    /*!
+     * @return True when all received frames in the capture were passed on.
+     */
+    bool IsFinished(void) const;
+
+  private:
+    /*!
+     * @brief Split the options off the port name.
+     */
+    void ParsePort(const std::string &strPort);
+
+    struct replay_record
+    {
+      cec_capture_record record;
+      bool               bTransmitted; /**< true once a transmitted frame was sent again */
+    };
+
+    mutable CMutex             m_mutex;
+    CCondition<bool>           m_condition;
+    bool                       m_bOpen;
+    bool                       m_bWakeUp;          /**< set when the replay thread should check again */
+    bool                       m_bFinished;
+    std::string                m_strPort;
+    std::string                m_strPath;
+    uint16_t                   m_iPhysicalAddress;
+    uint32_t                   m_iSpeed;
+    cec_logical_addresses      m_logicalAddresses;
+    std::vector<replay_record> m_records;
+    struct cec_adapter_stats   m_stats;
+  };
+};
+
+#endif
@@ -0,0 +1,350 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+
+#include "env.h"
+
+#if defined(HAVE_VIRTUAL_API)
+#include "VirtualCECAdapterCommunication.h"
+#include "LibCEC.h"
+#include "platform/util/timeutils.h"
+#include <algorithm>
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+using namespace CEC;
+
+#define LIB_CEC m_callback->GetLib()
+
+namespace
+{
+  std::vector<std::string> Split(const std::string &str, char delimiter)
+  {
+    std::vector<std::string> tokens;
+    size_t iStart(0), iEnd;
+    while ((iEnd = str.find(delimiter, iStart)) != std::string::npos)
+    {
+      tokens.push_back(str.substr(iStart, iEnd - iStart));
+      iStart = iEnd + 1;
+    }
+    tokens.push_back(str.substr(iStart));
+    return tokens;
+  }
+}
+
+CVirtualCECAdapterCommunication::CVirtualCECAdapterCommunication(IAdapterCommunicationCallback *callback, const char *strPort) :
+    IAdapterCommunication(callback),
+    m_bHasPending(false),
+    m_bOpen(false),
+    m_strPort(strPort),
+    m_iSpeed(1),
+    m_bMatchReplies(false)
+{
+  memset(&m_stats, 0, sizeof(struct cec_adapter_stats));
+  memset(&m_counters, 0, sizeof(cec_adapter_counters));
+  m_counters.version = CEC_ADAPTER_COUNTERS_VERSION;
+  m_counters.size    = sizeof(cec_adapter_counters);
+
+  const size_t iPrefixLen(strlen(CEC_VIRTUAL_COM_PREFIX));
+  ParsePort(m_strPort.size() > iPrefixLen ? m_strPort.substr(iPrefixLen) : std::string());
+}
+
+CVirtualCECAdapterCommunication::~CVirtualCECAdapterCommunication(void)
+{
+  Close();
+}
+
+void CVirtualCECAdapterCommunication::ParsePort(const std::string &strOptions)
+{
+  std::vector<std::string> tokens = Split(strOptions, ',');
+  std::vector<std::string> peers;
+
+  // options first, so the peers' physical addresses don't depend on the order
+  for (std::vector<std::string>::const_iterator it = tokens.begin(); it != tokens.end(); ++it)
+  {
+    const std::string &strToken = *it;
+    if (strToken.empty())
+      continue;
+
+    if (!strToken.compare(0, 3, "pa="))
+      m_bus.SetAdapterPhysicalAddress((uint16_t)strtoul(strToken.c_str() + 3, NULL, 16));
+    else if (!strToken.compare(0, 6, "speed="))
+      m_iSpeed = (uint32_t)strtoul(strToken.c_str() + 6, NULL, 10);
+    else if (strToken == "match")
+      m_bMatchReplies = true;
+    else
+      peers.push_back(strToken);
+  }
+
+  if (peers.empty())
+  {
+    peers.push_back("tv");
+    peers.push_back("audio");
+  }
+
+  for (std::vector<std::string>::const_iterator it = peers.begin(); it != peers.end(); ++it)
+    if (!m_bus.AddPeer(*it))
+      LIB_CEC->AddLog(CEC_LOG_WARNING, "%s - ignoring virtual peer '%s'", __FUNCTION__, it->c_str());
+}
+
+bool CVirtualCECAdapterCommunication::Open(uint32_t UNUSED(iTimeoutMs), bool UNUSED(bSkipChecks), bool bStartListening)
+{
+  if (IsOpen())
+    Close();
+
+  LIB_CEC->AddLog(CEC_LOG_DEBUG, "%s - port=%s peers=%u speed=%u", __FUNCTION__, m_strPort.c_str(), (unsigned int)m_bus.Size(), m_iSpeed);
+
+  // there's nothing to detect
+  if (!bStartListening)
+    return true;
+
+  {
+    CLockObject lock(m_mutex);
+    m_bOpen = true;
+    m_bHasPending = false;
+  }
+
+  if (CreateThread())
+    return true;
+
+  Close();
+  return false;
+}
+
+void CVirtualCECAdapterCommunication::Close(void)
+{
+  {
+    CLockObject lock(m_mutex);
+    m_bOpen = false;
+    m_pending.clear();
+    m_bHasPending = true;
+    m_condition.Broadcast();
+
+    for (std::vector<pending_request *>::iterator it = m_requests.begin(); it != m_requests.end(); ++it)
+      (*it)->bDone = true;
+    m_replyCondition.Broadcast();
+  }
+
+  StopThread(0);
+}
+
+bool CVirtualCECAdapterCommunication::IsOpen(void)
+{
+  CLockObject lock(m_mutex);
+  return m_bOpen;
+}
+
+void CVirtualCECAdapterCommunication::BusDelay(int64_t iUs) const
+{
+  if (m_iSpeed > 0 && iUs > 0)
+    std::this_thread::sleep_for(std::chrono::microseconds(iUs / m_iSpeed));
+}
+
+int64_t CVirtualCECAdapterCommunication::OccupyBus(const cec_command &command)
+{
+  CLockObject lock(m_busMutex);
+
+  BusDelay(CEC_VIRTUAL_SIGNAL_FREE_BITS * CEC_VIRTUAL_DATA_BIT_US);
+
+  const int64_t iStartUs(GetTimeUs());
+  BusDelay(CVirtualCECBus::FrameTimeUs(command));
+
+  return iStartUs;
+}
+
+cec_adapter_message_state CVirtualCECAdapterCommunication::Write(const cec_command &data, bool &bRetry, uint8_t UNUSED(iLineTimeout), bool UNUSED(bIsReply))
+{
+  // nothing else is driving this bus, so an ack or a nack is final
+  bRetry = false;
+
+  if (!IsOpen())
+    return ADAPTER_MESSAGE_STATE_UNKNOWN;
+
+  OccupyBus(data);
+
+  std::vector<cec_command> replies;
+
+  CLockObject lock(m_mutex);
+  const bool bAcked(m_bus.Transmit(data, replies));
+
+  if (bAcked)
+    ++m_stats.tx_ack;
+  else
+    ++m_stats.tx_nack;
+
+  if (!replies.empty())
+  {
+    const int64_t iDueUs(GetTimeUs() + (m_iSpeed > 0 ? CEC_VIRTUAL_REPLY_DELAY_US / m_iSpeed : 0));
+    for (std::vector<cec_command>::const_iterator it = replies.begin(); it != replies.end(); ++it)
+    {
+      pending_frame frame = { *it, iDueUs };
+      m_pending.push_back(frame);
+    }
+    m_bHasPending = true;
+    m_condition.Signal();
+  }
+
+  return bAcked ? ADAPTER_MESSAGE_STATE_SENT_ACKED : ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED;
+}
+
+cec_adapter_message_state CVirtualCECAdapterCommunication::WriteRequest(const cec_command &data, bool &bRetry, uint8_t iLineTimeout, cec_transmit_reply &reply)
+{
+  reply.bReceived = false;
+
+  // registered before the request is written, because the reply may be
+  // delivered before Write() returns
+  pending_request request = { data.destination, data.opcode, reply.opcode, false, false };
+  {
+    CLockObject lock(m_mutex);
+    if (!m_bOpen)
+      return ADAPTER_MESSAGE_STATE_UNKNOWN;
+    m_requests.push_back(&request);
+  }
+
+  const cec_adapter_message_state state(Write(data, bRetry, iLineTimeout, false));
+
+  CLockObject lock(m_mutex);
+  if (state == ADAPTER_MESSAGE_STATE_SENT_ACKED)
+    m_replyCondition.Wait(lock, request.bDone, reply.iWaitMs);
+  m_requests.erase(std::remove(m_requests.begin(), m_requests.end(), &request), m_requests.end());
+
+  reply.bReceived = request.bReceived;
+  return state;
+}
+
+void CVirtualCECAdapterCommunication::MatchReplies(const cec_command &command)
+{
+  CLockObject lock(m_mutex);
+  for (std::vector<pending_request *>::iterator it = m_requests.begin(); it != m_requests.end(); ++it)
+  {
+    pending_request &request = **it;
+    if (request.bDone || command.initiator != request.destination)
+      continue;
+
+    if (command.opcode == request.reply)
+      request.bReceived = request.bDone = true;
+    else if (command.opcode == CEC_OPCODE_FEATURE_ABORT && command.parameters.size > 0 && command.parameters[0] == (uint8_t)request.opcode)
+      request.bDone = true;
+  }
+  m_replyCondition.Broadcast();
+}
+
+bool CVirtualCECAdapterCommunication::SetLogicalAddresses(const cec_logical_addresses &addresses)
+{
+  CLockObject lock(m_mutex);
+  m_logicalAddresses = addresses;
+  return true;
+}
+
+cec_logical_addresses CVirtualCECAdapterCommunication::GetLogicalAddresses(void) const
+{
+  CLockObject lock(m_mutex);
+  return m_logicalAddresses;
+}
+
+#if CEC_LIB_VERSION_MAJOR >= 5
+bool CVirtualCECAdapterCommunication::GetStats(struct cec_adapter_stats* stats)
+{
+  CLockObject lock(m_mutex);
+  memcpy(stats, &m_stats, sizeof(struct cec_adapter_stats));
+  return true;
+}
+#endif
+
+bool CVirtualCECAdapterCommunication::GetCounters(cec_adapter_counters* counters)
+{
+  CLockObject lock(m_mutex);
+  memcpy(counters, &m_counters, sizeof(cec_adapter_counters));
+  return true;
+}
+
+void *CVirtualCECAdapterCommunication::Process(void)
+{
+  while (!IsStopped())
+  {
+    pending_frame frame;
+    {
+      CLockObject lock(m_mutex);
+      if (!m_bOpen)
+        break;
+
+      if (m_pending.empty())
+      {
+        m_bHasPending = false;
+        m_condition.Wait(lock, m_bHasPending);
+        continue;
+      }
+
+      frame = m_pending.front();
+      m_pending.pop_front();
+    }
+
+    // replies are queued in the order they're due in
+    const int64_t iWaitUs(frame.iDueUs - GetTimeUs());
+    if (iWaitUs > 0)
+      std::this_thread::sleep_for(std::chrono::microseconds(iWaitUs));
+
+    const int64_t iStartUs(OccupyBus(frame.command));
+
+    // only frames that the adapter's addresses would have acked get delivered
+    bool bDeliver(frame.command.destination == CECDEVICE_BROADCAST);
+    {
+      CLockObject lock(m_mutex);
+      bDeliver |= m_logicalAddresses.IsSet(frame.command.destination);
+      if (!m_bOpen)
+        break;
+    }
+
+    if (bDeliver && !IsStopped())
+    {
+      {
+        CLockObject lock(m_mutex);
+        const int64_t iLatencyUs(GetTimeUs() - iStartUs);
+        ++m_stats.rx_total;
+        ++m_counters.rx_latency_count;
+        m_counters.rx_latency_total_us += (uint64_t)iLatencyUs;
+        if ((uint64_t)iLatencyUs > m_counters.rx_latency_max_us)
+          m_counters.rx_latency_max_us = (uint32_t)iLatencyUs;
+      }
+      m_callback->OnCommandReceived(frame.command);
+      if (m_bMatchReplies)
+        MatchReplies(frame.command);
+    }
+  }
+
+  return NULL;
+}
+
+#endif
@@ -0,0 +1,178 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "env.h"
+
+#if defined(HAVE_VIRTUAL_API)
+#include <deque>
+#include <vector>
+#include <string>
+#include "platform/threads/mutex.h"
+#include "platform/threads/threads.h"
+#include "../AdapterCommunication.h"
+#include "VirtualCECPeer.h"
+
+// ports starting with this prefix open the virtual adapter. the rest of the
+// port is a comma separated list of peers and options, see the constructor
+#define CEC_VIRTUAL_COM_PREFIX       "virtual:"
+#define VIRTUAL_ADAPTER_VID          0x2548
+#define VIRTUAL_ADAPTER_PID          0x1100
+
+namespace CEC
+{
+  /*!
+   * @brief An adapter without hardware behind it. Frames are put on a simulated
+   *        bus, which is held for as long as the frame would take on a real CEC
+   *        line, and answered by simulated peer devices.
+   */
+  class CVirtualCECAdapterCommunication : public IAdapterCommunication, public CThread
+  {
+  public:
+    /*!
+     * @brief Create a new virtual CEC communication handler.
+     * @param callback The callback to use for incoming CEC commands.
+     * @param strPort The port that was opened, "virtual:" followed by a comma
+     *        separated list of:
+     *        - tv, recorder, tuner, playback, audio (or avr): add a peer of this
+     *          type at the first free logical address of the type. append
+     *          ":standby" to start it in standby and ":nack" to have it never
+     *          acknowledge a frame
+     *        - pa=XXXX: the physical address of the adapter in hex, 1000 by default
+     *        - speed=N: run the bus N times faster than a real CEC line, or
+     *          without any delays when 0
+     *        - match: wait for the replies to requests in the adapter, like the
+     *          Linux CEC framework does
+     *        an empty list is the same as "virtual:tv,audio".
+     */
+    CVirtualCECAdapterCommunication(IAdapterCommunicationCallback *callback, const char *strPort);
+    virtual ~CVirtualCECAdapterCommunication(void);
+
+    /** @name IAdapterCommunication implementation */
+    ///{
+    bool Open(uint32_t iTimeoutMs = CEC_DEFAULT_CONNECT_TIMEOUT, bool bSkipChecks = false, bool bStartListening = true) override;
+    void Close(void) override;
+    bool IsOpen(void) override;
+    cec_adapter_message_state Write(const cec_command &data, bool &bRetry, uint8_t iLineTimeout, bool bIsReply) override;
+    uint8_t GetMaxPendingTransmits(void) const override { return 3; }
+    bool SupportsReplyMatching(void) const override { return m_bMatchReplies; }
+    cec_adapter_message_state WriteRequest(const cec_command &data, bool &bRetry, uint8_t iLineTimeout, cec_transmit_reply &reply) override;
+
+    bool SetLineTimeout(uint8_t UNUSED(iTimeout)) override { return true; }
+    bool StartBootloader(void) override { return false; }
+    bool SetLogicalAddresses(const cec_logical_addresses &addresses) override;
+    cec_logical_addresses GetLogicalAddresses(void) const override;
+    bool PingAdapter(void) override { return IsOpen(); }
+    uint16_t GetFirmwareVersion(void) override { return 0; }
+    uint32_t GetFirmwareBuildDate(void) override { return 0; }
+    bool IsRunningLatestFirmware(void) override { return true; }
+    bool SetControlledMode(bool UNUSED(controlled)) override { return true; }
+    bool SaveConfiguration(const libcec_configuration & UNUSED(configuration)) override { return false; }
+    bool SetAutoMode(bool UNUSED(automode)) override { return false; }
+    bool GetConfiguration(libcec_configuration & UNUSED(configuration)) override { return false; }
+    std::string GetPortName(void) override { return m_strPort; }
+    uint16_t GetPhysicalAddress(void) override { return m_bus.GetAdapterPhysicalAddress(); }
+    cec_vendor_id GetVendorId(void) override { return CEC_VENDOR_UNKNOWN; }
+    bool SupportsSourceLogicalAddress(const cec_logical_address address) override { return address >= CECDEVICE_TV && address <= CECDEVICE_BROADCAST; }
+    cec_adapter_type GetAdapterType(void) override { return ADAPTERTYPE_VIRTUAL; }
+    uint16_t GetAdapterVendorId(void) const override { return VIRTUAL_ADAPTER_VID; }
+    uint16_t GetAdapterProductId(void) const override { return VIRTUAL_ADAPTER_PID; }
+    void SetActiveSource(bool UNUSED(bSetTo), bool UNUSED(bClientUnregistered)) override {}
+#if CEC_LIB_VERSION_MAJOR >= 5
+    bool GetStats(struct cec_adapter_stats* stats) override;
+#endif
+    bool GetCounters(cec_adapter_counters* counters) override;
+    ///}
+
+    /** @name CThread implementation */
+    ///{
+    void *Process(void) override;
+    ///}
+
+  private:
+    struct pending_frame
+    {
+      cec_command command;
+      int64_t     iDueUs;
+    };
+
+    struct pending_request
+    {
+      cec_logical_address destination;
+      cec_opcode          opcode;
+      cec_opcode          reply;
+      bool                bReceived; /**< the reply was delivered */
+      bool                bDone;     /**< the reply was delivered, or the request was aborted */
+    };
+
+    /*!
+     * @brief Complete the requests that a delivered frame answers.
+     */
+    void MatchReplies(const cec_command &command);
+
+    /*!
+     * @brief Parse the peers and options in the port name.
+     */
+    void ParsePort(const std::string &strOptions);
+
+    /*!
+     * @brief Hold the bus for the duration of a frame, including the signal free
+     *        time before it. Only one frame is on the bus at a time.
+     * @return The time at which the frame started, in microseconds.
+     */
+    int64_t OccupyBus(const cec_command &command);
+
+    /*!
+     * @brief Sleep for a bus time, scaled by the configured speed.
+     */
+    void BusDelay(int64_t iUs) const;
+
+    mutable CMutex                m_mutex;
+    CCondition<bool>              m_condition;
+    bool                          m_bHasPending;
+    bool                          m_bOpen;
+    std::deque<pending_frame>     m_pending;
+    std::vector<pending_request *> m_requests;   /**< requests that are waiting for their reply */
+    CCondition<bool>              m_replyCondition;
+    CVirtualCECBus                m_bus;
+    cec_logical_addresses         m_logicalAddresses;
+    std::string                   m_strPort;
+    uint32_t                      m_iSpeed;
+    bool                          m_bMatchReplies;
+    CMutex                        m_busMutex;
+    struct cec_adapter_stats      m_stats;
+    cec_adapter_counters          m_counters;
+  };
+};
+
+#endif
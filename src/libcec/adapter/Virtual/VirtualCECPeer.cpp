@@ -0,0 +1,308 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+
+#include "env.h"
+
+#if defined(HAVE_VIRTUAL_API)
+#include "VirtualCECPeer.h"
+#include "CECTypeUtils.h"
+
+using namespace CEC;
+
+namespace
+{
+  struct virtual_peer_type
+  {
+    const char                *strName;
+    const char                *strOSDName;
+    const cec_logical_address *addresses;
+    size_t                     iAddresses;
+  };
+
+  const cec_logical_address g_tvAddresses[]       = { CECDEVICE_TV };
+  const cec_logical_address g_recorderAddresses[] = { CECDEVICE_RECORDINGDEVICE1, CECDEVICE_RECORDINGDEVICE2, CECDEVICE_RECORDINGDEVICE3 };
+  const cec_logical_address g_tunerAddresses[]    = { CECDEVICE_TUNER1, CECDEVICE_TUNER2, CECDEVICE_TUNER3, CECDEVICE_TUNER4 };
+  const cec_logical_address g_playbackAddresses[] = { CECDEVICE_PLAYBACKDEVICE1, CECDEVICE_PLAYBACKDEVICE2, CECDEVICE_PLAYBACKDEVICE3 };
+  const cec_logical_address g_audioAddresses[]    = { CECDEVICE_AUDIOSYSTEM };
+
+#define VIRTUAL_PEER_TYPE(name, osdname, addresses) { name, osdname, addresses, sizeof(addresses) / sizeof(addresses[0]) }
+  const virtual_peer_type g_peerTypes[] =
+  {
+    VIRTUAL_PEER_TYPE("tv",       "TV",       g_tvAddresses),
+    VIRTUAL_PEER_TYPE("recorder", "Recorder", g_recorderAddresses),
+    VIRTUAL_PEER_TYPE("tuner",    "Tuner",    g_tunerAddresses),
+    VIRTUAL_PEER_TYPE("playback", "Playback", g_playbackAddresses),
+    VIRTUAL_PEER_TYPE("audio",    "Audio",    g_audioAddresses),
+    VIRTUAL_PEER_TYPE("avr",      "Audio",    g_audioAddresses),
+  };
+#undef VIRTUAL_PEER_TYPE
+}
+
+CVirtualCECPeer::CVirtualCECPeer(cec_logical_address address, uint16_t iPhysicalAddress, const std::string &strOSDName) :
+    m_address(address),
+    m_type(CCECTypeUtils::GetType(address)),
+    m_iPhysicalAddress(iPhysicalAddress),
+    m_strOSDName(strOSDName),
+    m_vendorId(CEC_VENDOR_PULSE_EIGHT),
+    m_powerStatus(CEC_POWER_STATUS_ON),
+    m_iVolume(0x20),
+    m_bMuted(false),
+    m_bAck(true)
+{
+}
+
+cec_command &CVirtualCECPeer::Reply(std::vector<cec_command> &replies, cec_logical_address destination, cec_opcode opcode)
+{
+  cec_command command;
+  cec_command::Format(command, m_address, destination, opcode);
+  replies.push_back(command);
+  return replies.back();
+}
+
+void CVirtualCECPeer::FeatureAbort(std::vector<cec_command> &replies, const cec_command &command, cec_abort_reason reason)
+{
+  // never answer a broadcast with <Feature Abort>
+  if (command.destination == CECDEVICE_BROADCAST)
+    return;
+
+  cec_command &reply = Reply(replies, command.initiator, CEC_OPCODE_FEATURE_ABORT);
+  reply.parameters.PushBack((uint8_t)command.opcode);
+  reply.parameters.PushBack((uint8_t)reason);
+}
+
+void CVirtualCECPeer::HandleCommand(const cec_command &command, std::vector<cec_command> &replies)
+{
+  // polls carry no opcode, the ack is all the answer they get
+  if (!command.opcode_set)
+    return;
+
+  switch (command.opcode)
+  {
+  case CEC_OPCODE_GIVE_PHYSICAL_ADDRESS:
+    {
+      cec_command &reply = Reply(replies, CECDEVICE_BROADCAST, CEC_OPCODE_REPORT_PHYSICAL_ADDRESS);
+      reply.parameters.PushBack((uint8_t)(m_iPhysicalAddress >> 8));
+      reply.parameters.PushBack((uint8_t)(m_iPhysicalAddress & 0xFF));
+      reply.parameters.PushBack((uint8_t)m_type);
+    }
+    break;
+  case CEC_OPCODE_GIVE_DEVICE_VENDOR_ID:
+    {
+      cec_command &reply = Reply(replies, CECDEVICE_BROADCAST, CEC_OPCODE_DEVICE_VENDOR_ID);
+      reply.parameters.PushBack((uint8_t)(((uint32_t)m_vendorId >> 16) & 0xFF));
+      reply.parameters.PushBack((uint8_t)(((uint32_t)m_vendorId >> 8) & 0xFF));
+      reply.parameters.PushBack((uint8_t)((uint32_t)m_vendorId & 0xFF));
+    }
+    break;
+  case CEC_OPCODE_GIVE_OSD_NAME:
+    {
+      cec_command &reply = Reply(replies, command.initiator, CEC_OPCODE_SET_OSD_NAME);
+      for (size_t iPtr = 0; iPtr < m_strOSDName.size() && iPtr < 14; iPtr++)
+        reply.parameters.PushBack((uint8_t)m_strOSDName[iPtr]);
+    }
+    break;
+  case CEC_OPCODE_GET_CEC_VERSION:
+    Reply(replies, command.initiator, CEC_OPCODE_CEC_VERSION).parameters.PushBack((uint8_t)CEC_VERSION_1_4);
+    break;
+  case CEC_OPCODE_GIVE_DEVICE_POWER_STATUS:
+    Reply(replies, command.initiator, CEC_OPCODE_REPORT_POWER_STATUS).parameters.PushBack((uint8_t)m_powerStatus);
+    break;
+  case CEC_OPCODE_STANDBY:
+    m_powerStatus = CEC_POWER_STATUS_STANDBY;
+    break;
+  case CEC_OPCODE_IMAGE_VIEW_ON:
+  case CEC_OPCODE_TEXT_VIEW_ON:
+    if (m_type == CEC_DEVICE_TYPE_TV)
+      m_powerStatus = CEC_POWER_STATUS_ON;
+    else
+      FeatureAbort(replies, command, CEC_ABORT_REASON_UNRECOGNIZED_OPCODE);
+    break;
+  case CEC_OPCODE_GET_MENU_LANGUAGE:
+    if (m_type == CEC_DEVICE_TYPE_TV)
+    {
+      cec_command &reply = Reply(replies, CECDEVICE_BROADCAST, CEC_OPCODE_SET_MENU_LANGUAGE);
+      reply.parameters.PushBack((uint8_t)'e');
+      reply.parameters.PushBack((uint8_t)'n');
+      reply.parameters.PushBack((uint8_t)'g');
+    }
+    else
+      FeatureAbort(replies, command, CEC_ABORT_REASON_UNRECOGNIZED_OPCODE);
+    break;
+  case CEC_OPCODE_GIVE_DECK_STATUS:
+    if (m_type == CEC_DEVICE_TYPE_PLAYBACK_DEVICE || m_type == CEC_DEVICE_TYPE_RECORDING_DEVICE)
+      Reply(replies, command.initiator, CEC_OPCODE_DECK_STATUS).parameters.PushBack((uint8_t)CEC_DECK_INFO_STOP);
+    else
+      FeatureAbort(replies, command, CEC_ABORT_REASON_UNRECOGNIZED_OPCODE);
+    break;
+  case CEC_OPCODE_GIVE_AUDIO_STATUS:
+    if (m_type == CEC_DEVICE_TYPE_AUDIO_SYSTEM)
+      Reply(replies, command.initiator, CEC_OPCODE_REPORT_AUDIO_STATUS).parameters.PushBack((uint8_t)((m_bMuted ? CEC_AUDIO_MUTE_STATUS_MASK : 0) | m_iVolume));
+    else
+      FeatureAbort(replies, command, CEC_ABORT_REASON_UNRECOGNIZED_OPCODE);
+    break;
+  case CEC_OPCODE_GIVE_SYSTEM_AUDIO_MODE_STATUS:
+    if (m_type == CEC_DEVICE_TYPE_AUDIO_SYSTEM)
+      Reply(replies, command.initiator, CEC_OPCODE_SYSTEM_AUDIO_MODE_STATUS).parameters.PushBack((uint8_t)CEC_SYSTEM_AUDIO_STATUS_ON);
+    else
+      FeatureAbort(replies, command, CEC_ABORT_REASON_UNRECOGNIZED_OPCODE);
+    break;
+  case CEC_OPCODE_USER_CONTROL_PRESSED:
+    if (m_type == CEC_DEVICE_TYPE_AUDIO_SYSTEM && command.parameters.size > 0)
+    {
+      switch (command.parameters[0])
+      {
+      case CEC_USER_CONTROL_CODE_VOLUME_UP:
+        if (m_iVolume < CEC_AUDIO_VOLUME_MAX)
+          ++m_iVolume;
+        m_bMuted = false;
+        break;
+      case CEC_USER_CONTROL_CODE_VOLUME_DOWN:
+        if (m_iVolume > CEC_AUDIO_VOLUME_MIN)
+          --m_iVolume;
+        m_bMuted = false;
+        break;
+      case CEC_USER_CONTROL_CODE_MUTE:
+        m_bMuted = !m_bMuted;
+        break;
+      default:
+        break;
+      }
+    }
+    break;
+  case CEC_OPCODE_ABORT:
+    FeatureAbort(replies, command, CEC_ABORT_REASON_REFUSED);
+    break;
+  case CEC_OPCODE_VENDOR_COMMAND:
+  case CEC_OPCODE_VENDOR_COMMAND_WITH_ID:
+  case CEC_OPCODE_VENDOR_REMOTE_BUTTON_DOWN:
+    FeatureAbort(replies, command, CEC_ABORT_REASON_UNRECOGNIZED_OPCODE);
+    break;
+  default:
+    // everything else is accepted without a reply
+    break;
+  }
+}
+
+CVirtualCECPeer *CVirtualCECBus::AddPeer(const std::string &strPeer)
+{
+  const size_t iFlags(strPeer.find(':'));
+  const std::string strType(strPeer.substr(0, iFlags));
+
+  for (size_t iType = 0; iType < sizeof(g_peerTypes) / sizeof(g_peerTypes[0]); iType++)
+  {
+    const virtual_peer_type &type = g_peerTypes[iType];
+    if (strType != type.strName)
+      continue;
+
+    cec_power_status powerStatus(CEC_POWER_STATUS_ON);
+    bool bAck(true);
+    size_t iStart(iFlags);
+    while (iStart != std::string::npos)
+    {
+      const size_t iEnd(strPeer.find(':', iStart + 1));
+      const std::string strFlag(strPeer.substr(iStart + 1, iEnd == std::string::npos ? std::string::npos : iEnd - iStart - 1));
+      if (strFlag == "standby")
+        powerStatus = CEC_POWER_STATUS_STANDBY;
+      else if (strFlag == "nack")
+        bAck = false;
+      else
+        return NULL;
+      iStart = iEnd;
+    }
+
+    for (size_t iAddress = 0; iAddress < type.iAddresses; iAddress++)
+    {
+      if (GetPeer(type.addresses[iAddress]))
+        continue;
+
+      // the tv is the root, and everything else gets the next free input on it
+      uint16_t iPhysicalAddress(0);
+      if (type.addresses[iAddress] != CECDEVICE_TV)
+      {
+        uint16_t iPort(1);
+        bool bTaken(true);
+        while (bTaken && iPort <= 0xF)
+        {
+          iPhysicalAddress = (uint16_t)(iPort++ << 12);
+          bTaken = iPhysicalAddress == m_iAdapterPhysicalAddress;
+          for (size_t iPeer = 0; !bTaken && iPeer < m_peers.size(); iPeer++)
+            bTaken = m_peers[iPeer]->GetPhysicalAddress() == iPhysicalAddress;
+        }
+      }
+
+      m_peers.emplace_back(new CVirtualCECPeer(type.addresses[iAddress], iPhysicalAddress, type.strOSDName));
+      m_peers.back()->SetPowerStatus(powerStatus);
+      m_peers.back()->SetAcks(bAck);
+      return m_peers.back().get();
+    }
+    return NULL;
+  }
+  return NULL;
+}
+
+CVirtualCECPeer *CVirtualCECBus::GetPeer(cec_logical_address address) const
+{
+  for (size_t iPeer = 0; iPeer < m_peers.size(); iPeer++)
+    if (m_peers[iPeer]->GetLogicalAddress() == address)
+      return m_peers[iPeer].get();
+  return NULL;
+}
+
+bool CVirtualCECBus::Transmit(const cec_command &command, std::vector<cec_command> &replies)
+{
+  if (command.destination == CECDEVICE_BROADCAST)
+  {
+    // broadcasts are acked unless a follower rejects them, which peers don't
+    for (size_t iPeer = 0; iPeer < m_peers.size(); iPeer++)
+      if (m_peers[iPeer]->Acks())
+        m_peers[iPeer]->HandleCommand(command, replies);
+    return true;
+  }
+
+  CVirtualCECPeer *peer = GetPeer(command.destination);
+  if (!peer || !peer->Acks())
+    return false;
+
+  peer->HandleCommand(command, replies);
+  return true;
+}
+
+int64_t CVirtualCECBus::FrameTimeUs(const cec_command &command)
+{
+  // header, plus the opcode and parameters when this isn't a poll
+  const int64_t iBlocks(1 + (command.opcode_set ? 1 + command.parameters.size : 0));
+  return CEC_VIRTUAL_START_BIT_US + iBlocks * CEC_VIRTUAL_BITS_PER_BLOCK * CEC_VIRTUAL_DATA_BIT_US;
+}
+
+#endif
@@ -0,0 +1,158 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "env.h"
+
+#if defined(HAVE_VIRTUAL_API)
+#include "cectypes.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// nominal CEC timing, in microseconds
+#define CEC_VIRTUAL_START_BIT_US     4500
+#define CEC_VIRTUAL_DATA_BIT_US      2400
+// 8 data bits, EOM and ACK per block
+#define CEC_VIRTUAL_BITS_PER_BLOCK   10
+// the signal free time a new initiator waits for, in bit periods
+#define CEC_VIRTUAL_SIGNAL_FREE_BITS 5
+// the time a peer takes to start transmitting a reply
+#define CEC_VIRTUAL_REPLY_DELAY_US   10000
+
+namespace CEC
+{
+  /*!
+   * @brief A simulated device on the virtual CEC bus. It answers the requests
+   *        that libCEC sends while discovering and controlling devices, the way
+   *        a well behaved device of its type would.
+   */
+  class CVirtualCECPeer
+  {
+  public:
+    /*!
+     * @brief Create a new peer.
+     * @param address The logical address of the peer.
+     * @param iPhysicalAddress The physical address of the peer.
+     * @param strOSDName The name the peer reports in <Set OSD Name>.
+     */
+    CVirtualCECPeer(cec_logical_address address, uint16_t iPhysicalAddress, const std::string &strOSDName);
+    virtual ~CVirtualCECPeer(void) {}
+
+    /*!
+     * @brief Process a frame that was sent to this peer, or broadcast.
+     * @param command The frame that was received.
+     * @param replies Filled with the frames the peer transmits in response.
+     */
+    void HandleCommand(const cec_command &command, std::vector<cec_command> &replies);
+
+    cec_logical_address GetLogicalAddress(void) const { return m_address; }
+    uint16_t GetPhysicalAddress(void) const { return m_iPhysicalAddress; }
+    cec_power_status GetPowerStatus(void) const { return m_powerStatus; }
+    void SetPowerStatus(cec_power_status status) { m_powerStatus = status; }
+    cec_vendor_id GetVendorId(void) const { return m_vendorId; }
+    void SetVendorId(cec_vendor_id vendorId) { m_vendorId = vendorId; }
+
+    /*!
+     * @return False when this peer doesn't acknowledge any frame, like a device
+     *         that is listed on the bus but has CEC disabled.
+     */
+    bool Acks(void) const { return m_bAck; }
+    void SetAcks(bool bAck) { m_bAck = bAck; }
+
+  private:
+    cec_command &Reply(std::vector<cec_command> &replies, cec_logical_address destination, cec_opcode opcode);
+    void FeatureAbort(std::vector<cec_command> &replies, const cec_command &command, cec_abort_reason reason);
+
+    cec_logical_address m_address;
+    cec_device_type     m_type;
+    uint16_t            m_iPhysicalAddress;
+    std::string         m_strOSDName;
+    cec_vendor_id       m_vendorId;
+    cec_power_status    m_powerStatus;
+    uint8_t             m_iVolume;
+    bool                m_bMuted;
+    bool                m_bAck;
+  };
+
+  /*!
+   * @brief The peers on a simulated CEC bus, and the acks they give. Used by
+   *        every backend that simulates a bus, so they all behave the same.
+   *        Not thread safe, callers serialise access.
+   */
+  class CVirtualCECBus
+  {
+  public:
+    /*!
+     * @param iAdapterPhysicalAddress The physical address of the adapter, which
+     *        won't be given to any peer.
+     */
+    CVirtualCECBus(uint16_t iAdapterPhysicalAddress = 0x1000) :
+      m_iAdapterPhysicalAddress(iAdapterPhysicalAddress) {}
+
+    void SetAdapterPhysicalAddress(uint16_t iPhysicalAddress) { m_iAdapterPhysicalAddress = iPhysicalAddress; }
+    uint16_t GetAdapterPhysicalAddress(void) const { return m_iAdapterPhysicalAddress; }
+
+    /*!
+     * @brief Add a peer at the first free logical address of its type.
+     * @param strPeer The type of the peer: tv, recorder, tuner, playback, audio
+     *        or avr, optionally followed by ":standby" to start it in standby
+     *        and ":nack" to have it never acknowledge a frame.
+     * @return The new peer, or NULL when the type or a flag isn't known, or all
+     *         addresses of the type are taken.
+     */
+    CVirtualCECPeer *AddPeer(const std::string &strPeer);
+    CVirtualCECPeer *GetPeer(cec_logical_address address) const;
+    size_t Size(void) const { return m_peers.size(); }
+
+    /*!
+     * @brief Put a frame on the bus.
+     * @param command The frame to send.
+     * @param replies Filled with the frames the peers transmit in response.
+     * @return True when the frame was acked.
+     */
+    bool Transmit(const cec_command &command, std::vector<cec_command> &replies);
+
+    /*!
+     * @return The time a frame occupies the bus, excluding the signal free time
+     *         before it, in microseconds.
+     */
+    static int64_t FrameTimeUs(const cec_command &command);
+
+  private:
+    std::vector<std::unique_ptr<CVirtualCECPeer>> m_peers;
+    uint16_t                                      m_iAdapterPhysicalAddress;
+  };
+};
+
+#endif
@@ -0,0 +1,532 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+
+/*
+ * Micro-benchmarks for the per-frame work libCEC does: parsing and framing
+ * adapter messages, matching replies, serialising and logging commands, and
+ * dispatching them to the command handlers. The inputs are generated from a
+ * seed, so two runs with the same seed measure the same work, and the results
+ * can be written as json or csv to compare builds.
+ */
+
+#include "env.h"
+#include "cec.h"
+#include "version.h"
+#include "CECTypeUtils.h"
+#include "CECProcessor.h"
+#include "LibCEC.h"
+#include "adapter/Pulse-Eight/USBCECAdapterMessage.h"
+#include "adapter/Pulse-Eight/USBCECAdapterMessageQueue.h"
+#include "devices/CECBusDevice.h"
+#include "implementations/CECCommandHandler.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace CEC;
+
+namespace
+{
+  struct bench_options
+  {
+    uint32_t    iSeed;
+    size_t      iFrames;
+    size_t      iIterations;
+    size_t      iSamples;
+    std::string strFilter;
+    std::string strFormat;
+  };
+
+  struct bench_result
+  {
+    std::string strName;
+    std::string strUnit;
+    uint64_t    iOps;
+    double      fMinNs;
+    double      fMedianNs;
+  };
+
+  struct bench_corpus
+  {
+    std::vector<cec_command>        commands;  /**< frames on the bus */
+    std::vector<uint8_t>            serial;    /**< the same frames, as sent by a Pulse-Eight adapter */
+    size_t                          iMessages; /**< the number of adapter messages in serial */
+    std::vector<CCECAdapterMessage> messages;  /**< the same adapter messages, parsed */
+  };
+
+  /*!
+   * @brief The opcodes in the corpus, roughly in the mix seen on a busy bus.
+   */
+  struct corpus_opcode
+  {
+    cec_opcode opcode;
+    uint8_t    iMinParameters;
+    uint8_t    iMaxParameters;
+    unsigned   iWeight;
+  };
+
+  const corpus_opcode g_corpusOpcodes[] =
+  {
+    { CEC_OPCODE_NONE,                    0, 0,  10 }, // polls
+    { CEC_OPCODE_REPORT_POWER_STATUS,     1, 1,  12 },
+    { CEC_OPCODE_GIVE_DEVICE_POWER_STATUS,0, 0,  12 },
+    { CEC_OPCODE_REPORT_PHYSICAL_ADDRESS, 3, 3,   6 },
+    { CEC_OPCODE_DEVICE_VENDOR_ID,        3, 3,   4 },
+    { CEC_OPCODE_SET_OSD_NAME,            1, 14,  4 },
+    { CEC_OPCODE_CEC_VERSION,             1, 1,   4 },
+    { CEC_OPCODE_ACTIVE_SOURCE,           2, 2,   4 },
+    { CEC_OPCODE_USER_CONTROL_PRESSED,    1, 1,  12 },
+    { CEC_OPCODE_USER_CONTROL_RELEASE,    0, 0,  12 },
+    { CEC_OPCODE_REPORT_AUDIO_STATUS,     1, 1,   8 },
+    { CEC_OPCODE_VENDOR_COMMAND_WITH_ID,  4, 11,  8 },
+    { CEC_OPCODE_FEATURE_ABORT,           2, 2,   4 },
+  };
+
+  /*!
+   * @brief Append a message the way the adapter sends it, escaping the payload.
+   */
+  void AppendAdapterMessage(std::vector<uint8_t> &serial, uint8_t iCode, uint8_t iData)
+  {
+    serial.push_back(MSGSTART);
+    serial.push_back(iCode);
+    if (iData >= MSGESC)
+    {
+      serial.push_back(MSGESC);
+      serial.push_back((uint8_t)(iData - ESCOFFSET));
+    }
+    else
+      serial.push_back(iData);
+    serial.push_back(MSGEND);
+  }
+
+  void BuildCorpus(const bench_options &options, bench_corpus &corpus)
+  {
+    std::mt19937 random(options.iSeed);
+    unsigned iTotalWeight(0);
+    for (size_t iPtr = 0; iPtr < sizeof(g_corpusOpcodes) / sizeof(g_corpusOpcodes[0]); iPtr++)
+      iTotalWeight += g_corpusOpcodes[iPtr].iWeight;
+
+    std::uniform_int_distribution<unsigned> weight(0, iTotalWeight - 1);
+    std::uniform_int_distribution<int> address(CECDEVICE_TV, CECDEVICE_BROADCAST);
+    std::uniform_int_distribution<int> byte(0, 0xFF);
+
+    corpus.iMessages = 0;
+    for (size_t iFrame = 0; iFrame < options.iFrames; iFrame++)
+    {
+      unsigned iWeight(weight(random));
+      const corpus_opcode *type = g_corpusOpcodes;
+      while (iWeight >= type->iWeight)
+        iWeight -= (type++)->iWeight;
+
+      cec_command command;
+      command.Clear();
+      command.initiator = (cec_logical_address)address(random);
+      if (command.initiator == CECDEVICE_BROADCAST)
+        command.initiator = CECDEVICE_UNREGISTERED;
+      do
+        command.destination = (cec_logical_address)address(random);
+      while (command.destination == command.initiator);
+
+      if (type->opcode != CEC_OPCODE_NONE)
+      {
+        command.opcode_set = 1;
+        command.opcode     = type->opcode;
+        std::uniform_int_distribution<int> parameters(type->iMinParameters, type->iMaxParameters);
+        for (int iPtr = parameters(random); iPtr > 0; iPtr--)
+          command.parameters.PushBack((uint8_t)byte(random));
+      }
+      corpus.commands.push_back(command);
+
+      // a frame start, and a data message per byte after the header
+      uint8_t frame[CEC_MAX_DATA_PACKET_SIZE + 2];
+      const int iSize(command.Serialize(frame, sizeof(frame)));
+      for (int iPtr = 0; iPtr < iSize; iPtr++)
+      {
+        uint8_t iCode((uint8_t)(iPtr == 0 ? MSGCODE_FRAME_START : MSGCODE_FRAME_DATA));
+        if (command.destination != CECDEVICE_BROADCAST)
+          iCode |= MSGCODE_FRAME_ACK;
+        if (iPtr == iSize - 1)
+          iCode |= MSGCODE_FRAME_EOM;
+        AppendAdapterMessage(corpus.serial, iCode, frame[iPtr]);
+        ++corpus.iMessages;
+      }
+    }
+
+    CCECAdapterMessage message;
+    for (size_t iPtr = 0; iPtr < corpus.serial.size(); iPtr++)
+    {
+      if (message.PushReceivedByte(corpus.serial[iPtr]))
+      {
+        corpus.messages.push_back(message);
+        message.Clear();
+      }
+    }
+  }
+
+  /*!
+   * @brief Run a benchmark, and time it over several samples.
+   * @param run Processes the whole corpus once, and returns the number of ops.
+   */
+  bool RunBenchmark(const bench_options &options, const char *strName, const char *strUnit, const std::function<uint64_t(void)> &run, std::vector<bench_result> &results)
+  {
+    if (!options.strFilter.empty() && std::string(strName).find(options.strFilter) == std::string::npos)
+      return false;
+
+    // warm the caches and branch predictors
+    run();
+
+    std::vector<double> samples;
+    uint64_t iOps(0);
+    for (size_t iSample = 0; iSample < options.iSamples; iSample++)
+    {
+      uint64_t iSampleOps(0);
+      const auto start = std::chrono::steady_clock::now();
+      for (size_t iIteration = 0; iIteration < options.iIterations; iIteration++)
+        iSampleOps += run();
+      const auto end = std::chrono::steady_clock::now();
+
+      const double fNs((double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+      samples.push_back(iSampleOps > 0 ? fNs / (double)iSampleOps : 0);
+      iOps += iSampleOps;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    bench_result result;
+    result.strName   = strName;
+    result.strUnit   = strUnit;
+    result.iOps      = iOps;
+    result.fMinNs    = samples.front();
+    result.fMedianNs = samples[samples.size() / 2];
+    results.push_back(result);
+    return true;
+  }
+
+  // keeps the compiler from optimising the benchmarked calls away
+  volatile uint64_t g_iSink(0);
+
+  void BenchParsing(const bench_options &options, const bench_corpus &corpus, std::vector<bench_result> &results)
+  {
+    RunBenchmark(options, "push_received_byte", "message", [&corpus]() {
+      CCECAdapterMessage message;
+      uint64_t iMessages(0);
+      for (std::vector<uint8_t>::const_iterator it = corpus.serial.begin(); it != corpus.serial.end(); ++it)
+      {
+        if (message.PushReceivedByte(*it))
+        {
+          ++iMessages;
+          message.Clear();
+        }
+      }
+      return iMessages;
+    }, results);
+
+    RunBenchmark(options, "push_escaped", "frame", [&corpus]() {
+      CCECAdapterMessage message;
+      uint8_t frame[CEC_MAX_DATA_PACKET_SIZE + 2];
+      for (std::vector<cec_command>::const_iterator it = corpus.commands.begin(); it != corpus.commands.end(); ++it)
+      {
+        const int iSize(it->Serialize(frame, sizeof(frame)));
+        message.Clear();
+        for (int iPtr = 0; iPtr < iSize; iPtr++)
+          message.PushEscaped(frame[iPtr]);
+        g_iSink += message.Size();
+      }
+      return (uint64_t)corpus.commands.size();
+    }, results);
+
+    RunBenchmark(options, "push_to_cec_command", "frame", [&corpus]() {
+      cec_command command;
+      command.Clear();
+      uint64_t iFrames(0);
+      for (std::vector<CCECAdapterMessage>::const_iterator it = corpus.messages.begin(); it != corpus.messages.end(); ++it)
+        if (it->PushToCecCommand(command))
+          ++iFrames;
+      return iFrames;
+    }, results);
+  }
+
+  void BenchMatching(const bench_options &options, const bench_corpus &corpus, std::vector<bench_result> &results)
+  {
+    // a transmission and a few settings requests are waiting for a reply, and
+    // every message that the adapter sends is checked against all of them
+    std::vector<CCECAdapterMessage *> sent;
+    sent.push_back(new CCECAdapterMessage(corpus.commands.front()));
+    const cec_adapter_messagecode requests[] = { MSGCODE_PING, MSGCODE_GET_BUILDDATE, MSGCODE_SET_ACK_MASK };
+    for (size_t iPtr = 0; iPtr < sizeof(requests) / sizeof(requests[0]); iPtr++)
+    {
+      CCECAdapterMessage *message = new CCECAdapterMessage;
+      message->PushBack(MSGSTART);
+      message->PushEscaped((uint8_t)requests[iPtr]);
+      message->PushBack(MSGEND);
+      sent.push_back(message);
+    }
+
+    std::vector<CCECAdapterMessageQueueEntry *> entries;
+    for (std::vector<CCECAdapterMessage *>::iterator it = sent.begin(); it != sent.end(); ++it)
+      entries.push_back(new CCECAdapterMessageQueueEntry(NULL, *it));
+
+    // the replies, mixed with the frames from the corpus
+    std::vector<CCECAdapterMessage> replies;
+    const uint8_t replyCodes[][2] =
+    {
+      { MSGCODE_COMMAND_ACCEPTED, MSGCODE_TRANSMIT_ACK_POLARITY },
+      { MSGCODE_COMMAND_ACCEPTED, MSGCODE_TRANSMIT },
+      { MSGCODE_COMMAND_ACCEPTED, MSGCODE_TRANSMIT_EOM },
+      { MSGCODE_TRANSMIT_SUCCEEDED, 0 },
+      { MSGCODE_TRANSMIT_FAILED_ACK, 0 },
+      { MSGCODE_COMMAND_ACCEPTED, MSGCODE_PING },
+      { MSGCODE_GET_BUILDDATE, 0x50 },
+    };
+    for (size_t iPtr = 0; iPtr < corpus.messages.size(); iPtr++)
+    {
+      replies.push_back(corpus.messages[iPtr]);
+      const uint8_t *reply = replyCodes[iPtr % (sizeof(replyCodes) / sizeof(replyCodes[0]))];
+      CCECAdapterMessage message;
+      message.PushBack(MSGSTART);
+      message.PushEscaped(reply[0]);
+      if (reply[1])
+        message.PushEscaped(reply[1]);
+      message.PushBack(MSGEND);
+      replies.push_back(message);
+    }
+
+    RunBenchmark(options, "is_response", "check", [&entries, &replies]() {
+      uint64_t iMatches(0);
+      for (std::vector<CCECAdapterMessage>::const_iterator it = replies.begin(); it != replies.end(); ++it)
+        for (std::vector<CCECAdapterMessageQueueEntry *>::const_iterator entry = entries.begin(); entry != entries.end(); ++entry)
+          iMatches += (*entry)->IsResponse(*it) ? 1 : 0;
+      g_iSink += iMatches;
+      return (uint64_t)(replies.size() * entries.size());
+    }, results);
+
+    for (size_t iPtr = 0; iPtr < entries.size(); iPtr++)
+    {
+      delete entries[iPtr];
+      delete sent[iPtr];
+    }
+  }
+
+  void BenchCommands(const bench_options &options, const bench_corpus &corpus, std::vector<bench_result> &results)
+  {
+    RunBenchmark(options, "serialize", "frame", [&corpus]() {
+      uint8_t frame[CEC_MAX_DATA_PACKET_SIZE + 2];
+      for (std::vector<cec_command>::const_iterator it = corpus.commands.begin(); it != corpus.commands.end(); ++it)
+        g_iSink += (uint64_t)it->Serialize(frame, sizeof(frame));
+      return (uint64_t)corpus.commands.size();
+    }, results);
+
+    RunBenchmark(options, "to_string", "frame", [&corpus]() {
+      for (std::vector<cec_command>::const_iterator it = corpus.commands.begin(); it != corpus.commands.end(); ++it)
+        g_iSink += CCECTypeUtils::ToString(*it).size();
+      return (uint64_t)corpus.commands.size();
+    }, results);
+  }
+
+  void BenchHandlers(const bench_options &options, std::vector<bench_result> &results)
+  {
+    if (!options.strFilter.empty() && std::string("handle_command").find(options.strFilter) == std::string::npos)
+      return;
+
+    // a real processor, on a bus without any delays
+    libcec_configuration config;
+    config.Clear();
+    snprintf(config.strDeviceName, sizeof(config.strDeviceName), "cec-bench");
+    config.bActivateSource = 0;
+    config.deviceTypes.Add(CEC_DEVICE_TYPE_RECORDING_DEVICE);
+
+    CLibCEC *lib = static_cast<CLibCEC *>(CECInitialise(&config));
+    if (!lib || !lib->Open("virtual:tv,audio,speed=0"))
+    {
+      fprintf(stderr, "couldn't open the virtual adapter, skipping handle_command\n");
+      if (lib)
+        CECDestroy(lib);
+      return;
+    }
+
+    // reports from the tv and the audio system, that are handled without
+    // transmitting anything
+    const cec_logical_address ourAddress(lib->GetLogicalAddresses().primary);
+    std::vector<cec_command> commands;
+    cec_command command;
+    cec_command::Format(command, CECDEVICE_TV, ourAddress, CEC_OPCODE_REPORT_POWER_STATUS);
+    command.parameters.PushBack(CEC_POWER_STATUS_ON);
+    commands.push_back(command);
+    cec_command::Format(command, CECDEVICE_TV, ourAddress, CEC_OPCODE_CEC_VERSION);
+    command.parameters.PushBack(CEC_VERSION_1_4);
+    commands.push_back(command);
+    cec_command::Format(command, CECDEVICE_TV, ourAddress, CEC_OPCODE_SET_OSD_NAME);
+    command.PushArray(2, (const uint8_t *)"TV");
+    commands.push_back(command);
+    cec_command::Format(command, CECDEVICE_TV, CECDEVICE_BROADCAST, CEC_OPCODE_SET_MENU_LANGUAGE);
+    command.PushArray(3, (const uint8_t *)"eng");
+    commands.push_back(command);
+    cec_command::Format(command, CECDEVICE_AUDIOSYSTEM, ourAddress, CEC_OPCODE_REPORT_AUDIO_STATUS);
+    command.parameters.PushBack(0x20);
+    commands.push_back(command);
+
+    RunBenchmark(options, "handle_command", "frame", [lib, &commands]() {
+      for (std::vector<cec_command>::const_iterator it = commands.begin(); it != commands.end(); ++it)
+      {
+        CCECBusDevice *device = lib->m_cec->GetDevice(it->initiator);
+        CCECCommandHandler *handler = device->GetHandler();
+        g_iSink += handler->HandleCommand(*it) ? 1 : 0;
+        device->MarkHandlerReady();
+      }
+      return (uint64_t)commands.size();
+    }, results);
+
+    lib->Close();
+    CECDestroy(lib);
+  }
+
+  void PrintResults(const bench_options &options, const bench_corpus &corpus, const std::vector<bench_result> &results)
+  {
+    const unsigned int iVersion(_LIBCEC_VERSION_CURRENT);
+    if (options.strFormat == "json")
+    {
+      printf("{\n  \"libcec\": \"%u.%u.%u\",\n  \"seed\": %u,\n  \"frames\": %u,\n  \"iterations\": %u,\n  \"samples\": %u,\n  \"benchmarks\": [\n",
+          LIBCEC_UINT_TO_VERSION_MAJOR(iVersion), LIBCEC_UINT_TO_VERSION_MINOR(iVersion), LIBCEC_UINT_TO_VERSION_PATCH(iVersion),
+          options.iSeed, (unsigned int)corpus.commands.size(), (unsigned int)options.iIterations, (unsigned int)options.iSamples);
+      for (size_t iPtr = 0; iPtr < results.size(); iPtr++)
+        printf("    { \"name\": \"%s\", \"unit\": \"%s\", \"ops\": %llu, \"ns_per_op_min\": %.2f, \"ns_per_op_median\": %.2f }%s\n",
+            results[iPtr].strName.c_str(), results[iPtr].strUnit.c_str(), (unsigned long long)results[iPtr].iOps,
+            results[iPtr].fMinNs, results[iPtr].fMedianNs, iPtr + 1 < results.size() ? "," : "");
+      printf("  ]\n}\n");
+    }
+    else if (options.strFormat == "csv")
+    {
+      printf("name,unit,ops,ns_per_op_min,ns_per_op_median\n");
+      for (size_t iPtr = 0; iPtr < results.size(); iPtr++)
+        printf("%s,%s,%llu,%.2f,%.2f\n", results[iPtr].strName.c_str(), results[iPtr].strUnit.c_str(),
+            (unsigned long long)results[iPtr].iOps, results[iPtr].fMinNs, results[iPtr].fMedianNs);
+    }
+    else
+    {
+      printf("libCEC %u.%u.%u, seed %u, %u frames, %u iterations x %u samples\n\n",
+          LIBCEC_UINT_TO_VERSION_MAJOR(iVersion), LIBCEC_UINT_TO_VERSION_MINOR(iVersion), LIBCEC_UINT_TO_VERSION_PATCH(iVersion),
+          options.iSeed, (unsigned int)corpus.commands.size(), (unsigned int)options.iIterations, (unsigned int)options.iSamples);
+      printf("%-22s %-9s %14s %14s\n", "benchmark", "per", "min ns", "median ns");
+      for (size_t iPtr = 0; iPtr < results.size(); iPtr++)
+        printf("%-22s %-9s %14.2f %14.2f\n", results[iPtr].strName.c_str(), results[iPtr].strUnit.c_str(),
+            results[iPtr].fMinNs, results[iPtr].fMedianNs);
+    }
+  }
+
+  void ShowHelpCommandLine(const char *strExec)
+  {
+    printf("\n%s [options]\n\n"
+        "parameters:\n"
+        "  -h --help                   Shows this help text\n"
+        "  -s --seed {n}               Seed for the generated frames. Default: 1\n"
+        "  -n --frames {n}             Number of frames to generate. Default: 256\n"
+        "  -i --iterations {n}         Passes over the frames per sample. Default: 200\n"
+        "  -r --samples {n}            Number of samples to take. Default: 5\n"
+        "  -b --bench {name}           Only run the benchmarks with this in their name\n"
+        "  -f --format {text|json|csv} Output format. Default: text\n\n",
+        strExec);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  bench_options options;
+  options.iSeed       = 1;
+  options.iFrames     = 256;
+  options.iIterations = 200;
+  options.iSamples    = 5;
+  options.strFormat   = "text";
+
+  for (int iArgPtr = 1; iArgPtr < argc; iArgPtr++)
+  {
+    const char *strArg = argv[iArgPtr];
+    const char *strValue = iArgPtr + 1 < argc ? argv[iArgPtr + 1] : NULL;
+
+    if (!strcmp(strArg, "-h") || !strcmp(strArg, "--help"))
+    {
+      ShowHelpCommandLine(argv[0]);
+      return 0;
+    }
+
+    if (!strValue)
+    {
+      fprintf(stderr, "unknown or incomplete parameter: %s\n", strArg);
+      ShowHelpCommandLine(argv[0]);
+      return 1;
+    }
+
+    if (!strcmp(strArg, "-s") || !strcmp(strArg, "--seed"))
+      options.iSeed = (uint32_t)strtoul(strValue, NULL, 10);
+    else if (!strcmp(strArg, "-n") || !strcmp(strArg, "--frames"))
+      options.iFrames = (size_t)strtoul(strValue, NULL, 10);
+    else if (!strcmp(strArg, "-i") || !strcmp(strArg, "--iterations"))
+      options.iIterations = (size_t)strtoul(strValue, NULL, 10);
+    else if (!strcmp(strArg, "-r") || !strcmp(strArg, "--samples"))
+      options.iSamples = (size_t)strtoul(strValue, NULL, 10);
+    else if (!strcmp(strArg, "-b") || !strcmp(strArg, "--bench"))
+      options.strFilter = strValue;
+    else if (!strcmp(strArg, "-f") || !strcmp(strArg, "--format"))
+      options.strFormat = strValue;
+    else
+    {
+      fprintf(stderr, "unknown parameter: %s\n", strArg);
+      ShowHelpCommandLine(argv[0]);
+      return 1;
+    }
+    ++iArgPtr;
+  }
+
+  if (options.iFrames == 0 || options.iIterations == 0 || options.iSamples == 0)
+  {
+    fprintf(stderr, "frames, iterations and samples must be at least 1\n");
+    return 1;
+  }
+
+  bench_corpus corpus;
+  BuildCorpus(options, corpus);
+
+  std::vector<bench_result> results;
+  BenchParsing(options, corpus, results);
+  BenchMatching(options, corpus, results);
+  BenchCommands(options, corpus, results);
+  BenchHandlers(options, results);
+
+  PrintResults(options, corpus, results);
+  return results.empty() ? 1 : 0;
+}
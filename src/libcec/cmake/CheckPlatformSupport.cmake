@@ -22,6 +22,8 @@
 #       RPI_INCLUDE_DIR           PATH to Raspberry Pi includes
 #       RPI_LIB_DIR               PATH to Raspberry Pi libs
 #       HAVE_TEGRA_API            ON if Tegra is supported
+#       HAVE_VIRTUAL_API          OFF to leave out the virtual adapter (ON by default)
+#       HAVE_DAEMON_API           ON if cec-daemon and its "daemon:" port are supported
 #
 
 set(PLATFORM_LIBREQUIRES "")
@@ -33,6 +35,8 @@ include(FindPkgConfig)
 # defaults
 # Pulse-Eight devices are always supported
 set(HAVE_P8_USB          ON  CACHE BOOL "p8 usb-cec supported" FORCE)
+# the virtual adapter needs no hardware or headers, and is what the tests run against
+set(HAVE_VIRTUAL_API     ON  CACHE BOOL "virtual adapter supported")
 # Raspberry Pi libs and headers are in a non-standard path on some distributions
 set(RPI_INCLUDE_DIR      ""  CACHE FILEPATH "path to Raspberry Pi includes")
 set(RPI_LIB_DIR          ""  CACHE FILEPATH "path to Raspberry Pi libs")
@@ -191,6 +195,27 @@ else()
   endif()
 endif()
 
+# Virtual
+if (HAVE_VIRTUAL_API)
+  set(CEC_SOURCES_ADAPTER_VIRTUAL adapter/Virtual/VirtualCECAdapterCommunication.cpp
+                                  adapter/Virtual/VirtualCECPeer.cpp
+                                  adapter/Virtual/ReplayCECAdapterCommunication.cpp)
+  source_group("Source Files\\adapter\\Virtual" FILES ${CEC_SOURCES_ADAPTER_VIRTUAL})
+  list(APPEND CEC_SOURCES ${CEC_SOURCES_ADAPTER_VIRTUAL})
+endif()
+
+# cec-daemon, which shares an adapter over a unix domain socket
+if (NOT WIN32)
+  set(HAVE_DAEMON_API ON)
+  set(CEC_SOURCES_ADAPTER_DAEMON adapter/Daemon/DaemonProtocol.cpp
+                                 adapter/Daemon/DaemonCECAdapterCommunication.cpp
+                                 adapter/Daemon/DaemonCECServer.cpp)
+  source_group("Source Files\\adapter\\Daemon" FILES ${CEC_SOURCES_ADAPTER_DAEMON})
+  list(APPEND CEC_SOURCES ${CEC_SOURCES_ADAPTER_DAEMON})
+else()
+  set(HAVE_DAEMON_API OFF)
+endif()
+
 # rt
 check_library_exists(rt clock_gettime "" HAVE_RT)
 
@@ -281,6 +306,14 @@ else()
   SET(HAVE_EXYNOS_API OFF CACHE BOOL "Tegra supported")
 endif()
 
+if (HAVE_VIRTUAL_API)
+  set(LIB_INFO "${LIB_INFO}, virtual")
+endif()
+
+if (HAVE_DAEMON_API)
+  set(LIB_INFO "${LIB_INFO}, daemon")
+endif()
+
 SET(SKIP_PYTHON_WRAPPER 0 CACHE STRING "Define to 1 to not generate the Python wrapper")
 
 if (${SKIP_PYTHON_WRAPPER})
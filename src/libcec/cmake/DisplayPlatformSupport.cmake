@@ -68,6 +68,12 @@ else()
   message(STATUS "i.MX6 SoC support:                      no")
 endif()
 
+if (HAVE_VIRTUAL_API)
+  message(STATUS "Virtual adapter support:                yes")
+else()
+  message(STATUS "Virtual adapter support:                no")
+endif()
+
 if (HAVE_PYTHON)
   message(STATUS "Python support:                         version ${PYTHONLIBS_VERSION_STRING} (${PYTHON_VERSION})")
 else()
@@ -81,7 +81,9 @@ void CResponse::Broadcast(void)
   m_event.Broadcast();
 }
 
-CWaitForResponse::CWaitForResponse(void)
+CWaitForResponse::CWaitForResponse(CCECLatencyStats *stats /* = NULL */, cec_logical_address address /* = CECDEVICE_UNKNOWN */) :
+    m_stats(stats),
+    m_address(address)
 {
 }
 
@@ -104,7 +106,14 @@ void CWaitForResponse::Clear()
 bool CWaitForResponse::Wait(cec_opcode opcode, uint32_t iTimeout)
 {
   CResponse *response = GetEvent(opcode);
-  return response ? response->Wait(iTimeout) : false;
+  if (!response)
+    return false;
+
+  const int64_t iStartUs(GetTimeUs());
+  const bool bReceived(response->Wait(iTimeout));
+  if (m_stats)
+    m_stats->AddResponse(m_address, opcode, bReceived, GetTimeUs() - iStartUs);
+  return bReceived;
 }
 
 void CWaitForResponse::Received(cec_opcode opcode)
@@ -152,7 +161,8 @@ CCECBusDevice::CCECBusDevice(CCECProcessor *processor, cec_logical_address iLogi
   m_iHandlerUseCount      (0),
   m_bAwaitingReceiveFailed(false),
   m_bVendorIdRequested    (false),
-  m_waitForResponse       (new CWaitForResponse),
+  m_bCachedInformation    (false),
+  m_waitForResponse       (new CWaitForResponse(&processor->GetLatencyStats(), iLogicalAddress)),
   m_bImageViewOnSent      (false),
   m_bActiveSourceSent     (false)
 {
@@ -378,6 +388,12 @@ bool CCECBusDevice::TransmitPlay(const cec_logical_address initiator, cec_play_m
   return bReturn;
 }
 
+cec_version CCECBusDevice::GetCurrentCecVersion(void)
+{
+  CLockObject lock(m_mutex);
+  return m_cecVersion;
+}
+
 cec_version CCECBusDevice::GetCecVersion(const cec_logical_address initiator, bool bUpdate /* = false */)
 {
   bool bIsPresent(GetStatus() == CEC_DEVICE_STATUS_PRESENT);
@@ -401,6 +417,9 @@ cec_version CCECBusDevice::GetCecVersion(const cec_logical_address initiator, bo
 void CCECBusDevice::SetCecVersion(const cec_version newVersion)
 {
   CLockObject lock(m_mutex);
+  if (m_bCachedInformation && m_cecVersion != CEC_VERSION_UNKNOWN &&
+      newVersion != CEC_VERSION_UNKNOWN && m_cecVersion != newVersion)
+    DropCachedInformation("CEC version changed");
   if (m_cecVersion != newVersion)
     LIB_CEC->AddLog(CEC_LOG_DEBUG, "%s (%X): CEC version %s", GetLogicalAddressName(), m_iLogicalAddress, ToString(newVersion));
   m_cecVersion = newVersion;
@@ -436,6 +455,12 @@ bool CCECBusDevice::TransmitCECVersion(const cec_logical_address destination, bo
   return bReturn;
 }
 
+std::string CCECBusDevice::GetCurrentMenuLanguage(void)
+{
+  CLockObject lock(m_mutex);
+  return m_menuLanguage;
+}
+
 std::string CCECBusDevice::GetMenuLanguage(const cec_logical_address initiator, bool bUpdate /* = false */)
 {
   bool bIsPresent(GetStatus() == CEC_DEVICE_STATUS_PRESENT);
@@ -633,9 +658,13 @@ uint16_t CCECBusDevice::GetPhysicalAddress(const cec_logical_address initiator,
 bool CCECBusDevice::SetPhysicalAddress(uint16_t iNewAddress)
 {
   CLockObject lock(m_mutex);
+  if (m_bCachedInformation && iNewAddress > 0 && m_iPhysicalAddress != iNewAddress)
+    DropCachedInformation("physical address changed");
   if (iNewAddress > 0 && m_iPhysicalAddress != iNewAddress)
   {
     LIB_CEC->AddLog(CEC_LOG_DEBUG, "%s (%X): physical address changed from %04x to %04x", GetLogicalAddressName(), m_iLogicalAddress, m_iPhysicalAddress, iNewAddress);
+    if (m_processor->GetDevices())
+      m_processor->GetDevices()->OnPhysicalAddressChanged(m_iLogicalAddress, m_iPhysicalAddress, iNewAddress);
     m_iPhysicalAddress = iNewAddress;
   }
   return true;
@@ -813,6 +842,8 @@ bool CCECBusDevice::SetVendorId(uint64_t iVendorId)
   {
     CLockObject lock(m_mutex);
     bVendorChanged = (m_vendor != (cec_vendor_id)iVendorId);
+    if (bVendorChanged && m_bCachedInformation && m_vendor != CEC_VENDOR_UNKNOWN && iVendorId != CEC_VENDOR_UNKNOWN)
+      DropCachedInformation("vendor changed");
     m_vendor = (cec_vendor_id)iVendorId;
   }
 
@@ -878,16 +909,7 @@ cec_bus_device_status CCECBusDevice::GetStatus(bool bForcePoll /* = false */, bo
   {
     CLockObject lock(m_mutex);
     status = m_deviceStatus;
-    bNeedsPoll = !bSuppressPoll &&
-        m_deviceStatus != CEC_DEVICE_STATUS_HANDLED_BY_LIBCEC &&
-        // don't poll Samsung TVs because they can power on randomly
-        (m_processor->GetDevice(CECDEVICE_TV)->GetCurrentVendorId() != CEC_VENDOR_SAMSUNG || m_iLogicalAddress != CECDEVICE_TV) &&
-            // poll forced
-            (bForcePoll ||
-            // don't know the status
-            m_deviceStatus == CEC_DEVICE_STATUS_UNKNOWN ||
-            // always poll the TV if it's marked as not present
-            (m_deviceStatus == CEC_DEVICE_STATUS_NOT_PRESENT && m_iLogicalAddress == CECDEVICE_TV));
+    bNeedsPoll = !bSuppressPoll && NeedsPoll(bForcePoll);
   }
 
   if (bNeedsPoll)
@@ -901,6 +923,23 @@ cec_bus_device_status CCECBusDevice::GetStatus(bool bForcePoll /* = false */, bo
   return status;
 }
 
+bool CCECBusDevice::NeedsPoll(bool bForcePoll /* = false */)
+{
+  if (m_iLogicalAddress == CECDEVICE_BROADCAST)
+    return false;
+
+  CLockObject lock(m_mutex);
+  return m_deviceStatus != CEC_DEVICE_STATUS_HANDLED_BY_LIBCEC &&
+      // don't poll Samsung TVs because they can power on randomly
+      (m_processor->GetDevice(CECDEVICE_TV)->GetCurrentVendorId() != CEC_VENDOR_SAMSUNG || m_iLogicalAddress != CECDEVICE_TV) &&
+          // poll forced
+          (bForcePoll ||
+          // don't know the status
+          m_deviceStatus == CEC_DEVICE_STATUS_UNKNOWN ||
+          // always poll the TV if it's marked as not present
+          (m_deviceStatus == CEC_DEVICE_STATUS_NOT_PRESENT && m_iLogicalAddress == CECDEVICE_TV));
+}
+
 void CCECBusDevice::SetDeviceStatus(const cec_bus_device_status newStatus, cec_version libCECSpecVersion /* = CEC_VERSION_1_4 */)
 {
   if (m_iLogicalAddress == CECDEVICE_UNREGISTERED)
@@ -927,6 +966,8 @@ void CCECBusDevice::SetDeviceStatus(const cec_bus_device_status newStatus, cec_v
     case CEC_DEVICE_STATUS_HANDLED_BY_LIBCEC:
       if (m_deviceStatus != newStatus)
         LIB_CEC->AddLog(CEC_LOG_DEBUG, "%s (%X): device status changed into 'handled by libCEC'", GetLogicalAddressName(), m_iLogicalAddress);
+      if (m_bCachedInformation)
+        DropCachedInformation("address claimed by libCEC");
       SetPowerStatus   (CEC_POWER_STATUS_ON);
       SetVendorId      (iVendorId);
       SetMenuState     (CEC_MENU_STATE_ACTIVATED);
@@ -968,6 +1009,14 @@ void CCECBusDevice::ResetDeviceStatus(bool bClientUnregistered /* = false */)
   SetOSDName       (ToString(m_iLogicalAddress));
   MarkAsInactiveSource(bClientUnregistered);
 
+  // cached properties weren't confirmed by the device, so nothing is kept
+  if (m_bCachedInformation)
+  {
+    m_bCachedInformation = false;
+    SetPhysicalAddress(CEC_INVALID_PHYSICAL_ADDRESS);
+    SetMenuLanguage("???");
+  }
+
   m_iLastActive = 0;
   m_bVendorIdRequested = false;
   m_unsupportedFeatures.clear();
@@ -1441,7 +1490,12 @@ bool CCECBusDevice::TryLogicalAddress(cec_version libCECSpecVersion /* = CEC_VER
 {
   LIB_CEC->AddLog(CEC_LOG_DEBUG, "trying logical address '%s'", GetLogicalAddressName());
 
-  if (!TransmitPoll(m_iLogicalAddress, false))
+  return HandleLogicalAddressPoll(TransmitPoll(m_iLogicalAddress, false), libCECSpecVersion);
+}
+
+bool CCECBusDevice::HandleLogicalAddressPoll(bool bTaken, cec_version libCECSpecVersion /* = CEC_VERSION_1_4 */)
+{
+  if (!bTaken)
   {
     LIB_CEC->AddLog(CEC_LOG_DEBUG, "using logical address '%s'", GetLogicalAddressName());
     SetDeviceStatus(CEC_DEVICE_STATUS_HANDLED_BY_LIBCEC, libCECSpecVersion);
@@ -1464,9 +1518,149 @@ void CCECBusDevice::SignalOpcode(cec_opcode opcode)
   m_waitForResponse->Received(opcode);
 }
 
-bool CCECBusDevice::WaitForOpcode(cec_opcode opcode)
+bool CCECBusDevice::WaitForOpcode(cec_opcode opcode, uint32_t iTimeout /* = CEC_DEFAULT_TRANSMIT_WAIT */)
+{
+  return m_waitForResponse->Wait(opcode, iTimeout);
+}
+
+void CCECBusDevice::RequestDeviceInformation(const cec_logical_address initiator, std::vector<device_request_t> &requests)
+{
+  if (GetStatus(false, true) != CEC_DEVICE_STATUS_PRESENT)
+    return;
+
+  // the same properties that the getters would request, one at a time
+  std::vector<cec_opcode> opcodes;
+  bool bReplaceHandler(false);
+  {
+    CLockObject lock(m_mutex);
+    if (m_vendor == CEC_VENDOR_UNKNOWN)
+      opcodes.push_back(CEC_OPCODE_GIVE_DEVICE_VENDOR_ID);
+    if (m_iPhysicalAddress == CEC_INVALID_PHYSICAL_ADDRESS)
+      opcodes.push_back(CEC_OPCODE_GIVE_PHYSICAL_ADDRESS);
+    if (m_cecVersion == CEC_VERSION_UNKNOWN)
+      opcodes.push_back(CEC_OPCODE_GET_CEC_VERSION);
+    if (m_powerStatus == CEC_POWER_STATUS_UNKNOWN ||
+        m_powerStatus == CEC_POWER_STATUS_IN_TRANSITION_STANDBY_TO_ON ||
+        m_powerStatus == CEC_POWER_STATUS_IN_TRANSITION_ON_TO_STANDBY ||
+        GetTimeMs() - m_iLastPowerStateUpdate >= CEC_POWER_STATE_REFRESH_TIME)
+      opcodes.push_back(CEC_OPCODE_GIVE_DEVICE_POWER_STATUS);
+    if (m_strDeviceName == ToString(m_iLogicalAddress) && m_type != CEC_DEVICE_TYPE_TV)
+      opcodes.push_back(CEC_OPCODE_GIVE_OSD_NAME);
+    if (m_menuLanguage == "???")
+      opcodes.push_back(CEC_OPCODE_GET_MENU_LANGUAGE);
+
+    bReplaceHandler = !opcodes.empty() && !m_bVendorIdRequested;
+    if (bReplaceHandler)
+      m_bVendorIdRequested = true;
+  }
+
+  if (bReplaceHandler)
+    ReplaceHandler(false);
+
+  for (std::vector<cec_opcode>::const_iterator it = opcodes.begin(); it != opcodes.end(); ++it)
+  {
+    if (IsUnsupportedFeature(*it))
+      continue;
+
+    LIB_CEC->AddLog(CEC_LOG_DEBUG, "<< requesting '%s' from '%s' (%X)", ToString(*it), GetLogicalAddressName(), m_iLogicalAddress);
+    cec_command command;
+    cec_command::Format(command, initiator, m_iLogicalAddress, *it);
+
+    device_request_t request;
+    request.device      = this;
+    request.response    = cec_command::GetResponseOpcode(*it);
+    request.transmitted = m_processor->TransmitAsync(command, false);
+    requests.push_back(std::move(request));
+  }
+}
+
+void CCECBusDevice::GetCurrentDeviceInformation(cec_device_info &info)
+{
+  const bool bHandledByLibCEC(IsHandledByLibCEC());
+
+  CLockObject lock(m_mutex);
+  memset(&info, 0, sizeof(info));
+  info.logicalAddress   = m_iLogicalAddress;
+  info.iPhysicalAddress = m_iPhysicalAddress;
+  info.iVendorId        = (uint32_t)m_vendor;
+  info.cecVersion       = m_cecVersion;
+  info.powerStatus      = m_powerStatus;
+  strncpy(info.strOSDName, m_strDeviceName.c_str(), sizeof(info.strOSDName) - 1);
+  strncpy(info.strMenuLanguage, m_menuLanguage.c_str(), sizeof(info.strMenuLanguage) - 1);
+  info.bActiveSource    = m_bActiveSource ? 1 : 0;
+  info.bHandledByLibCEC = bHandledByLibCEC ? 1 : 0;
+}
+
+void CCECBusDevice::SetCachedInformation(const device_cache_entry_t &entry)
 {
-  return m_waitForResponse->Wait(opcode);
+  CLockObject lock(m_mutex);
+  LIB_CEC->AddLog(CEC_LOG_DEBUG, "%s (%X): using cached information, last seen %lds ago", GetLogicalAddressName(), m_iLogicalAddress, (long)(CCECDeviceCache::Now() - entry.iLastSeen));
+  SetPhysicalAddress(entry.iPhysicalAddress);
+  SetVendorId       (entry.vendor);
+  SetCecVersion     (entry.cecVersion);
+  if (!entry.strOSDName.empty())
+    SetOSDName      (entry.strOSDName);
+  if (!entry.strMenuLanguage.empty())
+    SetMenuLanguage (entry.strMenuLanguage);
+  m_bCachedInformation = true;
+}
+
+bool CCECBusDevice::HasCachedInformation(void)
+{
+  CLockObject lock(m_mutex);
+  return m_bCachedInformation;
+}
+
+bool CCECBusDevice::GetCacheEntry(device_cache_entry_t &entry)
+{
+  CLockObject lock(m_mutex);
+  if (m_deviceStatus != CEC_DEVICE_STATUS_PRESENT ||
+      !CCECDeviceCache::IsValidPhysicalAddress(m_iLogicalAddress, m_iPhysicalAddress) ||
+      m_cecVersion == CEC_VERSION_UNKNOWN)
+    return false;
+
+  entry.logicalAddress   = m_iLogicalAddress;
+  entry.iPhysicalAddress = m_iPhysicalAddress;
+  entry.vendor           = m_vendor;
+  entry.cecVersion       = m_cecVersion;
+  entry.strOSDName       = m_strDeviceName == ToString(m_iLogicalAddress) ? "" : m_strDeviceName;
+  entry.strMenuLanguage  = m_menuLanguage == "???" ? "" : m_menuLanguage;
+  entry.iLastSeen        = CCECDeviceCache::Now();
+  return true;
+}
+
+void CCECBusDevice::RevalidateCachedInformation(const cec_logical_address initiator)
+{
+  if (!HasCachedInformation())
+    return;
+
+  LIB_CEC->AddLog(CEC_LOG_DEBUG, "<< checking the cached information of '%s' (%X)", GetLogicalAddressName(), m_iLogicalAddress);
+  cec_command poll;
+  cec_command::Format(poll, initiator, m_iLogicalAddress, CEC_OPCODE_NONE);
+  m_processor->TransmitAsync(poll, false, [this, initiator](bool bSucceeded) {
+    // a device that doesn't respond loses the cached properties
+    SetDeviceStatus(bSucceeded ? CEC_DEVICE_STATUS_PRESENT : CEC_DEVICE_STATUS_NOT_PRESENT);
+    if (!bSucceeded)
+      return;
+
+    // the replies are compared to the cached values when they're received
+    cec_command request;
+    cec_command::Format(request, initiator, m_iLogicalAddress, CEC_OPCODE_GIVE_PHYSICAL_ADDRESS);
+    m_processor->TransmitAsync(request, false);
+    cec_command::Format(request, initiator, m_iLogicalAddress, CEC_OPCODE_GIVE_DEVICE_VENDOR_ID);
+    m_processor->TransmitAsync(request, false);
+  });
+}
+
+void CCECBusDevice::DropCachedInformation(const char *strReason)
+{
+  // called with m_mutex held
+  LIB_CEC->AddLog(CEC_LOG_NOTICE, "%s (%X): dropping the cached information: %s", GetLogicalAddressName(), m_iLogicalAddress, strReason);
+  m_bCachedInformation = false;
+  SetCecVersion  (CEC_VERSION_UNKNOWN);
+  SetOSDName     (ToString(m_iLogicalAddress));
+  SetMenuLanguage("???");
+  m_bVendorIdRequested = false;
 }
 
 bool CCECBusDevice::SystemAudioModeRequest(void)
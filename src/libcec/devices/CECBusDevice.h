@@ -38,10 +38,15 @@
 #include <map>
 #include <string>
 #include <memory>
+#include <future>
+#include <vector>
+#include "CECDeviceCache.h"
 
 namespace CEC
 {
+  class CCECBusDevice;
   class CCECClient;
+  class CCECLatencyStats;
   class CCECProcessor;
   class CCECCommandHandler;
   class CCECAudioSystem;
@@ -51,6 +56,13 @@ namespace CEC
   class CCECTV;
   typedef std::shared_ptr<CCECClient> CECClientPtr;
 
+  typedef struct
+  {
+    CCECBusDevice*    device;
+    cec_opcode        response;    /**< the opcode of the reply to wait for */
+    std::future<bool> transmitted; /**< the result of the transmission */
+  } device_request_t;
+
   class CResponse
   {
   public:
@@ -68,7 +80,11 @@ namespace CEC
   class CWaitForResponse
   {
   public:
-    CWaitForResponse(void);
+    /*!
+     * @param stats Where the time spent waiting is added, or NULL.
+     * @param address The device that replies are waited for.
+     */
+    CWaitForResponse(CCECLatencyStats *stats = NULL, cec_logical_address address = CECDEVICE_UNKNOWN);
     ~CWaitForResponse(void);
 
     void Clear();
@@ -80,6 +96,8 @@ namespace CEC
 
     CMutex                           m_mutex;
     std::map<cec_opcode, CResponse*> m_waitingFor;
+    CCECLatencyStats *               m_stats;
+    cec_logical_address              m_address;
   };
 
   class CCECBusDevice
@@ -121,11 +139,13 @@ namespace CEC
     virtual bool                  TransmitKeyRelease(const cec_logical_address initiator, bool bWait = true);
     virtual bool                  TransmitPlay(const cec_logical_address initiator, cec_play_mode mode);
 
+    virtual cec_version           GetCurrentCecVersion(void);
     virtual cec_version           GetCecVersion(const cec_logical_address initiator, bool bUpdate = false);
     virtual void                  SetCecVersion(const cec_version newVersion);
     virtual bool                  RequestCecVersion(const cec_logical_address initiator, bool bWaitForResponse = true);
     virtual bool                  TransmitCECVersion(const cec_logical_address destination, bool bIsReply);
 
+    virtual std::string           GetCurrentMenuLanguage(void);
     virtual std::string           GetMenuLanguage(const cec_logical_address initiator, bool bUpdate = false);
     virtual void                  SetMenuLanguage(const std::string& strLanguage);
     virtual void                  SetMenuLanguage(const cec_menu_language &menuLanguage);
@@ -166,6 +186,7 @@ namespace CEC
     virtual cec_bus_device_status GetStatus(bool bForcePoll = false, bool bSuppressPoll = false);
     virtual void                  SetDeviceStatus(const cec_bus_device_status newStatus, cec_version libCECSpecVersion = CEC_VERSION_1_4);
     virtual void                  ResetDeviceStatus(bool bClientUnregistered = false);
+    virtual bool                  NeedsPoll(bool bForcePoll = false);
     virtual bool                  TransmitPoll(const cec_logical_address destination, bool bUpdateDeviceStatus);
     virtual void                  HandlePoll(const cec_logical_address destination);
     virtual void                  HandlePollFrom(const cec_logical_address initiator);
@@ -197,9 +218,59 @@ namespace CEC
 
     virtual bool                  TryLogicalAddress(cec_version libCECSpecVersion = CEC_VERSION_1_4);
 
+    /*!
+     * @brief Update the status of this logical address after it was polled to see whether it's free.
+     * @param bTaken True when the poll was acked by another device.
+     * @param libCECSpecVersion The CEC version to use when libCEC takes this address.
+     * @return True when libCEC took this address.
+     */
+    virtual bool                  HandleLogicalAddressPoll(bool bTaken, cec_version libCECSpecVersion = CEC_VERSION_1_4);
+
+    /*!
+     * @brief Queue requests for the properties of this device that aren't known yet,
+     *        without waiting for the transmissions or the replies.
+     * @param initiator The logical address to send the requests from.
+     * @param requests The requests are added to this list.
+     */
+    virtual void                  RequestDeviceInformation(const cec_logical_address initiator, std::vector<device_request_t> &requests);
+
+    /*!
+     * @brief Get the properties of this device that are known, without sending requests.
+     * @param info The properties.
+     */
+    virtual void                  GetCurrentDeviceInformation(cec_device_info &info);
+
+    /*!
+     * @brief Use the properties that were stored in the device cache during a previous connection.
+     *        They're dropped when the device doesn't respond, or when it reports a different
+     *        vendor, physical address or CEC version.
+     * @param entry The cached properties.
+     */
+    virtual void                  SetCachedInformation(const device_cache_entry_t &entry);
+
+    /*!
+     * @return True when the properties of this device were taken from the device cache.
+     */
+    virtual bool                  HasCachedInformation(void);
+
+    /*!
+     * @brief Get the properties of this device to store in the device cache.
+     * @param entry The properties.
+     * @return True when this device is present and can be cached, false otherwise.
+     */
+    virtual bool                  GetCacheEntry(device_cache_entry_t &entry);
+
+    /*!
+     * @brief Check cached properties in the background: poll this device, and request its
+     *        physical address and vendor id when it's present. The replies are compared to
+     *        the cached values when they're received.
+     * @param initiator The logical address to send the poll and requests from.
+     */
+    virtual void                  RevalidateCachedInformation(const cec_logical_address initiator);
+
     CECClientPtr                  GetClient(void);
     void                          SignalOpcode(cec_opcode opcode);
-    bool                          WaitForOpcode(cec_opcode opcode);
+    bool                          WaitForOpcode(cec_opcode opcode, uint32_t iTimeout = CEC_DEFAULT_TRANSMIT_WAIT);
 
     void                          SetActiveSourceSent(bool setto = true);
     bool                          ActiveSourceSent(void) const;
@@ -217,6 +288,7 @@ namespace CEC
 
   protected:
     void CheckVendorIdRequested(const cec_logical_address source);
+    void DropCachedInformation(const char *strReason);
     void MarkBusy(void);
     void MarkReady(void);
 
@@ -243,6 +315,7 @@ namespace CEC
     unsigned              m_iHandlerUseCount;
     bool                  m_bAwaitingReceiveFailed;
     bool                  m_bVendorIdRequested;
+    bool                  m_bCachedInformation;  /**< true when the properties were taken from the device cache */
     CWaitForResponse     *m_waitForResponse;
     bool                  m_bImageViewOnSent;
     bool                  m_bActiveSourceSent;
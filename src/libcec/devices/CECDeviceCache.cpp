@@ -0,0 +1,215 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+
+#include "env.h"
+#include "CECDeviceCache.h"
+
+#include "LibCEC.h"
+#include <ctime>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace CEC;
+
+#define DEVICE_CACHE_HEADER "# libCEC device cache v1"
+
+CCECDeviceCache::CCECDeviceCache(const std::string &strPath, const std::string &strAdapter) :
+    m_strPath(strPath),
+    m_strAdapter(strAdapter)
+{
+  // the adapter is a column in the file
+  for (std::string::iterator it = m_strAdapter.begin(); it != m_strAdapter.end(); ++it)
+  {
+    if (*it == '\t' || *it == '\r' || *it == '\n')
+      *it = ' ';
+  }
+}
+
+int64_t CCECDeviceCache::Now(void)
+{
+  return (int64_t)time(NULL);
+}
+
+bool CCECDeviceCache::IsValidPhysicalAddress(cec_logical_address logicalAddress, uint16_t iPhysicalAddress)
+{
+  // the tv is the root device
+  return iPhysicalAddress == 0 ?
+      logicalAddress == CECDEVICE_TV :
+      CLibCEC::IsValidPhysicalAddress(iPhysicalAddress);
+}
+
+bool CCECDeviceCache::Load(std::vector<device_cache_entry_t> &entries) const
+{
+  std::ifstream file(m_strPath.c_str());
+  if (!file)
+    return false;
+
+  const int64_t iNow(Now());
+  std::string strLine;
+  while (std::getline(file, strLine))
+  {
+    if (strLine.empty() || strLine[0] == '#')
+      continue;
+
+    std::string strAdapter;
+    device_cache_entry_t entry;
+    if (!Parse(strLine, strAdapter, entry) || strAdapter != m_strAdapter)
+      continue;
+
+    // expired, or the clock changed
+    if (iNow - entry.iLastSeen > CEC_DEVICE_CACHE_TTL_S || entry.iLastSeen > iNow)
+      continue;
+
+    // a second device with the same logical address replaces the first one
+    std::vector<device_cache_entry_t>::iterator it = entries.begin();
+    while (it != entries.end() && it->logicalAddress != entry.logicalAddress)
+      ++it;
+    if (it == entries.end())
+      entries.push_back(entry);
+    else if (it->iLastSeen < entry.iLastSeen)
+      *it = entry;
+  }
+
+  return true;
+}
+
+bool CCECDeviceCache::Save(const std::vector<device_cache_entry_t> &entries) const
+{
+  // keep the devices of other adapters
+  std::vector<std::string> lines;
+  {
+    std::ifstream file(m_strPath.c_str());
+    std::string strLine;
+    while (file && std::getline(file, strLine))
+    {
+      std::string strAdapter;
+      device_cache_entry_t entry;
+      if (Parse(strLine, strAdapter, entry) && strAdapter != m_strAdapter)
+        lines.push_back(strLine);
+    }
+  }
+
+  for (std::vector<device_cache_entry_t>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+    lines.push_back(Format(*it));
+
+  // write to a temporary file first, so a crash doesn't leave half a file behind
+  const std::string strTmpPath(m_strPath + ".tmp");
+  {
+    std::ofstream file(strTmpPath.c_str(), std::ios::out | std::ios::trunc);
+    if (!file)
+      return false;
+
+    file << DEVICE_CACHE_HEADER << '\n';
+    for (std::vector<std::string>::const_iterator it = lines.begin(); it != lines.end(); ++it)
+      file << *it << '\n';
+
+    file.flush();
+    if (!file)
+    {
+      file.close();
+      remove(strTmpPath.c_str());
+      return false;
+    }
+  }
+
+#if defined(_WIN32) || defined(_WIN64)
+  // rename() doesn't replace an existing file on windows
+  remove(m_strPath.c_str());
+#endif
+  if (rename(strTmpPath.c_str(), m_strPath.c_str()) != 0)
+  {
+    remove(strTmpPath.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool CCECDeviceCache::Parse(const std::string &strLine, std::string &strAdapter, device_cache_entry_t &entry) const
+{
+  std::vector<std::string> fields;
+  std::istringstream stream(strLine);
+  std::string strField;
+  while (fields.size() < 7 && std::getline(stream, strField, '\t'))
+    fields.push_back(strField);
+  // the osd name is the last field, and is allowed to be empty
+  if (fields.size() != 7)
+    return false;
+  std::getline(stream, entry.strOSDName);
+
+  unsigned int iPhysicalAddress(0), iLogicalAddress(0), iVendor(0), iVersion(0);
+  long long iLastSeen(0);
+  if (sscanf(fields[1].c_str(), "%x", &iPhysicalAddress) != 1 ||
+      sscanf(fields[2].c_str(), "%x", &iLogicalAddress) != 1 ||
+      sscanf(fields[3].c_str(), "%x", &iVendor) != 1 ||
+      sscanf(fields[4].c_str(), "%u", &iVersion) != 1 ||
+      sscanf(fields[6].c_str(), "%lld", &iLastSeen) != 1)
+    return false;
+
+  // sanity checks. libCEC's own devices are never cached
+  if (iLogicalAddress >= CECDEVICE_UNREGISTERED ||
+      !IsValidPhysicalAddress((cec_logical_address)iLogicalAddress, (uint16_t)iPhysicalAddress) ||
+      iVendor > 0xFFFFFF ||
+      iVersion < CEC_VERSION_1_2 || iVersion > CEC_VERSION_2_0 ||
+      fields[5].size() > 3 ||
+      entry.strOSDName.size() > 14)
+    return false;
+
+  strAdapter             = fields[0];
+  entry.logicalAddress   = (cec_logical_address)iLogicalAddress;
+  entry.iPhysicalAddress = (uint16_t)iPhysicalAddress;
+  entry.vendor           = (cec_vendor_id)iVendor;
+  entry.cecVersion       = (cec_version)iVersion;
+  entry.strMenuLanguage  = fields[5];
+  entry.iLastSeen        = (int64_t)iLastSeen;
+  return true;
+}
+
+std::string CCECDeviceCache::Format(const device_cache_entry_t &entry) const
+{
+  // the osd name is sent by the device, and may contain anything
+  std::string strOSDName(entry.strOSDName);
+  for (std::string::iterator it = strOSDName.begin(); it != strOSDName.end(); ++it)
+  {
+    if (*it == '\t' || *it == '\r' || *it == '\n')
+      *it = ' ';
+  }
+
+  char buf[64];
+  snprintf(buf, sizeof(buf), "\t%04x\t%x\t%06x\t%u\t", entry.iPhysicalAddress, (unsigned int)entry.logicalAddress, (unsigned int)entry.vendor, (unsigned int)entry.cecVersion);
+
+  std::ostringstream line;
+  line << m_strAdapter << buf << entry.strMenuLanguage << '\t' << (long long)entry.iLastSeen << '\t' << strOSDName;
+  return line.str();
+}
@@ -0,0 +1,105 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "env.h"
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace CEC
+{
+  // cached information is used for this long after a device was last seen
+  #define CEC_DEVICE_CACHE_TTL_S          (7 * 24 * 60 * 60)
+  // the delay after opening the connection after which the cached devices are checked
+  #define CEC_DEVICE_CACHE_REVALIDATE_MS  2000
+
+  /*!
+   * @brief The properties of a device that are remembered across connections.
+   */
+  typedef struct
+  {
+    cec_logical_address logicalAddress;
+    uint16_t            iPhysicalAddress;
+    cec_vendor_id       vendor;
+    cec_version         cecVersion;
+    std::string         strOSDName;
+    std::string         strMenuLanguage;
+    int64_t             iLastSeen;        /**< the time at which the device was last seen, in seconds since the epoch */
+  } device_cache_entry_t;
+
+  /*!
+   * @brief Reads and writes the devices that were seen through an adapter to a file.
+   *
+   * A single file can be shared by several adapters. Each line holds one device,
+   * keyed by the adapter's path and the device's physical address:
+   *   <adapter> TAB <physical address> TAB <logical address> TAB <vendor> TAB <cec version> TAB <menu language> TAB <last seen> TAB <osd name>
+   */
+  class CCECDeviceCache
+  {
+  public:
+    CCECDeviceCache(const std::string &strPath, const std::string &strAdapter);
+    virtual ~CCECDeviceCache(void) {}
+
+    /*!
+     * @brief Read the devices of this adapter. Entries that expired or that
+     *        don't make sense are skipped.
+     * @param entries The devices that were read.
+     * @return True when the file was read, false otherwise.
+     */
+    bool Load(std::vector<device_cache_entry_t> &entries) const;
+
+    /*!
+     * @brief Replace the devices of this adapter, and keep the devices of other adapters.
+     * @param entries The devices to write.
+     * @return True when the file was written, false otherwise.
+     */
+    bool Save(const std::vector<device_cache_entry_t> &entries) const;
+
+    const std::string &GetPath(void) const { return m_strPath; }
+
+    static int64_t Now(void);
+
+    /*!
+     * @return True when a device with this logical address can have this physical address.
+     */
+    static bool IsValidPhysicalAddress(cec_logical_address logicalAddress, uint16_t iPhysicalAddress);
+
+  private:
+    bool Parse(const std::string &strLine, std::string &strAdapter, device_cache_entry_t &entry) const;
+    std::string Format(const device_cache_entry_t &entry) const;
+
+    std::string m_strPath;
+    std::string m_strAdapter;
+  };
+}
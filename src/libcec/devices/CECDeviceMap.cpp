@@ -41,11 +41,15 @@
 #include "CECTV.h"
 #include "CECProcessor.h"
 #include "CECTypeUtils.h"
+#include "LibCEC.h"
+#include "platform/util/util.h"
+#include "platform/util/StringUtils.h"
 
 using namespace CEC;
 
 CCECDeviceMap::CCECDeviceMap(CCECProcessor *processor) :
-    m_processor(processor)
+    m_processor(processor),
+    m_cache(NULL)
 {
   for (uint8_t iPtr = CECDEVICE_TV; iPtr <= CECDEVICE_BROADCAST; iPtr++)
   {
@@ -78,10 +82,15 @@ CCECDeviceMap::CCECDeviceMap(CCECProcessor *processor) :
       break;
     }
   }
+
+  // the tv is created with its physical address
+  for (CECDEVICEMAP::iterator it = m_busDevices.begin(); it != m_busDevices.end(); it++)
+    OnPhysicalAddressChanged(it->first, CEC_INVALID_PHYSICAL_ADDRESS, it->second->GetCurrentPhysicalAddress());
 }
 CCECDeviceMap::~CCECDeviceMap(void)
 {
   Clear();
+  SafeDelete(m_cache);
 }
 
 CECDEVICEMAP::iterator CCECDeviceMap::Begin(void)
@@ -123,6 +132,76 @@ CCECBusDevice *CCECDeviceMap::At(uint8_t iAddress) const
   return NULL;
 }
 
+bool CCECDeviceMap::LoadCache(const std::string &strPath, const std::string &strAdapter)
+{
+  SafeDelete(m_cache);
+  m_cacheEntries.clear();
+
+  // a missing file is fine, it's created when the connection is closed
+  m_cache = new CCECDeviceCache(strPath, strAdapter);
+  if (!m_cache->Load(m_cacheEntries))
+  {
+    m_processor->GetLib()->AddLog(CEC_LOG_DEBUG, "device cache '%s' not found", strPath.c_str());
+    return false;
+  }
+
+  for (std::vector<device_cache_entry_t>::const_iterator it = m_cacheEntries.begin(); it != m_cacheEntries.end(); ++it)
+  {
+    CCECBusDevice *device = At(it->logicalAddress);
+    if (device)
+      device->SetCachedInformation(*it);
+  }
+
+  m_processor->GetLib()->AddLog(CEC_LOG_DEBUG, "%u devices read from device cache '%s'", (unsigned)m_cacheEntries.size(), strPath.c_str());
+  return true;
+}
+
+bool CCECDeviceMap::SaveCache(void)
+{
+  if (!m_cache)
+    return false;
+
+  std::vector<device_cache_entry_t> entries;
+  for (CECDEVICEMAP::iterator it = m_busDevices.begin(); it != m_busDevices.end(); it++)
+  {
+    device_cache_entry_t entry;
+    if (it->second->GetCacheEntry(entry))
+    {
+      entries.push_back(entry);
+      continue;
+    }
+
+    // keep the old entry when the device wasn't seen, but wasn't found to be gone either
+    if (it->second->HasCachedInformation() && it->second->GetCurrentStatus() == CEC_DEVICE_STATUS_UNKNOWN)
+    {
+      for (std::vector<device_cache_entry_t>::const_iterator cached = m_cacheEntries.begin(); cached != m_cacheEntries.end(); ++cached)
+      {
+        if (cached->logicalAddress == it->first)
+          entries.push_back(*cached);
+      }
+    }
+  }
+
+  bool bReturn = m_cache->Save(entries);
+  if (bReturn)
+    m_processor->GetLib()->AddLog(CEC_LOG_DEBUG, "%u devices written to device cache '%s'", (unsigned)entries.size(), m_cache->GetPath().c_str());
+  else
+    m_processor->GetLib()->AddLog(CEC_LOG_WARNING, "failed to write device cache '%s'", m_cache->GetPath().c_str());
+
+  SafeDelete(m_cache);
+  m_cacheEntries.clear();
+  return bReturn;
+}
+
+void CCECDeviceMap::RevalidateCache(const cec_logical_address initiator)
+{
+  for (CECDEVICEMAP::iterator it = m_busDevices.begin(); it != m_busDevices.end(); it++)
+  {
+    if (it->first != initiator)
+      it->second->RevalidateCachedInformation(initiator);
+  }
+}
+
 void CCECDeviceMap::Clear(void)
 {
   for (CECDEVICEMAP::iterator it = m_busDevices.begin(); it != m_busDevices.end(); it++)
@@ -132,18 +211,90 @@ void CCECDeviceMap::Clear(void)
 
 CCECBusDevice *CCECDeviceMap::GetDeviceByPhysicalAddress(uint16_t iPhysicalAddress, bool bSuppressUpdate /* = true */)
 {
-  CCECBusDevice *device(NULL);
+  CCECBusDevice *device = FindByPhysicalAddress(iPhysicalAddress);
+  if (device || bSuppressUpdate)
+    return device;
 
-  // check each device until we found a match
-  for (CECDEVICEMAP::iterator it = m_busDevices.begin(); !device && it != m_busDevices.end(); it++)
+  // request the physical addresses that aren't known yet. the replies update the index
+  const cec_logical_address initiator(m_processor->GetLogicalAddress());
+  for (CECDEVICEMAP::iterator it = m_busDevices.begin(); it != m_busDevices.end(); it++)
   {
-    if (it->second->GetPhysicalAddress(m_processor->GetLogicalAddress(), bSuppressUpdate) == iPhysicalAddress)
-      device = it->second;
+    if (it->second->GetCurrentPhysicalAddress() == CEC_INVALID_PHYSICAL_ADDRESS)
+      it->second->GetPhysicalAddress(initiator, false);
   }
 
+  return FindByPhysicalAddress(iPhysicalAddress);
+}
+
+CCECBusDevice *CCECDeviceMap::FindByPhysicalAddress(uint16_t iPhysicalAddress) const
+{
+  uint16_t iDevices(0);
+  {
+    CLockObject lock(m_indexMutex);
+    std::map<uint16_t, uint16_t>::const_iterator it = m_physicalAddresses.find(iPhysicalAddress);
+    if (it != m_physicalAddresses.end())
+      iDevices = it->second;
+  }
+
+  for (uint8_t iPtr = CECDEVICE_TV; iPtr <= CECDEVICE_BROADCAST; iPtr++)
+  {
+    if (iDevices & (1 << iPtr))
+      return At(iPtr);
+  }
+  return NULL;
+}
+
+void CCECDeviceMap::OnPhysicalAddressChanged(cec_logical_address iAddress, uint16_t iOldAddress, uint16_t iNewAddress)
+{
+  if (iAddress < CECDEVICE_TV || iAddress > CECDEVICE_BROADCAST || iOldAddress == iNewAddress)
+    return;
+
+  CLockObject lock(m_indexMutex);
+  std::map<uint16_t, uint16_t>::iterator it = m_physicalAddresses.find(iOldAddress);
+  if (it != m_physicalAddresses.end())
+  {
+    it->second &= ~(1 << iAddress);
+    if (it->second == 0)
+      m_physicalAddresses.erase(it);
+  }
+
+  if (iNewAddress != CEC_INVALID_PHYSICAL_ADDRESS)
+    m_physicalAddresses[iNewAddress] |= (1 << iAddress);
+}
+
+CCECBusDevice *CCECDeviceMap::GetParentOf(uint16_t iPhysicalAddress) const
+{
+  CCECBusDevice *device(NULL);
+  for (uint16_t iParent = CCECTypeUtils::PhysicalAddressParent(iPhysicalAddress);
+       !device && iParent != CEC_INVALID_PHYSICAL_ADDRESS;
+       iParent = CCECTypeUtils::PhysicalAddressParent(iParent))
+    device = FindByPhysicalAddress(iParent);
   return device;
 }
 
+std::string CCECDeviceMap::RoutingTreeToString(void) const
+{
+  std::map<uint16_t, uint16_t> physicalAddresses;
+  {
+    CLockObject lock(m_indexMutex);
+    physicalAddresses = m_physicalAddresses;
+  }
+
+  // physical addresses sort parents before their children
+  std::string strTree;
+  for (std::map<uint16_t, uint16_t>::const_iterator it = physicalAddresses.begin(); it != physicalAddresses.end(); ++it)
+  {
+    for (uint8_t iPtr = CECDEVICE_TV; iPtr <= CECDEVICE_BROADCAST; iPtr++)
+    {
+      if (!(it->second & (1 << iPtr)))
+        continue;
+      strTree.append(2 * CCECTypeUtils::PhysicalAddressDepth(it->first), ' ');
+      strTree += StringUtils::Format("%x.%x.%x.%x %s (%X)\n", (it->first >> 12) & 0xF, (it->first >> 8) & 0xF, (it->first >> 4) & 0xF, it->first & 0xF, CCECTypeUtils::ToString((cec_logical_address)iPtr), iPtr);
+    }
+  }
+  return strTree;
+}
+
 void CCECDeviceMap::Get(CECDEVICEVEC &devices) const
 {
   for (CECDEVICEMAP::const_iterator it = m_busDevices.begin(); it != m_busDevices.end(); it++)
@@ -295,12 +446,24 @@ void CCECDeviceMap::GetChildrenOf(CECDEVICEVEC& devices, CCECBusDevice* device)
     return;
 
   uint16_t iPA = device->GetCurrentPhysicalAddress();
+  if (iPA == CEC_INVALID_PHYSICAL_ADDRESS)
+    return;
 
-  for (CECDEVICEMAP::const_iterator it = m_busDevices.begin(); it != m_busDevices.end(); it++)
+  // the devices below a physical address are a range in the index
+  const uint8_t iDepth = CCECTypeUtils::PhysicalAddressDepth(iPA);
+  const uint16_t iLast = iDepth == 0 ? 0xFFFE : (uint16_t)(iPA | ((1 << 4*(4 - iDepth)) - 1));
+  uint16_t iDevices(0);
   {
-    uint16_t iCurrentPA = it->second->GetCurrentPhysicalAddress();
-    if (CCECTypeUtils::PhysicalAddressIsIncluded(iPA, iCurrentPA))
-      devices.push_back(it->second);
+    CLockObject lock(m_indexMutex);
+    for (std::map<uint16_t, uint16_t>::const_iterator it = m_physicalAddresses.lower_bound(iPA);
+         it != m_physicalAddresses.end() && it->first <= iLast; ++it)
+      iDevices |= it->second;
+  }
+
+  for (uint8_t iPtr = CECDEVICE_TV; iPtr <= CECDEVICE_BROADCAST; iPtr++)
+  {
+    if (iDevices & (1 << iPtr))
+      devices.push_back(At(iPtr));
   }
 }
 
@@ -33,7 +33,10 @@
  */
 
 #include "env.h"
+#include "CECDeviceCache.h"
+#include "platform/threads/mutex.h"
 #include <map>
+#include <string>
 #include <vector>
 
 namespace CEC
@@ -57,8 +60,36 @@ namespace CEC
     CCECBusDevice *         operator[] (uint8_t iAddress) const;
     CCECBusDevice *         At(cec_logical_address iAddress) const;
     CCECBusDevice *         At(uint8_t iAddress) const;
+
+    /*!
+     * @brief Find a device by physical address. Devices are indexed by physical address
+     *        when it changes, so this doesn't have to check every device.
+     * @param iPhysicalAddress The physical address.
+     * @param bSuppressUpdate False to request the physical addresses that aren't known yet
+     *                        from devices that are present when no device was found.
+     * @return The device with the lowest logical address that has this physical address, or NULL when not found.
+     */
     CCECBusDevice *         GetDeviceByPhysicalAddress(uint16_t iPhysicalAddress, bool bSuppressUpdate = true);
 
+    /*!
+     * @brief Update the physical address index. Called by the device when its physical address changed.
+     */
+    void                    OnPhysicalAddressChanged(cec_logical_address iAddress, uint16_t iOldAddress, uint16_t iNewAddress);
+
+    /*!
+     * @brief Find the nearest device between a physical address and the tv, like the
+     *        audio system or switch that a device is connected to.
+     * @param iPhysicalAddress The physical address.
+     * @return The device, or NULL when no device was found.
+     */
+    CCECBusDevice *         GetParentOf(uint16_t iPhysicalAddress) const;
+
+    /*!
+     * @return The HDMI topology of the devices with a known physical address, one device per
+     *         line, indented by the number of levels below the tv.
+     */
+    std::string             RoutingTreeToString(void) const;
+
     void Get(CECDEVICEVEC &devices) const;
     void GetLibCECControlled(CECDEVICEVEC &devices) const;
     void GetByLogicalAddresses(CECDEVICEVEC &devices, const cec_logical_addresses &addresses);
@@ -74,6 +105,32 @@ namespace CEC
     CCECBusDevice *GetActiveSource(void) const;
     void ResetActiveSourceSent(void);
 
+    /*!
+     * @brief Read the device cache, and use the properties of the devices that were seen through this adapter before.
+     * @param strPath The path to the cache file.
+     * @param strAdapter The path to the adapter.
+     * @return True when the cache was read, false otherwise.
+     */
+    bool LoadCache(const std::string &strPath, const std::string &strAdapter);
+
+    /*!
+     * @brief Write the devices that are present to the device cache, and close it.
+     *        Cached devices that weren't checked yet are kept.
+     * @return True when the cache was written, false otherwise or when no cache was loaded.
+     */
+    bool SaveCache(void);
+
+    /*!
+     * @return True when a device cache was loaded.
+     */
+    bool HasCache(void) const { return !!m_cache; }
+
+    /*!
+     * @brief Check the cached properties of all devices in the background.
+     * @param initiator The logical address to send the polls and requests from.
+     */
+    void RevalidateCache(const cec_logical_address initiator);
+
     static void FilterLibCECControlled(CECDEVICEVEC &devices);
     static void FilterActive(CECDEVICEVEC &devices);
     static void FilterTypes(const cec_device_type_list &types, CECDEVICEVEC &devices);
@@ -81,8 +138,13 @@ namespace CEC
     static cec_logical_addresses ToLogicalAddresses(const CECDEVICEVEC &devices);
   private:
     void Clear(void);
+    CCECBusDevice *FindByPhysicalAddress(uint16_t iPhysicalAddress) const;
 
-    CECDEVICEMAP   m_busDevices;
-    CCECProcessor *m_processor;
+    CECDEVICEMAP                      m_busDevices;
+    CCECProcessor *                   m_processor;
+    CCECDeviceCache *                 m_cache;
+    std::vector<device_cache_entry_t> m_cacheEntries; /**< the entries that were read from the cache */
+    mutable CMutex                    m_indexMutex;
+    std::map<uint16_t, uint16_t>      m_physicalAddresses; /**< a physical address, and a bit for each logical address that has it */
   };
 }
@@ -0,0 +1,509 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+
+#include "env.h"
+
+#if defined(HAVE_VIRTUAL_API)
+#include "USBCECAdapterEmulator.h"
+#include "adapter/Pulse-Eight/USBCECAdapterMessage.h"
+#include "platform/util/timeutils.h"
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace CEC;
+
+// the longest the thread waits for input before checking whether it should stop
+#define EMULATOR_POLL_INTERVAL_MS 50
+
+CUSBCECAdapterEmulator::CUSBCECAdapterEmulator(const usbcec_emulator_config &config) :
+    m_config(config),
+    m_iMaster(-1),
+    m_iSlave(-1),
+    m_random(config.iSeed),
+    m_bus(config.iPhysicalAddress),
+    m_bInMessage(false),
+    m_bEscaped(false),
+    m_iAckMask(0)
+{
+  memset(&m_stats, 0, sizeof(usbcec_emulator_stats));
+
+  // the defaults of a new adapter
+  m_settings.iAutoEnabled           = 0;
+  m_settings.iDefaultLogicalAddress = CECDEVICE_PLAYBACKDEVICE1;
+  m_settings.iLogicalAddressMask    = 0;
+  m_settings.iPhysicalAddress       = config.iPhysicalAddress;
+  m_settings.iDeviceType            = CEC_DEVICE_TYPE_PLAYBACK_DEVICE;
+  m_settings.iHdmiVersion           = CEC_VERSION_1_4;
+  m_settings.iAutoPowerOn           = 0;
+
+  if (m_config.peers.empty())
+  {
+    m_config.peers.push_back("tv");
+    m_config.peers.push_back("audio");
+  }
+  for (std::vector<std::string>::const_iterator it = m_config.peers.begin(); it != m_config.peers.end(); ++it)
+    m_bus.AddPeer(*it);
+}
+
+CUSBCECAdapterEmulator::~CUSBCECAdapterEmulator(void)
+{
+  Close();
+}
+
+bool CUSBCECAdapterEmulator::Open(void)
+{
+  Close();
+
+  m_iMaster = posix_openpt(O_RDWR | O_NOCTTY);
+  if (m_iMaster < 0 || grantpt(m_iMaster) != 0 || unlockpt(m_iMaster) != 0)
+  {
+    Close();
+    return false;
+  }
+
+  const char *strSlave = ptsname(m_iMaster);
+  if (!strSlave)
+  {
+    Close();
+    return false;
+  }
+  m_strPortName = strSlave;
+
+  // keep the slave open, so the master doesn't hang up while no host has it open
+  m_iSlave = open(m_strPortName.c_str(), O_RDWR | O_NOCTTY);
+  struct termios options;
+  if (m_iSlave < 0 || tcgetattr(m_iSlave, &options) != 0)
+  {
+    Close();
+    return false;
+  }
+  cfmakeraw(&options);
+  tcsetattr(m_iSlave, TCSANOW, &options);
+
+  if (CreateThread())
+    return true;
+
+  Close();
+  return false;
+}
+
+void CUSBCECAdapterEmulator::Close(void)
+{
+  StopThread(0);
+
+  if (m_iSlave >= 0)
+    close(m_iSlave);
+  if (m_iMaster >= 0)
+    close(m_iMaster);
+  m_iSlave = m_iMaster = -1;
+  m_strPortName.clear();
+}
+
+void CUSBCECAdapterEmulator::GetStats(usbcec_emulator_stats &stats) const
+{
+  CLockObject lock(m_mutex);
+  stats = m_stats;
+}
+
+void CUSBCECAdapterEmulator::SetErrorRates(uint8_t iTxErrorPercent, uint8_t iRxErrorPercent, uint8_t iDropPercent)
+{
+  CLockObject lock(m_mutex);
+  m_config.iTxErrorPercent = iTxErrorPercent;
+  m_config.iRxErrorPercent = iRxErrorPercent;
+  m_config.iDropPercent    = iDropPercent;
+}
+
+void *CUSBCECAdapterEmulator::Process(void)
+{
+  uint8_t buf[256];
+
+  while (!IsStopped())
+  {
+    const int iNextFrameMs(DeliverPendingFrames());
+    const int iTimeoutMs(iNextFrameMs >= 0 && iNextFrameMs < EMULATOR_POLL_INTERVAL_MS ? iNextFrameMs : EMULATOR_POLL_INTERVAL_MS);
+
+    struct pollfd fd = { m_iMaster, POLLIN, 0 };
+    const int iReady(poll(&fd, 1, iTimeoutMs));
+    if (iReady < 0 && errno != EINTR)
+      break;
+    if (iReady <= 0 || !(fd.revents & POLLIN))
+      continue;
+
+    const ssize_t iRead(read(m_iMaster, buf, sizeof(buf)));
+    for (ssize_t iPtr = 0; iPtr < iRead && !IsStopped(); iPtr++)
+      PushReceivedByte(buf[iPtr]);
+  }
+
+  return NULL;
+}
+
+void CUSBCECAdapterEmulator::PushReceivedByte(uint8_t byte)
+{
+  if (byte == MSGSTART)
+  {
+    m_message.clear();
+    m_bInMessage = true;
+    m_bEscaped = false;
+  }
+  else if (!m_bInMessage)
+  {
+    // garbage between messages, like the firmware ignores it
+  }
+  else if (byte == MSGEND)
+  {
+    m_bInMessage = false;
+    if (!m_message.empty())
+    {
+      const uint8_t iCode(m_message[0]);
+      m_message.erase(m_message.begin());
+      HandleMessage(iCode, m_message);
+    }
+  }
+  else if (m_bEscaped)
+  {
+    m_message.push_back((uint8_t)(byte + ESCOFFSET));
+    m_bEscaped = false;
+  }
+  else if (byte == MSGESC)
+    m_bEscaped = true;
+  else
+    m_message.push_back(byte);
+}
+
+void CUSBCECAdapterEmulator::HandleMessage(uint8_t iCode, const std::vector<uint8_t> &data)
+{
+  {
+    CLockObject lock(m_mutex);
+    ++m_stats.commands;
+  }
+
+  switch (iCode)
+  {
+  case MSGCODE_PING:
+  case MSGCODE_SET_CONTROLLED:
+  case MSGCODE_TRANSMIT_IDLETIME:
+  case MSGCODE_TRANSMIT_LINE_TIMEOUT:
+  case MSGCODE_SET_ACTIVE_SOURCE:
+    SendAccepted(iCode);
+    break;
+  case MSGCODE_SET_ACK_MASK:
+    if (data.size() == 2)
+      m_iAckMask = (uint16_t)(data[0] << 8 | data[1]);
+    SendAccepted(iCode);
+    break;
+  case MSGCODE_FIRMWARE_VERSION:
+    SendValue(iCode, m_config.iFirmwareVersion, 2);
+    break;
+  case MSGCODE_GET_BUILDDATE:
+    SendValue(iCode, m_config.iFirmwareBuildDate, 4);
+    break;
+  case MSGCODE_GET_ADAPTER_TYPE:
+    SendValue(iCode, P8_ADAPTERTYPE_EXTERNAL, 1);
+    break;
+  case MSGCODE_GET_AUTO_ENABLED:
+    SendValue(iCode, m_settings.iAutoEnabled, 1);
+    break;
+  case MSGCODE_GET_DEFAULT_LOGICAL_ADDRESS:
+    SendValue(iCode, m_settings.iDefaultLogicalAddress, 1);
+    break;
+  case MSGCODE_GET_LOGICAL_ADDRESS_MASK:
+    SendValue(iCode, m_settings.iLogicalAddressMask, 2);
+    break;
+  case MSGCODE_GET_PHYSICAL_ADDRESS:
+    SendValue(iCode, m_settings.iPhysicalAddress, 2);
+    break;
+  case MSGCODE_GET_DEVICE_TYPE:
+    SendValue(iCode, m_settings.iDeviceType, 1);
+    break;
+  case MSGCODE_GET_HDMI_VERSION:
+    SendValue(iCode, m_settings.iHdmiVersion, 1);
+    break;
+  case MSGCODE_GET_AUTO_POWER_ON:
+    SendValue(iCode, m_settings.iAutoPowerOn, 1);
+    break;
+  case MSGCODE_GET_OSD_NAME:
+    Send(iCode, std::vector<uint8_t>(m_settings.strOSDName.begin(), m_settings.strOSDName.end()));
+    break;
+  case MSGCODE_SET_AUTO_ENABLED:
+  case MSGCODE_SET_DEFAULT_LOGICAL_ADDRESS:
+  case MSGCODE_SET_DEVICE_TYPE:
+  case MSGCODE_SET_HDMI_VERSION:
+  case MSGCODE_SET_AUTO_POWER_ON:
+    if (data.size() != 1)
+    {
+      Send(MSGCODE_COMMAND_REJECTED, std::vector<uint8_t>(1, iCode));
+      break;
+    }
+    if (iCode == MSGCODE_SET_AUTO_ENABLED)
+      m_settings.iAutoEnabled = data[0];
+    else if (iCode == MSGCODE_SET_DEFAULT_LOGICAL_ADDRESS)
+      m_settings.iDefaultLogicalAddress = data[0];
+    else if (iCode == MSGCODE_SET_DEVICE_TYPE)
+      m_settings.iDeviceType = data[0];
+    else if (iCode == MSGCODE_SET_HDMI_VERSION)
+      m_settings.iHdmiVersion = data[0];
+    else
+      m_settings.iAutoPowerOn = data[0];
+    SendAccepted(iCode);
+    break;
+  case MSGCODE_SET_LOGICAL_ADDRESS_MASK:
+  case MSGCODE_SET_PHYSICAL_ADDRESS:
+    if (data.size() != 2)
+    {
+      Send(MSGCODE_COMMAND_REJECTED, std::vector<uint8_t>(1, iCode));
+      break;
+    }
+    if (iCode == MSGCODE_SET_LOGICAL_ADDRESS_MASK)
+      m_settings.iLogicalAddressMask = (uint16_t)(data[0] << 8 | data[1]);
+    else
+      m_settings.iPhysicalAddress = (uint16_t)(data[0] << 8 | data[1]);
+    SendAccepted(iCode);
+    break;
+  case MSGCODE_SET_OSD_NAME:
+    m_settings.strOSDName.assign(data.begin(), data.end());
+    SendAccepted(iCode);
+    break;
+  case MSGCODE_WRITE_EEPROM:
+    {
+      CLockObject lock(m_mutex);
+      ++m_stats.eeprom_writes;
+    }
+    SendAccepted(iCode);
+    break;
+  case MSGCODE_TRANSMIT_ACK_POLARITY:
+    // always the first packet of a transmission
+    m_frame.clear();
+    SendAccepted(iCode);
+    break;
+  case MSGCODE_TRANSMIT:
+  case MSGCODE_TRANSMIT_EOM:
+    if (!data.empty())
+      m_frame.push_back(data[0]);
+    SendAccepted(iCode);
+    if (iCode == MSGCODE_TRANSMIT_EOM)
+      TransmitFrame();
+    break;
+  default:
+    {
+      CLockObject lock(m_mutex);
+      ++m_stats.rejected;
+    }
+    Send(MSGCODE_COMMAND_REJECTED, std::vector<uint8_t>(1, iCode));
+    break;
+  }
+}
+
+void CUSBCECAdapterEmulator::TransmitFrame(void)
+{
+  if (m_frame.empty())
+    return;
+
+  cec_command command;
+  command.Clear();
+  command.initiator   = (cec_logical_address)(m_frame[0] >> 4);
+  command.destination = (cec_logical_address)(m_frame[0] & 0xF);
+  if (m_frame.size() > 1)
+  {
+    command.opcode     = (cec_opcode)m_frame[1];
+    command.opcode_set = 1;
+    for (size_t iPtr = 2; iPtr < m_frame.size(); iPtr++)
+      command.parameters.PushBack(m_frame[iPtr]);
+  }
+  m_frame.clear();
+
+  BusDelay(CEC_VIRTUAL_SIGNAL_FREE_BITS * CEC_VIRTUAL_DATA_BIT_US + CVirtualCECBus::FrameTimeUs(command));
+
+  if (Chance(m_config.iTxErrorPercent))
+  {
+    {
+      CLockObject lock(m_mutex);
+      ++m_stats.tx_errors;
+    }
+    Send(MSGCODE_TRANSMIT_FAILED_TIMEOUT_DATA);
+    return;
+  }
+
+  std::vector<cec_command> replies;
+  const bool bAcked(m_bus.Transmit(command, replies));
+  {
+    CLockObject lock(m_mutex);
+    if (bAcked)
+      ++m_stats.tx_acked;
+    else
+      ++m_stats.tx_nacked;
+  }
+  Send(bAcked ? MSGCODE_TRANSMIT_SUCCEEDED : MSGCODE_TRANSMIT_FAILED_ACK);
+
+  const int64_t iDueUs(GetTimeUs() + (m_config.iSpeed > 0 ? CEC_VIRTUAL_REPLY_DELAY_US / m_config.iSpeed : 0));
+  for (std::vector<cec_command>::const_iterator it = replies.begin(); it != replies.end(); ++it)
+  {
+    pending_frame frame = { *it, iDueUs };
+    m_pending.push_back(frame);
+  }
+}
+
+int CUSBCECAdapterEmulator::DeliverPendingFrames(void)
+{
+  while (!m_pending.empty() && !IsStopped())
+  {
+    const int64_t iWaitUs(m_pending.front().iDueUs - GetTimeUs());
+    if (iWaitUs > 0)
+      return (int)((iWaitUs + 999) / 1000);
+
+    const cec_command command(m_pending.front().command);
+    m_pending.erase(m_pending.begin());
+
+    BusDelay(CEC_VIRTUAL_SIGNAL_FREE_BITS * CEC_VIRTUAL_DATA_BIT_US + CVirtualCECBus::FrameTimeUs(command));
+
+    // the adapter acks the addresses in its mask, and only sends the host the
+    // frames that it acked and broadcasts
+    const bool bBroadcast(command.destination == CECDEVICE_BROADCAST);
+    const bool bAcked(!bBroadcast && (m_iAckMask & (1 << command.destination)));
+    if (!bBroadcast && !bAcked)
+      continue;
+
+    if (Chance(m_config.iRxErrorPercent))
+    {
+      {
+        CLockObject lock(m_mutex);
+        ++m_stats.rx_errors;
+      }
+      Send(MSGCODE_RECEIVE_FAILED);
+      continue;
+    }
+
+    {
+      CLockObject lock(m_mutex);
+      ++m_stats.rx_frames;
+    }
+
+    const uint8_t iAckFlag(bAcked ? MSGCODE_FRAME_ACK : 0);
+    const uint8_t iHeader((uint8_t)(command.initiator << 4 | command.destination));
+    Send((uint8_t)(MSGCODE_FRAME_START | iAckFlag | (command.opcode_set ? 0 : MSGCODE_FRAME_EOM)), std::vector<uint8_t>(1, iHeader));
+    if (!command.opcode_set)
+      continue;
+
+    Send((uint8_t)(MSGCODE_FRAME_DATA | iAckFlag | (command.parameters.IsEmpty() ? MSGCODE_FRAME_EOM : 0)), std::vector<uint8_t>(1, (uint8_t)command.opcode));
+    for (uint8_t iPtr = 0; iPtr < command.parameters.size; iPtr++)
+      Send((uint8_t)(MSGCODE_FRAME_DATA | iAckFlag | (iPtr + 1 == command.parameters.size ? MSGCODE_FRAME_EOM : 0)), std::vector<uint8_t>(1, command.parameters[iPtr]));
+  }
+
+  return -1;
+}
+
+void CUSBCECAdapterEmulator::Send(uint8_t iCode, const std::vector<uint8_t> &data)
+{
+  if (m_config.iJitterUs > 0)
+  {
+    std::uniform_int_distribution<uint32_t> jitter(0, m_config.iJitterUs);
+    std::this_thread::sleep_for(std::chrono::microseconds(jitter(m_random)));
+  }
+
+  // the same framing as CCECAdapterMessage::PushEscaped()
+  std::vector<uint8_t> message;
+  message.push_back(MSGSTART);
+  message.push_back(iCode);
+  for (std::vector<uint8_t>::const_iterator it = data.begin(); it != data.end(); ++it)
+  {
+    if (*it >= MSGESC)
+    {
+      message.push_back(MSGESC);
+      message.push_back((uint8_t)(*it - ESCOFFSET));
+    }
+    else
+      message.push_back(*it);
+  }
+  message.push_back(MSGEND);
+
+  size_t iWritten(0);
+  while (iWritten < message.size())
+  {
+    const ssize_t iRet(write(m_iMaster, message.data() + iWritten, message.size() - iWritten));
+    if (iRet < 0 && errno == EINTR)
+      continue;
+    if (iRet <= 0)
+      break;
+    iWritten += (size_t)iRet;
+  }
+}
+
+void CUSBCECAdapterEmulator::SendAccepted(uint8_t iCode)
+{
+  if (Chance(m_config.iDropPercent))
+  {
+    CLockObject lock(m_mutex);
+    ++m_stats.dropped;
+    return;
+  }
+
+  Send(MSGCODE_COMMAND_ACCEPTED, std::vector<uint8_t>(1, iCode));
+}
+
+void CUSBCECAdapterEmulator::SendValue(uint8_t iCode, uint32_t iValue, size_t iBytes)
+{
+  // values are sent msb first
+  std::vector<uint8_t> data;
+  for (size_t iPtr = iBytes; iPtr > 0; iPtr--)
+    data.push_back((uint8_t)(iValue >> (8 * (iPtr - 1))));
+  Send(iCode, data);
+}
+
+void CUSBCECAdapterEmulator::BusDelay(int64_t iUs) const
+{
+  if (m_config.iSpeed > 0 && iUs > 0)
+    std::this_thread::sleep_for(std::chrono::microseconds(iUs / m_config.iSpeed));
+}
+
+bool CUSBCECAdapterEmulator::Chance(const uint8_t &iPercent)
+{
+  uint8_t iValue;
+  {
+    CLockObject lock(m_mutex);
+    iValue = iPercent;
+  }
+
+  if (iValue == 0)
+    return false;
+  std::uniform_int_distribution<int> percent(0, 99);
+  return percent(m_random) < iValue;
+}
+
+#endif
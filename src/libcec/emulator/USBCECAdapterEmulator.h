@@ -0,0 +1,205 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "env.h"
+
+#if defined(HAVE_VIRTUAL_API)
+#include "cectypes.h"
+#include <random>
+#include <string>
+#include <vector>
+#include "platform/threads/mutex.h"
+#include "platform/threads/threads.h"
+#include "adapter/Virtual/VirtualCECPeer.h"
+
+namespace CEC
+{
+  struct usbcec_emulator_config
+  {
+    std::vector<std::string> peers;              /*!< the peers on the bus, see CVirtualCECBus::AddPeer(). tv and audio when empty */
+    uint16_t                 iPhysicalAddress;   /*!< the physical address of the port the adapter is connected to */
+    uint16_t                 iFirmwareVersion;   /*!< the firmware version that is reported */
+    uint32_t                 iFirmwareBuildDate; /*!< the firmware build date that is reported */
+    uint32_t                 iSpeed;             /*!< run the bus this many times faster than a real CEC line, or without any delays when 0 */
+    uint32_t                 iJitterUs;          /*!< delay every message to the host by up to this many microseconds */
+    uint8_t                  iTxErrorPercent;    /*!< the chance in percent that a transmission fails with a data timeout */
+    uint8_t                  iRxErrorPercent;    /*!< the chance in percent that a received frame is replaced by 'receive failed' */
+    uint8_t                  iDropPercent;       /*!< the chance in percent that a 'command accepted' is never sent */
+    uint32_t                 iSeed;              /*!< seed for the jitter and errors, so runs can be repeated */
+
+    usbcec_emulator_config(void) :
+      iPhysicalAddress(0x1000),
+      iFirmwareVersion(12),
+      iFirmwareBuildDate(0x5e1c2d2a),
+      iSpeed(1),
+      iJitterUs(0),
+      iTxErrorPercent(0),
+      iRxErrorPercent(0),
+      iDropPercent(0),
+      iSeed(0) {}
+  };
+
+  struct usbcec_emulator_stats
+  {
+    unsigned int commands;      /*!< messages received from the host */
+    unsigned int rejected;      /*!< messages that were answered with 'command rejected' */
+    unsigned int dropped;       /*!< 'command accepted' replies that were dropped on purpose */
+    unsigned int tx_acked;      /*!< frames transmitted and acked */
+    unsigned int tx_nacked;     /*!< frames transmitted and not acked */
+    unsigned int tx_errors;     /*!< transmissions that failed on purpose */
+    unsigned int rx_frames;     /*!< frames sent to the host */
+    unsigned int rx_errors;     /*!< frames replaced by 'receive failed' on purpose */
+    unsigned int eeprom_writes; /*!< number of times the settings were persisted */
+  };
+
+  /*!
+   * @brief Emulates the firmware of a Pulse-Eight USB-CEC adapter on a pseudo
+   *        terminal. libCEC opens the slave side like it would open the serial
+   *        port of a real adapter, so the whole USB backend is exercised,
+   *        including the serial port and the message queue. The CEC bus behind
+   *        the adapter is simulated with CVirtualCECBus.
+   */
+  class CUSBCECAdapterEmulator : public CThread
+  {
+  public:
+    CUSBCECAdapterEmulator(const usbcec_emulator_config &config);
+    virtual ~CUSBCECAdapterEmulator(void);
+
+    /*!
+     * @brief Create the pseudo terminal and start answering the host.
+     * @return True when opened, false otherwise.
+     */
+    bool Open(void);
+    void Close(void);
+
+    /*!
+     * @return The path of the slave side of the pseudo terminal, which is the
+     *         port to open in libCEC. Empty when not opened.
+     */
+    const std::string &GetPortName(void) const { return m_strPortName; }
+
+    void GetStats(usbcec_emulator_stats &stats) const;
+
+    /*!
+     * @brief Change the error rates while running, e.g. to only inject errors
+     *        after the host finished opening the adapter.
+     */
+    void SetErrorRates(uint8_t iTxErrorPercent, uint8_t iRxErrorPercent, uint8_t iDropPercent);
+
+    /** @name CThread implementation */
+    ///{
+    void *Process(void) override;
+    ///}
+
+  private:
+    struct pending_frame
+    {
+      cec_command command;
+      int64_t     iDueUs;
+    };
+
+    struct eeprom_settings
+    {
+      uint8_t     iAutoEnabled;
+      uint8_t     iDefaultLogicalAddress;
+      uint16_t    iLogicalAddressMask;
+      uint16_t    iPhysicalAddress;
+      uint8_t     iDeviceType;
+      uint8_t     iHdmiVersion;
+      uint8_t     iAutoPowerOn;
+      std::string strOSDName;
+    };
+
+    /*!
+     * @brief Process a byte that was written by the host.
+     */
+    void PushReceivedByte(uint8_t byte);
+
+    /*!
+     * @brief Process a complete, unescaped message from the host.
+     */
+    void HandleMessage(uint8_t iCode, const std::vector<uint8_t> &data);
+
+    /*!
+     * @brief Put the frame that was sent by the host on the bus and tell the
+     *        host how that went.
+     */
+    void TransmitFrame(void);
+
+    /*!
+     * @brief Send the frames that peers transmitted and that are due to the
+     *        host, the same way the firmware sends frames it received.
+     * @return The time until the next frame is due in ms, or -1 if none are
+     *         pending.
+     */
+    int DeliverPendingFrames(void);
+
+    /*!
+     * @brief Send a message to the host.
+     */
+    void Send(uint8_t iCode, const std::vector<uint8_t> &data = std::vector<uint8_t>());
+    void SendAccepted(uint8_t iCode);
+    void SendValue(uint8_t iCode, uint32_t iValue, size_t iBytes);
+
+    /*!
+     * @brief Sleep for a bus time, scaled by the configured speed.
+     */
+    void BusDelay(int64_t iUs) const;
+
+    /*!
+     * @param iPercent One of the error rates in m_config, which is read while
+     *        holding m_mutex.
+     * @return True with a chance of iPercent percent.
+     */
+    bool Chance(const uint8_t &iPercent);
+
+    usbcec_emulator_config     m_config;
+    mutable CMutex             m_mutex;
+    int                        m_iMaster;
+    int                        m_iSlave;
+    std::string                m_strPortName;
+    std::mt19937               m_random;
+    CVirtualCECBus             m_bus;
+    std::vector<pending_frame> m_pending;
+    std::vector<uint8_t>       m_message;
+    bool                       m_bInMessage;
+    bool                       m_bEscaped;
+    std::vector<uint8_t>       m_frame;
+    uint16_t                   m_iAckMask;
+    eeprom_settings            m_settings;
+    usbcec_emulator_stats      m_stats;
+  };
+};
+
+#endif
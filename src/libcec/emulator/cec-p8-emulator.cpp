@@ -0,0 +1,185 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+
+/*
+ * Emulates a Pulse-Eight USB-CEC adapter on a pseudo terminal, so libCEC's USB
+ * backend can be run and benchmarked without an adapter: start this, and open
+ * the port it prints in cec-client or any other libCEC client.
+ */
+
+#include "env.h"
+#include "USBCECAdapterEmulator.h"
+#include <errno.h>
+#include <iostream>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace CEC;
+
+static volatile sig_atomic_t g_bExit(0);
+
+static void sighandler(int UNUSED(iSignal))
+{
+  g_bExit = 1;
+}
+
+static void ShowHelpCommandLine(const char *strExec)
+{
+  std::cout << std::endl <<
+      strExec << " [options]" << std::endl <<
+      std::endl <<
+      "parameters:" << std::endl <<
+      "  -h --help                   Shows this help text" << std::endl <<
+      "  -p --peers {list}           Comma separated list of peers on the bus, e.g." << std::endl <<
+      "                              tv,playback:standby,audio:nack. Default: tv,audio" << std::endl <<
+      "  -a --physical-address {pa}  The physical address of the adapter in hex." << std::endl <<
+      "                              Default: 1000" << std::endl <<
+      "  -v --firmware {version}     The firmware version to report. Default: 12" << std::endl <<
+      "  -b --build-date {date}      The firmware build date to report, as a unix" << std::endl <<
+      "                              timestamp" << std::endl <<
+      "  -s --speed {n}              Run the bus n times faster than a real CEC line," << std::endl <<
+      "                              or without any delays when 0. Default: 1" << std::endl <<
+      "  -j --jitter {us}            Delay every message to the host by up to this" << std::endl <<
+      "                              many microseconds" << std::endl <<
+      "  --tx-errors {percent}       Fail this percentage of transmissions" << std::endl <<
+      "  --rx-errors {percent}       Replace this percentage of received frames with" << std::endl <<
+      "                              'receive failed'" << std::endl <<
+      "  --drop {percent}            Drop this percentage of 'command accepted' replies" << std::endl <<
+      "  --seed {n}                  Seed for the jitter and errors" << std::endl <<
+      "  -l --link {path}            Create a symlink to the pseudo terminal" << std::endl <<
+      std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+  usbcec_emulator_config config;
+  std::string strLink;
+
+  for (int iArgPtr = 1; iArgPtr < argc; iArgPtr++)
+  {
+    const char *strArg = argv[iArgPtr];
+    const char *strValue = iArgPtr + 1 < argc ? argv[iArgPtr + 1] : NULL;
+
+    if (!strcmp(strArg, "-h") || !strcmp(strArg, "--help"))
+    {
+      ShowHelpCommandLine(argv[0]);
+      return 0;
+    }
+
+    if (!strValue)
+    {
+      std::cerr << "unknown or incomplete parameter: " << strArg << std::endl;
+      ShowHelpCommandLine(argv[0]);
+      return 1;
+    }
+
+    if (!strcmp(strArg, "-p") || !strcmp(strArg, "--peers"))
+    {
+      std::string strPeers(strValue);
+      size_t iStart(0), iEnd;
+      while ((iEnd = strPeers.find(',', iStart)) != std::string::npos)
+      {
+        config.peers.push_back(strPeers.substr(iStart, iEnd - iStart));
+        iStart = iEnd + 1;
+      }
+      config.peers.push_back(strPeers.substr(iStart));
+    }
+    else if (!strcmp(strArg, "-a") || !strcmp(strArg, "--physical-address"))
+      config.iPhysicalAddress = (uint16_t)strtoul(strValue, NULL, 16);
+    else if (!strcmp(strArg, "-v") || !strcmp(strArg, "--firmware"))
+      config.iFirmwareVersion = (uint16_t)strtoul(strValue, NULL, 10);
+    else if (!strcmp(strArg, "-b") || !strcmp(strArg, "--build-date"))
+      config.iFirmwareBuildDate = (uint32_t)strtoul(strValue, NULL, 10);
+    else if (!strcmp(strArg, "-s") || !strcmp(strArg, "--speed"))
+      config.iSpeed = (uint32_t)strtoul(strValue, NULL, 10);
+    else if (!strcmp(strArg, "-j") || !strcmp(strArg, "--jitter"))
+      config.iJitterUs = (uint32_t)strtoul(strValue, NULL, 10);
+    else if (!strcmp(strArg, "--tx-errors"))
+      config.iTxErrorPercent = (uint8_t)atoi(strValue);
+    else if (!strcmp(strArg, "--rx-errors"))
+      config.iRxErrorPercent = (uint8_t)atoi(strValue);
+    else if (!strcmp(strArg, "--drop"))
+      config.iDropPercent = (uint8_t)atoi(strValue);
+    else if (!strcmp(strArg, "--seed"))
+      config.iSeed = (uint32_t)strtoul(strValue, NULL, 10);
+    else if (!strcmp(strArg, "-l") || !strcmp(strArg, "--link"))
+      strLink = strValue;
+    else
+    {
+      std::cerr << "unknown parameter: " << strArg << std::endl;
+      ShowHelpCommandLine(argv[0]);
+      return 1;
+    }
+    ++iArgPtr;
+  }
+
+  CUSBCECAdapterEmulator emulator(config);
+  if (!emulator.Open())
+  {
+    std::cerr << "couldn't create a pseudo terminal: " << strerror(errno) << std::endl;
+    return 1;
+  }
+
+  if (!strLink.empty())
+  {
+    unlink(strLink.c_str());
+    if (symlink(emulator.GetPortName().c_str(), strLink.c_str()) != 0)
+    {
+      std::cerr << "couldn't create " << strLink << ": " << strerror(errno) << std::endl;
+      return 1;
+    }
+  }
+
+  std::cout << emulator.GetPortName() << std::endl;
+
+  signal(SIGINT, sighandler);
+  signal(SIGTERM, sighandler);
+  while (!g_bExit)
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  usbcec_emulator_stats stats;
+  emulator.GetStats(stats);
+  std::cout << "commands: " << stats.commands << " (rejected: " << stats.rejected << ", dropped: " << stats.dropped << ")" << std::endl <<
+      "transmitted: " << stats.tx_acked << " acked, " << stats.tx_nacked << " not acked, " << stats.tx_errors << " failed" << std::endl <<
+      "received: " << stats.rx_frames << " (failed: " << stats.rx_errors << ")" << std::endl <<
+      "eeprom writes: " << stats.eeprom_writes << std::endl;
+
+  emulator.Close();
+  if (!strLink.empty())
+    unlink(strLink.c_str());
+  return 0;
+}
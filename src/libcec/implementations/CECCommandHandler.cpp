@@ -266,8 +266,9 @@ int CCECCommandHandler::HandleDeviceVendorCommandWithId(const cec_command& comma
     /** vendor id changed, parse command after the handler has been replaced */
     if (HasSpecificHandler((cec_vendor_id)iVendorId))
     {
-      LIB_CEC->AddLog(CEC_LOG_TRAFFIC, ">> process after replacing vendor handler: %s", ToString(command).c_str());
-      m_processor->OnCommandReceived(command);
+      if (LIB_CEC->IsLogLevelEnabled(CEC_LOG_TRAFFIC))
+        LIB_CEC->AddLog(CEC_LOG_TRAFFIC, ">> process after replacing vendor handler: %s", ToString(command).c_str());
+      m_processor->RequeueCommand(command);
       return COMMAND_HANDLED;
     }
   }
@@ -1278,17 +1279,24 @@ bool CCECCommandHandler::Transmit(cec_command &command, bool bSuppressWait, bool
   }
 
   {
+    // when the adapter waits for the reply itself, it has passed the reply on
+    // before the transmission completes, so we only wait for it to be processed
+    const bool bMatchReply(bExpectResponse && command.destination != CECDEVICE_BROADCAST && m_processor->SupportsReplyMatching());
+    const uint32_t iReplyWaitMs(m_iTransmitWait > 0 ? (uint32_t)m_iTransmitWait : CEC_DEFAULT_TRANSMIT_WAIT);
     uint8_t iTries(0), iMaxTries(m_iTransmitRetries + 1);
     while (!bReturn && ++iTries <= iMaxTries)
     {
-      if ((bReturn = m_processor->Transmit(command, bIsReply)) == true)
+      cec_transmit_reply reply = { expectedResponse, iReplyWaitMs, false };
+      if ((bReturn = m_processor->Transmit(command, bIsReply, bMatchReply ? &reply : NULL)) == true)
       {
 #ifdef CEC_DEBUGGING
         LIB_CEC->AddLog(CEC_LOG_DEBUG, "command transmitted");
 #endif
         if (bExpectResponse)
         {
-          bReturn = m_busDevice->WaitForOpcode(expectedResponse);
+          bReturn = bMatchReply ?
+              reply.bReceived && m_busDevice->WaitForOpcode(expectedResponse) :
+              m_busDevice->WaitForOpcode(expectedResponse);
           LIB_CEC->AddLog(CEC_LOG_DEBUG, bReturn ? "expected response received (%X: %s)" : "expected response not received (%X: %s)", (int)expectedResponse, ToString(expectedResponse));
         }
       }
@@ -1365,6 +1373,7 @@ bool CCECCommandHandler::ActivateSource(bool bTransmitDelayedCommandsOnly /* = f
       CLockObject lock(m_mutex);
       if (m_iActiveSourcePending == 0 || m_iActiveSourcePending < now)
         m_iActiveSourcePending = now + (int64_t)CEC_ACTIVE_SOURCE_SWITCH_RETRY_TIME_MS;
+      m_processor->ScheduleActiveSourceCheck(m_iActiveSourcePending - now);
       return false;
     }
     else
@@ -1385,6 +1394,7 @@ void CCECCommandHandler::ScheduleActivateSource(uint64_t iDelay)
 {
   CLockObject lock(m_mutex);
   m_iActiveSourcePending = GetTimeMs() + iDelay;
+  m_processor->ScheduleActiveSourceCheck((int64_t)iDelay);
 }
 
 void CCECCommandHandler::RequestEmailFromCustomer(const cec_command& command)
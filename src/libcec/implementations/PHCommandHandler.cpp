@@ -72,6 +72,7 @@ void* CImageViewOnCheck::Process(void)
       CLockObject lock(m_handler->m_mutex);
       tv->OnImageViewOnSent(false);
       m_handler->m_iActiveSourcePending = GetTimeMs();
+      m_handler->m_processor->ScheduleActiveSourceCheck(0);
     }
   }
   return NULL;
@@ -529,6 +529,7 @@ bool CSLCommandHandler::ActivateSource(bool bTransmitDelayedCommandsOnly /* = fa
       CLockObject lock(m_mutex);
       if (m_iActiveSourcePending == 0 || m_iActiveSourcePending < now)
         m_iActiveSourcePending = now + (int64_t)CEC_ACTIVE_SOURCE_SWITCH_RETRY_TIME_MS;
+      m_processor->ScheduleActiveSourceCheck(m_iActiveSourcePending - now);
       return false;
     }
     else
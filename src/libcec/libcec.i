@@ -147,9 +147,11 @@
 
 namespace std {
   %template(AdapterVector) vector<CEC::AdapterDescriptor>;
+  %template(CommandVector) vector<CEC::cec_command>;
+  %template(IntVector) vector<int>;
 }
 
-/////// replace CECInitialise(), CECDestroy() and DetectAdapters() ///////
+/////// replace CECInitialise(), CECDestroy(), DetectAdapters() and TransmitBatch() ///////
 
 %extend CEC::ICECAdapter {
   public:
@@ -186,6 +188,13 @@ namespace std {
         retval.push_back(CEC::AdapterDescriptor(devList[adapter]));
       return retval;
     }
+
+    std::vector<int> TransmitBatch(const std::vector<CEC::cec_command> &commands)
+    {
+      std::vector<CEC::cec_transmit_result> results(commands.size(), CEC::CEC_TRANSMIT_RESULT_NOT_SENT);
+      self->TransmitBatch(commands.data(), commands.size(), results.data());
+      return std::vector<int>(results.begin(), results.end());
+    }
 }
 
 %ignore CEC::ICECAdapter::~ICECAdapter;
@@ -193,6 +202,7 @@ namespace std {
 %ignore CEC::ICECAdapter::EnableCallbacks;
 %ignore CEC::ICECAdapter::CanPersistConfiguration;
 %ignore CEC::ICECAdapter::PersistConfiguration;
+%ignore CEC::ICECAdapter::TransmitBatch(const cec_command *, size_t, cec_transmit_result *);
 %ignore CEC::ICECCallbacks;
 %ignore CEC::DetectAdapters;
 %ignore CEC::GetDeviceMenuLanguage;
@@ -36,6 +36,7 @@
 #include "platform/util/timeutils.h"
 
 #include <fcntl.h>
+#include <poll.h>
 #include <stdio.h>
 #include <sys/ioctl.h>
 
@@ -153,6 +154,96 @@ namespace CEC
     return iBytesRead;
   }
 
+  /*!
+   * @brief Block until socket can be read from, or until wakeup becomes readable.
+   * @param socket The socket to wait for.
+   * @param wakeup A second descriptor that ends the wait early, or INVALID_SOCKET_VALUE.
+   * @param iTimeoutMs The maximum time to wait, or 0 to wait without a timeout.
+   * @return 1 when socket is readable, 0 on timeout or wakeup, or -errno.
+   */
+  inline int SocketWaitReadable(socket_t socket, socket_t wakeup, uint64_t iTimeoutMs /*= 0*/)
+  {
+    if (socket == INVALID_SOCKET_VALUE)
+      return -EBADF;
+
+    struct pollfd fds[2];
+    fds[0].fd      = socket;
+    fds[0].events  = POLLIN;
+    fds[0].revents = 0;
+    fds[1].fd      = wakeup;
+    fds[1].events  = POLLIN;
+    fds[1].revents = 0;
+
+    int returnv = poll(fds, wakeup != INVALID_SOCKET_VALUE ? 2 : 1, iTimeoutMs == 0 ? -1 : (int)iTimeoutMs);
+    if (returnv < 0)
+      return errno == EINTR ? 0 : -errno;
+
+    if (fds[0].revents & POLLNVAL)
+      return -EBADF;
+    if (fds[0].revents & POLLIN)
+      return 1;
+    if (fds[0].revents & (POLLERR | POLLHUP))
+      return -EIO;
+
+    return 0;
+  }
+
+  /*!
+   * @brief Read everything that is pending on socket, without blocking.
+   * @return The number of bytes read, or -errno.
+   */
+  inline ssize_t SocketReadAvailable(socket_t socket, int *iError, void* data, size_t len)
+  {
+    ssize_t iBytesRead(0);
+    *iError = 0;
+
+    if (socket == INVALID_SOCKET_VALUE)
+    {
+      *iError = EINVAL;
+      return -EINVAL;
+    }
+
+    struct pollfd port;
+    port.fd     = socket;
+    port.events = POLLIN;
+
+    while (iBytesRead < (ssize_t)len)
+    {
+      port.revents = 0;
+      int returnv = poll(&port, 1, 0);
+      if (returnv < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        *iError = errno;
+        return -errno;
+      }
+      else if (returnv == 0 || !(port.revents & POLLIN))
+      {
+        break; //nothing (more) to read
+      }
+
+      returnv = read(socket, (char*)data + iBytesRead, len - iBytesRead);
+      if (returnv == -1)
+      {
+        if (errno == EINTR || errno == EAGAIN)
+          continue;
+        *iError = errno;
+        return -errno;
+      }
+      else if (returnv == 0)
+      {
+        // readable but nothing to read: the device is gone
+        *iError = EIO;
+        return -EIO;
+      }
+
+      iBytesRead += returnv;
+    }
+
+    return iBytesRead;
+  }
+
   inline int SocketIoctl(socket_t socket, int *iError, int request, void* data)
   {
     if (socket == INVALID_SOCKET_VALUE)
@@ -38,6 +38,10 @@
 #include "../util/baudrate.h"
 #include "platform/posix/os-socket.h"
 
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#endif
+
 #if defined(__APPLE__) || defined(__FreeBSD__)
 #ifndef XCASE
 #define XCASE	0
@@ -71,13 +75,76 @@ inline bool RemoveLock(int sock)
   #endif
 }
 
+/* the wakeup descriptors live as long as the socket, so a reader can keep
+   waiting on them while the port itself is closed and reopened */
+static bool OpenWakeup(socket_t &readEnd, socket_t &writeEnd)
+{
+#if defined(__linux__)
+  readEnd = writeEnd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  return readEnd != INVALID_SOCKET_VALUE;
+#else
+  int fds[2];
+  if (pipe(fds) != 0)
+    return false;
+  for (int i = 0; i < 2; i++)
+  {
+    fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+    SocketSetBlocking(fds[i], false);
+  }
+  readEnd  = fds[0];
+  writeEnd = fds[1];
+  return true;
+#endif
+}
+
+static void DrainWakeup(socket_t readEnd)
+{
+  uint64_t buff[8];
+  while (read(readEnd, buff, sizeof(buff)) > 0) {}
+}
+
+CSerialSocket::~CSerialSocket(void)
+{
+  Close();
+
+  if (m_wakeupWrite != m_wakeupRead)
+    SocketClose(m_wakeupWrite);
+  SocketClose(m_wakeupRead);
+}
+
 void CSerialSocket::Close(void)
 {
   if (IsOpen())
   {
+    /* don't leave a reader blocked on a descriptor that's about to go away */
+    Interrupt();
     RemoveLock(m_socket);
     SocketClose(m_socket);
   }
+  m_socket  = INVALID_SERIAL_SOCKET_VALUE;
+  m_bIsOpen = false;
+}
+
+int CSerialSocket::WaitForData(uint64_t iTimeoutMs /* = 0 */)
+{
+  int iReturn = SocketWaitReadable(m_socket, m_wakeupRead, iTimeoutMs);
+  if (iReturn != 1 && m_wakeupRead != INVALID_SOCKET_VALUE)
+    DrainWakeup(m_wakeupRead);
+  return iReturn;
+}
+
+void CSerialSocket::Interrupt(void)
+{
+  if (m_wakeupWrite != INVALID_SOCKET_VALUE)
+  {
+    uint64_t iValue(1);
+    if (write(m_wakeupWrite, &iValue, sizeof(iValue)) < 0) {} // a full pipe is still a pending wakeup
+  }
+}
+
+ssize_t CSerialSocket::ReadAvailable(void* data, size_t len)
+{
+  return IsOpen() ? SocketReadAvailable(m_socket, &m_iError, data, len) : -1;
 }
 
 ssize_t CSerialSocket::Write(void* data, size_t len)
@@ -122,6 +189,13 @@ bool CSerialSocket::Open(uint64_t iTimeoutMs /* = 0 */)
     return false;
   }
 
+  if (m_wakeupRead == INVALID_SOCKET_VALUE && !OpenWakeup(m_wakeupRead, m_wakeupWrite))
+  {
+    m_iError = errno;
+    m_strError = strerror(errno);
+    return false;
+  }
+
   m_socket = open(m_strName.c_str(), O_RDWR | O_NOCTTY | O_NDELAY | O_CLOEXEC);
 
   if (m_socket == INVALID_SERIAL_SOCKET_VALUE)
@@ -35,6 +35,7 @@
 #include "env.h"
 #include "platform/util/buffer.h"
 
+#include <atomic>
 #include <string>
 #include <stdint.h>
 
@@ -74,6 +75,12 @@ namespace CEC
           CCommonSocket<serial_socket_t>(INVALID_SERIAL_SOCKET_VALUE, strName),
           #ifdef __WINDOWS__
           m_iCurrentReadTimeout(MAXDWORD),
+          m_readEvent(CreateEvent(NULL, TRUE, FALSE, NULL)),
+          m_waitEvent(CreateEvent(NULL, TRUE, FALSE, NULL)),
+          m_interruptEvent(CreateEvent(NULL, FALSE, FALSE, NULL)),
+          #else
+          m_wakeupRead(INVALID_SOCKET_VALUE),
+          m_wakeupWrite(INVALID_SOCKET_VALUE),
           #endif
           m_bIsOpen(false),
           m_iBaudrate(iBaudrate),
@@ -81,13 +88,35 @@ namespace CEC
           m_iStopbits(iStopbits),
           m_iParity(iParity) {}
 
-      ~CSerialSocket(void) { Close(); }
+      ~CSerialSocket(void);
 
       bool Open(uint64_t iTimeoutMs = 0);
       void Close(void);
       ssize_t Write(void* data, size_t len);
       ssize_t Read(void* data, size_t len, uint64_t iTimeoutMs = 0);
 
+      /*!
+       * @brief Block until data can be read from the port, until Interrupt() is
+       *        called or until the timeout passed.
+       * @param iTimeoutMs The maximum time to wait, or 0 to wait until data or
+       *                   an interrupt arrives.
+       * @return 1 when data can be read, 0 on timeout or interrupt, or -errno.
+       */
+      int WaitForData(uint64_t iTimeoutMs = 0);
+
+      /*!
+       * @brief Wake up a thread that's blocked in WaitForData().
+       */
+      void Interrupt(void);
+
+      /*!
+       * @brief Read whatever is available right now, without blocking.
+       * @param data The buffer to read into.
+       * @param len The size of the buffer.
+       * @return The number of bytes read (0 when nothing was pending), or -errno.
+       */
+      ssize_t ReadAvailable(void* data, size_t len);
+
       bool IsOpen(void)
       {
         return m_socket != INVALID_SERIAL_SOCKET_VALUE &&
@@ -99,9 +128,14 @@ namespace CEC
     protected:
   #ifndef __WINDOWS__
       struct termios  m_options;
+      socket_t        m_wakeupRead;  /**< eventfd (or the read end of a pipe) that wakes up WaitForData() */
+      socket_t        m_wakeupWrite; /**< the end that Interrupt() writes to */
   #else
       bool SetTimeouts(serial_socket_t socket, int* iError, DWORD iTimeoutMs);
-      DWORD           m_iCurrentReadTimeout;
+      DWORD             m_iCurrentReadTimeout;
+      HANDLE            m_readEvent;      /**< completes the overlapped reads of the reader thread */
+      HANDLE            m_waitEvent;      /**< completes WaitCommEvent() in WaitForData() */
+      HANDLE            m_interruptEvent; /**< auto reset event that Interrupt() sets */
   #endif
 
       bool            m_bIsOpen;
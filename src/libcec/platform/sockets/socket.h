@@ -156,6 +156,32 @@ namespace CEC
       return iReturn;
     }
 
+    /*!
+     * @brief Wait for incoming data. This doesn't claim the socket, so writes
+     *        can go out while a reader thread is blocked in here.
+     */
+    int WaitForData(uint64_t iTimeoutMs = 0)
+    {
+      return m_socket ? m_socket->WaitForData(iTimeoutMs) : -EINVAL;
+    }
+
+    void Interrupt(void)
+    {
+      if (m_socket)
+        m_socket->Interrupt();
+    }
+
+    ssize_t ReadAvailable(void* data, size_t len)
+    {
+      if (!m_socket || !WaitReady())
+        return -EINVAL;
+
+      ssize_t iReturn = m_socket->ReadAvailable(data, len);
+      MarkReady();
+
+      return iReturn;
+    }
+
     std::string GetError(void)
     {
       CLockObject lock(m_mutex);
@@ -34,8 +34,10 @@
 
 #include "platform/threads/mutex.h"
 
+#include <atomic>
 #include <queue>
 #include <stdint.h>
+#include <vector>
 
 namespace CEC
 {
@@ -109,4 +111,83 @@ namespace CEC
       bool               m_bHasData;
       CCondition<bool>   m_condition;
     };
+
+  /*!
+   * @brief Fixed-capacity ring for exactly one producer and one consumer thread.
+   *
+   * Push() and Pop() never lock or allocate. Push() may only be called from the
+   * producer thread and Pop() only from the consumer thread; Size() and
+   * IsEmpty() may be called from either. Waking up a consumer is left to the
+   * user of this buffer.
+   */
+  template<typename _BType>
+    class SPSCBuffer
+    {
+    public:
+      SPSCBuffer(size_t iCapacity = 128) :
+          m_iMask(RoundUp(iCapacity) - 1),
+          m_iHead(0),
+          m_iTail(0)
+      {
+        m_buffer.resize(m_iMask + 1);
+      }
+
+      SPSCBuffer(const SPSCBuffer &) = delete;
+      SPSCBuffer &operator=(const SPSCBuffer &) = delete;
+
+      size_t Capacity(void) const
+      {
+        return m_iMask + 1;
+      }
+
+      size_t Size(void) const
+      {
+        return m_iTail.load(std::memory_order_acquire) - m_iHead.load(std::memory_order_acquire);
+      }
+
+      bool IsEmpty(void) const
+      {
+        return Size() == 0;
+      }
+
+      bool Push(const _BType &entry)
+      {
+        const size_t iTail(m_iTail.load(std::memory_order_relaxed));
+        if (iTail - m_iHead.load(std::memory_order_acquire) > m_iMask)
+          return false;
+
+        m_buffer[iTail & m_iMask] = entry;
+        m_iTail.store(iTail + 1, std::memory_order_release);
+        return true;
+      }
+
+      bool Pop(_BType &entry)
+      {
+        const size_t iHead(m_iHead.load(std::memory_order_relaxed));
+        if (iHead == m_iTail.load(std::memory_order_acquire))
+          return false;
+
+        entry = m_buffer[iHead & m_iMask];
+        m_iHead.store(iHead + 1, std::memory_order_release);
+        return true;
+      }
+
+    private:
+      static size_t RoundUp(size_t iCapacity)
+      {
+        size_t iReturn(1);
+        while (iReturn < iCapacity)
+          iReturn <<= 1;
+        return iReturn;
+      }
+
+      std::vector<_BType> m_buffer;
+      const size_t        m_iMask;
+      // head and tail are written by different threads: keep them on separate cache lines
+      char                m_padding1[64];
+      std::atomic<size_t> m_iHead; /**< written by the consumer */
+      char                m_padding2[64];
+      std::atomic<size_t> m_iTail; /**< written by the producer */
+      char                m_padding3[64];
+    };
 };
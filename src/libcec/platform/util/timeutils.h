@@ -47,6 +47,15 @@ namespace CEC
         std::chrono::steady_clock::now().time_since_epoch()).count();
   }
 
+  /*!
+   * @return the number of microseconds on the same clock as GetTimeMs().
+   */
+  inline int64_t GetTimeUs(void)
+  {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
   class CTimeout
   {
   public:
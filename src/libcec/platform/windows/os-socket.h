@@ -45,7 +45,12 @@ namespace CEC
       CloseHandle(socket);
   }
 
-  inline ssize_t SerialSocketWrite(serial_socket_t socket, int *iError, void* data, size_t len)
+  /*!
+   * @brief Write to a serial port that was opened with FILE_FLAG_OVERLAPPED,
+   *        and wait until the write completed.
+   * @param event A manual reset event that no other thread uses at the same time.
+   */
+  inline ssize_t SerialSocketWrite(serial_socket_t socket, int *iError, void* data, size_t len, HANDLE event)
   {
     if (len != (DWORD)len)
     {
@@ -56,7 +61,10 @@ namespace CEC
     DWORD iBytesWritten(0);
     if (socket != INVALID_HANDLE_VALUE)
     {
-      if (!WriteFile(socket, data, (DWORD)len, &iBytesWritten, NULL))
+      OVERLAPPED overlapped = {0};
+      overlapped.hEvent = event;
+      if ((!WriteFile(socket, data, (DWORD)len, NULL, &overlapped) && GetLastError() != ERROR_IO_PENDING) ||
+          !GetOverlappedResult(socket, &overlapped, &iBytesWritten, TRUE))
       {
         *iError = GetLastError();
         return -1;
@@ -67,10 +75,13 @@ namespace CEC
     return -1;
   }
 
-  inline ssize_t SerialSocketRead(serial_socket_t socket, int *iError, void* data, size_t len, uint64_t iTimeoutMs /*= 0*/)
+  /*!
+   * @brief Read from a serial port that was opened with FILE_FLAG_OVERLAPPED.
+   *        The port's read timeouts make this return right away.
+   * @param event A manual reset event that no other thread uses at the same time.
+   */
+  inline ssize_t SerialSocketRead(serial_socket_t socket, int *iError, void* data, size_t len, HANDLE event)
   {
-    (void)iTimeoutMs;
-
     if (len != (DWORD)len)
     {
       *iError = EINVAL;
@@ -80,7 +91,10 @@ namespace CEC
     DWORD iBytesRead(0);
     if (socket != INVALID_HANDLE_VALUE)
     {
-      if (!ReadFile(socket, data, (DWORD)len, &iBytesRead, NULL))
+      OVERLAPPED overlapped = {0};
+      overlapped.hEvent = event;
+      if ((!ReadFile(socket, data, (DWORD)len, NULL, &overlapped) && GetLastError() != ERROR_IO_PENDING) ||
+          !GetOverlappedResult(socket, &overlapped, &iBytesRead, TRUE))
       {
         *iError = GetLastError();
         return -1;
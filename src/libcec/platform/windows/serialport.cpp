@@ -85,18 +85,97 @@ bool CSerialSocket::SetTimeouts(serial_socket_t socket, int* iError, DWORD iTime
 void CSerialSocket::Close(void)
 {
   if (IsOpen())
+  {
+    /* don't leave a reader blocked on a handle that's about to go away */
+    Interrupt();
     SerialSocketClose(m_socket);
+  }
   m_socket = INVALID_SERIAL_SOCKET_VALUE;
+  m_bIsOpen = false;
 }
 
 ssize_t CSerialSocket::Write(void* data, size_t len)
 {
-  return IsOpen() ? SerialSocketWrite(m_socket, &m_iError, data, len) : -1;
+  if (!IsOpen())
+    return -1;
+
+  /* writes can come from more than one thread, so each gets an event of its own */
+  HANDLE event = CreateEvent(NULL, TRUE, FALSE, NULL);
+  if (!event)
+  {
+    m_iError = GetLastError();
+    return -1;
+  }
+  ssize_t iReturn = SerialSocketWrite(m_socket, &m_iError, data, len, event);
+  CloseHandle(event);
+  return iReturn;
 }
 
 ssize_t CSerialSocket::Read(void* data, size_t len, uint64_t iTimeoutMs /* = 0 */)
 {
-  return IsOpen() ? SerialSocketRead(m_socket, &m_iError, data, len, iTimeoutMs) : -1;
+  /* the read timeouts are set up to return immediately */
+  (void)iTimeoutMs;
+  return IsOpen() ? SerialSocketRead(m_socket, &m_iError, data, len, m_readEvent) : -1;
+}
+
+CSerialSocket::~CSerialSocket(void)
+{
+  Close();
+
+  CloseHandle(m_readEvent);
+  CloseHandle(m_waitEvent);
+  CloseHandle(m_interruptEvent);
+}
+
+int CSerialSocket::WaitForData(uint64_t iTimeoutMs /* = 0 */)
+{
+  if (!IsOpen())
+    return -EBADF;
+
+  /* data that is queued already won't raise EV_RXCHAR again */
+  DWORD iErrors(0);
+  COMSTAT stat;
+  if (!ClearCommError(m_socket, &iErrors, &stat))
+    return -EIO;
+  if (stat.cbInQue > 0)
+    return 1;
+
+  OVERLAPPED overlapped = {0};
+  overlapped.hEvent = m_waitEvent;
+  DWORD iEvents(0);
+  if (!WaitCommEvent(m_socket, &iEvents, &overlapped))
+  {
+    if (GetLastError() != ERROR_IO_PENDING)
+      return -EIO;
+
+    HANDLE handles[2] = { m_waitEvent, m_interruptEvent };
+    DWORD iWait = WaitForMultipleObjects(2, handles, FALSE, iTimeoutMs == 0 ? INFINITE : (DWORD)iTimeoutMs);
+
+    DWORD iUnused(0);
+    if (iWait != WAIT_OBJECT_0)
+    {
+      /* changing the mask completes the pending WaitCommEvent(), which must
+         be done with before overlapped goes out of scope */
+      SetCommMask(m_socket, EV_RXCHAR);
+      GetOverlappedResult(m_socket, &overlapped, &iUnused, TRUE);
+      return iWait == WAIT_OBJECT_0 + 1 || iWait == WAIT_TIMEOUT ? 0 : -EIO;
+    }
+
+    if (!GetOverlappedResult(m_socket, &overlapped, &iUnused, FALSE))
+      return -EIO;
+  }
+
+  return (iEvents & EV_RXCHAR) ? 1 : 0;
+}
+
+void CSerialSocket::Interrupt(void)
+{
+  SetEvent(m_interruptEvent);
+}
+
+ssize_t CSerialSocket::ReadAvailable(void* data, size_t len)
+{
+  return IsOpen() ? SerialSocketRead(m_socket, &m_iError, data, len, m_readEvent) : -1;
 }
 
 bool CSerialSocket::Open(uint64_t iTimeoutMs /* = 0 */)
@@ -107,7 +186,8 @@ bool CSerialSocket::Open(uint64_t iTimeoutMs /* = 0 */)
 
   std::string strComPath = "\\\\.\\" + m_strName;
   CLockObject lock(m_mutex);
-  m_socket = CreateFile(strComPath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+  // overlapped, so WaitForData() can wait for data without blocking writes
+  m_socket = CreateFile(strComPath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, 0);
   if (m_socket == INVALID_HANDLE_VALUE)
   {
     m_strError = "Unable to open COM port";
@@ -154,6 +234,14 @@ bool CSerialSocket::Open(uint64_t iTimeoutMs /* = 0 */)
     return false;
   }
 
+  if (!SetCommMask(m_socket, EV_RXCHAR))
+  {
+    m_strError = "unable to set the event mask";
+    FormatWindowsError(GetLastError(), m_strError);
+    Close();
+    return false;
+  }
+
   m_bIsOpen = true;
   return m_bIsOpen;
 }
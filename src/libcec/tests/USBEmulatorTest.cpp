@@ -0,0 +1,287 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+
+/*
+ * Runs libCEC's USB backend against the emulated Pulse-Eight firmware, over a
+ * pseudo terminal, so the serial port and message queue are tested without an
+ * adapter.
+ */
+
+#include "cec.h"
+#include "LibCEC.h"
+#include "CECProcessor.h"
+#include "adapter/Pulse-Eight/USBCECAdapterCommunication.h"
+#include "adapter/Pulse-Eight/USBCECAdapterMessage.h"
+#include "adapter/Pulse-Eight/USBCECAdapterMessageQueue.h"
+#include "emulator/USBCECAdapterEmulator.h"
+#include <chrono>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace CEC;
+
+static int g_iFailures(0);
+
+#define CHECK(expr) \
+  do { \
+    if (!(expr)) \
+    { \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+      ++g_iFailures; \
+    } \
+  } while (0)
+
+static ICECAdapter *OpenEmulator(CUSBCECAdapterEmulator &emulator, cec_device_type type)
+{
+  if (!emulator.Open())
+    return NULL;
+
+  libcec_configuration config;
+  config.Clear();
+  snprintf(config.strDeviceName, sizeof(config.strDeviceName), "cec-test");
+  config.bActivateSource = 0;
+  config.deviceTypes.Add(type);
+
+  ICECAdapter *adapter = CECInitialise(&config);
+  if (adapter && !adapter->Open(emulator.GetPortName().c_str()))
+  {
+    CECDestroy(adapter);
+    adapter = NULL;
+  }
+  return adapter;
+}
+
+static void TestDiscovery(void)
+{
+  usbcec_emulator_config config;
+  config.peers.push_back("tv");
+  config.peers.push_back("audio");
+  config.peers.push_back("playback:nack");
+  config.iSpeed = 10;
+
+  CUSBCECAdapterEmulator emulator(config);
+  ICECAdapter *adapter = OpenEmulator(emulator, CEC_DEVICE_TYPE_PLAYBACK_DEVICE);
+  CHECK(adapter != NULL);
+  if (!adapter)
+    return;
+
+  CHECK(adapter->GetLogicalAddresses().primary == CECDEVICE_PLAYBACKDEVICE1);
+  CHECK(adapter->PollDevice(CECDEVICE_TV));
+  CHECK(!adapter->PollDevice(CECDEVICE_TUNER1));
+  CHECK(adapter->GetDevicePowerStatus(CECDEVICE_TV) == CEC_POWER_STATUS_ON);
+  CHECK(adapter->GetDeviceOSDName(CECDEVICE_TV) == "TV");
+  CHECK(adapter->GetDevicePhysicalAddress(CECDEVICE_AUDIOSYSTEM) == 0x2000);
+
+  cec_adapter_stats stats;
+  CHECK(adapter->GetStats(&stats));
+  CHECK(stats.tx_ack > 0);
+  CHECK(stats.tx_nack > 0);
+  CHECK(stats.rx_total > 0);
+
+  adapter->Close();
+  CECDestroy(adapter);
+
+  usbcec_emulator_stats emulatorStats;
+  emulator.GetStats(emulatorStats);
+  CHECK(emulatorStats.tx_acked == stats.tx_ack);
+  CHECK(emulatorStats.tx_nacked == stats.tx_nack);
+  CHECK(emulatorStats.rx_frames > 0);
+  CHECK(emulatorStats.rejected == 0);
+}
+
+static void TestJitter(void)
+{
+  // replies that trickle in must still be matched to the right commands
+  usbcec_emulator_config config;
+  config.iSpeed = 0;
+  config.iJitterUs = 2000;
+  config.iSeed = 1;
+
+  CUSBCECAdapterEmulator emulator(config);
+  ICECAdapter *adapter = OpenEmulator(emulator, CEC_DEVICE_TYPE_RECORDING_DEVICE);
+  CHECK(adapter != NULL);
+  if (!adapter)
+    return;
+
+  CHECK(adapter->GetLogicalAddresses().primary == CECDEVICE_RECORDINGDEVICE1);
+  CHECK(adapter->GetDeviceVendorId(CECDEVICE_TV) == CEC_VENDOR_PULSE_EIGHT);
+  CHECK(adapter->PollDevice(CECDEVICE_AUDIOSYSTEM));
+  CHECK(adapter->AudioStatus() == 0x20);
+
+  adapter->Close();
+  CECDestroy(adapter);
+}
+
+static void TestTransmitErrors(void)
+{
+  usbcec_emulator_config config;
+  config.iSpeed = 0;
+
+  CUSBCECAdapterEmulator emulator(config);
+  ICECAdapter *adapter = OpenEmulator(emulator, CEC_DEVICE_TYPE_RECORDING_DEVICE);
+  CHECK(adapter != NULL);
+  if (!adapter)
+    return;
+
+  // a failed transmission is reported as an error, not as a nack
+  emulator.SetErrorRates(100, 0, 0);
+  CHECK(!adapter->PollDevice(CECDEVICE_TV));
+
+  cec_adapter_stats stats;
+  CHECK(adapter->GetStats(&stats));
+  CHECK(stats.tx_error > 0);
+
+  emulator.SetErrorRates(0, 0, 0);
+  CHECK(adapter->PollDevice(CECDEVICE_TV));
+
+  adapter->Close();
+  CECDestroy(adapter);
+}
+
+static void TestEepromWrite(void)
+{
+  usbcec_emulator_config config;
+  config.iSpeed = 0;
+
+  CUSBCECAdapterEmulator emulator(config);
+  ICECAdapter *adapter = OpenEmulator(emulator, CEC_DEVICE_TYPE_RECORDING_DEVICE);
+  CHECK(adapter != NULL);
+  if (!adapter)
+    return;
+
+  // changed settings are written by the maintenance thread while the connection is open
+  libcec_configuration configuration;
+  CHECK(adapter->GetCurrentConfiguration(&configuration));
+  snprintf(configuration.strDeviceName, sizeof(configuration.strDeviceName), "eeprom");
+  CHECK(adapter->SetConfiguration(&configuration));
+
+  usbcec_emulator_stats emulatorStats;
+  for (int iTry = 0; iTry < 200; iTry++)
+  {
+    emulator.GetStats(emulatorStats);
+    if (emulatorStats.eeprom_writes > 0)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  CHECK(emulatorStats.eeprom_writes > 0);
+
+  adapter->Close();
+  CECDestroy(adapter);
+}
+
+static CCECAdapterMessage *AllocatePing(CCECAdapterMessageQueue &queue)
+{
+  CCECAdapterMessage *message = queue.AllocateMessage();
+  message->PushBack(MSGSTART);
+  message->PushEscaped(MSGCODE_PING);
+  message->PushBack(MSGEND);
+  message->bFireAndForget = true;
+  return message;
+}
+
+static void TestMessagePool(void)
+{
+  // the queue's own libCEC instance is only used to log, it's never opened
+  libcec_configuration config;
+  config.Clear();
+  ICECAdapter *lib = CECInitialise(&config);
+  CHECK(lib != NULL);
+  if (!lib)
+    return;
+
+  {
+    // the queue's thread isn't started, so everything that's written stays pending
+    CUSBCECAdapterCommunication com(static_cast<CLibCEC *>(lib)->m_cec, "/dev/null");
+    CCECAdapterMessageQueue queue(&com);
+    size_t iMessages(0), iEntries(0);
+
+    // messages come from the pool until it's empty, and from the heap after that
+    std::vector<CCECAdapterMessage *> messages;
+    for (size_t iPtr = 0; iPtr <= MESSAGE_QUEUE_SLOTS; iPtr++)
+      messages.push_back(queue.AllocateMessage());
+    queue.PoolSize(iMessages, iEntries);
+    CHECK(iMessages == 0);
+    CHECK(iEntries == MESSAGE_QUEUE_SLOTS);
+
+    // a message from the heap is deleted, the others go back to the pool
+    queue.ReleaseMessage(messages.back());
+    messages.pop_back();
+    queue.PoolSize(iMessages, iEntries);
+    CHECK(iMessages == 0);
+    for (std::vector<CCECAdapterMessage *>::iterator it = messages.begin(); it != messages.end(); ++it)
+      queue.ReleaseMessage(*it);
+    queue.PoolSize(iMessages, iEntries);
+    CHECK(iMessages == MESSAGE_QUEUE_SLOTS);
+
+    // a write is refused while MESSAGE_QUEUE_SLOTS messages are pending. the refused
+    // message and its entry come from the heap, and are deleted
+    for (size_t iPtr = 0; iPtr < MESSAGE_QUEUE_SLOTS; iPtr++)
+      CHECK(queue.Write(AllocatePing(queue)));
+    CHECK(queue.WriteQueueSize() == MESSAGE_QUEUE_SLOTS);
+    CHECK(!queue.Write(AllocatePing(queue)));
+    queue.PoolSize(iMessages, iEntries);
+    CHECK(iMessages == 0);
+    CHECK(iEntries == 0);
+
+    // nobody waits for fire and forget messages, so Clear() releases them
+    queue.Clear();
+    queue.PoolSize(iMessages, iEntries);
+    CHECK(iMessages == MESSAGE_QUEUE_SLOTS);
+    CHECK(iEntries == MESSAGE_QUEUE_SLOTS);
+    CHECK(queue.WriteQueueSize() == 0);
+    CHECK(queue.Write(AllocatePing(queue)));
+  }
+
+  CECDestroy(lib);
+}
+
+int main(void)
+{
+  TestDiscovery();
+  TestJitter();
+  TestTransmitErrors();
+  TestEepromWrite();
+  TestMessagePool();
+
+  if (g_iFailures > 0)
+  {
+    fprintf(stderr, "%d check(s) failed\n", g_iFailures);
+    return 1;
+  }
+
+  printf("all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,1098 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+
+/*
+ * Runs libCEC against the virtual adapter, which simulates a CEC bus with a
+ * few peer devices on it, so these need no hardware.
+ */
+
+#include "env.h"
+#include "cec.h"
+#include "LibCEC.h"
+#include "CECTimerService.h"
+#include "CECCallbackQueue.h"
+#include "CECProcessor.h"
+#include "CECInputBuffer.h"
+#include "adapter/AdapterMessageQueue.h"
+#include "devices/CECBusDevice.h"
+#include "adapter/Daemon/DaemonCECServer.h"
+#include "platform/util/timeutils.h"
+#include <atomic>
+#include <mutex>
+#include <stdio.h>
+#include <string>
+#include <time.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace CEC;
+
+static int g_iFailures(0);
+
+#define CHECK(expr) \
+  do { \
+    if (!(expr)) \
+    { \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+      ++g_iFailures; \
+    } \
+  } while (0)
+
+static ICECAdapter *OpenVirtual(const char *strPort, cec_device_type type, const char *strDeviceCache = NULL, const char *strCapture = NULL)
+{
+  libcec_configuration config;
+  config.Clear();
+  snprintf(config.strDeviceName, sizeof(config.strDeviceName), "cec-test");
+  config.bActivateSource = 0;
+  config.deviceTypes.Add(type);
+
+  ICECAdapter *adapter = CECInitialise(&config);
+  if (adapter)
+  {
+    adapter->SetDeviceCachePath(strDeviceCache);
+    if (strCapture)
+      adapter->SetTrafficCapture(strCapture);
+  }
+  if (adapter && !adapter->Open(strPort))
+  {
+    CECDestroy(adapter);
+    adapter = NULL;
+  }
+  return adapter;
+}
+
+static void TestDiscovery(void)
+{
+  ICECAdapter *adapter = OpenVirtual("virtual:tv,audio,playback", CEC_DEVICE_TYPE_PLAYBACK_DEVICE);
+  CHECK(adapter != NULL);
+  if (!adapter)
+    return;
+
+  // the playback peer holds the first playback address
+  CHECK(adapter->GetLogicalAddresses().primary == CECDEVICE_PLAYBACKDEVICE2);
+
+  CHECK(adapter->PollDevice(CECDEVICE_TV));
+  CHECK(adapter->PollDevice(CECDEVICE_AUDIOSYSTEM));
+  CHECK(!adapter->PollDevice(CECDEVICE_TUNER1));
+
+  CHECK(adapter->GetDevicePowerStatus(CECDEVICE_TV) == CEC_POWER_STATUS_ON);
+  CHECK(adapter->GetDeviceVendorId(CECDEVICE_TV) == CEC_VENDOR_PULSE_EIGHT);
+  CHECK(adapter->GetDeviceOSDName(CECDEVICE_PLAYBACKDEVICE1) == "Playback");
+  CHECK(adapter->GetDevicePhysicalAddress(CECDEVICE_AUDIOSYSTEM) == 0x2000);
+  CHECK(adapter->GetDevicePhysicalAddress(CECDEVICE_PLAYBACKDEVICE1) == 0x3000);
+  CHECK(adapter->AudioStatus() == 0x20);
+
+  cec_adapter_stats stats;
+  CHECK(adapter->GetStats(&stats));
+  CHECK(stats.tx_ack > 0);
+  CHECK(stats.tx_nack > 0);
+  CHECK(stats.rx_total > 0);
+
+  cec_adapter_counters counters;
+  memset(&counters, 0, sizeof(counters));
+  counters.version = CEC_ADAPTER_COUNTERS_VERSION + 1;
+  counters.size    = sizeof(cec_adapter_counters);
+  CHECK(!adapter->GetAdapterCounters(&counters));
+  counters.version = CEC_ADAPTER_COUNTERS_VERSION;
+  CHECK(adapter->GetAdapterCounters(&counters));
+  CHECK(counters.rx_latency_count >= stats.rx_total);
+  CHECK(counters.rx_latency_total_us >= counters.rx_latency_max_us);
+  CHECK(counters.rx_lost == 0);
+  CHECK(counters.cb_overflow == 0);
+
+  adapter->Close();
+  CECDestroy(adapter);
+}
+
+static void TestNack(void)
+{
+  // a peer that never acks doesn't hold on to its address
+  ICECAdapter *adapter = OpenVirtual("virtual:tv,playback:nack,speed=10", CEC_DEVICE_TYPE_PLAYBACK_DEVICE);
+  CHECK(adapter != NULL);
+  if (!adapter)
+    return;
+
+  CHECK(adapter->GetLogicalAddresses().primary == CECDEVICE_PLAYBACKDEVICE1);
+  CHECK(adapter->PollDevice(CECDEVICE_TV));
+
+  adapter->Close();
+  CECDestroy(adapter);
+}
+
+static void TestMultipleTypes(void)
+{
+  libcec_configuration config;
+  config.Clear();
+  snprintf(config.strDeviceName, sizeof(config.strDeviceName), "cec-test");
+  config.bActivateSource = 0;
+  config.deviceTypes.Add(CEC_DEVICE_TYPE_PLAYBACK_DEVICE);
+  config.deviceTypes.Add(CEC_DEVICE_TYPE_RECORDING_DEVICE);
+  config.deviceTypes.Add(CEC_DEVICE_TYPE_TUNER);
+
+  ICECAdapter *adapter = CECInitialise(&config);
+  CHECK(adapter != NULL);
+  if (!adapter)
+    return;
+
+  // all candidates are polled together, and every type gets the lowest free address
+  CHECK(adapter->Open("virtual:tv,playback,tuner,speed=0"));
+  cec_logical_addresses addresses = adapter->GetLogicalAddresses();
+  CHECK(addresses.primary == CECDEVICE_PLAYBACKDEVICE2);
+  CHECK(addresses.IsSet(CECDEVICE_RECORDINGDEVICE1));
+  CHECK(addresses.IsSet(CECDEVICE_TUNER2));
+  CHECK(!addresses.IsSet(CECDEVICE_PLAYBACKDEVICE1));
+  CHECK(!addresses.IsSet(CECDEVICE_PLAYBACKDEVICE3));
+  CHECK(!addresses.IsSet(CECDEVICE_TUNER1));
+  CHECK(adapter->PollDevice(CECDEVICE_PLAYBACKDEVICE1));
+
+  // a free address that isn't used was polled once
+  cec_latency_stats *stats = new cec_latency_stats;
+  stats->version = CEC_LATENCY_STATS_VERSION;
+  stats->size    = sizeof(cec_latency_stats);
+  CHECK(adapter->GetLatencyStats(stats));
+  CHECK(stats->destinations[CECDEVICE_PLAYBACKDEVICE3].nacks == 1);
+  CHECK(stats->destinations[CECDEVICE_TUNER4].nacks == 1);
+  delete stats;
+
+  adapter->Close();
+  CECDestroy(adapter);
+}
+
+static void TestScanBus(void)
+{
+  ICECAdapter *adapter = OpenVirtual("virtual:tv,audio,playback,speed=0", CEC_DEVICE_TYPE_PLAYBACK_DEVICE);
+  CHECK(adapter != NULL);
+  if (!adapter)
+    return;
+
+  cec_bus_scan scan;
+  CHECK(adapter->ScanBus(&scan));
+  CHECK(scan.iDeviceCount == 4);
+  CHECK(scan.iRequests > 0);
+  CHECK(scan.iReplies > 0 && scan.iReplies <= scan.iRequests);
+
+  for (uint8_t iPtr = 0; iPtr < scan.iDeviceCount; iPtr++)
+  {
+    const cec_device_info &device = scan.devices[iPtr];
+    switch (device.logicalAddress)
+    {
+    case CECDEVICE_TV:
+      CHECK(device.iPhysicalAddress == 0x0000);
+      CHECK(device.iVendorId == CEC_VENDOR_PULSE_EIGHT);
+      CHECK(device.powerStatus == CEC_POWER_STATUS_ON);
+      break;
+    case CECDEVICE_AUDIOSYSTEM:
+      CHECK(device.iPhysicalAddress == 0x2000);
+      CHECK(std::string(device.strOSDName) == "Audio");
+      break;
+    case CECDEVICE_PLAYBACKDEVICE1:
+      CHECK(device.iPhysicalAddress == 0x3000);
+      CHECK(std::string(device.strOSDName) == "Playback");
+      CHECK(!device.bHandledByLibCEC);
+      break;
+    case CECDEVICE_PLAYBACKDEVICE2:
+      CHECK(device.bHandledByLibCEC);
+      break;
+    default:
+      CHECK(!"unexpected device");
+      break;
+    }
+  }
+
+  // known properties aren't requested again
+  cec_bus_scan rescan;
+  CHECK(adapter->ScanBus(&rescan));
+  CHECK(rescan.iDeviceCount == scan.iDeviceCount);
+  CHECK(rescan.iRequests < scan.iRequests);
+
+  adapter->Close();
+  CECDestroy(adapter);
+}
+
+static void TestRoutingTree(void)
+{
+  ICECAdapter *adapter = OpenVirtual("virtual:tv,audio,playback,speed=0", CEC_DEVICE_TYPE_PLAYBACK_DEVICE);
+  CHECK(adapter != NULL);
+  if (!adapter)
+    return;
+
+  cec_bus_scan scan;
+  CHECK(adapter->ScanBus(&scan));
+
+  // the index is updated when a physical address changes
+  CCECDeviceMap *devices = static_cast<CLibCEC *>(adapter)->m_cec->GetDevices();
+  CCECBusDevice *audio = devices->At(CECDEVICE_AUDIOSYSTEM);
+  CHECK(devices->GetDeviceByPhysicalAddress(0x0000) == devices->At(CECDEVICE_TV));
+  CHECK(devices->GetDeviceByPhysicalAddress(0x2000) == audio);
+  CHECK(devices->GetDeviceByPhysicalAddress(0x3000) == devices->At(CECDEVICE_PLAYBACKDEVICE1));
+  CHECK(devices->GetDeviceByPhysicalAddress(0x4000) == NULL);
+
+  audio->SetPhysicalAddress(0x4000);
+  CHECK(devices->GetDeviceByPhysicalAddress(0x2000) == NULL);
+  CHECK(devices->GetDeviceByPhysicalAddress(0x4000) == audio);
+
+  // a device behind the audio system
+  devices->At(CECDEVICE_TUNER1)->SetPhysicalAddress(0x4100);
+  CHECK(devices->GetParentOf(0x4100) == audio);
+  CHECK(devices->GetParentOf(0x4120) == devices->At(CECDEVICE_TUNER1));
+  CHECK(devices->GetParentOf(0x3000) == devices->At(CECDEVICE_TV));
+  CHECK(devices->GetParentOf(0x0000) == NULL);
+
+  CECDEVICEVEC children;
+  devices->GetChildrenOf(children, audio);
+  CHECK(children.size() == 2);
+  devices->GetChildrenOf(children, devices->At(CECDEVICE_TV));
+  CHECK(children.size() == 5);
+
+  std::string strTree = devices->RoutingTreeToString();
+  CHECK(strTree.find("  4.0.0.0 Audio (5)\n    4.1.0.0 Tuner 1 (3)\n") != std::string::npos);
+
+  adapter->Close();
+  CECDestroy(adapter);
+}
+
+static std::string ReadFile(const char *strPath)
+{
+  std::string strContents;
+  FILE *file = fopen(strPath, "r");
+  if (file)
+  {
+    char buf[256];
+    size_t iRead;
+    while ((iRead = fread(buf, 1, sizeof(buf), file)) > 0)
+      strContents.append(buf, iRead);
+    fclose(file);
+  }
+  return strContents;
+}
+
+static void TestDeviceCache(void)
+{
+  const char *strCache = "cec-virtual-test.cache";
+  remove(strCache);
+
+  // the first connection finds the devices, and writes them to the cache when closed
+  ICECAdapter *adapter = OpenVirtual("virtual:tv,playback,speed=0", CEC_DEVICE_TYPE_RECORDING_DEVICE, strCache);
+  CHECK(adapter != NULL);
+  if (!adapter)
+    return;
+
+  cec_bus_scan scan;
+  CHECK(adapter->ScanBus(&scan));
+  adapter->Close();
+  CECDestroy(adapter);
+
+  std::string strContents = ReadFile(strCache);
+  CHECK(strContents.find("\t2000\t4\t") != std::string::npos);
+  CHECK(strContents.find("Playback") != std::string::npos);
+
+  // add a device that isn't on the bus anymore
+  FILE *file = fopen(strCache, "a");
+  CHECK(file != NULL);
+  if (file)
+  {
+    fprintf(file, "virtual:tv,playback,speed=0\t3000\t5\t001582\t5\t\t%lld\tGone\n", (long long)time(NULL));
+    fclose(file);
+  }
+
+  // the next connection only requests what can change
+  adapter = OpenVirtual("virtual:tv,playback,speed=0", CEC_DEVICE_TYPE_RECORDING_DEVICE, strCache);
+  CHECK(adapter != NULL);
+  if (!adapter)
+    return;
+
+  CHECK(adapter->GetDeviceOSDName(CECDEVICE_PLAYBACKDEVICE1) == "Playback");
+
+  cec_bus_scan cached;
+  CHECK(adapter->ScanBus(&cached));
+  CHECK(cached.iDeviceCount == scan.iDeviceCount);
+  CHECK(cached.iRequests < scan.iRequests);
+  for (uint8_t iPtr = 0; iPtr < cached.iDeviceCount; iPtr++)
+  {
+    CHECK(cached.devices[iPtr].logicalAddress != CECDEVICE_AUDIOSYSTEM);
+    if (cached.devices[iPtr].logicalAddress == CECDEVICE_PLAYBACKDEVICE1)
+      CHECK(cached.devices[iPtr].iPhysicalAddress == 0x2000);
+  }
+
+  adapter->Close();
+  CECDestroy(adapter);
+
+  // the device that didn't respond was dropped
+  strContents = ReadFile(strCache);
+  CHECK(strContents.find("Playback") != std::string::npos);
+  CHECK(strContents.find("Gone") == std::string::npos);
+  remove(strCache);
+}
+
+static void TestTrafficCapture(void)
+{
+  const char *strCapture = "cec-virtual-test.pcap";
+  remove(strCapture);
+
+  ICECAdapter *adapter = OpenVirtual("virtual:tv,audio,playback,speed=0", CEC_DEVICE_TYPE_RECORDING_DEVICE, NULL, strCapture);
+  CHECK(adapter != NULL);
+  if (!adapter)
+    return;
+
+  cec_bus_scan scan;
+  CHECK(adapter->ScanBus(&scan));
+  CHECK(adapter->SetTrafficCapture(NULL));
+  adapter->Close();
+  CECDestroy(adapter);
+
+  // a pcap header, followed by the frames
+  std::string strContents = ReadFile(strCapture);
+  CHECK(strContents.size() > 24 + 16);
+  CHECK(strContents.compare(0, 4, "\xd4\xc3\xb2\xa1") == 0);
+
+  // the same session again, without a bus. the replies are replayed after the requests
+  std::string strPort("replay:");
+  strPort.append(strCapture).append(",speed=0");
+  adapter = OpenVirtual(strPort.c_str(), CEC_DEVICE_TYPE_RECORDING_DEVICE);
+  CHECK(adapter != NULL);
+  if (!adapter)
+  {
+    remove(strCapture);
+    return;
+  }
+
+  cec_bus_scan replayed;
+  CHECK(adapter->ScanBus(&replayed));
+  CHECK(replayed.iDeviceCount == scan.iDeviceCount);
+
+  CCECBusDevice *audio = static_cast<CLibCEC *>(adapter)->m_cec->GetDevices()->At(CECDEVICE_AUDIOSYSTEM);
+  CHECK(audio->GetCurrentPhysicalAddress() == 0x2000);
+  CHECK(audio->GetCurrentOSDName() == "Audio");
+
+  adapter->Close();
+  CECDestroy(adapter);
+  remove(strCapture);
+}
+
+static void TestLatencyStats(void)
+{
+  ICECAdapter *adapter = OpenVirtual("virtual:tv,playback,speed=0", CEC_DEVICE_TYPE_RECORDING_DEVICE);
+  CHECK(adapter != NULL);
+  if (!adapter)
+    return;
+
+  CHECK(adapter->GetDeviceOSDName(CECDEVICE_PLAYBACKDEVICE1) == "Playback");
+
+  cec_latency_stats *stats = new cec_latency_stats;
+  stats->version = CEC_LATENCY_STATS_VERSION + 1;
+  stats->size    = sizeof(cec_latency_stats);
+  CHECK(!adapter->GetLatencyStats(stats));
+
+  stats->version = CEC_LATENCY_STATS_VERSION;
+  CHECK(adapter->GetLatencyStats(stats));
+
+  // the request was acked and answered, and the free logical address was found by polls that weren't acked
+  const cec_transmit_stats &request(stats->opcodes[CEC_OPCODE_GIVE_OSD_NAME]);
+  CHECK(request.ack.count == 1);
+  CHECK(request.retries[0] == 1);
+  CHECK(stats->opcodes[CEC_OPCODE_SET_OSD_NAME].response.count == 1);
+  CHECK(stats->opcodes[CEC_OPCODE_NONE].nacks > 0);
+  CHECK(stats->destinations[CECDEVICE_PLAYBACKDEVICE1].ack.count >= 1);
+  CHECK(stats->destinations[CECDEVICE_PLAYBACKDEVICE1].response.count >= 1);
+
+  uint32_t iBucketTotal(0);
+  for (uint8_t iPtr = 0; iPtr < CEC_LATENCY_BUCKETS; iPtr++)
+    iBucketTotal += request.ack.buckets[iPtr];
+  CHECK(iBucketTotal == request.ack.count);
+  CHECK(request.ack.total_us >= request.ack.max_us);
+
+  // the log callbacks aren't counted, but the configuration change after opening is
+  CHECK(stats->callbacks.count > 0);
+
+  adapter->ResetLatencyStats();
+  CHECK(adapter->GetLatencyStats(stats));
+  CHECK(stats->opcodes[CEC_OPCODE_GIVE_OSD_NAME].ack.count == 0);
+
+  delete stats;
+  adapter->Close();
+  CECDestroy(adapter);
+}
+
+static void TestStatusSnapshot(void)
+{
+  ICECAdapter *adapter = OpenVirtual("virtual:tv,playback,speed=0", CEC_DEVICE_TYPE_RECORDING_DEVICE);
+  CHECK(adapter != NULL);
+  if (!adapter)
+    return;
+
+  CHECK(adapter->GetDevicePhysicalAddress(CECDEVICE_PLAYBACKDEVICE1) == 0x2000);
+
+  cec_status_snapshot snapshot;
+  memset(&snapshot, 0, sizeof(snapshot));
+  snapshot.version = CEC_STATUS_SNAPSHOT_VERSION;
+  snapshot.size    = sizeof(cec_status_snapshot) - 1;
+  CHECK(!adapter->GetStatusSnapshot(&snapshot));
+
+  // reading the snapshot doesn't poll, so only what's already known is returned
+  snapshot.size = sizeof(cec_status_snapshot);
+  CHECK(adapter->GetStatusSnapshot(&snapshot));
+  CHECK(snapshot.deviceStatus[CECDEVICE_PLAYBACKDEVICE1] == CEC_DEVICE_STATUS_PRESENT);
+  CHECK(snapshot.physicalAddress[CECDEVICE_PLAYBACKDEVICE1] == 0x2000);
+  CHECK(snapshot.deviceStatus[CECDEVICE_RECORDINGDEVICE1] == CEC_DEVICE_STATUS_HANDLED_BY_LIBCEC);
+  CHECK(snapshot.deviceStatus[CECDEVICE_AUDIOSYSTEM] != CEC_DEVICE_STATUS_PRESENT);
+
+  adapter->Close();
+  CECDestroy(adapter);
+}
+
+static void TestTransmitBatch(void)
+{
+  ICECAdapter *adapter = OpenVirtual("virtual:tv,playback,speed=0", CEC_DEVICE_TYPE_RECORDING_DEVICE);
+  CHECK(adapter != NULL);
+  if (!adapter)
+    return;
+
+  // a key press and release for the playback device, one for an address that isn't
+  // there, and an invalid frame
+  cec_command commands[5];
+  cec_command::Format(commands[0], CECDEVICE_RECORDINGDEVICE1, CECDEVICE_PLAYBACKDEVICE1, CEC_OPCODE_USER_CONTROL_PRESSED);
+  commands[0].parameters.PushBack(CEC_USER_CONTROL_CODE_SELECT);
+  cec_command::Format(commands[1], CECDEVICE_RECORDINGDEVICE1, CECDEVICE_PLAYBACKDEVICE1, CEC_OPCODE_USER_CONTROL_RELEASE);
+  cec_command::Format(commands[2], CECDEVICE_RECORDINGDEVICE1, CECDEVICE_PLAYBACKDEVICE2, CEC_OPCODE_USER_CONTROL_PRESSED);
+  commands[2].parameters.PushBack(CEC_USER_CONTROL_CODE_SELECT);
+  cec_command::Format(commands[3], CECDEVICE_RECORDINGDEVICE1, CECDEVICE_TV, CEC_OPCODE_GIVE_DEVICE_POWER_STATUS);
+  cec_command::Format(commands[4], CECDEVICE_UNKNOWN, CECDEVICE_UNKNOWN, CEC_OPCODE_NONE);
+
+  cec_transmit_result results[5];
+  CHECK(!adapter->TransmitBatch(commands, 5, results));
+  CHECK(results[0] == CEC_TRANSMIT_RESULT_ACKED);
+  CHECK(results[1] == CEC_TRANSMIT_RESULT_ACKED);
+  CHECK(results[2] == CEC_TRANSMIT_RESULT_NOT_ACKED);
+  CHECK(results[3] == CEC_TRANSMIT_RESULT_ACKED);
+  CHECK(results[4] == CEC_TRANSMIT_RESULT_NOT_SENT);
+
+  CHECK(adapter->TransmitBatch(commands, 2, NULL));
+  CHECK(adapter->TransmitBatch(NULL, 0, NULL));
+
+  adapter->Close();
+  CECDestroy(adapter);
+}
+
+static void TestTransmitScheduling(void)
+{
+  // frames take a bit of time on this bus, so the queues fill up
+  ICECAdapter *adapter = OpenVirtual("virtual:tv,speed=20", CEC_DEVICE_TYPE_RECORDING_DEVICE);
+  CHECK(adapter != NULL);
+  if (!adapter)
+    return;
+
+  CCECProcessor *processor = static_cast<CLibCEC *>(adapter)->m_cec;
+  std::mutex mutex;
+  std::vector<int> completed;
+  auto queue = [&](const cec_command &command, bool bIsReply, int iId) {
+    return processor->TransmitAsync(command, bIsReply, [&mutex, &completed, iId](bool UNUSED(bSucceeded)) {
+      std::lock_guard<std::mutex> lock(mutex);
+      completed.push_back(iId);
+    });
+  };
+
+  // frames to addresses that nobody acks. the ids are the destination * 100 plus the
+  // order in which they were queued
+  const cec_logical_address absent[] = { CECDEVICE_TUNER4, CECDEVICE_PLAYBACKDEVICE3, CECDEVICE_RESERVED1 };
+  std::vector<std::future<bool>> results;
+  for (int iFrame = 0; iFrame < 5; iFrame++)
+  {
+    for (size_t iPtr = 0; iPtr < sizeof(absent) / sizeof(absent[0]); iPtr++)
+    {
+      cec_command command;
+      cec_command::Format(command, CECDEVICE_RECORDINGDEVICE1, absent[iPtr], CEC_OPCODE_GIVE_DEVICE_POWER_STATUS);
+      results.push_back(queue(command, false, absent[iPtr] * 100 + iFrame));
+    }
+  }
+
+  // a broadcast and a reply that are queued after them
+  cec_command broadcast, reply;
+  cec_command::Format(broadcast, CECDEVICE_RECORDINGDEVICE1, CECDEVICE_BROADCAST, CEC_OPCODE_REPORT_PHYSICAL_ADDRESS);
+  broadcast.parameters.PushBack(0x10);
+  broadcast.parameters.PushBack(0x00);
+  broadcast.parameters.PushBack(CEC_DEVICE_TYPE_RECORDING_DEVICE);
+  cec_command::Format(reply, CECDEVICE_RECORDINGDEVICE1, CECDEVICE_TV, CEC_OPCODE_REPORT_POWER_STATUS);
+  reply.parameters.PushBack(CEC_POWER_STATUS_ON);
+  std::future<bool> broadcastResult(queue(broadcast, false, 1));
+  std::future<bool> replyResult(queue(reply, true, 2));
+
+  CHECK(broadcastResult.get());
+  CHECK(replyResult.get());
+  for (auto &result : results)
+    CHECK(!result.get());
+
+  std::lock_guard<std::mutex> lock(mutex);
+  CHECK(completed.size() == results.size() + 2);
+
+  // the broadcast and the reply didn't wait for the frames to the absent devices
+  size_t iBroadcast(completed.size()), iReply(completed.size());
+  for (size_t iPtr = 0; iPtr < completed.size(); iPtr++)
+  {
+    if (completed[iPtr] == 1)
+      iBroadcast = iPtr;
+    else if (completed[iPtr] == 2)
+      iReply = iPtr;
+  }
+  CHECK(iBroadcast < completed.size() / 2);
+  CHECK(iReply < completed.size() / 2);
+
+  // and the frames to each destination completed in the order in which they were queued
+  for (size_t iPtr = 0; iPtr < sizeof(absent) / sizeof(absent[0]); iPtr++)
+  {
+    int iLast(-1);
+    for (size_t iCompleted = 0; iCompleted < completed.size(); iCompleted++)
+    {
+      if (completed[iCompleted] / 100 != absent[iPtr])
+        continue;
+      CHECK(completed[iCompleted] % 100 == iLast + 1);
+      iLast = completed[iCompleted] % 100;
+    }
+    CHECK(iLast == 4);
+  }
+
+  adapter->Close();
+  CECDestroy(adapter);
+}
+
+static void TestReplyMatching(void)
+{
+  // the adapter waits for the replies to requests, like the Linux CEC framework
+  ICECAdapter *adapter = OpenVirtual("virtual:tv,playback,match,speed=0", CEC_DEVICE_TYPE_RECORDING_DEVICE);
+  CHECK(adapter != NULL);
+  if (!adapter)
+    return;
+
+  // replies to the initiator and broadcast replies both complete the request
+  CHECK(adapter->GetDeviceOSDName(CECDEVICE_PLAYBACKDEVICE1) == "Playback");
+  CHECK(adapter->GetDevicePhysicalAddress(CECDEVICE_PLAYBACKDEVICE1) == 0x2000);
+  CHECK(adapter->GetDevicePowerStatus(CECDEVICE_TV) == CEC_POWER_STATUS_ON);
+
+  // a <Feature Abort> ends the request, instead of waiting until it times out
+  const int64_t iStart(GetTimeMs());
+  CHECK(adapter->GetDeviceMenuLanguage(CECDEVICE_PLAYBACKDEVICE1) == "???");
+  CHECK(GetTimeMs() - iStart < CEC_DEFAULT_TRANSMIT_WAIT);
+
+  adapter->Close();
+  CECDestroy(adapter);
+}
+
+static std::atomic<int> g_iCommandHandlerCalls(0);
+static std::atomic<int> g_iCommandHandlerResult(0);
+
+static int CEC_CDECL CommandHandler(void *UNUSED(cbParam), const cec_command *UNUSED(command))
+{
+  ++g_iCommandHandlerCalls;
+  return g_iCommandHandlerResult;
+}
+
+static bool WaitForCommandHandlerCalls(int iCalls)
+{
+  CTimeout timeout(2000);
+  while (g_iCommandHandlerCalls < iCalls && timeout.TimeLeft() > 0)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  return g_iCommandHandlerCalls >= iCalls;
+}
+
+static uint32_t FeatureAbortsSent(ICECAdapter *adapter)
+{
+  cec_latency_stats *stats = new cec_latency_stats;
+  stats->version = CEC_LATENCY_STATS_VERSION;
+  stats->size    = sizeof(cec_latency_stats);
+  uint32_t iCount = adapter->GetLatencyStats(stats) ? stats->opcodes[CEC_OPCODE_FEATURE_ABORT].ack.count : 0;
+  delete stats;
+  return iCount;
+}
+
+static void TestCommandHandlerFilter(void)
+{
+  ICECAdapter *adapter = OpenVirtual("virtual:tv,speed=0", CEC_DEVICE_TYPE_RECORDING_DEVICE);
+  CHECK(adapter != NULL);
+  if (!adapter)
+    return;
+
+  ICECCallbacks callbacks;
+  callbacks.Clear();
+  callbacks.commandHandler = CommandHandler;
+  CHECK(adapter->SetCallbacks(&callbacks, NULL));
+
+  // the tv answers these with a <Set OSD Name> to us, a broadcast <Device Vendor ID> and a
+  // <Report Power Status> to us
+  cec_command osdName, vendorId, powerStatus;
+  cec_command::Format(osdName, CECDEVICE_RECORDINGDEVICE1, CECDEVICE_TV, CEC_OPCODE_GIVE_OSD_NAME);
+  cec_command::Format(vendorId, CECDEVICE_RECORDINGDEVICE1, CECDEVICE_TV, CEC_OPCODE_GIVE_DEVICE_VENDOR_ID);
+  cec_command::Format(powerStatus, CECDEVICE_RECORDINGDEVICE1, CECDEVICE_TV, CEC_OPCODE_GIVE_DEVICE_POWER_STATUS);
+  cec_command reply;
+  cec_command::Format(reply, CECDEVICE_TV, CECDEVICE_RECORDINGDEVICE1, CEC_OPCODE_SET_OSD_NAME);
+
+  // only the commands in the filter are passed to the handler
+  const cec_opcode opcodes[] = { CEC_OPCODE_SET_OSD_NAME, CEC_OPCODE_DEVICE_VENDOR_ID };
+  CHECK(adapter->SetCommandHandlerFilter(opcodes, 2, 0));
+  g_iCommandHandlerCalls = 0;
+  g_iCommandHandlerResult = 1;
+  CHECK(adapter->Transmit(powerStatus));
+  CHECK(adapter->Transmit(osdName));
+  // commands are processed in order, so the power status was filtered out by now
+  CHECK(WaitForCommandHandlerCalls(1));
+  CHECK(g_iCommandHandlerCalls == 1);
+
+  // in claim mode, broadcasts are passed to the handler and processed by libCEC too, and
+  // never answered with a feature abort
+  CHECK(adapter->SetCommandHandlerFilter(opcodes, 2, 100));
+  const uint32_t iAborts(FeatureAbortsSent(adapter));
+  CCECBusDevice *tv = static_cast<CLibCEC *>(adapter)->m_cec->GetDevices()->At(CECDEVICE_TV);
+  tv->SetVendorId(CEC_VENDOR_UNKNOWN);
+  g_iCommandHandlerResult = 1;
+  CHECK(adapter->Transmit(vendorId));
+  CHECK(WaitForCommandHandlerCalls(2));
+  CTimeout timeout(2000);
+  while (tv->GetCurrentVendorId() != CEC_VENDOR_PULSE_EIGHT && timeout.TimeLeft() > 0)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  CHECK(tv->GetCurrentVendorId() == CEC_VENDOR_PULSE_EIGHT);
+
+  // a command to us that the handler claims isn't answered by libCEC
+  g_iCommandHandlerResult = 1;
+  CHECK(adapter->Transmit(osdName));
+  CHECK(WaitForCommandHandlerCalls(3));
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  CHECK(!adapter->ClaimCommand(reply));
+  CHECK(FeatureAbortsSent(adapter) == iAborts);
+
+  // one that isn't claimed in time is answered with a feature abort
+  g_iCommandHandlerResult = 0;
+  CHECK(adapter->Transmit(osdName));
+  CHECK(WaitForCommandHandlerCalls(4));
+  timeout.Init(2000);
+  while (FeatureAbortsSent(adapter) == iAborts && timeout.TimeLeft() > 0)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  CHECK(FeatureAbortsSent(adapter) == iAborts + 1);
+  CHECK(!adapter->ClaimCommand(reply));
+
+  adapter->Close();
+  CECDestroy(adapter);
+}
+
+#if defined(HAVE_DAEMON_API)
+static void TestDaemon(void)
+{
+  // the daemon only uses its libCEC instance to log, it's never opened
+  libcec_configuration config;
+  config.Clear();
+  ICECAdapter *lib = CECInitialise(&config);
+  CHECK(lib != NULL);
+  if (!lib)
+    return;
+
+  char strSocket[64];
+  snprintf(strSocket, sizeof(strSocket), "/tmp/cec-virtual-test-%d.sock", (int)getpid());
+  CDaemonCECServer *server = new CDaemonCECServer(static_cast<CLibCEC *>(lib));
+  CHECK(server->Start("virtual:tv,playback,speed=0", strSocket));
+
+  std::string strPort("daemon:");
+  strPort += strSocket;
+
+  // every client takes its own logical address, and sees the others on the bus
+  ICECAdapter *first = OpenVirtual(strPort.c_str(), CEC_DEVICE_TYPE_RECORDING_DEVICE);
+  CHECK(first != NULL);
+  ICECAdapter *second = OpenVirtual(strPort.c_str(), CEC_DEVICE_TYPE_RECORDING_DEVICE);
+  CHECK(second != NULL);
+  CHECK(server->ClientCount() == 2);
+
+  if (first && second)
+  {
+    CHECK(first->GetLogicalAddresses().primary == CECDEVICE_RECORDINGDEVICE1);
+    CHECK(second->GetLogicalAddresses().primary == CECDEVICE_RECORDINGDEVICE2);
+    CHECK(first->GetDeviceOSDName(CECDEVICE_PLAYBACKDEVICE1) == "Playback");
+    CHECK(second->GetDeviceOSDName(CECDEVICE_RECORDINGDEVICE1) == "cec-test");
+    CHECK(second->GetDevicePhysicalAddress(CECDEVICE_RECORDINGDEVICE1) == first->GetDevicePhysicalAddress(CECDEVICE_RECORDINGDEVICE1));
+
+    // clients can't send from an address that another client claimed, or that nobody claimed
+    cec_command command;
+    cec_command::Format(command, CECDEVICE_RECORDINGDEVICE1, CECDEVICE_TV, CEC_OPCODE_GIVE_OSD_NAME);
+    CHECK(!second->Transmit(command));
+    cec_command::Format(command, CECDEVICE_PLAYBACKDEVICE2, CECDEVICE_RECORDINGDEVICE1, CEC_OPCODE_GIVE_OSD_NAME);
+    CHECK(!second->Transmit(command));
+    cec_command::Format(command, CECDEVICE_RECORDINGDEVICE2, CECDEVICE_RECORDINGDEVICE1, CEC_OPCODE_GIVE_OSD_NAME);
+    CHECK(second->Transmit(command));
+  }
+
+  if (first)
+  {
+    first->Close();
+    CECDestroy(first);
+  }
+  if (second)
+  {
+    second->Close();
+    CECDestroy(second);
+  }
+
+  // stopping the daemon removes the socket
+  delete server;
+  CHECK(access(strSocket, F_OK) != 0);
+  CECDestroy(lib);
+}
+#endif
+
+static void TestStandby(void)
+{
+  ICECAdapter *adapter = OpenVirtual("virtual:tv:standby,speed=0", CEC_DEVICE_TYPE_RECORDING_DEVICE);
+  CHECK(adapter != NULL);
+  if (!adapter)
+    return;
+
+  CHECK(adapter->GetLogicalAddresses().primary == CECDEVICE_RECORDINGDEVICE1);
+  CHECK(adapter->GetDevicePowerStatus(CECDEVICE_TV) == CEC_POWER_STATUS_STANDBY);
+  CHECK(adapter->GetDeviceOSDName(CECDEVICE_TV) == "TV");
+
+  adapter->Close();
+  CECDestroy(adapter);
+}
+
+static void TestTimers(void)
+{
+  CCECTimerService timers;
+  std::atomic<int> iOneShot(0), iPeriodic(0), iLong(0), iCancelled(0);
+  std::atomic<int64_t> iLongFiredAt(0);
+
+  int64_t iStart = GetTimeMs();
+  timers.Schedule(20, [&]() { ++iOneShot; return (uint32_t)0; });
+  uint64_t iPeriodicTimer = timers.Schedule(10, [&]() { ++iPeriodic; return (uint32_t)10; });
+  // further away than a slot on level 0 covers, so this one moves down a level first
+  timers.Schedule(300, [&]() { ++iLong; iLongFiredAt = GetTimeMs(); return (uint32_t)0; });
+  uint64_t iCancelledTimer = timers.Schedule(50, [&]() { ++iCancelled; return (uint32_t)0; });
+  CHECK(timers.Cancel(iCancelledTimer));
+  CHECK(!timers.Cancel(iCancelledTimer));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  CHECK(iOneShot == 1);
+  CHECK(iPeriodic >= 5);
+  CHECK(timers.Cancel(iPeriodicTimer));
+  int iPeriodicRuns = iPeriodic;
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(250));
+  CHECK(iPeriodic == iPeriodicRuns);
+  CHECK(iCancelled == 0);
+  CHECK(iLong == 1);
+  CHECK(iLongFiredAt - iStart >= 300 && iLongFiredAt - iStart < 400);
+
+  // move a timer that is far away forward
+  std::atomic<int> iMoved(0);
+  uint64_t iMovedTimer = timers.Schedule(60000, [&]() { ++iMoved; return (uint32_t)0; });
+  CHECK(timers.Reschedule(iMovedTimer, 10));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  CHECK(iMoved == 1);
+  CHECK(!timers.Reschedule(iMovedTimer, 10));
+
+  // cancelling a timer whose callback runs waits for the callback
+  std::atomic<bool> bRunning(false), bDone(false);
+  uint64_t iSlowTimer = timers.Schedule(0, [&]() {
+    bRunning = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    bDone = true;
+    return (uint32_t)1;
+  });
+  while (!bRunning)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  CHECK(timers.Cancel(iSlowTimer));
+  CHECK(bDone);
+  CHECK(timers.Size() == 0);
+
+  // and the thread doesn't wake up when there's nothing to do
+  uint64_t iWakeups = timers.GetWakeups();
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  CHECK(timers.GetWakeups() == iWakeups);
+}
+
+static void TestCallbackQueue(void)
+{
+  cec_callback_event event;
+  cec_log_message_cpp log;
+  libcec_configuration config;
+  cec_keypress key;
+  key.duration = 0;
+
+  // a full log queue drops the oldest message, without counting it as a lost event
+  {
+    CCECCallbackQueue queue(2, 2, 50);
+    for (int iPtr = 0; iPtr < 3; iPtr++)
+    {
+      cec_log_message_cpp message;
+      message.message = std::to_string(iPtr);
+      message.level   = CEC_LOG_DEBUG;
+      message.time    = iPtr;
+      queue.PushLog(message);
+    }
+    CHECK(queue.LogOverflows() == 1);
+    CHECK(queue.Overflows() == 0);
+    CHECK(queue.Pop(event, log, config, 0) && event.type == cec_callback_event::CEC_CB_LOG_MESSAGE && log.message == "1");
+    CHECK(queue.Pop(event, log, config, 0) && log.message == "2");
+    CHECK(!queue.Pop(event, log, config, 1));
+  }
+
+  // configuration changes that weren't delivered yet are coalesced into the first one
+  {
+    CCECCallbackQueue queue(2, 2, 50);
+    libcec_configuration change;
+    change.Clear();
+    key.keycode = CEC_USER_CONTROL_CODE_SELECT;
+    change.iPhysicalAddress = 0x1000;
+    queue.PushConfiguration(change);
+    queue.PushKey(key);
+    change.iPhysicalAddress = 0x2000;
+    queue.PushConfiguration(change);
+
+    size_t iEvents(0), iLogs(0);
+    queue.Size(iEvents, iLogs);
+    CHECK(iEvents == 2);
+    CHECK(queue.Pop(event, log, config, 0) && event.type == cec_callback_event::CEC_CB_CONFIGURATION && config.iPhysicalAddress == 0x2000);
+    CHECK(queue.Pop(event, log, config, 0) && event.type == cec_callback_event::CEC_CB_KEY_PRESS);
+    CHECK(queue.Overflows() == 0);
+  }
+
+  // a full event queue blocks the producer, and the event is dropped and counted when
+  // no space comes free in time
+  {
+    CCECCallbackQueue queue(2, 2, 50);
+    key.keycode = CEC_USER_CONTROL_CODE_UP;
+    queue.PushKey(key);
+    queue.PushKey(key);
+    const int64_t iStart(GetTimeMs());
+    queue.PushKey(key);
+    CHECK(GetTimeMs() - iStart >= 40);
+    CHECK(queue.Overflows() == 1);
+    CHECK(!queue.PushCommandHandler(cec_command()));
+    CHECK(queue.Overflows() == 2);
+  }
+
+  // and is released as soon as the callback thread makes space
+  {
+    CCECCallbackQueue queue(2, 2, 5000);
+    key.keycode = CEC_USER_CONTROL_CODE_DOWN;
+    queue.PushKey(key);
+    queue.PushKey(key);
+    std::thread callbackThread([&queue]() {
+      cec_callback_event popped;
+      cec_log_message_cpp poppedLog;
+      libcec_configuration poppedConfig;
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      queue.Pop(popped, poppedLog, poppedConfig, 0);
+    });
+    const int64_t iStart(GetTimeMs());
+    queue.PushKey(key);
+    CHECK(GetTimeMs() - iStart < 5000);
+    callbackThread.join();
+    CHECK(queue.Overflows() == 0);
+    size_t iEvents(0), iLogs(0);
+    queue.Size(iEvents, iLogs);
+    CHECK(iEvents == 2);
+  }
+}
+
+static void TestInputBufferOrder(void)
+{
+  CCECInputBuffer buffer;
+  cec_command command;
+
+  cec_command::Format(command, CECDEVICE_PLAYBACKDEVICE1, CECDEVICE_BROADCAST, CEC_OPCODE_ACTIVE_SOURCE);
+  CHECK(buffer.Push(command));
+  cec_command::Format(command, CECDEVICE_TV, CECDEVICE_BROADCAST, CEC_OPCODE_STANDBY);
+  CHECK(buffer.Push(command));
+  cec_command::Format(command, CECDEVICE_AUDIOSYSTEM, CECDEVICE_BROADCAST, CEC_OPCODE_DEVICE_VENDOR_ID);
+  buffer.Requeue(command);
+  cec_command::Format(command, CECDEVICE_RECORDINGDEVICE1, CECDEVICE_BROADCAST, CEC_OPCODE_DEVICE_VENDOR_ID);
+  buffer.Requeue(command);
+  cec_command::Format(command, CECDEVICE_TV, CECDEVICE_BROADCAST, CEC_OPCODE_ROUTING_CHANGE);
+  CHECK(buffer.Push(command));
+  CHECK(buffer.Size() == 3);
+
+  // TV frames first, then the requeued ones in their order, then the rest
+  const cec_logical_address expected[] = { CECDEVICE_TV, CECDEVICE_TV, CECDEVICE_AUDIOSYSTEM, CECDEVICE_RECORDINGDEVICE1, CECDEVICE_PLAYBACKDEVICE1 };
+  const cec_opcode expectedOpcodes[] = { CEC_OPCODE_STANDBY, CEC_OPCODE_ROUTING_CHANGE, CEC_OPCODE_DEVICE_VENDOR_ID, CEC_OPCODE_DEVICE_VENDOR_ID, CEC_OPCODE_ACTIVE_SOURCE };
+  for (size_t iPtr = 0; iPtr < sizeof(expected) / sizeof(expected[0]); iPtr++)
+  {
+    CHECK(buffer.Pop(command, 10));
+    CHECK(command.initiator == expected[iPtr]);
+    CHECK(command.opcode == expectedOpcodes[iPtr]);
+  }
+
+  CHECK(!buffer.Pop(command, 10));
+  CHECK(buffer.Size() == 0);
+}
+
+struct test_transmit_result
+{
+  test_transmit_result(void) : destination(CECDEVICE_UNKNOWN), iValue(0) {}
+  test_transmit_result(cec_logical_address dest, int value) : destination(dest), iValue(value) {}
+
+  cec_logical_address destination;
+  int                 iValue;
+};
+
+struct test_transmit_matcher
+{
+  bool operator()(const cec_command &command, const test_transmit_result &result) const
+  {
+    return command.destination == result.destination;
+  }
+};
+
+static void TestAdapterMessageQueue(void)
+{
+  typedef CAdapterMessageQueue<test_transmit_result, test_transmit_matcher, 3> queue_type;
+  test_transmit_result result;
+  cec_command tv, playback;
+  cec_command::Format(tv, CECDEVICE_RECORDINGDEVICE1, CECDEVICE_TV, CEC_OPCODE_GIVE_OSD_NAME);
+  cec_command::Format(playback, CECDEVICE_RECORDINGDEVICE1, CECDEVICE_PLAYBACKDEVICE1, CEC_OPCODE_GIVE_OSD_NAME);
+
+  // a result goes to the oldest transmit that it matches, not to the lowest slot
+  {
+    queue_type queue;
+    int iFirst = queue.Add(tv);
+    int iSecond = queue.Add(tv);
+    int iThird = queue.Add(playback);
+    CHECK(iFirst == 0 && iSecond == 1 && iThird == 2);
+    CHECK(queue.Add(tv) == -1);
+
+    queue.Remove(iFirst);
+    int iNewest = queue.Add(tv);
+    CHECK(iNewest == iFirst);
+
+    CHECK(queue.MessageReceived(test_transmit_result(CECDEVICE_TV, 1)));
+    CHECK(queue.MessageReceived(test_transmit_result(CECDEVICE_TV, 2)));
+    CHECK(!queue.MessageReceived(test_transmit_result(CECDEVICE_TV, 3)));
+    CHECK(queue.MessageReceived(test_transmit_result(CECDEVICE_PLAYBACKDEVICE1, 4)));
+    CHECK(queue.Wait(iSecond, 1000, result) && result.iValue == 1);
+    CHECK(queue.Wait(iNewest, 1000, result) && result.iValue == 2);
+    CHECK(queue.Wait(iThird, 1000, result) && result.iValue == 4);
+    CHECK(!queue.Wait(iThird, 1000, result));
+  }
+
+  // a transmit that timed out gives up its slot, and doesn't take a late result
+  {
+    queue_type queue;
+    CHECK(queue.Add(tv) == 0);
+    CHECK(queue.Add(tv) == 1);
+    CHECK(queue.Add(tv) == 2);
+    CHECK(queue.Add(tv) == -1);
+
+    const int64_t iStart(GetTimeMs());
+    CHECK(!queue.Wait(1, 20, result));
+    CHECK(GetTimeMs() - iStart >= 20);
+    CHECK(queue.Add(playback) == 1);
+    CHECK(!queue.MessageReceived(test_transmit_result(CECDEVICE_AUDIOSYSTEM, 1)));
+    CHECK(queue.MessageReceived(test_transmit_result(CECDEVICE_PLAYBACKDEVICE1, 2)));
+    CHECK(queue.Wait(1, 1000, result) && result.iValue == 2);
+  }
+
+  // Clear() wakes up the transmits that are waiting, without a result
+  {
+    queue_type queue;
+    int iFirst = queue.Add(tv);
+    int iSecond = queue.Add(playback);
+    std::atomic<int> iWoken(0), iResults(0);
+    std::vector<std::thread> waiters;
+    for (int iSlot : { iFirst, iSecond })
+      waiters.emplace_back([&queue, &iWoken, &iResults, iSlot]() {
+        test_transmit_result waited;
+        if (queue.Wait(iSlot, 5000, waited))
+          ++iResults;
+        ++iWoken;
+      });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(iWoken == 0);
+    const int64_t iStart(GetTimeMs());
+    queue.Clear();
+    for (auto &waiter : waiters)
+      waiter.join();
+    CHECK(GetTimeMs() - iStart < 1000);
+    CHECK(iWoken == 2);
+    CHECK(iResults == 0);
+    CHECK(queue.Add(tv) == 0);
+  }
+}
+
+static void TestIdleWakeups(void)
+{
+  ICECAdapter *adapter = OpenVirtual("virtual:tv,speed=0", CEC_DEVICE_TYPE_PLAYBACK_DEVICE);
+  CHECK(adapter != NULL);
+  if (!adapter)
+    return;
+
+  // an idle connection only sets timers that are seconds away
+  CCECTimerService *timers = static_cast<CLibCEC *>(adapter)->GetTimers();
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  uint64_t iWakeups = timers->GetWakeups();
+  std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+  CHECK(timers->GetWakeups() - iWakeups <= 1);
+
+  adapter->Close();
+  CECDestroy(adapter);
+}
+
+int main(void)
+{
+  TestDiscovery();
+  TestNack();
+  TestMultipleTypes();
+  TestScanBus();
+  TestRoutingTree();
+  TestDeviceCache();
+  TestTrafficCapture();
+  TestLatencyStats();
+  TestStatusSnapshot();
+  TestTransmitBatch();
+  TestTransmitScheduling();
+  TestReplyMatching();
+  TestCommandHandlerFilter();
+#if defined(HAVE_DAEMON_API)
+  TestDaemon();
+#endif
+  TestStandby();
+  TestTimers();
+  TestInputBufferOrder();
+  TestCallbackQueue();
+  TestAdapterMessageQueue();
+  TestIdleWakeups();
+
+  if (g_iFailures > 0)
+  {
+    fprintf(stderr, "%d check(s) failed\n", g_iFailures);
+    return 1;
+  }
+
+  printf("all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,379 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011-2015 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+
+/*
+ * Runs two libCEC instances over the Linux kernel CEC framework, against the
+ * emulated adapters of the vivid test driver (modprobe vivid), which are
+ * connected to each other. This tests the Linux backend end to end without
+ * HDMI hardware, and reports the transmit latency, the throughput and the
+ * delivery of received frames to the client under load.
+ *
+ * Exits with 77, which ctest reports as skipped, when there are no vivid nodes.
+ */
+
+#include "cec.h"
+#include "platform/util/timeutils.h"
+#include <algorithm>
+#include <atomic>
+#include <fcntl.h>
+#include <linux/cec.h>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace CEC;
+
+#define VIVID_SKIP_RETURN_CODE 77
+#define VIVID_MAX_DEVICES      64
+#define VIVID_FRAMES           50
+#define VIVID_POLLS            20
+#define VIVID_DELIVERY_WAIT_MS 5000
+
+static int g_iFailures(0);
+
+#define CHECK(expr) \
+  do { \
+    if (!(expr)) \
+    { \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+      ++g_iFailures; \
+    } \
+  } while (0)
+
+typedef struct vivid_node
+{
+  std::string strPath;
+  std::string strName; /**< eg. vivid-000-vid-cap0 or vivid-000-vid-out0 */
+} vivid_node;
+
+/*!
+ * @brief The frames that the receiving instance passed on to the client,
+ *        keyed by the sequence number in the frame.
+ */
+class CVividReceiver
+{
+public:
+  CVividReceiver(void) :
+    m_iReceived(0),
+    m_iSentUs(VIVID_FRAMES, 0),
+    m_iDeliveredUs(VIVID_FRAMES, 0) {}
+
+  void Sent(uint16_t iSequence)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (iSequence < m_iSentUs.size())
+      m_iSentUs[iSequence] = GetTimeUs();
+  }
+
+  void Received(const cec_command &command)
+  {
+    if (command.opcode != CEC_OPCODE_VENDOR_COMMAND || command.parameters.size != 2)
+      return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint16_t iSequence = (uint16_t)(command.parameters[0] << 8 | command.parameters[1]);
+    if (iSequence < m_iDeliveredUs.size() && !m_iDeliveredUs[iSequence])
+    {
+      m_iDeliveredUs[iSequence] = GetTimeUs();
+      ++m_iReceived;
+    }
+  }
+
+  unsigned int Received(void) const { return m_iReceived; }
+
+  /*!
+   * @return the time between the start of the transmission and the callback, for the frames that arrived.
+   */
+  std::vector<int64_t> DeliveryUs(void)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<int64_t> delays;
+    for (size_t iPtr = 0; iPtr < m_iSentUs.size(); iPtr++)
+      if (m_iSentUs[iPtr] && m_iDeliveredUs[iPtr])
+        delays.push_back(m_iDeliveredUs[iPtr] - m_iSentUs[iPtr]);
+    return delays;
+  }
+
+private:
+  std::mutex                m_mutex;
+  std::atomic<unsigned int> m_iReceived;
+  std::vector<int64_t>      m_iSentUs;
+  std::vector<int64_t>      m_iDeliveredUs;
+};
+
+static void CecCommand(void *cbParam, const cec_command *command)
+{
+  static_cast<CVividReceiver *>(cbParam)->Received(*command);
+}
+
+static void FindVividNodes(std::vector<vivid_node> &nodes)
+{
+  for (unsigned int iDevice = 0; iDevice < VIVID_MAX_DEVICES; iDevice++)
+  {
+    char path[32];
+    snprintf(path, sizeof(path), "/dev/cec%u", iDevice);
+
+    int fd = open(path, O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+      continue;
+
+    struct cec_caps caps = {};
+    if (!ioctl(fd, CEC_ADAP_G_CAPS, &caps) && !strcmp(caps.driver, "vivid"))
+    {
+      vivid_node node;
+      node.strPath = path;
+      node.strName = caps.name;
+      nodes.push_back(node);
+    }
+    close(fd);
+  }
+}
+
+/*!
+ * @brief Pick an HDMI input (the TV side) and an HDMI output of the same vivid
+ *        instance, since only the adapters of one instance share a bus.
+ */
+static bool SelectNodes(const std::vector<vivid_node> &nodes, vivid_node &tv, vivid_node &playback)
+{
+  for (size_t iCap = 0; iCap < nodes.size(); iCap++)
+  {
+    size_t iPos = nodes[iCap].strName.find("-vid-cap");
+    if (iPos == std::string::npos)
+      continue;
+
+    const std::string strInstance(nodes[iCap].strName.substr(0, iPos));
+    for (size_t iOut = 0; iOut < nodes.size(); iOut++)
+    {
+      if (nodes[iOut].strName.compare(0, iPos + 8, strInstance + "-vid-out") == 0)
+      {
+        tv = nodes[iCap];
+        playback = nodes[iOut];
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+static ICECAdapter *OpenNode(const vivid_node &node, cec_device_type type, const char *strName, ICECCallbacks *callbacks = NULL, void *cbParam = NULL)
+{
+  libcec_configuration config;
+  config.Clear();
+  snprintf(config.strDeviceName, sizeof(config.strDeviceName), "%s", strName);
+  config.bActivateSource = 0;
+  config.deviceTypes.Add(type);
+  config.callbacks = callbacks;
+  config.callbackParam = cbParam;
+
+  ICECAdapter *adapter = CECInitialise(&config);
+  if (adapter && !adapter->Open(node.strPath.c_str()))
+  {
+    fprintf(stderr, "couldn't open %s (%s)\n", node.strPath.c_str(), node.strName.c_str());
+    CECDestroy(adapter);
+    adapter = NULL;
+  }
+  return adapter;
+}
+
+static void PrintLatency(const char *strName, std::vector<int64_t> values)
+{
+  if (values.empty())
+  {
+    printf("%-18s no samples\n", strName);
+    return;
+  }
+
+  std::sort(values.begin(), values.end());
+  int64_t iTotal(0);
+  for (size_t iPtr = 0; iPtr < values.size(); iPtr++)
+    iTotal += values[iPtr];
+
+  printf("%-18s %4u samples, min %7.2f ms, avg %7.2f ms, p95 %7.2f ms, max %7.2f ms\n", strName,
+         (unsigned int)values.size(),
+         values.front() / 1000.0,
+         iTotal / (double)values.size() / 1000.0,
+         values[(values.size() * 95) / 100] / 1000.0,
+         values.back() / 1000.0);
+}
+
+static void TestDiscovery(ICECAdapter *tv, ICECAdapter *playback)
+{
+  const cec_logical_address tvAddress(tv->GetLogicalAddresses().primary);
+  const cec_logical_address playbackAddress(playback->GetLogicalAddresses().primary);
+  CHECK(tvAddress == CECDEVICE_TV);
+  CHECK(playbackAddress == CECDEVICE_PLAYBACKDEVICE1);
+
+  CHECK(playback->PollDevice(tvAddress));
+  CHECK(tv->PollDevice(playbackAddress));
+  CHECK(!tv->PollDevice(CECDEVICE_TUNER1));
+  CHECK(tv->GetDeviceOSDName(playbackAddress) == "vivid-playback");
+}
+
+static void TestTransmitLatency(ICECAdapter *tv, ICECAdapter *playback)
+{
+  // a poll is the shortest frame there is, so this is the round trip through
+  // libCEC, the kernel and the emulated bus
+  const cec_logical_address playbackAddress(playback->GetLogicalAddresses().primary);
+  std::vector<int64_t> latency;
+  for (unsigned int iPoll = 0; iPoll < VIVID_POLLS; iPoll++)
+  {
+    int64_t iStartUs = GetTimeUs();
+    bool bAcked = tv->PollDevice(playbackAddress);
+    CHECK(bAcked);
+    if (bAcked)
+      latency.push_back(GetTimeUs() - iStartUs);
+  }
+  PrintLatency("poll", latency);
+
+  // a request that has to be answered by the other instance
+  latency.clear();
+  for (unsigned int iRequest = 0; iRequest < VIVID_POLLS / 4; iRequest++)
+  {
+    int64_t iStartUs = GetTimeUs();
+    uint16_t iAddress = tv->GetDevicePhysicalAddress(playbackAddress);
+    CHECK(iAddress != CEC_INVALID_PHYSICAL_ADDRESS);
+    if (iAddress != CEC_INVALID_PHYSICAL_ADDRESS)
+      latency.push_back(GetTimeUs() - iStartUs);
+  }
+  PrintLatency("request/reply", latency);
+}
+
+static void TestThroughput(ICECAdapter *tv, ICECAdapter *playback, CVividReceiver &receiver)
+{
+  // send a numbered frame after the other, and check that every one of them
+  // reaches the client of the other instance
+  const cec_logical_address tvAddress(tv->GetLogicalAddresses().primary);
+  const cec_logical_address playbackAddress(playback->GetLogicalAddresses().primary);
+
+  unsigned int iAcked(0);
+  int64_t iStartUs = GetTimeUs();
+  for (uint16_t iSequence = 0; iSequence < VIVID_FRAMES; iSequence++)
+  {
+    cec_command command;
+    cec_command::Format(command, tvAddress, playbackAddress, CEC_OPCODE_VENDOR_COMMAND);
+    command.parameters.PushBack((uint8_t)(iSequence >> 8));
+    command.parameters.PushBack((uint8_t)(iSequence & 0xFF));
+
+    receiver.Sent(iSequence);
+    if (tv->Transmit(command))
+      ++iAcked;
+  }
+  int64_t iElapsedUs = GetTimeUs() - iStartUs;
+  CHECK(iAcked == VIVID_FRAMES);
+
+  CTimeout timeout(VIVID_DELIVERY_WAIT_MS);
+  while (receiver.Received() < iAcked && timeout.TimeLeft() > 0)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  CHECK(receiver.Received() == iAcked);
+
+  printf("%-18s %4u frames in %.2f s, %.1f frames/s\n", "throughput", iAcked,
+         iElapsedUs / 1000000.0, iElapsedUs > 0 ? iAcked * 1000000.0 / iElapsedUs : 0.0);
+  printf("%-18s %4u of %u acked frames\n", "delivered", receiver.Received(), iAcked);
+  PrintLatency("delivery", receiver.DeliveryUs());
+
+  cec_adapter_stats stats;
+  CHECK(tv->GetStats(&stats));
+  CHECK(stats.tx_ack >= iAcked);
+  CHECK(stats.tx_error == 0);
+  CHECK(playback->GetStats(&stats));
+  CHECK(stats.rx_total >= iAcked);
+
+  cec_adapter_counters counters;
+  memset(&counters, 0, sizeof(counters));
+  counters.version = CEC_ADAPTER_COUNTERS_VERSION;
+  counters.size    = sizeof(cec_adapter_counters);
+  CHECK(playback->GetAdapterCounters(&counters));
+  CHECK(counters.rx_lost == 0);
+  printf("%-18s rx %u, rx errors %u, rx lost %u, rx latency avg %u us, max %u us\n", "playback stats",
+         stats.rx_total, stats.rx_error, counters.rx_lost,
+         counters.rx_latency_count ? (unsigned int)(counters.rx_latency_total_us / counters.rx_latency_count) : 0,
+         counters.rx_latency_max_us);
+}
+
+int main(void)
+{
+  std::vector<vivid_node> nodes;
+  FindVividNodes(nodes);
+
+  vivid_node tvNode, playbackNode;
+  if (!SelectNodes(nodes, tvNode, playbackNode))
+  {
+    printf("no connected vivid CEC nodes found (modprobe vivid), skipping\n");
+    return VIVID_SKIP_RETURN_CODE;
+  }
+  printf("tv: %s (%s), playback: %s (%s)\n", tvNode.strPath.c_str(), tvNode.strName.c_str(),
+         playbackNode.strPath.c_str(), playbackNode.strName.c_str());
+
+  CVividReceiver receiver;
+  ICECCallbacks callbacks;
+  callbacks.commandReceived = CecCommand;
+
+  ICECAdapter *tv = OpenNode(tvNode, CEC_DEVICE_TYPE_TV, "vivid-tv");
+  ICECAdapter *playback = OpenNode(playbackNode, CEC_DEVICE_TYPE_PLAYBACK_DEVICE, "vivid-playback", &callbacks, &receiver);
+  CHECK(tv != NULL);
+  CHECK(playback != NULL);
+
+  if (tv && playback)
+  {
+    TestDiscovery(tv, playback);
+    TestTransmitLatency(tv, playback);
+    TestThroughput(tv, playback, receiver);
+  }
+
+  if (playback)
+  {
+    playback->Close();
+    CECDestroy(playback);
+  }
+  if (tv)
+  {
+    tv->Close();
+    CECDestroy(tv);
+  }
+
+  if (g_iFailures > 0)
+  {
+    fprintf(stderr, "%d check(s) failed\n", g_iFailures);
+    return 1;
+  }
+
+  printf("all checks passed\n");
+  return 0;
+}
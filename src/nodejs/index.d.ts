@@ -108,6 +108,18 @@ export enum CecAdapterType {
   AOCEC = 0x500,
   IMX = 0x600,
   Tegra = 0x700,
+  Virtual = 0x800,
+}
+
+/** What happened to one frame of {@link CecAdapter.transmitBatch}. */
+export enum CecTransmitResult {
+  /** Not passed to the adapter: the frame was invalid, or libCEC isn't connected. */
+  NotSent = 0,
+  Acked = 1,
+  /** Sent, but not acked after all retries. */
+  NotAcked = 2,
+  /** The adapter failed to send the frame, or didn't report the result in time. */
+  Failed = 3,
 }
 
 /** Severity of a {@link CecAdapterEvents.log} message (a bitmask). */
@@ -328,6 +340,13 @@ export class CecAdapter extends EventEmitter {
   // --- Control -------------------------------------------------------------
   /** Transmit a raw CEC command frame. */
   transmit(command: CecCommand): boolean;
+  /**
+   * Transmit several frames in one call, e.g. a key press and its release.
+   * They're all queued at once, so the line isn't idle between frames, and
+   * frames to the same destination go out in order. Returns the result of
+   * each frame.
+   */
+  transmitBatch(commands: CecCommand[]): CecTransmitResult[];
   /** Power on the given device (default: broadcast). */
   powerOnDevices(address?: CecLogicalAddress): boolean;
   /** Put the given device into standby (default: broadcast). */
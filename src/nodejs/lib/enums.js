@@ -87,6 +87,14 @@ const CecAdapterType = Object.freeze({
   AOCEC: 0x500,
   IMX: 0x600,
   Tegra: 0x700,
+  Virtual: 0x800,
+});
+
+const CecTransmitResult = Object.freeze({
+  NotSent: 0,
+  Acked: 1,
+  NotAcked: 2,
+  Failed: 3,
 });
 
 const CecLogLevel = Object.freeze({
@@ -168,6 +176,7 @@ module.exports = {
   CecDisplayControl,
   CecPlayMode,
   CecAdapterType,
+  CecTransmitResult,
   CecLogLevel,
   CecAlert,
   CecUserControlCode,
@@ -51,6 +51,7 @@ class CecAdapter extends EventEmitter {
   close() { this._native.close(); }
 
   transmit(command) { return this._native.transmit(command); }
+  transmitBatch(commands) { return this._native.transmitBatch(commands); }
   powerOnDevices(address = enums.CecLogicalAddress.Broadcast) { return this._native.powerOnDevices(address); }
   standbyDevices(address = enums.CecLogicalAddress.Broadcast) { return this._native.standbyDevices(address); }
   setActiveSource(deviceType = enums.CecDeviceType.Reserved) { return this._native.setActiveSource(deviceType); }
@@ -166,6 +166,7 @@ class CecAdapter : public Napi::ObjectWrap<CecAdapter> {
 
   // control
   Napi::Value Transmit(const Napi::CallbackInfo& info);
+  Napi::Value TransmitBatch(const Napi::CallbackInfo& info);
   Napi::Value PowerOnDevices(const Napi::CallbackInfo& info);
   Napi::Value StandbyDevices(const Napi::CallbackInfo& info);
   Napi::Value SetActiveSource(const Napi::CallbackInfo& info);
@@ -429,6 +430,25 @@ static bool ArgBool(const Napi::CallbackInfo& info, size_t i, bool fallback) {
   return (info.Length() > i && info[i].IsBoolean()) ? info[i].As<Napi::Boolean>().Value() : fallback;
 }
 
+// a CecCommand object -> cec_command
+static void CommandFromObject(const Napi::Object& o, cec_command& cmd) {
+  cmd.Clear();
+  cmd.initiator   = static_cast<cec_logical_address>(o.Has("initiator") ? o.Get("initiator").ToNumber().Int32Value() : CECDEVICE_UNKNOWN);
+  cmd.destination = static_cast<cec_logical_address>(o.Has("destination") ? o.Get("destination").ToNumber().Int32Value() : CECDEVICE_BROADCAST);
+  cmd.opcode      = static_cast<cec_opcode>(o.Get("opcode").ToNumber().Int32Value());
+  cmd.opcode_set  = 1;
+  cmd.eom         = 1;
+  cmd.transmit_timeout = o.Has("transmitTimeout") ? o.Get("transmitTimeout").ToNumber().Int32Value() : 1000;
+  if (o.Has("parameters") && o.Get("parameters").IsArray()) {
+    Napi::Array params = o.Get("parameters").As<Napi::Array>();
+    uint32_t n = params.Length();
+    if (n > 64) n = 64;
+    for (uint32_t i = 0; i < n; ++i)
+      cmd.parameters.data[i] = static_cast<uint8_t>(params.Get(i).ToNumber().Uint32Value());
+    cmd.parameters.size = static_cast<uint8_t>(n);
+  }
+}
+
 // -----------------------------------------------------------------------------
 // lifecycle
 // -----------------------------------------------------------------------------
@@ -459,25 +479,37 @@ Napi::Value CecAdapter::Transmit(const Napi::CallbackInfo& info) {
     Napi::TypeError::New(env, "transmit(command) expects an object").ThrowAsJavaScriptException();
     return env.Undefined();
   }
-  Napi::Object o = info[0].As<Napi::Object>();
-  cec_command cmd;  // its ctor clears it; cec_command is not trivially copyable
-  cmd.initiator   = static_cast<cec_logical_address>(o.Has("initiator") ? o.Get("initiator").ToNumber().Int32Value() : CECDEVICE_UNKNOWN);
-  cmd.destination = static_cast<cec_logical_address>(o.Has("destination") ? o.Get("destination").ToNumber().Int32Value() : CECDEVICE_BROADCAST);
-  cmd.opcode      = static_cast<cec_opcode>(o.Get("opcode").ToNumber().Int32Value());
-  cmd.opcode_set  = 1;
-  cmd.eom         = 1;
-  cmd.transmit_timeout = o.Has("transmitTimeout") ? o.Get("transmitTimeout").ToNumber().Int32Value() : 1000;
-  if (o.Has("parameters") && o.Get("parameters").IsArray()) {
-    Napi::Array params = o.Get("parameters").As<Napi::Array>();
-    uint32_t n = params.Length();
-    if (n > 64) n = 64;
-    for (uint32_t i = 0; i < n; ++i)
-      cmd.parameters.data[i] = static_cast<uint8_t>(params.Get(i).ToNumber().Uint32Value());
-    cmd.parameters.size = static_cast<uint8_t>(n);
-  }
+  cec_command cmd;  // cec_command is not trivially copyable
+  CommandFromObject(info[0].As<Napi::Object>(), cmd);
   return Napi::Boolean::New(env, libcec_transmit(connection_, &cmd) != 0);
 }
 
+// one crossing into libCEC for the whole sequence, instead of one per frame
+Napi::Value CecAdapter::TransmitBatch(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  REQUIRE_CONN(env);
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    Napi::TypeError::New(env, "transmitBatch(commands) expects an array").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Array list = info[0].As<Napi::Array>();
+  std::vector<cec_command> cmds(list.Length());
+  for (uint32_t i = 0; i < list.Length(); ++i) {
+    Napi::Value v = list.Get(i);
+    if (!v.IsObject()) {
+      Napi::TypeError::New(env, "transmitBatch(commands) expects an array of objects").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    CommandFromObject(v.As<Napi::Object>(), cmds[i]);
+  }
+  std::vector<cec_transmit_result> results(cmds.size(), CEC_TRANSMIT_RESULT_NOT_SENT);
+  libcec_transmit_batch(connection_, cmds.data(), cmds.size(), results.data());
+  Napi::Array out = Napi::Array::New(env, results.size());
+  for (uint32_t i = 0; i < results.size(); ++i)
+    out.Set(i, Napi::Number::New(env, results[i]));
+  return out;
+}
+
 Napi::Value CecAdapter::PowerOnDevices(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   REQUIRE_CONN(env);
@@ -757,6 +789,7 @@ Napi::Object CecAdapter::Init(Napi::Env env, Napi::Object exports) {
     InstanceMethod("open", &CecAdapter::Open),
     InstanceMethod("close", &CecAdapter::Close),
     InstanceMethod("transmit", &CecAdapter::Transmit),
+    InstanceMethod("transmitBatch", &CecAdapter::TransmitBatch),
     InstanceMethod("powerOnDevices", &CecAdapter::PowerOnDevices),
     InstanceMethod("standbyDevices", &CecAdapter::StandbyDevices),
     InstanceMethod("setActiveSource", &CecAdapter::SetActiveSource),
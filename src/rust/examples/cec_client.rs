@@ -342,7 +342,10 @@ fn run_command(cec: &Connection, line: &str) -> Result<bool, Error> {
                 println!("  {address}");
             }
         }
-        "stats" => println!("{:?}", cec.stats()?),
+        "stats" => {
+            println!("{:?}", cec.stats()?);
+            println!("{:?}", cec.counters()?);
+        }
         "mon" => cec.switch_monitoring(rest.first() != Some(&"0"))?,
         "ping" => {
             cec.ping_adapter()?;
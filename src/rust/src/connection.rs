@@ -34,6 +34,7 @@ use std::ffi::CString;
 use std::fmt;
 use std::os::raw::{c_char, c_int, c_void};
 use std::panic::{catch_unwind, AssertUnwindSafe};
+use std::path::{Path, PathBuf};
 use std::pin::Pin;
 use std::ptr;
 use std::sync::Arc;
@@ -41,14 +42,14 @@ use std::time::Duration;
 
 use crate::callbacks::CecCallbacks;
 use crate::enums::{
-    Alert, CecVersion, DeckControlMode, DeckInfo, DeviceType, DisplayControl, LogicalAddress,
-    MenuState, PlayMode, PowerStatus, UserControlCode,
+    Alert, CecVersion, DeckControlMode, DeckInfo, DeviceType, DisplayControl, LogLevel,
+    LogicalAddress, MenuState, Opcode, PlayMode, PowerStatus, TransmitResult, UserControlCode,
 };
 use crate::error::{Error, Result};
 use crate::ffi;
 use crate::types::{
-    set_device_name, AdapterDescriptor, AdapterStats, AudioStatus, Command, Configuration,
-    Keypress, LogMessage, LogicalAddresses,
+    set_device_name, AdapterCounters, AdapterDescriptor, AdapterStats, AudioStatus, BusScan,
+    Command, Configuration, Keypress, LogMessage, LogicalAddresses,
 };
 use crate::util::{as_c_bool, from_c_bool, read_fixed, read_ptr};
 
@@ -230,6 +231,7 @@ pub struct ConnectionBuilder {
     device_name: String,
     device_types: Vec<DeviceType>,
     handler: Option<Arc<dyn CecCallbacks>>,
+    device_cache: Option<PathBuf>,
 }
 
 impl ConnectionBuilder {
@@ -247,6 +249,7 @@ impl ConnectionBuilder {
             device_name: device_name.into(),
             device_types: vec![DeviceType::RecordingDevice],
             handler: None,
+            device_cache: None,
         }
     }
 
@@ -355,6 +358,16 @@ impl ConnectionBuilder {
         self
     }
 
+    /// Remember what's known about the devices on the bus in this file, so a
+    /// restarted process doesn't have to ask every device again. The file is
+    /// read when the connection opens and written when it closes; libCEC
+    /// checks the cached devices in the background and drops the ones that
+    /// changed or went away.
+    pub fn device_cache(mut self, path: impl Into<PathBuf>) -> Self {
+        self.device_cache = Some(path.into());
+        self
+    }
+
     /// Open the first adapter that can be opened.
     ///
     /// Adapters that another process is already using are skipped, so this
@@ -372,6 +385,20 @@ impl ConnectionBuilder {
     pub fn open(mut self, port: Option<&str>, timeout: Duration) -> Result<Connection> {
         set_device_name(&mut self.config, &self.device_name)?;
 
+        let device_cache_c = match &self.device_cache {
+            Some(path) => {
+                let path = path.to_str().ok_or(Error::InvalidString {
+                    field: "device_cache",
+                    reason: "is not valid UTF-8",
+                })?;
+                Some(CString::new(path).map_err(|_| Error::InvalidString {
+                    field: "device_cache",
+                    reason: "contains an interior NUL byte",
+                })?)
+            }
+            None => None,
+        };
+
         // Clear() leaves every slot RESERVED, which is how libCEC spells "not
         // claimed"; fill from the front and leave the rest alone.
         for (slot, device_type) in self
@@ -425,6 +452,12 @@ impl ConnectionBuilder {
         // SAFETY: handle is live.
         unsafe { ffi::libcec_init_video_standalone(handle) };
 
+        // Has to be set before opening, which is when the cache is read.
+        if let Some(path) = &device_cache_c {
+            // SAFETY: handle is live; libCEC copies the string.
+            unsafe { ffi::libcec_set_device_cache_path(handle, path.as_ptr()) };
+        }
+
         // A null port asks libCEC to open the first adapter it can, walking past
         // any that another process holds. Doing the detection here instead would
         // only be able to try one of them.
@@ -641,6 +674,86 @@ impl Connection {
         )
     }
 
+    /// Send several raw CEC messages in one call, e.g. a key press and its
+    /// release. They are all queued before libCEC waits for any of them, so
+    /// the line isn't idle between frames. Messages to the same destination go
+    /// out in the given order.
+    ///
+    /// Returns what happened to each message. Unlike with
+    /// [`transmit`](Self::transmit), a message that wasn't acked isn't an error.
+    pub fn transmit_batch(&self, commands: &[Command]) -> Result<Vec<TransmitResult>> {
+        let raw = commands
+            .iter()
+            .map(Command::to_raw)
+            .collect::<Result<Vec<_>>>()?;
+        let mut results: Vec<ffi::cec_transmit_result> = vec![0; raw.len()];
+        // SAFETY: handle is live; raw and results both hold raw.len() elements
+        // that outlive the call.
+        let ok = unsafe {
+            ffi::libcec_transmit_batch(self.handle(), raw.as_ptr(), raw.len(), results.as_mut_ptr())
+        };
+        if ok < 0 {
+            return Err(Error::Call("transmit a batch of commands"));
+        }
+        Ok(results.into_iter().map(TransmitResult::from_raw).collect())
+    }
+
+    /// Only pass commands with these opcodes to
+    /// [`command_handler`](CecCallbacks::command_handler), or every command
+    /// with `None`.
+    ///
+    /// Without a `claim_timeout` libCEC waits for the handler's answer, as it
+    /// always did. With one, the handler runs without holding up libCEC, and
+    /// matching commands sent to one of our devices are left to the
+    /// application: they have to be claimed in time, by returning `true` from
+    /// the handler or with [`claim_command`](Self::claim_command), or libCEC
+    /// answers them with a feature abort. Broadcasts are still processed by
+    /// libCEC as well.
+    pub fn set_command_handler_filter(
+        &self,
+        opcodes: Option<&[Opcode]>,
+        claim_timeout: Option<Duration>,
+    ) -> Result<()> {
+        let raw: Vec<ffi::cec_opcode> = opcodes
+            .unwrap_or_default()
+            .iter()
+            .map(|opcode| opcode.raw())
+            .collect();
+        let count =
+            u8::try_from(raw.len()).map_err(|_| Error::Call("set the command handler filter"))?;
+        let timeout_ms = claim_timeout.map_or(0, |timeout| {
+            u32::try_from(timeout.as_millis())
+                .unwrap_or(u32::MAX)
+                .max(1)
+        });
+        let ptr = if opcodes.is_some() {
+            raw.as_ptr()
+        } else {
+            ptr::null()
+        };
+        // SAFETY: handle is live; ptr is null or points at count opcodes that
+        // outlive the call.
+        self.check(
+            unsafe {
+                ffi::libcec_set_command_handler_filter(self.handle(), ptr, count, timeout_ms)
+            },
+            "set the command handler filter",
+        )
+    }
+
+    /// Claim a command that the command handler received without libCEC
+    /// waiting for it, so libCEC doesn't answer it with a feature abort.
+    ///
+    /// Fails when the command wasn't waiting for a claim, or no longer is.
+    pub fn claim_command(&self, command: &Command) -> Result<()> {
+        let raw = command.to_raw()?;
+        // SAFETY: handle is live; raw is a fully initialised local.
+        self.check(
+            unsafe { ffi::libcec_claim_command(self.handle(), &raw) },
+            "claim a command",
+        )
+    }
+
     /// Send a keypress. With `wait`, blocks until the device answers.
     pub fn send_keypress(
         &self,
@@ -686,6 +799,21 @@ impl Connection {
         )
     }
 
+    /// Only deliver log messages of these levels to the log callback.
+    ///
+    /// libCEC skips formatting messages that no client wants, so leaving
+    /// traffic and debug out is noticeably cheaper on a busy bus.
+    pub fn set_log_levels(&self, levels: &[LogLevel]) -> Result<()> {
+        let mask = levels
+            .iter()
+            .fold(0u32, |mask, level| mask | level.raw() as u32);
+        // SAFETY: handle is live.
+        self.check(
+            unsafe { ffi::libcec_set_log_level_mask(self.handle(), mask) },
+            "set the log level mask",
+        )
+    }
+
     /// Put a message on a device's on-screen display.
     ///
     /// Not every television implements this, and those that do often cap the
@@ -778,6 +906,23 @@ impl Connection {
         LogicalAddresses::from_raw(&raw)
     }
 
+    /// Find every device on the bus and read its properties in one go.
+    ///
+    /// Unlike calling [`device_vendor_id`](Self::device_vendor_id),
+    /// [`device_osd_name`](Self::device_osd_name) and friends per address,
+    /// libCEC sends the requests for all devices together and waits for the
+    /// replies together. Properties it already knows are not requested again.
+    pub fn scan_bus(&self) -> Result<BusScan> {
+        let mut raw = ffi::cec_bus_scan::default();
+        // SAFETY: handle is live; raw is a valid target.
+        let ok = unsafe { ffi::libcec_scan_bus(self.handle(), &mut raw) };
+        if from_c_bool(ok) {
+            Ok(BusScan::from_raw(&raw))
+        } else {
+            Err(Error::Call("scan the bus"))
+        }
+    }
+
     /// Whether a device is present at `address`.
     pub fn is_active_device(&self, address: LogicalAddress) -> bool {
         // SAFETY: handle is live.
@@ -956,6 +1101,23 @@ impl Connection {
         }
     }
 
+    /// The counters that don't fit in [`AdapterStats`]: receive latency, frames
+    /// the adapter dropped, and callbacks that were dropped.
+    pub fn counters(&self) -> Result<AdapterCounters> {
+        let mut raw = ffi::cec_adapter_counters {
+            version: ffi::CEC_ADAPTER_COUNTERS_VERSION,
+            size: std::mem::size_of::<ffi::cec_adapter_counters>() as u32,
+            ..Default::default()
+        };
+        // SAFETY: handle is live; raw is a valid target with version and size set.
+        let ok = unsafe { ffi::libcec_get_adapter_counters(self.handle(), &mut raw) };
+        if from_c_bool(ok) {
+            Ok(AdapterCounters::from_raw(&raw))
+        } else {
+            Err(Error::Call("read the adapter counters"))
+        }
+    }
+
     /// The adapter's USB vendor id, or 0 for a SoC-native backend.
     pub fn adapter_vendor_id(&self) -> u16 {
         // SAFETY: handle is live.
@@ -968,6 +1130,38 @@ impl Connection {
         unsafe { ffi::libcec_get_adapter_product_id(self.handle()) }
     }
 
+    /// Write every frame that goes over the bus to a pcap file, or stop when
+    /// `path` is `None`.
+    ///
+    /// The file can be opened again as the port `replay:<path>` to play the
+    /// traffic back without a bus.
+    pub fn set_traffic_capture(&self, path: Option<&Path>) -> Result<()> {
+        let path_c = match path {
+            Some(path) => {
+                let path = path.to_str().ok_or(Error::InvalidString {
+                    field: "traffic_capture",
+                    reason: "is not valid UTF-8",
+                })?;
+                Some(CString::new(path).map_err(|_| Error::InvalidString {
+                    field: "traffic_capture",
+                    reason: "contains an interior NUL byte",
+                })?)
+            }
+            None => None,
+        };
+        // SAFETY: handle is live; path_c, when there is one, is a valid C
+        // string that libCEC copies.
+        self.check(
+            unsafe {
+                ffi::libcec_set_traffic_capture(
+                    self.handle(),
+                    path_c.as_ref().map_or(ptr::null(), |p| p.as_ptr()),
+                )
+            },
+            "start the traffic capture",
+        )
+    }
+
     /// Put the adapter into its bootloader for a firmware update.
     ///
     /// The connection is unusable afterwards: the adapter stops speaking CEC
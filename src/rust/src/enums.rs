@@ -149,6 +149,8 @@ pub enum AdapterType {
     Imx,
     /// `ADAPTERTYPE_TEGRA`
     Tegra,
+    /// `ADAPTERTYPE_VIRTUAL`
+    Virtual,
     /// A value libCEC reported that this crate has no name for.
     ///
     /// The CEC bus carries whatever devices put on it, so this is
@@ -170,6 +172,7 @@ impl AdapterType {
             AdapterType::Aocec => 1280,
             AdapterType::Imx => 1536,
             AdapterType::Tegra => 1792,
+            AdapterType::Virtual => 2048,
             AdapterType::Other(value) => value,
         }
     }
@@ -188,6 +191,7 @@ impl AdapterType {
             1280 => AdapterType::Aocec,
             1536 => AdapterType::Imx,
             1792 => AdapterType::Tegra,
+            2048 => AdapterType::Virtual,
             other => AdapterType::Other(other),
         }
     }
@@ -1370,6 +1374,63 @@ impl fmt::Display for SystemAudioStatus {
     }
 }
 
+/// What happened to one frame of a batch.
+///
+/// Mirrors the C `cec_transmit_result`.
+#[derive(Copy, Clone, PartialEq, Eq, Hash, Debug)]
+pub enum TransmitResult {
+    /// `CEC_TRANSMIT_RESULT_NOT_SENT`
+    NotSent,
+    /// `CEC_TRANSMIT_RESULT_ACKED`
+    Acked,
+    /// `CEC_TRANSMIT_RESULT_NOT_ACKED`
+    NotAcked,
+    /// `CEC_TRANSMIT_RESULT_FAILED`
+    Failed,
+    /// A value libCEC reported that this crate has no name for.
+    ///
+    /// The CEC bus carries whatever devices put on it, so this is
+    /// data, not an error.
+    Other(i32),
+}
+
+impl TransmitResult {
+    /// The value libCEC uses for this variant.
+    pub fn raw(self) -> i32 {
+        match self {
+            TransmitResult::NotSent => 0,
+            TransmitResult::Acked => 1,
+            TransmitResult::NotAcked => 2,
+            TransmitResult::Failed => 3,
+            TransmitResult::Other(value) => value,
+        }
+    }
+
+    /// Read a value libCEC produced. Total: anything unrecognised
+    /// becomes [`TransmitResult::Other`].
+    pub fn from_raw(value: i32) -> Self {
+        match value {
+            0 => TransmitResult::NotSent,
+            1 => TransmitResult::Acked,
+            2 => TransmitResult::NotAcked,
+            3 => TransmitResult::Failed,
+            other => TransmitResult::Other(other),
+        }
+    }
+}
+
+impl From<i32> for TransmitResult {
+    fn from(value: i32) -> Self {
+        Self::from_raw(value)
+    }
+}
+
+impl From<TransmitResult> for i32 {
+    fn from(value: TransmitResult) -> Self {
+        value.raw()
+    }
+}
+
 /// A remote control key.
 ///
 /// Mirrors the C `cec_user_control_code`.
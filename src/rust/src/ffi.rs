@@ -1,4 +1,4 @@
-﻿// This file is part of the libCEC(R) library.
+// This file is part of the libCEC(R) library.
 //
 // libCEC(R) is Copyright (C) 2011-2026 Pulse-Eight Limited.  All rights reserved.
 // libCEC(R) is an original work, containing original code.
@@ -99,6 +99,9 @@ pub const CEC_ADAPTER_PATH_SIZE: usize = 1024;
 /// Width of [`cec_adapter_descriptor::strDeviceName`].
 pub const CEC_ADAPTER_NAME_SIZE: usize = 64;
 
+/// The [`cec_adapter_counters`] version that this binding describes.
+pub const CEC_ADAPTER_COUNTERS_VERSION: u32 = 1;
+
 // ---------------------------------------------------------------------------
 // enum aliases
 //
@@ -121,6 +124,7 @@ pub type cec_opcode = c_int;
 pub type cec_play_mode = c_int;
 pub type cec_power_status = c_int;
 pub type cec_system_audio_status = c_int;
+pub type cec_transmit_result = c_int;
 pub type cec_user_control_code = c_int;
 pub type cec_vendor_id = c_int;
 pub type cec_version = c_int;
@@ -264,6 +268,49 @@ pub struct cec_adapter_stats {
     pub rx_error: c_uint,
 }
 
+/// Counters next to [`cec_adapter_stats`], filled in by
+/// [`libcec_get_adapter_counters`]. `version` and `size` are set by the caller.
+#[repr(C)]
+#[derive(Copy, Clone, Debug)]
+pub struct cec_adapter_counters {
+    pub version: u32,
+    pub size: u32,
+    pub rx_latency_total_us: u64,
+    pub rx_latency_count: u32,
+    pub rx_latency_max_us: u32,
+    pub rx_lost: u32,
+    pub cb_overflow: u32,
+}
+
+/// One device found by [`libcec_scan_bus`].
+#[repr(C)]
+#[derive(Copy, Clone, Debug)]
+pub struct cec_device_info {
+    pub logicalAddress: cec_logical_address,
+    pub iPhysicalAddress: u16,
+    pub iVendorId: u32,
+    pub cecVersion: cec_version,
+    pub powerStatus: cec_power_status,
+    pub strOSDName: [c_char; CEC_OSD_NAME_SIZE],
+    pub strMenuLanguage: [c_char; CEC_MENU_LANGUAGE_SIZE],
+    pub bActiveSource: u8,
+    pub bHandledByLibCEC: u8,
+}
+
+/// The result of [`libcec_scan_bus`]. Only the first `iDeviceCount` entries of
+/// `devices` are filled in.
+#[repr(C)]
+#[derive(Copy, Clone, Debug)]
+pub struct cec_bus_scan {
+    pub devices: [cec_device_info; CEC_LOGICAL_ADDRESS_COUNT],
+    pub iDeviceCount: u8,
+    pub activeSource: cec_logical_address,
+    pub iRequests: u8,
+    pub iReplies: u8,
+    pub iPollTimeMs: u32,
+    pub iRequestTimeMs: u32,
+}
+
 // The callback signatures. libCEC invokes all of these from its own worker
 // thread, never from the caller's, and `CEC_CDECL` is `__cdecl` on 32-bit
 // Windows - which is what `extern "C"` already means there.
@@ -396,6 +443,9 @@ zeroed_default!(
     cec_logical_addresses,
     libcec_parameter,
     cec_adapter_stats,
+    cec_adapter_counters,
+    cec_device_info,
+    cec_bus_scan,
     ICECCallbacks,
     libcec_configuration,
 );
@@ -462,6 +512,19 @@ extern "C" {
         connection: libcec_connection_t,
         stats: *mut cec_adapter_stats,
     ) -> c_int;
+    pub fn libcec_get_adapter_counters(
+        connection: libcec_connection_t,
+        counters: *mut cec_adapter_counters,
+    ) -> c_int;
+    pub fn libcec_scan_bus(connection: libcec_connection_t, scan: *mut cec_bus_scan) -> c_int;
+    pub fn libcec_set_device_cache_path(
+        connection: libcec_connection_t,
+        path: *const c_char,
+    ) -> c_int;
+    pub fn libcec_set_traffic_capture(
+        connection: libcec_connection_t,
+        path: *const c_char,
+    ) -> c_int;
 
     // -- power / source -----------------------------------------------------
 
@@ -496,6 +559,12 @@ extern "C" {
     // -- transmit / input ---------------------------------------------------
 
     pub fn libcec_transmit(connection: libcec_connection_t, data: *const cec_command) -> c_int;
+    pub fn libcec_transmit_batch(
+        connection: libcec_connection_t,
+        commands: *const cec_command,
+        iCount: usize,
+        results: *mut cec_transmit_result,
+    ) -> c_int;
     pub fn libcec_send_keypress(
         connection: libcec_connection_t,
         iDestination: cec_logical_address,
@@ -512,6 +581,17 @@ extern "C" {
         iDestination: cec_logical_address,
         mode: cec_play_mode,
     ) -> c_int;
+    pub fn libcec_set_log_level_mask(connection: libcec_connection_t, iMask: u32) -> c_int;
+    pub fn libcec_set_command_handler_filter(
+        connection: libcec_connection_t,
+        opcodes: *const cec_opcode,
+        iCount: u8,
+        iClaimTimeoutMs: u32,
+    ) -> c_int;
+    pub fn libcec_claim_command(
+        connection: libcec_connection_t,
+        command: *const cec_command,
+    ) -> c_int;
     pub fn libcec_set_osd_string(
         connection: libcec_connection_t,
         iLogicalAddress: cec_logical_address,
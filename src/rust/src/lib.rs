@@ -153,6 +153,6 @@ pub use callbacks::{CecCallbacks, CecEvent};
 pub use connection::{Connection, ConnectionBuilder, DEFAULT_OPEN_TIMEOUT};
 pub use error::{Error, Result};
 pub use types::{
-    format_physical_address, AdapterDescriptor, AdapterStats, AudioStatus, Command, Configuration,
-    Keypress, LogMessage, LogicalAddresses,
+    format_physical_address, AdapterCounters, AdapterDescriptor, AdapterStats, AudioStatus,
+    BusScan, Command, Configuration, DeviceInfo, Keypress, LogMessage, LogicalAddresses,
 };
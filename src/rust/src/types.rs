@@ -39,7 +39,8 @@ use std::fmt;
 use std::time::Duration;
 
 use crate::enums::{
-    AdapterType, CecVersion, DeviceType, LogLevel, LogicalAddress, Opcode, UserControlCode,
+    AdapterType, CecVersion, DeviceType, LogLevel, LogicalAddress, Opcode, PowerStatus,
+    UserControlCode,
 };
 use crate::error::{Error, Result};
 use crate::ffi;
@@ -411,6 +412,107 @@ impl AdapterStats {
     }
 }
 
+/// Counters that are kept next to [`AdapterStats`]. Counters that the adapter
+/// doesn't keep are 0.
+#[derive(Copy, Clone, PartialEq, Eq, Debug, Default)]
+pub struct AdapterCounters {
+    /// Summed time from the start of each received frame to its delivery, in
+    /// microseconds. Divide by `rx_latency_count` for the average.
+    pub rx_latency_total_us: u64,
+    /// Received frames in `rx_latency_total_us`.
+    pub rx_latency_count: u32,
+    /// The highest latency of a single received frame, in microseconds.
+    pub rx_latency_max_us: u32,
+    /// Received frames that the adapter dropped before libCEC could read them.
+    pub rx_lost: u32,
+    /// Callback events that were dropped because the client's queue was full. Dropped log messages
+    /// aren't counted.
+    pub cb_overflow: u32,
+}
+
+impl AdapterCounters {
+    pub(crate) fn from_raw(raw: &ffi::cec_adapter_counters) -> Self {
+        AdapterCounters {
+            rx_latency_total_us: raw.rx_latency_total_us,
+            rx_latency_count: raw.rx_latency_count,
+            rx_latency_max_us: raw.rx_latency_max_us,
+            rx_lost: raw.rx_lost,
+            cb_overflow: raw.cb_overflow,
+        }
+    }
+}
+
+/// One device found by [`Connection::scan_bus`](crate::Connection::scan_bus).
+#[derive(Clone, PartialEq, Eq, Debug)]
+pub struct DeviceInfo {
+    /// Where it is on the bus.
+    pub logical_address: LogicalAddress,
+    /// Its physical address, or `0xFFFF` when it did not say.
+    pub physical_address: u16,
+    /// Its vendor id, or 0 when it did not say.
+    pub vendor_id: u32,
+    /// The CEC version it speaks.
+    pub cec_version: CecVersion,
+    /// Its power status.
+    pub power_status: PowerStatus,
+    /// The name it shows on screen.
+    pub osd_name: String,
+    /// Its menu language, or `"???"` when it did not say.
+    pub menu_language: String,
+    /// Whether it is the active source.
+    pub active_source: bool,
+    /// Whether it is one of this client's own addresses.
+    pub handled_by_libcec: bool,
+}
+
+impl DeviceInfo {
+    pub(crate) fn from_raw(raw: &ffi::cec_device_info) -> Self {
+        DeviceInfo {
+            logical_address: LogicalAddress::from_raw(raw.logicalAddress),
+            physical_address: raw.iPhysicalAddress,
+            vendor_id: raw.iVendorId,
+            cec_version: CecVersion::from_raw(raw.cecVersion),
+            power_status: PowerStatus::from_raw(raw.powerStatus),
+            osd_name: read_fixed(&raw.strOSDName),
+            menu_language: read_fixed(&raw.strMenuLanguage),
+            active_source: raw.bActiveSource != 0,
+            handled_by_libcec: raw.bHandledByLibCEC != 0,
+        }
+    }
+}
+
+/// Every device on the bus, as found by
+/// [`Connection::scan_bus`](crate::Connection::scan_bus).
+#[derive(Clone, PartialEq, Eq, Debug)]
+pub struct BusScan {
+    /// The devices that are present, our own included.
+    pub devices: Vec<DeviceInfo>,
+    /// The active source, or [`LogicalAddress::Unknown`].
+    pub active_source: LogicalAddress,
+    /// Requests sent for properties that were not known yet.
+    pub requests: u8,
+    /// Requests that were answered.
+    pub replies: u8,
+    /// How long finding the devices took.
+    pub poll_time: Duration,
+    /// How long the requests and the replies took.
+    pub request_time: Duration,
+}
+
+impl BusScan {
+    pub(crate) fn from_raw(raw: &ffi::cec_bus_scan) -> Self {
+        let count = usize::from(raw.iDeviceCount).min(raw.devices.len());
+        BusScan {
+            devices: raw.devices[..count].iter().map(DeviceInfo::from_raw).collect(),
+            active_source: LogicalAddress::from_raw(raw.activeSource),
+            requests: raw.iRequests,
+            replies: raw.iReplies,
+            poll_time: Duration::from_millis(u64::from(raw.iPollTimeMs)),
+            request_time: Duration::from_millis(u64::from(raw.iRequestTimeMs)),
+        }
+    }
+}
+
 /// A snapshot of what libCEC is configured to do.
 ///
 /// Returned by [`Connection::configuration`](crate::Connection::configuration)
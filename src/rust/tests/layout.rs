@@ -93,6 +93,7 @@ fn sizes_match_the_headers() {
     assert_eq!(CEC_MENU_LANGUAGE_SIZE, 4);
     assert_eq!(CEC_DEVICE_TYPE_LIST_SIZE, 5);
     assert_eq!(CEC_LOGICAL_ADDRESS_COUNT, 16);
+    assert_eq!(CEC_ADAPTER_COUNTERS_VERSION, 1);
 
     // C gives every enum in cectypes.h `int` as its underlying type, because the
     // largest value in any of them (CEC_VENDOR_HARMAN_KARDON, 0x9C645E) fits.
@@ -137,6 +138,38 @@ fn pointer_free_structs_match_the_headers() {
     check!(cec_logical_addresses, 68, 4, primary => 0, addresses => 4);
 
     check!(cec_adapter_stats, 20, 4);
+
+    check!(cec_adapter_counters, 32, align_of::<u64>(),
+        version             => 0,
+        size                => 4,
+        rx_latency_total_us => 8,
+        rx_latency_count    => 16,
+        rx_latency_max_us   => 20,
+        rx_lost             => 24,
+        cb_overflow         => 28,
+    );
+
+    check!(cec_device_info, 40, 4,
+        logicalAddress   => 0,
+        iPhysicalAddress => 4,
+        iVendorId        => 8,
+        cecVersion       => 12,
+        powerStatus      => 16,
+        strOSDName       => 20,
+        strMenuLanguage  => 34,
+        bActiveSource    => 38,
+        bHandledByLibCEC => 39,
+    );
+
+    check!(cec_bus_scan, 660, 4,
+        devices        => 0,
+        iDeviceCount   => 640,
+        activeSource   => 644,
+        iRequests      => 648,
+        iReplies       => 649,
+        iPollTimeMs    => 652,
+        iRequestTimeMs => 656,
+    );
 }
 
 #[cfg(target_pointer_width = "64")]
@@ -45,8 +45,8 @@ use std::time::Duration;
 
 use libcec::callbacks::channel;
 use libcec::enums::{
-    AdapterType, CecVersion, DeviceType, LogLevel, LogicalAddress, Opcode, UserControlCode,
-    VendorId,
+    AdapterType, CecVersion, DeviceType, LogLevel, LogicalAddress, Opcode, TransmitResult,
+    UserControlCode, VendorId,
 };
 use libcec::{AudioStatus, CecCallbacks, Command, Connection, ConnectionBuilder, Error, Keypress};
 
@@ -390,3 +390,38 @@ fn trait_callbacks_are_called_on_libcecs_thread() {
         "libCEC logs while opening, so the trait should have been called"
     );
 }
+
+#[test]
+fn a_batch_reports_each_frame() {
+    // The virtual adapter simulates a bus, so this needs no hardware.
+    let cec = ConnectionBuilder::new("RustCEC")
+        .device_type(DeviceType::RecordingDevice)
+        .activate_source(false)
+        .open(Some("virtual:tv,playback,speed=0"), Duration::from_secs(10))
+        .expect("the virtual adapter should open");
+
+    let from_us = |destination, opcode| {
+        Command::new(destination, opcode).from_initiator(LogicalAddress::RecordingDevice1)
+    };
+    let results = cec
+        .transmit_batch(&[
+            from_us(LogicalAddress::PlaybackDevice1, Opcode::UserControlPressed)
+                .with_parameters(vec![UserControlCode::Select.raw() as u8]),
+            from_us(LogicalAddress::PlaybackDevice1, Opcode::UserControlRelease),
+            from_us(
+                LogicalAddress::PlaybackDevice2,
+                Opcode::GiveDevicePowerStatus,
+            ),
+        ])
+        .expect("a valid batch is accepted");
+
+    assert_eq!(
+        results,
+        vec![
+            TransmitResult::Acked,
+            TransmitResult::Acked,
+            TransmitResult::NotAcked
+        ]
+    );
+    assert!(cec.transmit_batch(&[]).expect("an empty batch").is_empty());
+}
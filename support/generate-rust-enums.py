@@ -62,6 +62,8 @@ ENUMS = [
      'The power state a device reports.'),
     ('cec_system_audio_status', 'SystemAudioStatus', 'CEC_SYSTEM_AUDIO_STATUS_',
      'Whether system audio mode is engaged.'),
+    ('cec_transmit_result', 'TransmitResult', 'CEC_TRANSMIT_RESULT_',
+     'What happened to one frame of a batch.'),
     ('cec_user_control_code', 'UserControlCode', 'CEC_USER_CONTROL_CODE_',
      'A remote control key.'),
     ('cec_vendor_id', 'VendorId', 'CEC_VENDOR_',